@@ -0,0 +1,122 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * eagleye_config.hpp
+ * Author MapIV Sekino
+ */
+
+#ifndef BENCHMARK_EAGLEYE_CONFIG_H
+#define BENCHMARK_EAGLEYE_CONFIG_H
+
+#include "navigation/engine.hpp"
+
+// Values of eagleye_rt/config/eagleye_config.yaml
+inline void setEagleyeConfigParameter(EagleyeEngineParameter* p)
+{
+  *p = EagleyeEngineParameter();
+  p->trajectory_timer_update_rate = 10;
+  p->trajectory_th_deadlock_time = 1;
+
+  p->velocity_scale_factor.estimated_number_min = 1000;
+  p->velocity_scale_factor.estimated_number_max = 20000;
+  p->velocity_scale_factor.estimated_velocity_threshold = 2.78;
+  p->velocity_scale_factor.estimated_coefficient = 0.025;
+
+  p->yawrate_offset_stop.stop_judgment_velocity_threshold = 0.01;
+  p->yawrate_offset_stop.estimated_number = 200;
+  p->yawrate_offset_stop.outlier_threshold = 0.002;
+
+  p->angular_velocity_offset_stop.stop_judgment_velocity_threshold = 0.01;
+  p->angular_velocity_offset_stop.estimated_number = 200;
+  p->angular_velocity_offset_stop.outlier_threshold = 0.002;
+
+  p->yawrate_offset_1st.estimated_number_min = 1500;
+  p->yawrate_offset_1st.estimated_number_max = 14000;
+  p->yawrate_offset_1st.estimated_coefficient = 0.01;
+  p->yawrate_offset_1st.estimated_velocity_threshold = 2.78;
+  p->yawrate_offset_1st.outlier_threshold = 0.002;
+  p->yawrate_offset_2nd = p->yawrate_offset_1st;
+  p->yawrate_offset_2nd.estimated_number_max = 25000;
+
+  p->heading.estimated_number_min = 500;
+  p->heading.estimated_number_max = 1500;
+  p->heading.estimated_gnss_coefficient = 0.025;
+  p->heading.estimated_heading_coefficient = 0.0125;
+  p->heading.outlier_threshold = 0.0524;
+  p->heading.estimated_velocity_threshold = 2.78;
+  p->heading.stop_judgment_velocity_threshold = 0.01;
+  p->heading.estimated_yawrate_threshold = 0.0873;
+
+  p->heading_interpolate.stop_judgment_velocity_threshold = 0.01;
+  p->heading_interpolate.number_buffer_max = 100;
+
+  p->slip_angle.stop_judgment_velocity_threshold = 0.01;
+  p->slip_angle.manual_coefficient = 0.0;
+
+  p->trajectory.stop_judgment_velocity_threshold = 0.01;
+
+  p->position.estimated_distance = 300;
+  p->position.separation_distance = 0.1;
+  p->position.estimated_velocity_threshold = 2.78;
+  p->position.outlier_threshold = 3.0;
+  p->position.estimated_enu_vel_coefficient = 0.025;
+  p->position.estimated_position_coefficient = 0.25;
+  p->position.tf_gnss_rotation_w = 1;
+
+  p->position_interpolate.number_buffer_max = 100;
+  p->position_interpolate.stop_judgment_velocity_threshold = 0.01;
+
+  p->smoothing.estimated_number_max = 25;
+  p->smoothing.estimated_velocity_threshold = 2.78;
+  p->smoothing.estimated_threshold = 0.1;
+
+  p->height.estimated_distance = 200;
+  p->height.estimated_distance_max = 2000;
+  p->height.separation_distance = 0.1;
+  p->height.estimated_velocity_threshold = 2.78;
+  p->height.estimated_velocity_coefficient = 0.1;
+  p->height.estimated_height_coefficient = 0.02;
+  p->height.outlier_threshold = 0.3;
+  p->height.average_num = 50;
+
+  p->ekf.stop_judgment_velocity_threshold = 0.01;
+  p->ekf.estimated_velocity_threshold = 2.78;
+  p->ekf.yawrate_noise = 0.001;
+  p->ekf.yawrate_offset_noise = 0.00001;
+  p->ekf.velocity_scale_factor_noise = 0.00001;
+  p->ekf.pitch_noise = 0.002;
+  p->ekf.acc_x_offset_noise = 0.001;
+  p->ekf.position_noise = 0.05;
+  p->ekf.acc_noise = 0.5;
+  p->ekf.gnss_position_noise = 2.0;
+  p->ekf.gnss_height_noise = 3.0;
+  p->ekf.gnss_velocity_noise = 0.1;
+  p->ekf.outlier_threshold = 16;
+  p->ekf.yawrate_offset_std_threshold = 0.0005;
+  p->ekf.velocity_scale_factor_std_threshold = 0.005;
+}
+
+#endif /*BENCHMARK_EAGLEYE_CONFIG_H */
@@ -0,0 +1,278 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * ekf_benchmark.cpp
+ * Author MapIV Sekino
+ */
+
+// Runs EagleyeEngine with the windowed estimators, in ekf mode, and in ekf
+// mode followed by EkfSmoother over the same noisy synthetic drive, and
+// reports the per-tick cost and the error of each against the truth of the
+// drive. The drive has the sensor errors and GNSS events of the
+// golden_regression scenarios. The first 600 s, in which the online
+// estimators converge, are left out of the errors.
+//
+//   rosrun eagleye_navigation ekf_benchmark [minutes] [seed]
+
+#include "navigation/engine.hpp"
+#include "navigation/ekf_smoother.hpp"
+#include "navigation/synthetic_drive.hpp"
+#include "coordinate/coordinate.hpp"
+#include "eagleye_config.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+enum EkfBenchmarkMode
+{
+  WINDOWED,
+  EKF,
+  EKF_SMOOTHED
+};
+
+struct EkfBenchmarkTruth
+{
+  double latitude;
+  double longitude;
+  double altitude;
+  double heading;
+};
+
+struct EkfBenchmarkResult
+{
+  std::vector<double> latency;
+  double backward_time;
+  double fix_error_sum;
+  double fix_error_max;
+  unsigned long fix_count;
+  double heading_error_sum;
+  double heading_error_max;
+  unsigned long heading_count;
+  double height_error_sum;
+  double height_error_max;
+  unsigned long height_count;
+};
+
+static double percentile(std::vector<double> values, double ratio)
+{
+  std::size_t n = static_cast<std::size_t>(ratio * (values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + n, values.end());
+  return values[n];
+}
+
+static double angleDifference(double a, double b)
+{
+  double d = std::fmod(a - b, 2 * M_PI);
+  if (d > M_PI)
+  {
+    d -= 2 * M_PI;
+  }
+  else if (d < -M_PI)
+  {
+    d += 2 * M_PI;
+  }
+  return d;
+}
+
+static void addError(double error, double* sum, double* max, unsigned long* count)
+{
+  *sum += error * error;
+  *max = std::max(*max, error);
+  (*count)++;
+}
+
+// latitude and longitude in degrees
+static void addErrors(bool fix_status, double latitude, double longitude, bool heading_status, double heading,
+                      bool height_status, double height, const EkfBenchmarkTruth& truth, EkfBenchmarkResult* result)
+{
+  if (fix_status)
+  {
+    double north = (latitude - truth.latitude) * M_PI / 180 * 6378137;
+    double east = (longitude - truth.longitude) * M_PI / 180 * 6378137 * std::cos(truth.latitude * M_PI / 180);
+    addError(std::sqrt(east * east + north * north), &result->fix_error_sum, &result->fix_error_max, &result->fix_count);
+  }
+  if (heading_status)
+  {
+    double error = std::abs(angleDifference(heading, truth.heading));
+    addError(error, &result->heading_error_sum, &result->heading_error_max, &result->heading_count);
+  }
+  if (height_status)
+  {
+    double error = std::abs(height - truth.altitude);
+    addError(error, &result->height_error_sum, &result->height_error_max, &result->height_count);
+  }
+}
+
+static SyntheticDriveParameter driveParameter(unsigned int seed)
+{
+  SyntheticDriveParameter p;
+  setDefaultSyntheticDriveParameter(&p);
+  p.gyro_bias_drift = 0.00001;
+  p.gyro_noise = 0.001;
+  p.acc_offset = 0.05;
+  p.acc_scale = 1.01;
+  p.acc_noise = 0.02;
+  p.wheel_speed_noise = 0.02;
+  p.gnss_fix_position_noise = 0.02;
+  p.gnss_velocity_noise = 0.05;
+  p.multipath_probability = 0.001;
+  p.float_probability = 0.0005;
+  p.seed = seed;
+
+  SyntheticGnssEvent outage = { GNSS_OUTAGE, 300, 30, 0 };
+  SyntheticGnssEvent multipath = { GNSS_MULTIPATH, 450, 5, 20 };
+  SyntheticGnssEvent float_period = { GNSS_FLOAT, 600, 60, 0 };
+  p.gnss_events.push_back(outage);
+  p.gnss_events.push_back(multipath);
+  p.gnss_events.push_back(float_period);
+  return p;
+}
+
+static EkfBenchmarkResult run(EkfBenchmarkMode mode, double minutes, unsigned int seed)
+{
+  EagleyeEngineParameter parameter;
+  setEagleyeConfigParameter(&parameter);
+  parameter.use_ekf = mode != WINDOWED;
+  EagleyeEngine engine(parameter);
+  engine.reserve();
+  SyntheticDrive drive(driveParameter(seed));
+  EkfSmoother smoother;
+
+  EkfBenchmarkResult result = EkfBenchmarkResult();
+  std::size_t tick_num = static_cast<std::size_t>(minutes * 60 * 50);
+  std::size_t skip_num = 600 * 50;
+  std::vector<EkfBenchmarkTruth> truth;
+  result.latency.reserve(tick_num);
+
+  for (std::size_t i = 0; i < tick_num; i++)
+  {
+    const SyntheticDriveSample& s = drive.next();
+
+    std::chrono::steady_clock::time_point tick_start = std::chrono::steady_clock::now();
+    engine.addTwist(s.twist);
+    if (s.gnss_updated)
+    {
+      engine.addRtklibNav(s.rtklib_nav);
+      engine.addNavSatFix(s.fix);
+    }
+    const EagleyeEngineOutput& output = engine.addImu(s.imu);
+    if (mode == EKF_SMOOTHED)
+    {
+      const EkfEstimator& ekf = engine.getEkfEstimator();
+      smoother.add(stampToNSec(s.imu.header.stamp), ekf.getStatus(), ekf.getTransition(), ekf.getSlipAngle().slip_angle);
+    }
+    std::chrono::steady_clock::time_point tick_end = std::chrono::steady_clock::now();
+    result.latency.push_back(std::chrono::duration<double, std::micro>(tick_end - tick_start).count());
+
+    EkfBenchmarkTruth sample_truth;
+    sample_truth.latitude = s.truth_fix.latitude;
+    sample_truth.longitude = s.truth_fix.longitude;
+    sample_truth.altitude = s.truth_fix.altitude;
+    sample_truth.heading = s.heading_interpolate.heading_angle;
+    if (mode == EKF_SMOOTHED)
+    {
+      truth.push_back(sample_truth);
+    }
+    else if (i >= skip_num)
+    {
+      addErrors(output.fix_updated && output.enu_absolute_pos_interpolate.status.enabled_status, output.fix.latitude,
+                output.fix.longitude, output.heading_interpolate_3rd_updated && output.heading_interpolate_3rd.status.enabled_status,
+                output.heading_interpolate_3rd.heading_angle, output.height_updated && output.height.status.enabled_status,
+                output.height.height, sample_truth, &result);
+    }
+  }
+
+  if (mode != EKF_SMOOTHED)
+  {
+    return result;
+  }
+
+  std::chrono::steady_clock::time_point backward_start = std::chrono::steady_clock::now();
+  smoother.smooth();
+  result.backward_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - backward_start).count();
+
+  EkfSmoothedState smoothed;
+  for (std::size_t i = 0; smoother.next(&smoothed); i++)
+  {
+    if (i < skip_num)
+    {
+      continue;
+    }
+    double enu_pos[3], llh_pos[3];
+    std::copy(smoothed.state, smoothed.state + 3, enu_pos);
+    enu2llh(enu_pos, smoothed.ecef_base_pos, llh_pos);
+    addErrors(smoothed.position_status && smoothed.heading_status, llh_pos[0] * 180 / M_PI, llh_pos[1] * 180 / M_PI,
+              smoothed.heading_status, smoothed.state[EKF_HEADING] + smoothed.slip_angle, smoothed.height_status,
+              llh_pos[2], truth[i], &result);
+  }
+  return result;
+}
+
+static double rms(double sum, unsigned long count)
+{
+  return count > 0 ? std::sqrt(sum / count) : 0;
+}
+
+static void printResult(const std::string& name, const EkfBenchmarkResult& result)
+{
+  std::cout << name << std::endl;
+  std::cout << "  tick latency p50 " << percentile(result.latency, 0.50) << " [us] p99 "
+            << percentile(result.latency, 0.99) << " [us] max "
+            << *std::max_element(result.latency.begin(), result.latency.end()) << " [us]" << std::endl;
+  if (result.backward_time > 0)
+  {
+    std::cout << "  backward pass " << result.backward_time << " [s], "
+              << result.backward_time * 1e6 / result.latency.size() << " [us] per tick" << std::endl;
+  }
+  std::cout << "  fix error rms " << rms(result.fix_error_sum, result.fix_count) << " [m] max "
+            << result.fix_error_max << " [m] (" << result.fix_count << " samples)" << std::endl;
+  std::cout << "  heading_interpolate error rms " << rms(result.heading_error_sum, result.heading_count) * 180 / M_PI
+            << " [deg] max " << result.heading_error_max * 180 / M_PI << " [deg] (" << result.heading_count
+            << " samples)" << std::endl;
+  std::cout << "  height error rms " << rms(result.height_error_sum, result.height_count) << " [m] max "
+            << result.height_error_max << " [m] (" << result.height_count << " samples)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  double minutes = argc > 1 ? std::atof(argv[1]) : 60.0;
+  unsigned int seed = argc > 2 ? static_cast<unsigned int>(std::atoi(argv[2])) : 1;
+  if (minutes <= 10)
+  {
+    std::cerr << "Usage: ekf_benchmark [minutes] [seed], minutes must be more than 10" << std::endl;
+    return 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "drive " << minutes << " [min] seed " << seed << std::endl;
+  printResult("windowed estimators", run(WINDOWED, minutes, seed));
+  printResult("ekf", run(EKF, minutes, seed));
+  printResult("ekf smoothed", run(EKF_SMOOTHED, minutes, seed));
+  return 0;
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * engine_benchmark.cpp
+ * Author MapIV Sekino
+ */
+
+// Runs the whole eagleye_rt.launch estimator chain (EagleyeEngine) over a
+// synthetic drive of several hours and reports the sustained throughput, the
+// per-tick latency distribution and the peak RSS. One tick is one IMU sample
+// together with the twist and GNSS messages of the same instant.
+//
+//   rosrun eagleye_navigation engine_benchmark [hours]
+
+#include "navigation/engine.hpp"
+#include "navigation/synthetic_drive.hpp"
+#include "eagleye_config.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+static double percentile(std::vector<double>* values, double ratio)
+{
+  std::size_t n = static_cast<std::size_t>(ratio * (values->size() - 1));
+  std::nth_element(values->begin(), values->begin() + n, values->end());
+  return (*values)[n];
+}
+
+int main(int argc, char** argv)
+{
+  double hours = argc > 1 ? std::atof(argv[1]) : 2.0;
+  if (hours <= 0)
+  {
+    std::cerr << "Usage: engine_benchmark [hours]" << std::endl;
+    return 1;
+  }
+
+  EagleyeEngineParameter parameter;
+  setEagleyeConfigParameter(&parameter);
+  EagleyeEngine engine(parameter);
+  SyntheticDrive drive;
+
+  std::size_t tick_num = static_cast<std::size_t>(hours * 3600 * 50);
+  std::vector<double> latency;
+  latency.reserve(tick_num);
+  unsigned long fix_count = 0;
+  unsigned long heading_count = 0;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < tick_num; i++)
+  {
+    const SyntheticDriveSample& s = drive.next();
+
+    std::chrono::steady_clock::time_point tick_start = std::chrono::steady_clock::now();
+    engine.addTwist(s.twist);
+    if (s.gnss_updated)
+    {
+      engine.addRtklibNav(s.rtklib_nav);
+      engine.addNavSatFix(s.fix);
+    }
+    const EagleyeEngineOutput& output = engine.addImu(s.imu);
+    std::chrono::steady_clock::time_point tick_end = std::chrono::steady_clock::now();
+
+    latency.push_back(std::chrono::duration<double, std::micro>(tick_end - tick_start).count());
+    fix_count += output.fix_updated ? 1 : 0;
+    heading_count += output.heading_3rd_updated ? 1 : 0;
+  }
+
+  double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double max_latency = *std::max_element(latency.begin(), latency.end());
+  double p50 = percentile(&latency, 0.50);
+  double p99 = percentile(&latency, 0.99);
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "drive " << hours << " [h]" << std::endl;
+  std::cout << "imu samples " << tick_num << std::endl;
+  std::cout << "wall time " << wall_time << " [s]" << std::endl;
+  std::cout << "imu samples per second " << tick_num / wall_time << std::endl;
+  std::cout << "real-time factor " << hours * 3600 / wall_time << std::endl;
+  std::cout << "tick latency p50 " << p50 << " [us]" << std::endl;
+  std::cout << "tick latency p99 " << p99 << " [us]" << std::endl;
+  std::cout << "tick latency max " << max_latency << " [us]" << std::endl;
+  std::cout << "peak rss " << usage.ru_maxrss / 1024.0 << " [MB]" << std::endl;
+  std::cout << "published fix " << fix_count << " heading_3rd " << heading_count << std::endl;
+
+  return 0;
+}
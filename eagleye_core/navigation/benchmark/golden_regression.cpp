@@ -0,0 +1,648 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * golden_regression.cpp
+ * Author MapIV Sekino
+ */
+
+// Golden output regression check for EagleyeEngine. A fixed synthetic drive
+// (noisy sensors, GNSS outage, multipath and float periods) is run through the
+// whole estimator chain and every published message is flattened to named
+// fields. "record" stores them as text, "check" reruns the drive and compares
+// each field against the stored file with per field tolerances, stopping at
+// the first divergence with the preceding messages as context.
+//
+//   rosrun eagleye_navigation golden_regression record golden.txt   (before the change)
+//   rosrun eagleye_navigation golden_regression check golden.txt    (after the change)
+
+#include "navigation/engine.hpp"
+#include "navigation/synthetic_drive.hpp"
+#include "eagleye_config.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, double> > GoldenFields;
+
+struct GoldenMessage
+{
+  unsigned long tick;
+  std::string topic;
+  std::string stamp;
+  GoldenFields fields;
+};
+
+struct GoldenScenario
+{
+  double duration;
+  unsigned int seed;
+  bool use_rtk_heading;
+  bool use_rtk_deadreckoning;
+};
+
+static void addStatus(const eagleye_msgs::Status& status, GoldenFields* f)
+{
+  f->push_back(std::make_pair("enabled_status", status.enabled_status ? 1.0 : 0.0));
+  f->push_back(std::make_pair("estimate_status", status.estimate_status ? 1.0 : 0.0));
+}
+
+static void addVector3(const std::string& name, double x, double y, double z, GoldenFields* f)
+{
+  f->push_back(std::make_pair(name + ".x", x));
+  f->push_back(std::make_pair(name + ".y", y));
+  f->push_back(std::make_pair(name + ".z", z));
+}
+
+static void flatten(const eagleye_msgs::VelocityScaleFactor& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("scale_factor", m.scale_factor));
+  f->push_back(std::make_pair("correction_velocity.linear.x", m.correction_velocity.linear.x));
+  f->push_back(std::make_pair("correction_velocity.angular.z", m.correction_velocity.angular.z));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::Distance& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("distance", m.distance));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::YawrateOffset& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("yawrate_offset", m.yawrate_offset));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::Heading& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("heading_angle", m.heading_angle));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::SlipAngle& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("coefficient", m.coefficient));
+  f->push_back(std::make_pair("slip_angle", m.slip_angle));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::Height& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("height", m.height));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::Pitching& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("pitching_angle", m.pitching_angle));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::AccXOffset& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("acc_x_offset", m.acc_x_offset));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::AccXScaleFactor& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("acc_x_scale_factor", m.acc_x_scale_factor));
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::AngularVelocityOffset& m, GoldenFields* f)
+{
+  addVector3("angular_velocity_offset", m.angular_velocity_offset.x, m.angular_velocity_offset.y,
+             m.angular_velocity_offset.z, f);
+  addStatus(m.status, f);
+}
+
+static void flatten(const eagleye_msgs::Position& m, GoldenFields* f)
+{
+  addVector3("enu_pos", m.enu_pos.x, m.enu_pos.y, m.enu_pos.z, f);
+  addVector3("ecef_base_pos", m.ecef_base_pos.x, m.ecef_base_pos.y, m.ecef_base_pos.z, f);
+  addStatus(m.status, f);
+}
+
+static void flatten(const sensor_msgs::NavSatFix& m, GoldenFields* f)
+{
+  f->push_back(std::make_pair("status", static_cast<double>(m.status.status)));
+  f->push_back(std::make_pair("latitude", m.latitude));
+  f->push_back(std::make_pair("longitude", m.longitude));
+  f->push_back(std::make_pair("altitude", m.altitude));
+}
+
+static void flatten(const geometry_msgs::Vector3Stamped& m, GoldenFields* f)
+{
+  addVector3("vector", m.vector.x, m.vector.y, m.vector.z, f);
+}
+
+static void flatten(const geometry_msgs::TwistStamped& m, GoldenFields* f)
+{
+  addVector3("twist.linear", m.twist.linear.x, m.twist.linear.y, m.twist.linear.z, f);
+  addVector3("twist.angular", m.twist.angular.x, m.twist.angular.y, m.twist.angular.z, f);
+}
+
+static void flatten(const sensor_msgs::Imu& m, GoldenFields* f)
+{
+  addVector3("angular_velocity", m.angular_velocity.x, m.angular_velocity.y, m.angular_velocity.z, f);
+  addVector3("linear_acceleration", m.linear_acceleration.x, m.linear_acceleration.y, m.linear_acceleration.z, f);
+}
+
+template <class T>
+static void addMessage(unsigned long tick, const std::string& topic, bool updated, const T& msg,
+                       std::vector<GoldenMessage>* messages)
+{
+  if (!updated)
+  {
+    return;
+  }
+
+  char stamp[32];
+  std::snprintf(stamp, sizeof(stamp), "%u.%09u", msg.header.stamp.sec, msg.header.stamp.nsec);
+
+  GoldenMessage message;
+  message.tick = tick;
+  message.topic = topic;
+  message.stamp = stamp;
+  flatten(msg, &message.fields);
+  messages->push_back(message);
+}
+
+// Messages published by one add*() call, in a fixed topic order.
+static void collectOutput(unsigned long tick, const EagleyeEngineOutput& o, std::vector<GoldenMessage>* messages)
+{
+  addMessage(tick, "imu_corrected", o.imu_corrected_updated, o.imu_corrected, messages);
+  addMessage(tick, "velocity_scale_factor", o.velocity_scale_factor_updated, o.velocity_scale_factor, messages);
+  addMessage(tick, "distance", o.distance_updated, o.distance, messages);
+  addMessage(tick, "yawrate_offset_stop", o.yawrate_offset_stop_updated, o.yawrate_offset_stop, messages);
+  addMessage(tick, "angular_velocity_offset_stop", o.angular_velocity_offset_stop_updated,
+             o.angular_velocity_offset_stop, messages);
+  addMessage(tick, "yawrate_offset_1st", o.yawrate_offset_1st_updated, o.yawrate_offset_1st, messages);
+  addMessage(tick, "yawrate_offset_2nd", o.yawrate_offset_2nd_updated, o.yawrate_offset_2nd, messages);
+  addMessage(tick, "heading_1st", o.heading_1st_updated, o.heading_1st, messages);
+  addMessage(tick, "heading_2nd", o.heading_2nd_updated, o.heading_2nd, messages);
+  addMessage(tick, "heading_3rd", o.heading_3rd_updated, o.heading_3rd, messages);
+  addMessage(tick, "heading_interpolate_1st", o.heading_interpolate_1st_updated, o.heading_interpolate_1st, messages);
+  addMessage(tick, "heading_interpolate_2nd", o.heading_interpolate_2nd_updated, o.heading_interpolate_2nd, messages);
+  addMessage(tick, "heading_interpolate_3rd", o.heading_interpolate_3rd_updated, o.heading_interpolate_3rd, messages);
+  addMessage(tick, "slip_angle", o.slip_angle_updated, o.slip_angle, messages);
+  addMessage(tick, "height", o.height_updated, o.height, messages);
+  addMessage(tick, "pitching", o.pitching_updated, o.pitching, messages);
+  addMessage(tick, "acc_x_offset", o.acc_x_offset_updated, o.acc_x_offset, messages);
+  addMessage(tick, "acc_x_scale_factor", o.acc_x_scale_factor_updated, o.acc_x_scale_factor, messages);
+  addMessage(tick, "reliability_fix", o.reliability_fix_updated, o.reliability_fix, messages);
+  addMessage(tick, "enu_vel", o.enu_vel_updated, o.enu_vel, messages);
+  addMessage(tick, "enu_relative_pos", o.enu_relative_pos_updated, o.enu_relative_pos, messages);
+  addMessage(tick, "twist", o.twist_updated, o.twist, messages);
+  addMessage(tick, "enu_absolute_pos", o.enu_absolute_pos_updated, o.enu_absolute_pos, messages);
+  addMessage(tick, "enu_absolute_pos_interpolate", o.enu_absolute_pos_interpolate_updated,
+             o.enu_absolute_pos_interpolate, messages);
+  addMessage(tick, "fix", o.fix_updated, o.fix, messages);
+  addMessage(tick, "gnss_smooth_pos_enu", o.gnss_smooth_pos_enu_updated, o.gnss_smooth_pos_enu, messages);
+  addMessage(tick, "enu_absolute_rtk_deadreckoning", o.enu_absolute_rtk_deadreckoning_updated,
+             o.enu_absolute_rtk_deadreckoning, messages);
+  addMessage(tick, "rtk_fix", o.rtk_fix_updated, o.rtk_fix, messages);
+}
+
+// Runs the scenario drive, handing over the messages of every tick.
+class GoldenDrive
+{
+public:
+  explicit GoldenDrive(const GoldenScenario& scenario) : tick_(0), tick_num_(0), drive_(driveParameter(scenario))
+  {
+    EagleyeEngineParameter parameter;
+    setEagleyeConfigParameter(&parameter);
+    parameter.use_rtk_heading = scenario.use_rtk_heading;
+    parameter.use_rtk_deadreckoning = scenario.use_rtk_deadreckoning;
+    engine_.reset(new EagleyeEngine(parameter));
+    tick_num_ = static_cast<unsigned long>(scenario.duration * 50);
+  }
+
+  bool next(std::vector<GoldenMessage>* messages)
+  {
+    messages->clear();
+    if (tick_ >= tick_num_)
+    {
+      return false;
+    }
+
+    const SyntheticDriveSample& s = drive_.next();
+    collectOutput(tick_, engine_->addTwist(s.twist), messages);
+    if (s.gnss_updated)
+    {
+      collectOutput(tick_, engine_->addRtklibNav(s.rtklib_nav), messages);
+      collectOutput(tick_, engine_->addNavSatFix(s.fix), messages);
+    }
+    collectOutput(tick_, engine_->addImu(s.imu), messages);
+    tick_++;
+    return true;
+  }
+
+private:
+  static SyntheticDriveParameter driveParameter(const GoldenScenario& scenario)
+  {
+    SyntheticDriveParameter p;
+    setDefaultSyntheticDriveParameter(&p);
+    p.gyro_bias_drift = 0.00001;
+    p.gyro_noise = 0.001;
+    p.acc_offset = 0.05;
+    p.acc_scale = 1.01;
+    p.acc_noise = 0.02;
+    p.wheel_speed_noise = 0.02;
+    p.gnss_fix_position_noise = 0.02;
+    p.gnss_velocity_noise = 0.05;
+    p.multipath_probability = 0.001;
+    p.float_probability = 0.0005;
+    p.seed = scenario.seed;
+
+    SyntheticGnssEvent outage = { GNSS_OUTAGE, 300, 30, 0 };
+    SyntheticGnssEvent multipath = { GNSS_MULTIPATH, 450, 5, 20 };
+    SyntheticGnssEvent float_period = { GNSS_FLOAT, 600, 60, 0 };
+    p.gnss_events.push_back(outage);
+    p.gnss_events.push_back(multipath);
+    p.gnss_events.push_back(float_period);
+    return p;
+  }
+
+  unsigned long tick_;
+  unsigned long tick_num_;
+  SyntheticDrive drive_;
+  std::unique_ptr<EagleyeEngine> engine_;
+};
+
+static std::string toString(const GoldenMessage& message)
+{
+  std::ostringstream line;
+  line << message.tick << " " << message.topic << " " << message.stamp;
+  char value[32];
+  for (std::size_t i = 0; i < message.fields.size(); i++)
+  {
+    std::snprintf(value, sizeof(value), "%.17g", message.fields[i].second);
+    line << " " << message.fields[i].first << "=" << value;
+  }
+  return line.str();
+}
+
+static bool parse(const std::string& line, GoldenMessage* message)
+{
+  std::istringstream stream(line);
+  if (!(stream >> message->tick >> message->topic >> message->stamp))
+  {
+    return false;
+  }
+
+  message->fields.clear();
+  std::string field;
+  while (stream >> field)
+  {
+    std::string::size_type pos = field.find('=');
+    if (pos == std::string::npos)
+    {
+      return false;
+    }
+    message->fields.push_back(std::make_pair(field.substr(0, pos), std::strtod(field.c_str() + pos + 1, NULL)));
+  }
+  return true;
+}
+
+// Tolerances by "topic/field", then by "field", then "*". Status flags and
+// NavSatFix status are compared exactly.
+class GoldenTolerance
+{
+public:
+  GoldenTolerance()
+  {
+    tolerance_["*"] = 1e-9;
+    tolerance_["enabled_status"] = 0;
+    tolerance_["estimate_status"] = 0;
+    tolerance_["status"] = 0;
+  }
+
+  bool set(const std::string& arg)
+  {
+    std::string::size_type pos = arg.find('=');
+    if (pos == std::string::npos)
+    {
+      return false;
+    }
+    tolerance_[arg.substr(0, pos)] = std::atof(arg.c_str() + pos + 1);
+    return true;
+  }
+
+  double get(const std::string& topic, const std::string& field) const
+  {
+    std::map<std::string, double>::const_iterator it = tolerance_.find(topic + "/" + field);
+    if (it == tolerance_.end())
+    {
+      it = tolerance_.find(field);
+    }
+    if (it == tolerance_.end())
+    {
+      it = tolerance_.find("*");
+    }
+    return it->second;
+  }
+
+private:
+  std::map<std::string, double> tolerance_;
+};
+
+static std::string scenarioHeader(const GoldenScenario& scenario)
+{
+  std::ostringstream header;
+  header << "# eagleye_golden duration " << scenario.duration << " seed " << scenario.seed << " use_rtk_heading "
+         << scenario.use_rtk_heading << " use_rtk_deadreckoning " << scenario.use_rtk_deadreckoning;
+  return header.str();
+}
+
+static bool parseScenarioHeader(const std::string& line, GoldenScenario* scenario)
+{
+  std::istringstream stream(line);
+  std::string hash, magic, key;
+  if (!(stream >> hash >> magic) || hash != "#" || magic != "eagleye_golden")
+  {
+    return false;
+  }
+  while (stream >> key)
+  {
+    if (key == "duration")
+      stream >> scenario->duration;
+    else if (key == "seed")
+      stream >> scenario->seed;
+    else if (key == "use_rtk_heading")
+      stream >> scenario->use_rtk_heading;
+    else if (key == "use_rtk_deadreckoning")
+      stream >> scenario->use_rtk_deadreckoning;
+    else
+      return false;
+  }
+  return static_cast<bool>(stream.eof());
+}
+
+static int record(const std::string& file, const GoldenScenario& scenario)
+{
+  std::ofstream output(file.c_str());
+  if (!output)
+  {
+    std::cerr << "cannot open " << file << std::endl;
+    return 1;
+  }
+
+  output << scenarioHeader(scenario) << "\n";
+
+  GoldenDrive drive(scenario);
+  std::vector<GoldenMessage> messages;
+  unsigned long message_count = 0;
+  while (drive.next(&messages))
+  {
+    for (std::size_t i = 0; i < messages.size(); i++)
+    {
+      output << toString(messages[i]) << "\n";
+    }
+    message_count += messages.size();
+  }
+
+  output.close();
+  if (!output)
+  {
+    std::cerr << "failed to write " << file << std::endl;
+    return 1;
+  }
+
+  std::cout << "recorded " << message_count << " messages to " << file << std::endl;
+  return 0;
+}
+
+static void printContext(const std::deque<std::string>& context)
+{
+  std::cout << "preceding messages:" << std::endl;
+  for (std::size_t i = 0; i < context.size(); i++)
+  {
+    std::cout << "  " << context[i] << std::endl;
+  }
+}
+
+static std::string compare(const GoldenMessage& golden, const GoldenMessage& current, const GoldenTolerance& tolerance,
+                           std::map<std::string, double>* max_error)
+{
+  if (golden.tick != current.tick || golden.topic != current.topic || golden.stamp != current.stamp ||
+      golden.fields.size() != current.fields.size())
+  {
+    return "message differs";
+  }
+
+  for (std::size_t i = 0; i < golden.fields.size(); i++)
+  {
+    const std::string& name = golden.fields[i].first;
+    if (name != current.fields[i].first)
+    {
+      return "field " + name + " differs";
+    }
+
+    double expected = golden.fields[i].second;
+    double actual = current.fields[i].second;
+    double error = std::fabs(actual - expected);
+    if (std::isnan(expected) && std::isnan(actual))
+    {
+      error = 0;
+    }
+    else if (std::isnan(expected) || std::isnan(actual) || (std::isinf(expected) && expected != actual))
+    {
+      error = INFINITY;
+    }
+
+    double& max = (*max_error)[golden.topic + "/" + name];
+    max = std::max(max, error);
+
+    double limit = tolerance.get(golden.topic, name);
+    if (!(error <= limit))
+    {
+      std::ostringstream reason;
+      reason.precision(17);
+      reason << "field " << name << " expected " << expected << " actual " << actual << " error " << error
+             << " tolerance " << limit;
+      return reason.str();
+    }
+  }
+  return "";
+}
+
+static int check(const std::string& file, const GoldenTolerance& tolerance)
+{
+  std::ifstream input(file.c_str());
+  std::string line;
+  GoldenScenario scenario = GoldenScenario();
+  if (!input || !std::getline(input, line) || !parseScenarioHeader(line, &scenario))
+  {
+    std::cerr << "cannot read golden file " << file << std::endl;
+    return 1;
+  }
+  std::cout << line.substr(2) << std::endl;
+
+  GoldenDrive drive(scenario);
+  std::vector<GoldenMessage> messages;
+  std::deque<std::string> context;
+  std::map<std::string, double> max_error;
+  unsigned long message_count = 0;
+  bool golden_end = false;
+
+  while (drive.next(&messages))
+  {
+    for (std::size_t i = 0; i < messages.size(); i++)
+    {
+      GoldenMessage golden;
+      std::string reason;
+      golden_end = !std::getline(input, line);
+      if (golden_end)
+      {
+        reason = "golden file ends";
+      }
+      else if (!parse(line, &golden))
+      {
+        reason = "cannot parse golden line";
+      }
+      else
+      {
+        reason = compare(golden, messages[i], tolerance, &max_error);
+      }
+
+      if (!reason.empty())
+      {
+        std::cout << "DIVERGED at message " << message_count << " (tick " << messages[i].tick << "): " << reason
+                  << std::endl;
+        printContext(context);
+        std::cout << "golden:  " << (golden_end ? "<end of file>" : line) << std::endl;
+        std::cout << "current: " << toString(messages[i]) << std::endl;
+        return 1;
+      }
+
+      context.push_back(line);
+      if (context.size() > 10)
+      {
+        context.pop_front();
+      }
+      message_count++;
+    }
+  }
+
+  if (std::getline(input, line))
+  {
+    std::cout << "DIVERGED at message " << message_count << ": golden file has more messages" << std::endl;
+    printContext(context);
+    std::cout << "golden:  " << line << std::endl;
+    std::cout << "current: <end of drive>" << std::endl;
+    return 1;
+  }
+
+  std::cout << "max error per field:" << std::endl;
+  for (std::map<std::string, double>::const_iterator it = max_error.begin(); it != max_error.end(); ++it)
+  {
+    if (it->second > 0)
+    {
+      std::cout << "  " << it->first << " " << it->second << std::endl;
+    }
+  }
+  std::cout << "PASSED " << message_count << " messages" << std::endl;
+  return 0;
+}
+
+static void printUsage()
+{
+  std::cerr << "Usage: golden_regression record golden.txt [options]" << std::endl;
+  std::cerr << "       golden_regression check golden.txt [--tolerance NAME=VALUE]..." << std::endl;
+  std::cerr << "  --duration SEC           length of the drive to record (default: 900)" << std::endl;
+  std::cerr << "  --seed N                 sensor noise seed to record (default: 1)" << std::endl;
+  std::cerr << "  --use_rtk_heading        record with use_rtk_heading" << std::endl;
+  std::cerr << "  --use_rtk_deadreckoning  record with use_rtk_deadreckoning" << std::endl;
+  std::cerr << "  --tolerance NAME=VALUE   absolute tolerance of a field, NAME is topic/field, field or *" << std::endl;
+  std::cerr << "                           (default: * = 1e-9, status flags exact)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    printUsage();
+    return 1;
+  }
+
+  std::string mode = argv[1];
+  std::string file = argv[2];
+  GoldenScenario scenario = { 900, 1, false, false };
+  GoldenTolerance tolerance;
+
+  for (int i = 3; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--duration" && i + 1 < argc && mode == "record")
+    {
+      scenario.duration = std::atof(argv[++i]);
+    }
+    else if (arg == "--seed" && i + 1 < argc && mode == "record")
+    {
+      scenario.seed = static_cast<unsigned int>(std::atol(argv[++i]));
+    }
+    else if (arg == "--use_rtk_heading" && mode == "record")
+    {
+      scenario.use_rtk_heading = true;
+    }
+    else if (arg == "--use_rtk_deadreckoning" && mode == "record")
+    {
+      scenario.use_rtk_deadreckoning = true;
+    }
+    else if (arg == "--tolerance" && i + 1 < argc && mode == "check" && tolerance.set(argv[i + 1]))
+    {
+      i++;
+    }
+    else
+    {
+      printUsage();
+      return 1;
+    }
+  }
+
+  if (mode == "record" && scenario.duration > 0)
+  {
+    return record(file, scenario);
+  }
+  if (mode == "check")
+  {
+    return check(file, tolerance);
+  }
+  printUsage();
+  return 1;
+}
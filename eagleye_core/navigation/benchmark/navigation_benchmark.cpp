@@ -0,0 +1,456 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * navigation_benchmark.cpp
+ * Author MapIV Sekino
+ */
+
+// One benchmark per *_estimate function of navigation.hpp. Each estimator is
+// first fed until its window is full and then timed per call on the rest of
+// the synthetic drive. Window sizes are the benchmark arguments.
+//
+//   rosrun eagleye_navigation navigation_benchmark [--benchmark_filter=heading]
+
+#include "navigation/navigation.hpp"
+#include "navigation/synthetic_drive.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <new>
+
+static bool count_allocations = false;
+static unsigned long allocation_count = 0;
+
+void* operator new(std::size_t size)
+{
+  if (count_allocations)
+  {
+    allocation_count++;
+  }
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == NULL)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+// noinline keeps GCC from pairing the inlined free() with operator new.
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+static const std::size_t batch_size = 1000;
+static const double imu_rate = 50;
+
+// Number of samples of the synthetic drive needed to travel |distance| [m]
+// after the initial stop.
+static std::size_t samplesForDistance(double distance)
+{
+  return static_cast<std::size_t>((30 + distance / 12) * imu_rate * 1.2);
+}
+
+// Feeds |warm_up| samples to |step| and then times one call of |step| per
+// iteration. Samples are generated in batches outside the timed region. With
+// |gnss_only| only the samples carrying a new GNSS epoch are passed, for the
+// estimators triggered by rtklib_nav.
+template <class Step>
+static void runEstimate(benchmark::State& state, std::size_t warm_up, bool gnss_only, Step step)
+{
+  SyntheticDrive drive;
+  for (std::size_t i = 0; i < warm_up; i++)
+  {
+    const SyntheticDriveSample& s = drive.next();
+    if (!gnss_only || s.gnss_updated)
+    {
+      step(s);
+    }
+  }
+
+  std::vector<SyntheticDriveSample> samples;
+  samples.reserve(batch_size);
+  std::size_t index = 0;
+
+  allocation_count = 0;
+  count_allocations = true;
+  for (auto _ : state)
+  {
+    if (index == samples.size())
+    {
+      state.PauseTiming();
+      count_allocations = false;
+      samples.clear();
+      while (samples.size() < batch_size)
+      {
+        const SyntheticDriveSample& s = drive.next();
+        if (!gnss_only || s.gnss_updated)
+        {
+          samples.push_back(s);
+        }
+      }
+      index = 0;
+      count_allocations = true;
+      state.ResumeTiming();
+    }
+    step(samples[index++]);
+  }
+  count_allocations = false;
+
+  state.counters["allocs_per_call"] = state.iterations() > 0 ? static_cast<double>(allocation_count) / state.iterations() : 0;
+}
+
+static void BM_velocity_scale_factor_estimate(benchmark::State& state)
+{
+  VelocityScaleFactorParameter parameter = VelocityScaleFactorParameter();
+  parameter.estimated_number_min = 1000;
+  parameter.estimated_number_max = state.range(0);
+  parameter.estimated_velocity_threshold = 2.78;
+  parameter.estimated_coefficient = 0.025;
+  VelocityScaleFactorStatus status = VelocityScaleFactorStatus();
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor;
+
+  runEstimate(state, state.range(0), false, [&](const SyntheticDriveSample& s)
+  {
+    velocity_scale_factor_estimate(s.rtklib_nav, s.twist, parameter, &status, &velocity_scale_factor);
+  });
+}
+BENCHMARK(BM_velocity_scale_factor_estimate)->Arg(5000)->Arg(20000)->Unit(benchmark::kMicrosecond);
+
+static void BM_distance_estimate(benchmark::State& state)
+{
+  DistanceStatus status = DistanceStatus();
+  eagleye_msgs::Distance distance;
+
+  runEstimate(state, 100, false, [&](const SyntheticDriveSample& s)
+  {
+    distance_estimate(s.velocity_scale_factor, &status, &distance);
+  });
+}
+BENCHMARK(BM_distance_estimate)->Unit(benchmark::kMicrosecond);
+
+static void BM_yawrate_offset_stop_estimate(benchmark::State& state)
+{
+  YawrateOffsetStopParameter parameter = YawrateOffsetStopParameter();
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.estimated_number = state.range(0);
+  parameter.outlier_threshold = 0.002;
+  YawrateOffsetStopStatus status = YawrateOffsetStopStatus();
+  eagleye_msgs::YawrateOffset yawrate_offset_stop;
+
+  runEstimate(state, state.range(0), false, [&](const SyntheticDriveSample& s)
+  {
+    yawrate_offset_stop_estimate(s.twist, s.imu, parameter, &status, &yawrate_offset_stop);
+  });
+}
+BENCHMARK(BM_yawrate_offset_stop_estimate)->Arg(200)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_angular_velocity_offset_stop_estimate(benchmark::State& state)
+{
+  AngularVelocityOffsetStopParameter parameter = AngularVelocityOffsetStopParameter();
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.estimated_number = state.range(0);
+  parameter.outlier_threshold = 0.002;
+  AngularVelocityOffsetStopStatus status = AngularVelocityOffsetStopStatus();
+  eagleye_msgs::AngularVelocityOffset angular_velocity_offset_stop;
+
+  runEstimate(state, state.range(0), false, [&](const SyntheticDriveSample& s)
+  {
+    angular_velocity_offset_stop_estimate(s.twist, s.imu, parameter, &status, &angular_velocity_offset_stop);
+  });
+}
+BENCHMARK(BM_angular_velocity_offset_stop_estimate)->Arg(200)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_yawrate_offset_estimate(benchmark::State& state)
+{
+  YawrateOffsetParameter parameter = YawrateOffsetParameter();
+  parameter.estimated_number_min = 1500;
+  parameter.estimated_number_max = state.range(0);
+  parameter.estimated_coefficient = 0.01;
+  parameter.estimated_velocity_threshold = 2.78;
+  parameter.outlier_threshold = 0.002;
+  YawrateOffsetStatus status = YawrateOffsetStatus();
+  eagleye_msgs::YawrateOffset yawrate_offset;
+  ImuHistory imu_history;
+  imu_history.requireCapacity(state.range(0) + 1);
+
+  runEstimate(state, state.range(0), false, [&](const SyntheticDriveSample& s)
+  {
+    yawrate_offset.status.estimate_status = false;
+    imu_history.append(s.imu);
+    yawrate_offset_estimate(s.velocity_scale_factor, s.yawrate_offset_stop, s.heading_interpolate, imu_history, parameter, &status, &yawrate_offset);
+  });
+}
+BENCHMARK(BM_yawrate_offset_estimate)->Arg(14000)->Arg(25000)->Unit(benchmark::kMicrosecond);
+
+static void BM_heading_estimate(benchmark::State& state)
+{
+  HeadingParameter parameter = HeadingParameter();
+  parameter.estimated_number_min = 500;
+  parameter.estimated_number_max = state.range(0);
+  parameter.estimated_gnss_coefficient = 0.025;
+  parameter.estimated_heading_coefficient = 0.0125;
+  parameter.outlier_threshold = 0.0524;
+  parameter.estimated_velocity_threshold = 2.78;
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.estimated_yawrate_threshold = 0.0873;
+  HeadingStatus status = HeadingStatus();
+  eagleye_msgs::Heading heading;
+  ImuHistory imu_history;
+  imu_history.requireCapacity(state.range(0) + 1);
+
+  runEstimate(state, state.range(0), false, [&](const SyntheticDriveSample& s)
+  {
+    heading.status.estimate_status = false;
+    imu_history.append(s.imu);
+    heading_estimate(s.rtklib_nav, s.imu, imu_history, s.velocity_scale_factor, s.yawrate_offset_stop, s.yawrate_offset, s.slip_angle,
+      s.heading_interpolate, parameter, &status, &heading);
+  });
+}
+BENCHMARK(BM_heading_estimate)->Arg(500)->Arg(1500)->Arg(3000)->Unit(benchmark::kMicrosecond);
+
+static void BM_rtk_heading_estimate(benchmark::State& state)
+{
+  RtkHeadingParameter parameter = RtkHeadingParameter();
+  parameter.estimated_distance = 0.3;
+  parameter.estimated_heading_buffer_min = 2;
+  parameter.estimated_number_min = 500;
+  parameter.estimated_number_max = state.range(0);
+  parameter.estimated_gnss_coefficient = 0.025;
+  parameter.estimated_heading_coefficient = 0.0125;
+  parameter.outlier_threshold = 0.0524;
+  parameter.estimated_velocity_threshold = 0.278;
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.estimated_yawrate_threshold = 0.0873;
+  RtkHeadingStatus status = RtkHeadingStatus();
+  eagleye_msgs::Heading heading;
+  ImuHistory imu_history;
+  imu_history.requireCapacity(state.range(0) + 1);
+
+  runEstimate(state, state.range(0), false, [&](const SyntheticDriveSample& s)
+  {
+    heading.status.estimate_status = false;
+    imu_history.append(s.imu);
+    rtk_heading_estimate(s.fix, s.imu, imu_history, s.velocity_scale_factor, s.distance, s.yawrate_offset_stop, s.yawrate_offset, s.slip_angle,
+      s.heading_interpolate, parameter, &status, &heading);
+  });
+}
+BENCHMARK(BM_rtk_heading_estimate)->Arg(500)->Arg(1500)->Unit(benchmark::kMicrosecond);
+
+static void BM_heading_interpolate_estimate(benchmark::State& state)
+{
+  HeadingInterpolateParameter parameter = HeadingInterpolateParameter();
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.number_buffer_max = state.range(0);
+  HeadingInterpolateStatus status = HeadingInterpolateStatus();
+  eagleye_msgs::Heading heading_interpolate;
+
+  runEstimate(state, samplesForDistance(0), false, [&](const SyntheticDriveSample& s)
+  {
+    heading_interpolate_estimate(s.imu, s.velocity_scale_factor, s.yawrate_offset_stop, s.yawrate_offset, s.heading, s.slip_angle,
+      parameter, &status, &heading_interpolate);
+  });
+}
+BENCHMARK(BM_heading_interpolate_estimate)->Arg(100)->Arg(500)->Unit(benchmark::kMicrosecond);
+
+static void BM_slip_angle_estimate(benchmark::State& state)
+{
+  SlipangleParameter parameter = SlipangleParameter();
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.manual_coefficient = 0.0;
+  eagleye_msgs::SlipAngle slip_angle;
+
+  runEstimate(state, 100, false, [&](const SyntheticDriveSample& s)
+  {
+    slip_angle.status.estimate_status = false;
+    slip_angle_estimate(s.imu, s.velocity_scale_factor, s.yawrate_offset_stop, s.yawrate_offset, parameter, &slip_angle);
+  });
+}
+BENCHMARK(BM_slip_angle_estimate)->Unit(benchmark::kMicrosecond);
+
+static void BM_slip_coefficient_estimate(benchmark::State& state)
+{
+  SlipCoefficientParameter parameter = SlipCoefficientParameter();
+  parameter.estimated_number_min = 100;
+  parameter.estimated_number_max = state.range(0);
+  parameter.estimated_velocity_threshold = 3;
+  parameter.estimated_yawrate_threshold = 0.017453;
+  parameter.lever_arm = 0.26;
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  SlipCoefficientStatus status = SlipCoefficientStatus();
+  double estimate_coefficient = 0;
+
+  runEstimate(state, samplesForDistance(0), false, [&](const SyntheticDriveSample& s)
+  {
+    slip_coefficient_estimate(s.imu, s.rtklib_nav, s.velocity_scale_factor, s.yawrate_offset_stop, s.yawrate_offset, s.heading_interpolate,
+      parameter, &status, &estimate_coefficient);
+  });
+}
+BENCHMARK(BM_slip_coefficient_estimate)->Arg(5000)->Unit(benchmark::kMicrosecond);
+
+static void BM_trajectory_estimate(benchmark::State& state)
+{
+  TrajectoryParameter parameter = TrajectoryParameter();
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.stop_judgment_yawrate_threshold = 0.01;
+  TrajectoryStatus status = TrajectoryStatus();
+  geometry_msgs::Vector3Stamped enu_vel;
+  eagleye_msgs::Position enu_relative_pos;
+  geometry_msgs::TwistStamped twist;
+
+  runEstimate(state, samplesForDistance(0), false, [&](const SyntheticDriveSample& s)
+  {
+    trajectory_estimate(s.imu, s.velocity_scale_factor, s.heading_interpolate, s.yawrate_offset_stop, s.yawrate_offset, parameter,
+      &status, &enu_vel, &enu_relative_pos, &twist);
+  });
+}
+BENCHMARK(BM_trajectory_estimate)->Unit(benchmark::kMicrosecond);
+
+static void BM_trajectory3d_estimate(benchmark::State& state)
+{
+  TrajectoryParameter parameter = TrajectoryParameter();
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.stop_judgment_yawrate_threshold = 0.01;
+  TrajectoryStatus status = TrajectoryStatus();
+  geometry_msgs::Vector3Stamped enu_vel;
+  eagleye_msgs::Position enu_relative_pos;
+  geometry_msgs::TwistStamped twist;
+
+  runEstimate(state, samplesForDistance(0), false, [&](const SyntheticDriveSample& s)
+  {
+    trajectory3d_estimate(s.imu, s.velocity_scale_factor, s.heading_interpolate, s.yawrate_offset_stop, s.yawrate_offset, s.pitching,
+      parameter, &status, &enu_vel, &enu_relative_pos, &twist);
+  });
+}
+BENCHMARK(BM_trajectory3d_estimate)->Unit(benchmark::kMicrosecond);
+
+static void BM_position_estimate(benchmark::State& state)
+{
+  PositionParameter parameter = PositionParameter();
+  parameter.estimated_distance = state.range(0);
+  parameter.separation_distance = 0.1;
+  parameter.estimated_velocity_threshold = 2.78;
+  parameter.outlier_threshold = 3.0;
+  parameter.estimated_enu_vel_coefficient = 0.025;
+  parameter.estimated_position_coefficient = 0.25;
+  parameter.tf_gnss_rotation_w = 1;
+  PositionStatus status = PositionStatus();
+  eagleye_msgs::Position enu_absolute_pos;
+
+  runEstimate(state, samplesForDistance(state.range(0)), false, [&](const SyntheticDriveSample& s)
+  {
+    enu_absolute_pos.status.estimate_status = false;
+    position_estimate(s.rtklib_nav, s.velocity_scale_factor, s.distance, s.heading_interpolate, s.enu_vel, parameter, &status,
+      &enu_absolute_pos);
+  });
+}
+BENCHMARK(BM_position_estimate)->Arg(100)->Arg(300)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+static void BM_position_interpolate_estimate(benchmark::State& state)
+{
+  PositionInterpolateParameter parameter = PositionInterpolateParameter();
+  parameter.number_buffer_max = state.range(0);
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  PositionInterpolateStatus status = PositionInterpolateStatus();
+  eagleye_msgs::Position enu_absolute_pos_interpolate;
+  sensor_msgs::NavSatFix fix;
+
+  runEstimate(state, samplesForDistance(0), false, [&](const SyntheticDriveSample& s)
+  {
+    position_interpolate_estimate(s.enu_absolute_pos, s.enu_vel, s.gnss_smooth_pos, s.height, parameter, &status,
+      &enu_absolute_pos_interpolate, &fix);
+  });
+}
+BENCHMARK(BM_position_interpolate_estimate)->Arg(100)->Arg(500)->Unit(benchmark::kMicrosecond);
+
+static void BM_smoothing_estimate(benchmark::State& state)
+{
+  SmoothingParameter parameter = SmoothingParameter();
+  parameter.estimated_number_max = state.range(0);
+  parameter.estimated_velocity_threshold = 2.78;
+  parameter.estimated_threshold = 0.1;
+  SmoothingStatus status = SmoothingStatus();
+  eagleye_msgs::Position gnss_smooth_pos_enu;
+
+  runEstimate(state, samplesForDistance(0), true, [&](const SyntheticDriveSample& s)
+  {
+    smoothing_estimate(s.rtklib_nav, s.velocity_scale_factor, parameter, &status, &gnss_smooth_pos_enu);
+  });
+}
+BENCHMARK(BM_smoothing_estimate)->Arg(25)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+static void BM_pitching_estimate(benchmark::State& state)
+{
+  HeightParameter parameter = HeightParameter();
+  parameter.estimated_distance = 200;
+  parameter.estimated_distance_max = state.range(0);
+  parameter.separation_distance = 0.1;
+  parameter.estimated_velocity_threshold = 2.78;
+  parameter.estimated_velocity_coefficient = 0.1;
+  parameter.estimated_height_coefficient = 0.02;
+  parameter.outlier_threshold = 0.3;
+  parameter.average_num = 50;
+  HeightStatus status = HeightStatus();
+  eagleye_msgs::Height height;
+  eagleye_msgs::Pitching pitching;
+  eagleye_msgs::AccXOffset acc_x_offset;
+  eagleye_msgs::AccXScaleFactor acc_x_scale_factor;
+
+  runEstimate(state, samplesForDistance(state.range(0)), false, [&](const SyntheticDriveSample& s)
+  {
+    status.flag_reliability = false;
+    height.status.estimate_status = false;
+    pitching.status.estimate_status = false;
+    acc_x_offset.status.estimate_status = false;
+    acc_x_scale_factor.status.estimate_status = false;
+    pitching_estimate(s.imu, s.fix, s.velocity_scale_factor, s.distance, parameter, &status, &height, &pitching, &acc_x_offset,
+      &acc_x_scale_factor);
+  });
+}
+BENCHMARK(BM_pitching_estimate)->Arg(1000)->Arg(2000)->Unit(benchmark::kMicrosecond);
+
+static void BM_rtk_deadreckoning_estimate(benchmark::State& state)
+{
+  RtkDeadreckoningParameter parameter = RtkDeadreckoningParameter();
+  parameter.stop_judgment_velocity_threshold = 0.01;
+  parameter.tf_gnss_rotation_w = 1;
+  RtkDeadreckoningStatus status = RtkDeadreckoningStatus();
+  eagleye_msgs::Position enu_absolute_rtk_deadreckoning;
+  sensor_msgs::NavSatFix eagleye_fix;
+
+  runEstimate(state, samplesForDistance(0), false, [&](const SyntheticDriveSample& s)
+  {
+    rtk_deadreckoning_estimate(s.rtklib_nav, s.enu_vel, s.fix, s.heading_interpolate, parameter, &status,
+      &enu_absolute_rtk_deadreckoning, &eagleye_fix);
+  });
+}
+BENCHMARK(BM_rtk_deadreckoning_estimate)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,405 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * checkpoint.hpp
+ * Author MapIV Sekino
+ */
+
+// Binary checkpoint of the estimator state. saveCheckpoint() of an estimator
+// writes its latest inputs and outputs and its whole Status struct, window
+// contents included, and loadCheckpoint() of an estimator built with the same
+// parameters reads them back. The estimator then continues exactly as the one
+// that wrote the checkpoint would have, so a restarted node resumes where the
+// previous one left off and an offline tool can start in the middle of a log.
+//
+// Values are stored in host byte order and messages in their ROS wire format.
+// A checkpoint starts with a magic number and CHECKPOINT_VERSION, and the
+// part of every estimator with its name, so a checkpoint of another version
+// or of another node is rejected instead of misread. The parameters are not
+// stored, nor are the index and work vectors that an estimate call refills
+// before it reads them. Bump CHECKPOINT_VERSION whenever a Status struct or
+// the members of an estimator change.
+//
+// The field lists below are written once for both directions: the same
+// function template runs with a CheckpointWriter to save and with a
+// CheckpointReader to load. Errors are reported as std::runtime_error.
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "navigation/navigation.hpp"
+#include "ros/serialization.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const uint32_t CHECKPOINT_VERSION = 3;
+
+class CheckpointWriter
+{
+public:
+  CheckpointWriter();
+
+  // Starts the part of the named estimator.
+  void section(const std::string&);
+
+  void field(const bool&);
+  void field(const int&);
+  void field(const int64_t&);
+  void field(const uint64_t&);
+  void field(const double&);
+  void field(const std::vector<bool>&);
+  void field(const std::vector<int>&);
+  void field(const std::vector<int64_t>&);
+  void field(const std::vector<double>&);
+  void field(const std::string&);
+
+  template <std::size_t N>
+  void field(const double (&value)[N])
+  {
+    append(value, sizeof(value));
+  }
+
+  // Any ROS message.
+  template <class M>
+  void field(const M& msg)
+  {
+    uint32_t length = ros::serialization::serializationLength(msg);
+    field(static_cast<uint64_t>(length));
+    std::size_t offset = data_.size();
+    data_.resize(offset + length);
+    ros::serialization::OStream stream(data_.data() + offset, length);
+    ros::serialization::serialize(stream, msg);
+  }
+
+  const std::vector<uint8_t>& data() const { return data_; }
+  void save(const std::string&) const;
+
+private:
+  void append(const void*, std::size_t);
+
+  std::vector<uint8_t> data_;
+};
+
+class CheckpointReader
+{
+public:
+  explicit CheckpointReader(const std::vector<uint8_t>&);
+  explicit CheckpointReader(const std::string&);
+
+  // Checks that the part of the named estimator follows.
+  void section(const std::string&);
+
+  void field(bool&);
+  void field(int&);
+  void field(int64_t&);
+  void field(uint64_t&);
+  void field(double&);
+  void field(std::vector<bool>&);
+  void field(std::vector<int>&);
+  void field(std::vector<int64_t>&);
+  void field(std::vector<double>&);
+  void field(std::string&);
+
+  template <std::size_t N>
+  void field(double (&value)[N])
+  {
+    take(value, sizeof(value));
+  }
+
+  template <class M>
+  void field(M& msg)
+  {
+    uint64_t length;
+    field(length);
+    if (length > data_.size() - offset_)
+    {
+      throw std::runtime_error("checkpoint is truncated");
+    }
+    ros::serialization::IStream stream(&data_[offset_], static_cast<uint32_t>(length));
+    ros::serialization::deserialize(stream, msg);
+    offset_ += length;
+  }
+
+  bool atEnd() const { return offset_ == data_.size(); }
+
+private:
+  void checkHeader();
+  void take(void*, std::size_t);
+  template <class T>
+  void takeVector(std::vector<T>&);
+
+  std::vector<uint8_t> data_;
+  std::size_t offset_;
+};
+
+// Saves or loads an estimator or an imu history, so that a field list
+// containing them can also be written once for both directions.
+template <class T>
+void checkpointPart(CheckpointWriter* c, const T& part)
+{
+  part.saveCheckpoint(c);
+}
+
+template <class T>
+void checkpointPart(CheckpointReader* c, T& part)
+{
+  part.loadCheckpoint(c);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, VelocityScaleFactorStatus& s)
+{
+  c->field(s.gnss_status_buffer);
+  c->field(s.doppler_velocity_buffer);
+  c->field(s.velocity_buffer);
+  c->field(s.tow_last);
+  c->field(s.estimated_number);
+  c->field(s.velocity_scale_factor_last);
+  c->field(s.estimate_start_status);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, DistanceStatus& s)
+{
+  c->field(s.time_last);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, YawrateOffsetStopStatus& s)
+{
+  c->field(s.stop_count);
+  c->field(s.yawrate_offset_stop_last);
+  c->field(s.estimate_start_status);
+  c->field(s.yawrate_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, YawrateOffsetStatus& s)
+{
+  c->field(s.estimate_start_status);
+  c->field(s.estimated_preparation_conditions);
+  c->field(s.heading_estimate_status_count);
+  c->field(s.estimated_number);
+  c->field(s.imu_history_cursor);
+  c->field(s.heading_angle_buffer);
+  c->field(s.correction_velocity_buffer);
+  c->field(s.heading_estimate_status_buffer);
+  c->field(s.yawrate_offset_stop_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, HeadingStatus& s)
+{
+  c->field(s.tow_last);
+  c->field(s.estimated_number);
+  c->field(s.imu_history_cursor);
+  c->field(s.heading_angle_buffer);
+  c->field(s.correction_velocity_buffer);
+  c->field(s.yawrate_offset_stop_buffer);
+  c->field(s.yawrate_offset_buffer);
+  c->field(s.slip_angle_buffer);
+  c->field(s.gnss_status_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, RtkHeadingStatus& s)
+{
+  c->field(s.tow_last);
+  c->field(s.estimated_number);
+  c->field(s.last_rtk_heading_angle);
+  c->field(s.imu_history_cursor);
+  c->field(s.heading_angle_buffer);
+  c->field(s.correction_velocity_buffer);
+  c->field(s.yawrate_offset_stop_buffer);
+  c->field(s.yawrate_offset_buffer);
+  c->field(s.slip_angle_buffer);
+  c->field(s.gnss_status_buffer);
+  c->field(s.distance_buffer);
+  c->field(s.latitude_buffer);
+  c->field(s.longitude_buffer);
+  c->field(s.altitude_buffer);
+  c->field(s.fix_status_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, HeadingInterpolateStatus& s)
+{
+  c->field(s.number_buffer);
+  c->field(s.heading_estimate_status_count);
+  c->field(s.heading_estimate_start_status);
+  c->field(s.heading_stamp_last);
+  c->field(s.time_last);
+  c->field(s.provisional_heading_angle);
+  c->field(s.provisional_heading_angle_buffer);
+  c->field(s.imu_stamp_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, PositionStatus& s)
+{
+  c->field(s.estimated_number);
+  c->field(s.tow_last);
+  c->field(s.heading_estimate_status_count);
+  c->field(s.time_last);
+  c->field(s.enu_relative_pos_x);
+  c->field(s.enu_relative_pos_y);
+  c->field(s.enu_relative_pos_z);
+  c->field(s.distance_last);
+  c->field(s.enu_pos_x_buffer);
+  c->field(s.enu_pos_y_buffer);
+  c->field(s.enu_pos_z_buffer);
+  c->field(s.enu_relative_pos_x_buffer);
+  c->field(s.enu_relative_pos_y_buffer);
+  c->field(s.enu_relative_pos_z_buffer);
+  c->field(s.correction_velocity_buffer);
+  c->field(s.distance_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, PositionInterpolateStatus& s)
+{
+  c->field(s.position_estimate_status_count);
+  c->field(s.number_buffer);
+  c->field(s.position_estimate_start_status);
+  c->field(s.position_stamp_last);
+  c->field(s.time_last);
+  c->field(s.provisional_enu_pos_x);
+  c->field(s.provisional_enu_pos_y);
+  c->field(s.provisional_enu_pos_z);
+  c->field(s.provisional_enu_pos_x_buffer);
+  c->field(s.provisional_enu_pos_y_buffer);
+  c->field(s.provisional_enu_pos_z_buffer);
+  c->field(s.imu_stamp_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, SlipCoefficientStatus& s)
+{
+  c->field(s.heading_estimate_status_count);
+  c->field(s.doppler_slip_buffer);
+  c->field(s.acceleration_y_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, SmoothingStatus& s)
+{
+  c->field(s.estimated_number);
+  c->field(s.last_pos);
+  c->field(s.time_buffer);
+  c->field(s.enu_pos_x_buffer);
+  c->field(s.enu_pos_y_buffer);
+  c->field(s.enu_pos_z_buffer);
+  c->field(s.correction_velocity_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, TrajectoryStatus& s)
+{
+  c->field(s.estimate_status_count);
+  c->field(s.heading_last);
+  c->field(s.time_last);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, HeightStatus& s)
+{
+  c->field(s.relative_height_G);
+  c->field(s.relative_height_diffvel);
+  c->field(s.relative_height_offset);
+  c->field(s.acceleration_offset_linear_x_last);
+  c->field(s.acceleration_SF_linear_x_last);
+  c->field(s.height_last);
+  c->field(s.time_last);
+  c->field(s.distance_last);
+  c->field(s.correction_velocity_x_last);
+  c->field(s.fix_time_last);
+  c->field(s.pitching_angle_last);
+  c->field(s.height_estimate_start_status);
+  c->field(s.estimate_start_status);
+  c->field(s.acceleration_SF_estimate_status);
+  c->field(s.data_number);
+  c->field(s.flag_reliability);
+  c->field(s.height_fit_status);
+  c->field(s.height_buffer);
+  c->field(s.relative_height_G_buffer);
+  c->field(s.relative_height_diffvel_buffer);
+  c->field(s.relative_height_offset_buffer);
+  c->field(s.correction_relative_height_buffer);
+  c->field(s.correction_velocity_buffer);
+  c->field(s.distance_buffer);
+  c->field(s.acc_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, AngularVelocityOffsetStopStatus& s)
+{
+  c->field(s.stop_count);
+  c->field(s.rollrate_offset_stop_last);
+  c->field(s.pitchrate_offset_stop_last);
+  c->field(s.yawrate_offset_stop_last);
+  c->field(s.estimate_start_status);
+  c->field(s.rollrate_buffer);
+  c->field(s.pitchrate_buffer);
+  c->field(s.yawrate_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, RtkDeadreckoningStatus& s)
+{
+  c->field(s.position_estimate_status_count);
+  c->field(s.number_buffer);
+  c->field(s.position_estimate_start_status);
+  c->field(s.ecef_base_pos_status);
+  c->field(s.position_stamp_last);
+  c->field(s.time_last);
+  c->field(s.provisional_enu_pos_x);
+  c->field(s.provisional_enu_pos_y);
+  c->field(s.provisional_enu_pos_z);
+  c->field(s.provisional_enu_pos_x_buffer);
+  c->field(s.provisional_enu_pos_y_buffer);
+  c->field(s.provisional_enu_pos_z_buffer);
+  c->field(s.imu_stamp_buffer);
+}
+
+template <class Checkpoint>
+void checkpointStatus(Checkpoint* c, EkfStatus& s)
+{
+  c->field(s.heading_status);
+  c->field(s.position_status);
+  c->field(s.height_status);
+  c->field(s.state);
+  c->field(s.covariance);
+  c->field(s.ecef_base_pos);
+  c->field(s.velocity_last);
+  c->field(s.time_last);
+  c->field(s.fix_time_last);
+  c->field(s.tow_last);
+  c->field(s.position_outlier_count);
+  c->field(s.reset_count);
+}
+
+#endif /*CHECKPOINT_H */
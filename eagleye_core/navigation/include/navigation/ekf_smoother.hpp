@@ -0,0 +1,92 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*
+ * ekf_smoother.hpp
+ * Author MapIV Sekino
+ */
+
+// Fixed-interval (Rauch-Tung-Striebel) smoothing of the ekf mode for
+// post-processing. add() is called after every EkfEstimator::imuStep() of a
+// forward run over a whole log and stores the filtered state and the
+// prediction step in a temporary file, so the forward run needs no more
+// memory than the online one. smooth() then runs the backward pass over that
+// file from the end, segment_size samples at a time, and next() reads the
+// smoothed states in forward order. Every smoothed state uses the whole log,
+// so the start of the log and GNSS outages are bridged from both sides.
+//
+// A state restarted from a measurement (first doppler heading, position
+// outlier reset, ...) is not connected to the one before it; the backward
+// pass starts again from the filtered state there. Errors are reported as
+// std::runtime_error.
+
+#ifndef EKF_SMOOTHER_H
+#define EKF_SMOOTHER_H
+
+#include "navigation/navigation.hpp"
+#include <cstdio>
+#include <vector>
+
+struct EkfSmoothedState
+{
+  int64_t stamp;
+  bool heading_status;
+  bool position_status;
+  bool height_status;
+  double state[EKF_STATE_NUM];
+  // Diagonal of the smoothed covariance.
+  double variance[EKF_STATE_NUM];
+  double ecef_base_pos[3];
+  double slip_angle;
+};
+
+class EkfSmoother
+{
+public:
+  explicit EkfSmoother(std::size_t segment_size = 30000);
+  ~EkfSmoother();
+
+  // After every imu sample of the forward run, with the slip angle the
+  // sample used.
+  void add(int64_t stamp, const EkfStatus&, const EkfTransition&, double slip_angle);
+  // Runs the backward pass over every sample added so far.
+  void smooth();
+  // The smoothed states after smooth(), in the order they were added.
+  bool next(EkfSmoothedState*);
+
+  std::size_t size() const { return count_; }
+
+private:
+  EkfSmoother(const EkfSmoother&);
+  EkfSmoother& operator=(const EkfSmoother&);
+
+  std::size_t segment_size_;
+  std::size_t count_;
+  std::size_t read_count_;
+  std::FILE* forward_file_;
+  std::FILE* smoothed_file_;
+  int reset_count_last_;
+};
+
+#endif /*EKF_SMOOTHER_H */
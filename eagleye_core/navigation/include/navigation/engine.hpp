@@ -0,0 +1,212 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * engine.hpp
+ * Author MapIV Sekino
+ */
+
+// Synchronous version of the eagleye_rt.launch graph. Sensor samples are
+// pushed in with add*(), every estimator they trigger runs before the call
+// returns, and the returned output holds the latest published message of each
+// topic together with a flag telling whether it was published by this call.
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "navigation/estimator.hpp"
+
+struct EagleyeEngineParameter
+{
+  bool reverse_imu;
+  bool use_rtk_heading;
+  bool use_rtk_deadreckoning;
+  // Runs EkfEstimator in place of the windowed estimators, see ekf.cpp.
+  bool use_ekf;
+  double trajectory_timer_update_rate;
+  double trajectory_th_deadlock_time;
+  VelocityScaleFactorParameter velocity_scale_factor;
+  YawrateOffsetStopParameter yawrate_offset_stop;
+  YawrateOffsetParameter yawrate_offset_1st;
+  YawrateOffsetParameter yawrate_offset_2nd;
+  HeadingParameter heading;
+  RtkHeadingParameter rtk_heading;
+  HeadingInterpolateParameter heading_interpolate;
+  SlipangleParameter slip_angle;
+  HeightParameter height;
+  TrajectoryParameter trajectory;
+  PositionParameter position;
+  PositionInterpolateParameter position_interpolate;
+  SmoothingParameter smoothing;
+  AngularVelocityOffsetStopParameter angular_velocity_offset_stop;
+  RtkDeadreckoningParameter rtk_deadreckoning;
+  EkfParameter ekf;
+};
+
+struct EagleyeEngineOutput
+{
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor;
+  eagleye_msgs::Distance distance;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop;
+  eagleye_msgs::YawrateOffset yawrate_offset_1st;
+  eagleye_msgs::YawrateOffset yawrate_offset_2nd;
+  eagleye_msgs::Heading heading_1st;
+  eagleye_msgs::Heading heading_2nd;
+  eagleye_msgs::Heading heading_3rd;
+  eagleye_msgs::Heading heading_interpolate_1st;
+  eagleye_msgs::Heading heading_interpolate_2nd;
+  eagleye_msgs::Heading heading_interpolate_3rd;
+  eagleye_msgs::SlipAngle slip_angle;
+  eagleye_msgs::Height height;
+  eagleye_msgs::Pitching pitching;
+  eagleye_msgs::AccXOffset acc_x_offset;
+  eagleye_msgs::AccXScaleFactor acc_x_scale_factor;
+  sensor_msgs::NavSatFix reliability_fix;
+  geometry_msgs::Vector3Stamped enu_vel;
+  eagleye_msgs::Position enu_relative_pos;
+  geometry_msgs::TwistStamped twist;
+  eagleye_msgs::Position enu_absolute_pos;
+  eagleye_msgs::Position enu_absolute_pos_interpolate;
+  sensor_msgs::NavSatFix fix;
+  eagleye_msgs::Position gnss_smooth_pos_enu;
+  eagleye_msgs::AngularVelocityOffset angular_velocity_offset_stop;
+  sensor_msgs::Imu imu_corrected;
+  eagleye_msgs::Position enu_absolute_rtk_deadreckoning;
+  sensor_msgs::NavSatFix rtk_fix;
+
+  bool velocity_scale_factor_updated;
+  bool distance_updated;
+  bool yawrate_offset_stop_updated;
+  bool yawrate_offset_1st_updated;
+  bool yawrate_offset_2nd_updated;
+  bool heading_1st_updated;
+  bool heading_2nd_updated;
+  bool heading_3rd_updated;
+  bool heading_interpolate_1st_updated;
+  bool heading_interpolate_2nd_updated;
+  bool heading_interpolate_3rd_updated;
+  bool slip_angle_updated;
+  bool height_updated;
+  bool pitching_updated;
+  bool acc_x_offset_updated;
+  bool acc_x_scale_factor_updated;
+  bool reliability_fix_updated;
+  bool enu_vel_updated;
+  bool enu_relative_pos_updated;
+  bool twist_updated;
+  bool enu_absolute_pos_updated;
+  bool enu_absolute_pos_interpolate_updated;
+  bool fix_updated;
+  bool gnss_smooth_pos_enu_updated;
+  bool angular_velocity_offset_stop_updated;
+  bool imu_corrected_updated;
+  bool enu_absolute_rtk_deadreckoning_updated;
+  bool rtk_fix_updated;
+};
+
+// Calibrated quantities saved by a previous run. Only those whose *_status
+// is true are applied, see EagleyeEngine::warmStart().
+struct EagleyeWarmStart
+{
+  bool velocity_scale_factor_status;
+  double velocity_scale_factor;
+  bool yawrate_offset_1st_status;
+  double yawrate_offset_1st;
+  bool yawrate_offset_2nd_status;
+  double yawrate_offset_2nd;
+  bool slip_coefficient_status;
+  double slip_coefficient;
+  bool acc_x_status;
+  double acc_x_offset;
+  double acc_x_scale_factor;
+};
+
+class EagleyeEngine
+{
+public:
+  EagleyeEngine(const EagleyeEngineParameter&);
+
+  // Reserves the windows of every estimator, see VelocityScaleFactorEstimator::reserve().
+  void reserve();
+
+  // Starts the estimators from the given calibrations. The slip coefficient
+  // is only used when slip_angle/manual_coefficient is not set. Call it
+  // before the first add*().
+  void warmStart(const EagleyeWarmStart&);
+
+  const EagleyeEngineOutput& addImu(const sensor_msgs::Imu&);
+  const EagleyeEngineOutput& addTwist(const geometry_msgs::TwistStamped&);
+  const EagleyeEngineOutput& addRtklibNav(const rtklib_msgs::RtklibNav&);
+  const EagleyeEngineOutput& addNavSatFix(const sensor_msgs::NavSatFix&);
+
+  const EagleyeEngineOutput& getOutput() const { return output_; }
+  const EagleyeEngineParameter& getParameter() const { return parameter_; }
+  // The filter of ekf mode, see EkfSmoother.
+  const EkfEstimator& getEkfEstimator() const { return ekf_; }
+
+  // Writes the state of every estimator and the latest outputs to a
+  // checkpoint and reads them back, see checkpoint.hpp. The engine must have
+  // been built with the same parameters.
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+  void clearUpdated();
+  bool headingStep(int, const sensor_msgs::Imu&, const eagleye_msgs::YawrateOffset&, const eagleye_msgs::Heading&, eagleye_msgs::Heading*);
+  bool headingInterpolateStep(int, const sensor_msgs::Imu&, const eagleye_msgs::YawrateOffset&, const eagleye_msgs::Heading&, eagleye_msgs::Heading*);
+  void stopStep(const sensor_msgs::Imu&);
+  void windowStep(const sensor_msgs::Imu&);
+  void ekfStep(const sensor_msgs::Imu&);
+  void enuVelStep(const geometry_msgs::Vector3Stamped&);
+
+  EagleyeEngineParameter parameter_;
+  EagleyeEngineOutput output_;
+  int64_t trajectory_timer_last_;
+
+  // Shared by yawrate_offset and heading, appended to once per imu.
+  ImuHistory imu_history_;
+
+  VelocityScaleFactorEstimator velocity_scale_factor_;
+  DistanceEstimator distance_;
+  YawrateOffsetStopEstimator yawrate_offset_stop_;
+  AngularVelocityOffsetStopEstimator angular_velocity_offset_stop_;
+  YawrateOffsetEstimator yawrate_offset_[2];
+  HeadingEstimator heading_[3];
+  RtkHeadingEstimator rtk_heading_[3];
+  HeadingInterpolateEstimator heading_interpolate_[3];
+  SlipAngleEstimator slip_angle_;
+  HeightEstimator height_;
+  TrajectoryEstimator trajectory_;
+  PositionEstimator position_;
+  PositionInterpolateEstimator position_interpolate_;
+  SmoothingEstimator smoothing_;
+  RtkDeadreckoningEstimator rtk_deadreckoning_;
+  CorrectionImuEstimator correction_imu_;
+  EkfEstimator ekf_;
+};
+
+#endif /*ENGINE_H */
@@ -0,0 +1,693 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * estimator.hpp
+ * Author MapIV Sekino
+ */
+
+// Stateful wrappers around the *_estimate functions. Each class owns the
+// Parameter/Status pair and the latest inputs of one eagleye_rt node, and its
+// step function reproduces that node's callback: the output header is taken
+// from the trigger message and the return value tells whether the node would
+// publish. Nothing here depends on roscpp.
+
+#ifndef ESTIMATOR_H
+#define ESTIMATOR_H
+
+#include "navigation/navigation.hpp"
+#include "navigation/checkpoint.hpp"
+
+class VelocityScaleFactorEstimator
+{
+public:
+  VelocityScaleFactorEstimator();
+
+  void setParameter(const VelocityScaleFactorParameter&);
+  // Reserves every buffer of the status to the window length given by the
+  // parameter, so that steps after the warm-up do not allocate. Used by the
+  // real-time mode of eagleye_rt; call it after setParameter().
+  void reserve();
+  void setRtklibNav(const rtklib_msgs::RtklibNav&);
+  void setTwist(const geometry_msgs::TwistStamped&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  // Publishes the given scale factor, enabled, until the first one estimated
+  // in this run. Used to start from the value saved by a previous run.
+  void warmStart(double);
+
+  const eagleye_msgs::VelocityScaleFactor& getVelocityScaleFactor() const { return velocity_scale_factor_; }
+
+  // Writes the inputs, outputs and status to a checkpoint and reads them
+  // back, see checkpoint.hpp. A shared imu history is not part of it.
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  rtklib_msgs::RtklibNav rtklib_nav_;
+  geometry_msgs::TwistStamped velocity_;
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  VelocityScaleFactorParameter parameter_;
+  VelocityScaleFactorStatus status_;
+  bool warm_start_status_;
+  double warm_start_scale_factor_;
+};
+
+class DistanceEstimator
+{
+public:
+  DistanceEstimator();
+
+  bool velocityScaleFactorStep(const eagleye_msgs::VelocityScaleFactor&);
+
+  const eagleye_msgs::Distance& getDistance() const { return distance_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  eagleye_msgs::Distance distance_;
+  DistanceStatus status_;
+};
+
+class YawrateOffsetStopEstimator
+{
+public:
+  YawrateOffsetStopEstimator();
+
+  void setParameter(const YawrateOffsetStopParameter&);
+  void reserve();
+  void setTwist(const geometry_msgs::TwistStamped&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  const eagleye_msgs::YawrateOffset& getYawrateOffset() const { return yawrate_offset_stop_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  geometry_msgs::TwistStamped velocity_;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop_;
+  YawrateOffsetStopParameter parameter_;
+  YawrateOffsetStopStatus status_;
+};
+
+class AngularVelocityOffsetStopEstimator
+{
+public:
+  AngularVelocityOffsetStopEstimator();
+
+  void setParameter(const AngularVelocityOffsetStopParameter&);
+  void reserve();
+  void setTwist(const geometry_msgs::TwistStamped&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  const eagleye_msgs::AngularVelocityOffset& getAngularVelocityOffset() const { return angular_velocity_offset_stop_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  geometry_msgs::TwistStamped velocity_;
+  eagleye_msgs::AngularVelocityOffset angular_velocity_offset_stop_;
+  AngularVelocityOffsetStopParameter parameter_;
+  AngularVelocityOffsetStopStatus status_;
+};
+
+class YawrateOffsetEstimator
+{
+public:
+  YawrateOffsetEstimator();
+
+  void setParameter(const YawrateOffsetParameter&);
+  void reserve();
+  // Reads the imu from a history shared with other estimators instead of
+  // keeping one of its own. The caller appends every imu to it before the
+  // step, see ImuHistory.
+  void setImuHistory(ImuHistory*);
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  void setYawrateOffsetStop(const eagleye_msgs::YawrateOffset&);
+  void setHeadingInterpolate(const eagleye_msgs::Heading&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  // Publishes the given offset, enabled, until the first one estimated in
+  // this run, see VelocityScaleFactorEstimator::warmStart(). It is dropped
+  // early if the estimated stop offset is further from it than the outlier
+  // threshold.
+  void warmStart(double);
+
+  const eagleye_msgs::YawrateOffset& getYawrateOffset() const { return yawrate_offset_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop_;
+  eagleye_msgs::Heading heading_interpolate_;
+  eagleye_msgs::YawrateOffset yawrate_offset_;
+  YawrateOffsetParameter parameter_;
+  YawrateOffsetStatus status_;
+  ImuHistory own_imu_history_;
+  ImuHistory* shared_imu_history_;
+  bool warm_start_status_;
+  double warm_start_yawrate_offset_;
+};
+
+class HeadingEstimator
+{
+public:
+  HeadingEstimator();
+
+  void setParameter(const HeadingParameter&);
+  void reserve();
+  // See YawrateOffsetEstimator::setImuHistory().
+  void setImuHistory(ImuHistory*);
+  void setRtklibNav(const rtklib_msgs::RtklibNav&);
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  void setYawrateOffsetStop(const eagleye_msgs::YawrateOffset&);
+  void setYawrateOffset(const eagleye_msgs::YawrateOffset&);
+  void setSlipAngle(const eagleye_msgs::SlipAngle&);
+  void setHeadingInterpolate(const eagleye_msgs::Heading&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  const eagleye_msgs::Heading& getHeading() const { return heading_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  rtklib_msgs::RtklibNav rtklib_nav_;
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop_;
+  eagleye_msgs::YawrateOffset yawrate_offset_;
+  eagleye_msgs::SlipAngle slip_angle_;
+  eagleye_msgs::Heading heading_interpolate_;
+  eagleye_msgs::Heading heading_;
+  HeadingParameter parameter_;
+  HeadingStatus status_;
+  ImuHistory own_imu_history_;
+  ImuHistory* shared_imu_history_;
+};
+
+class RtkHeadingEstimator
+{
+public:
+  RtkHeadingEstimator();
+
+  void setParameter(const RtkHeadingParameter&);
+  void reserve();
+  // See YawrateOffsetEstimator::setImuHistory().
+  void setImuHistory(ImuHistory*);
+  void setNavSatFix(const sensor_msgs::NavSatFix&);
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  void setDistance(const eagleye_msgs::Distance&);
+  void setYawrateOffsetStop(const eagleye_msgs::YawrateOffset&);
+  void setYawrateOffset(const eagleye_msgs::YawrateOffset&);
+  void setSlipAngle(const eagleye_msgs::SlipAngle&);
+  void setHeadingInterpolate(const eagleye_msgs::Heading&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  const eagleye_msgs::Heading& getHeading() const { return heading_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  sensor_msgs::NavSatFix fix_;
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::Distance distance_;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop_;
+  eagleye_msgs::YawrateOffset yawrate_offset_;
+  eagleye_msgs::SlipAngle slip_angle_;
+  eagleye_msgs::Heading heading_interpolate_;
+  eagleye_msgs::Heading heading_;
+  RtkHeadingParameter parameter_;
+  RtkHeadingStatus status_;
+  ImuHistory own_imu_history_;
+  ImuHistory* shared_imu_history_;
+};
+
+class HeadingInterpolateEstimator
+{
+public:
+  HeadingInterpolateEstimator();
+
+  void setParameter(const HeadingInterpolateParameter&);
+  void reserve();
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  void setYawrateOffsetStop(const eagleye_msgs::YawrateOffset&);
+  void setYawrateOffset(const eagleye_msgs::YawrateOffset&);
+  void setHeading(const eagleye_msgs::Heading&);
+  void setSlipAngle(const eagleye_msgs::SlipAngle&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  const eagleye_msgs::Heading& getHeadingInterpolate() const { return heading_interpolate_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop_;
+  eagleye_msgs::YawrateOffset yawrate_offset_;
+  eagleye_msgs::Heading heading_;
+  eagleye_msgs::SlipAngle slip_angle_;
+  eagleye_msgs::Heading heading_interpolate_;
+  HeadingInterpolateParameter parameter_;
+  HeadingInterpolateStatus status_;
+};
+
+class SlipAngleEstimator
+{
+public:
+  SlipAngleEstimator();
+
+  void setParameter(const SlipangleParameter&);
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  void setYawrateOffsetStop(const eagleye_msgs::YawrateOffset&);
+  void setYawrateOffset(const eagleye_msgs::YawrateOffset&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  const eagleye_msgs::SlipAngle& getSlipAngle() const { return slip_angle_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop_;
+  eagleye_msgs::YawrateOffset yawrate_offset_2nd_;
+  eagleye_msgs::SlipAngle slip_angle_;
+  SlipangleParameter parameter_;
+};
+
+class HeightEstimator
+{
+public:
+  HeightEstimator();
+
+  void setParameter(const HeightParameter&);
+  void reserve();
+  void setNavSatFix(const sensor_msgs::NavSatFix&);
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  void setDistance(const eagleye_msgs::Distance&);
+  bool imuStep(const sensor_msgs::Imu&);
+  bool isReliabilityFixUpdated() const { return status_.flag_reliability; }
+
+  // Deferred window fit, see PositionEstimator::setDeferredFit(). Between
+  // fits the height is dead-reckoned; the fitted height, the acc x offset and
+  // scale factor and the outliers the fit removed from the window are merged
+  // in by the next imuStep() after applyFit(). The dead-reckoned change since
+  // the copy is added on top of the fitted height.
+  void setDeferredFit(bool deferred_fit) { deferred_fit_ = deferred_fit; }
+  bool isFitDue() const { return fit_due_; }
+  void fitSnapshot();
+  void applyFit() { fit_ready_ = true; }
+
+  // Starts from the given acc x offset and scale factor instead of 0 and 1,
+  // both enabled. The first window fit replaces them. Call it before the
+  // first imuStep().
+  void warmStart(double, double);
+
+  const eagleye_msgs::Height& getHeight() const { return height_; }
+  const eagleye_msgs::Pitching& getPitching() const { return pitching_; }
+  const eagleye_msgs::AccXOffset& getAccXOffset() const { return acc_x_offset_; }
+  const eagleye_msgs::AccXScaleFactor& getAccXScaleFactor() const { return acc_x_scale_factor_; }
+  const sensor_msgs::NavSatFix& getReliabilityFix() const { return deferred_fit_ ? fit_fix_ : fix_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  void mergeFit();
+
+  sensor_msgs::NavSatFix fix_;
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::Distance distance_;
+  eagleye_msgs::Height height_;
+  eagleye_msgs::Pitching pitching_;
+  eagleye_msgs::AccXOffset acc_x_offset_;
+  eagleye_msgs::AccXScaleFactor acc_x_scale_factor_;
+  HeightParameter parameter_;
+  HeightStatus status_;
+  bool deferred_fit_, fit_due_, fit_busy_, fit_ready_;
+  double fit_distance_last_, fit_height_last_;
+  sensor_msgs::NavSatFix fit_fix_;
+  eagleye_msgs::Height fit_height_;
+  eagleye_msgs::AccXOffset fit_acc_x_offset_;
+  eagleye_msgs::AccXScaleFactor fit_acc_x_scale_factor_;
+  HeightParameter fit_parameter_;
+  HeightStatus fit_status_;
+};
+
+class TrajectoryEstimator
+{
+public:
+  TrajectoryEstimator();
+
+  void setParameter(const TrajectoryParameter&);
+  void setTwist(const geometry_msgs::TwistStamped&);
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  void setHeadingInterpolate(const eagleye_msgs::Heading&);
+  void setYawrateOffsetStop(const eagleye_msgs::YawrateOffset&);
+  void setYawrateOffset(const eagleye_msgs::YawrateOffset&);
+  void setPitching(const eagleye_msgs::Pitching&);
+  // Deadlock check of the node timer: inputs must keep arriving and twist
+  // must stay within th_deadlock_time of the imu.
+  bool checkInputStatus(double th_deadlock_time);
+  bool imuStep(const sensor_msgs::Imu&);
+  bool isEnuVelUpdated() const { return enu_vel_status_; }
+
+  const geometry_msgs::Vector3Stamped& getEnuVel() const { return enu_vel_; }
+  const eagleye_msgs::Position& getEnuRelativePos() const { return enu_relative_pos_; }
+  const geometry_msgs::TwistStamped& getTwist() const { return eagleye_twist_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  sensor_msgs::Imu imu_;
+  geometry_msgs::TwistStamped velocity_;
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::Heading heading_interpolate_3rd_;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop_;
+  eagleye_msgs::YawrateOffset yawrate_offset_2nd_;
+  eagleye_msgs::Pitching pitching_;
+  geometry_msgs::Vector3Stamped enu_vel_;
+  eagleye_msgs::Position enu_relative_pos_;
+  geometry_msgs::TwistStamped eagleye_twist_;
+  int64_t imu_time_last_, velocity_time_last_;
+  bool input_status_;
+  bool enu_vel_status_;
+  TrajectoryParameter parameter_;
+  TrajectoryStatus status_;
+};
+
+class PositionEstimator
+{
+public:
+  PositionEstimator();
+
+  void setParameter(const PositionParameter&);
+  void reserve();
+  void setRtklibNav(const rtklib_msgs::RtklibNav&);
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  void setDistance(const eagleye_msgs::Distance&);
+  void setHeadingInterpolate(const eagleye_msgs::Heading&);
+  bool enuVelStep(const geometry_msgs::Vector3Stamped&);
+
+  // Deferred window fit. With setDeferredFit(true) the step only updates
+  // the window. When the fit is due, the step copies the window and
+  // isFitDue() is true until the next step. fitSnapshot() runs the outlier
+  // fit on that copy and may run on another thread; the estimator leaves the
+  // copy alone until applyFit(). No new copy is made while a fit is pending.
+  // applyFit() returns true when getEnuAbsolutePos() holds a new position.
+  // Its stamp is the enu_vel at which the window was copied, so
+  // position_interpolate corrects its track from there.
+  void setDeferredFit(bool deferred_fit) { deferred_fit_ = deferred_fit; }
+  bool isFitDue() const { return fit_due_; }
+  void fitSnapshot();
+  bool applyFit();
+
+  const eagleye_msgs::Position& getEnuAbsolutePos() const { return enu_absolute_pos_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  rtklib_msgs::RtklibNav rtklib_nav_;
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::Distance distance_;
+  eagleye_msgs::Heading heading_interpolate_3rd_;
+  eagleye_msgs::Position enu_absolute_pos_;
+  PositionParameter parameter_;
+  PositionStatus status_;
+  bool deferred_fit_, fit_due_, fit_busy_;
+  eagleye_msgs::Position fit_enu_absolute_pos_;
+  PositionParameter fit_parameter_;
+  PositionStatus fit_status_;
+};
+
+class PositionInterpolateEstimator
+{
+public:
+  PositionInterpolateEstimator();
+
+  void setParameter(const PositionInterpolateParameter&);
+  void reserve();
+  void setNavSatFix(const sensor_msgs::NavSatFix&);
+  void setEnuAbsolutePos(const eagleye_msgs::Position&);
+  void setGnssSmoothPos(const eagleye_msgs::Position&);
+  void setHeight(const eagleye_msgs::Height&);
+  // Returns true when enu_absolute_pos_interpolate is published. The fix
+  // output falls back to the raw navsat fix until the position is enabled.
+  bool enuVelStep(const geometry_msgs::Vector3Stamped&);
+  bool isFixUpdated() const { return fix_status_; }
+
+  const eagleye_msgs::Position& getEnuAbsolutePosInterpolate() const { return enu_absolute_pos_interpolate_; }
+  const sensor_msgs::NavSatFix& getFix() const;
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  sensor_msgs::NavSatFix fix_;
+  eagleye_msgs::Position enu_absolute_pos_;
+  eagleye_msgs::Position gnss_smooth_pos_;
+  eagleye_msgs::Height height_;
+  eagleye_msgs::Position enu_absolute_pos_interpolate_;
+  sensor_msgs::NavSatFix eagleye_fix_;
+  bool eagleye_fix_status_;
+  bool fix_status_;
+  PositionInterpolateParameter parameter_;
+  PositionInterpolateStatus status_;
+};
+
+class SmoothingEstimator
+{
+public:
+  SmoothingEstimator();
+
+  void setParameter(const SmoothingParameter&);
+  void reserve();
+  void setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor&);
+  bool rtklibNavStep(const rtklib_msgs::RtklibNav&);
+
+  const eagleye_msgs::Position& getGnssSmoothPos() const { return gnss_smooth_pos_enu_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::Position gnss_smooth_pos_enu_;
+  SmoothingParameter parameter_;
+  SmoothingStatus status_;
+};
+
+class RtkDeadreckoningEstimator
+{
+public:
+  RtkDeadreckoningEstimator();
+
+  void setParameter(const RtkDeadreckoningParameter&);
+  void setRtklibNav(const rtklib_msgs::RtklibNav&);
+  void setNavSatFix(const sensor_msgs::NavSatFix&);
+  void setHeadingInterpolate(const eagleye_msgs::Heading&);
+  bool enuVelStep(const geometry_msgs::Vector3Stamped&);
+  bool isFixUpdated() const { return fix_status_; }
+
+  const eagleye_msgs::Position& getEnuAbsoluteRtkDeadreckoning() const { return enu_absolute_rtk_deadreckoning_; }
+  const sensor_msgs::NavSatFix& getFix() const;
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  rtklib_msgs::RtklibNav rtklib_nav_;
+  sensor_msgs::NavSatFix fix_;
+  eagleye_msgs::Heading heading_interpolate_3rd_;
+  eagleye_msgs::Position enu_absolute_rtk_deadreckoning_;
+  sensor_msgs::NavSatFix eagleye_fix_;
+  bool eagleye_fix_status_;
+  bool fix_status_;
+  RtkDeadreckoningParameter parameter_;
+  RtkDeadreckoningStatus status_;
+};
+
+class CorrectionImuEstimator
+{
+public:
+  CorrectionImuEstimator();
+
+  void setReverseImu(bool);
+  void setAngularVelocityOffsetStop(const eagleye_msgs::AngularVelocityOffset&);
+  void setAccXOffset(const eagleye_msgs::AccXOffset&);
+  void setAccXScaleFactor(const eagleye_msgs::AccXScaleFactor&);
+  bool imuStep(const sensor_msgs::Imu&);
+
+  const sensor_msgs::Imu& getCorrectionImu() const { return correction_imu_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  bool reverse_imu_;
+  eagleye_msgs::AngularVelocityOffset angular_velocity_offset_stop_;
+  eagleye_msgs::AccXOffset acc_x_offset_;
+  eagleye_msgs::AccXScaleFactor acc_x_scale_factor_;
+  sensor_msgs::Imu correction_imu_;
+};
+
+// Recursive filter mode (see ekf.cpp) in place of velocity_scale_factor,
+// yawrate_offset, heading, heading_interpolate, position, position_interpolate
+// and height. The outputs are those of the replaced estimators: one yawrate
+// offset serves the 1st and 2nd stage, one heading all three, and the acc x
+// scale factor is 1. The reliability fix of height is not produced.
+class EkfEstimator
+{
+public:
+  EkfEstimator();
+
+  void setParameter(const EkfParameter&);
+  void setTwist(const geometry_msgs::TwistStamped&);
+  void setRtklibNav(const rtklib_msgs::RtklibNav&);
+  void setNavSatFix(const sensor_msgs::NavSatFix&);
+  void setSlipAngle(const eagleye_msgs::SlipAngle&);
+  bool imuStep(const sensor_msgs::Imu&);
+  // Whether the last imuStep() used a doppler velocity, an rtklib_nav
+  // position or a navsat/fix altitude.
+  bool isHeadingUpdated() const { return heading_updated_; }
+  bool isEnuAbsolutePosUpdated() const { return enu_absolute_pos_updated_; }
+  bool isHeightUpdated() const { return height_updated_; }
+  bool isEnuAbsolutePosInterpolateUpdated() const { return eagleye_fix_status_; }
+  bool isFixUpdated() const { return fix_status_; }
+
+  // Start values saved by a previous run, see VelocityScaleFactorEstimator::warmStart().
+  // The scale factor and the yawrate offset are enabled from the start. Call
+  // them before the first imuStep().
+  void warmStartVelocityScaleFactor(double);
+  void warmStartYawrateOffset(double);
+  void warmStartAccXOffset(double);
+
+  const eagleye_msgs::VelocityScaleFactor& getVelocityScaleFactor() const { return velocity_scale_factor_; }
+  const eagleye_msgs::YawrateOffset& getYawrateOffset() const { return yawrate_offset_; }
+  const eagleye_msgs::Heading& getHeading() const { return heading_; }
+  const eagleye_msgs::Heading& getHeadingInterpolate() const { return heading_interpolate_; }
+  const eagleye_msgs::Pitching& getPitching() const { return pitching_; }
+  const eagleye_msgs::Height& getHeight() const { return height_; }
+  const eagleye_msgs::AccXOffset& getAccXOffset() const { return acc_x_offset_; }
+  const eagleye_msgs::AccXScaleFactor& getAccXScaleFactor() const { return acc_x_scale_factor_; }
+  const eagleye_msgs::Position& getEnuAbsolutePos() const { return enu_absolute_pos_; }
+  const eagleye_msgs::Position& getEnuAbsolutePosInterpolate() const { return enu_absolute_pos_interpolate_; }
+  const sensor_msgs::NavSatFix& getFix() const { return eagleye_fix_status_ ? eagleye_fix_ : fix_; }
+  const EkfStatus& getStatus() const { return status_; }
+  const EkfTransition& getTransition() const { return transition_; }
+  const eagleye_msgs::SlipAngle& getSlipAngle() const { return slip_angle_; }
+
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  template <class Checkpoint>
+  void checkpointFields(Checkpoint*);
+
+  double stateStd(int index) const { return std::sqrt(status_.covariance[index * EKF_STATE_NUM + index]); }
+
+  geometry_msgs::TwistStamped velocity_;
+  rtklib_msgs::RtklibNav rtklib_nav_;
+  sensor_msgs::NavSatFix fix_;
+  eagleye_msgs::SlipAngle slip_angle_;
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor_;
+  eagleye_msgs::YawrateOffset yawrate_offset_;
+  eagleye_msgs::Heading heading_;
+  eagleye_msgs::Heading heading_interpolate_;
+  eagleye_msgs::Pitching pitching_;
+  eagleye_msgs::Height height_;
+  eagleye_msgs::AccXOffset acc_x_offset_;
+  eagleye_msgs::AccXScaleFactor acc_x_scale_factor_;
+  eagleye_msgs::Position enu_absolute_pos_;
+  eagleye_msgs::Position enu_absolute_pos_interpolate_;
+  sensor_msgs::NavSatFix eagleye_fix_;
+  bool heading_updated_;
+  bool enu_absolute_pos_updated_;
+  bool height_updated_;
+  bool eagleye_fix_status_;
+  bool fix_status_;
+  EkfParameter parameter_;
+  EkfStatus status_;
+  EkfTransition transition_;
+};
+
+#endif /*ESTIMATOR_H */
@@ -41,11 +41,73 @@
 #include "eagleye_msgs/AngularVelocityOffset.h"
 #include <boost/circular_buffer.hpp>
 #include <math.h>
+#include <stdint.h>
 #include <numeric>
 
 #ifndef NAVIGATION_H
 #define NAVIGATION_H
 
+// Time is kept as int64 nanoseconds in the status and only differences are
+// converted to seconds, so stamps compare exactly and keep full precision.
+inline int64_t stampToNSec(const ros::Time& stamp)
+{
+  return static_cast<int64_t>(stamp.toNSec());
+}
+
+inline double nsecToSec(int64_t nsec)
+{
+  return nsec * 1e-9;
+}
+
+// Append-only imu history shared by the estimators of one process, so that
+// yawrate_offset and heading read the imu from one place instead of each
+// keeping its own copy of the stamps and yaw rates. Samples are addressed by
+// a sequence number that keeps counting while old samples drop out of the
+// ring, and an estimator holds the sequence number of the first sample of its
+// window as a read cursor.
+//
+// Next to the stamp every sample caches the integral of the raw yaw rate
+// (angular_velocity.z) since the first sample, so the integrated yaw angle
+// over any window is one subtraction instead of a loop over the window.
+class CheckpointWriter;
+class CheckpointReader;
+
+class ImuHistory
+{
+public:
+  ImuHistory();
+
+  // Grows the ring to hold at least the given number of samples. Every
+  // estimator reading the history calls it with its window length.
+  void requireCapacity(std::size_t);
+  void append(const sensor_msgs::Imu&);
+
+  // Sequence numbers of the oldest sample and one past the newest sample.
+  uint64_t begin() const { return end_ - samples_.size(); }
+  uint64_t end() const { return end_; }
+  bool contains(uint64_t sequence) const { return sequence >= begin() && sequence < end_; }
+
+  int64_t stamp(uint64_t sequence) const { return at(sequence).stamp; }
+  // Integral of the raw yaw rate over (from, to].
+  double yawIntegral(uint64_t from, uint64_t to) const { return at(to).yaw_integral - at(from).yaw_integral; }
+
+  // See checkpoint.hpp. The capacity is kept if it is already large enough.
+  void saveCheckpoint(CheckpointWriter*) const;
+  void loadCheckpoint(CheckpointReader*);
+
+private:
+  struct Sample
+  {
+    int64_t stamp;
+    double yaw_integral;
+  };
+
+  const Sample& at(uint64_t sequence) const { return samples_[sequence - begin()]; }
+
+  boost::circular_buffer<Sample> samples_;
+  uint64_t end_;
+};
+
 struct VelocityScaleFactorParameter
 {
   double estimated_number_min;
@@ -62,11 +124,13 @@ struct VelocityScaleFactorStatus
   int tow_last, estimated_number;
   double velocity_scale_factor_last;
   bool estimate_start_status;
+  std::vector<int> gnss_index, velocity_index, index;
+  std::vector<double> velocity_scale_factor_buffer;
 };
 
 struct DistanceStatus
 {
-  double time_last;
+  int64_t time_last;
 };
 
 struct YawrateOffsetStopParameter
@@ -101,12 +165,13 @@ struct YawrateOffsetStatus
   int estimated_preparation_conditions;
   int heading_estimate_status_count;
   int estimated_number;
-  std::vector<double> time_buffer;
-  std::vector<double> yawrate_buffer;
+  uint64_t imu_history_cursor;
   std::vector<double> heading_angle_buffer;
   std::vector<double> correction_velocity_buffer;
   std::vector<bool> heading_estimate_status_buffer;
   std::vector<double> yawrate_offset_stop_buffer;
+  std::vector<int> velocity_index, heading_estimate_status_index, index;
+  std::vector<double> provisional_heading_angle_buffer, base_heading_angle_buffer, diff_buffer, time_buffer2;
 };
 
 struct HeadingParameter
@@ -127,14 +192,15 @@ struct HeadingStatus
 {
   int tow_last;
   int estimated_number;
-  std::vector<double> time_buffer;
+  uint64_t imu_history_cursor;
   std::vector<double> heading_angle_buffer;
-  std::vector<double> yawrate_buffer;
   std::vector<double> correction_velocity_buffer;
   std::vector<double> yawrate_offset_stop_buffer;
   std::vector<double> yawrate_offset_buffer;
   std::vector<double> slip_angle_buffer;
   std::vector<double> gnss_status_buffer;
+  std::vector<int> gnss_index, velocity_index, index;
+  std::vector<double> provisional_heading_angle_buffer, base_heading_angle_buffer, base_heading_angle_buffer2, diff_buffer, heading_angle_buffer2;
 };
 
 struct RtkHeadingParameter
@@ -158,9 +224,8 @@ struct RtkHeadingStatus
   int tow_last;
   int estimated_number;
   double last_rtk_heading_angle;
-  std::vector<double> time_buffer;
+  uint64_t imu_history_cursor;
   std::vector<double> heading_angle_buffer;
-  std::vector<double> yawrate_buffer;
   std::vector<double> correction_velocity_buffer;
   std::vector<double> yawrate_offset_stop_buffer;
   std::vector<double> yawrate_offset_buffer;
@@ -171,6 +236,8 @@ struct RtkHeadingStatus
   std::vector<double> longitude_buffer;
   std::vector<double> altitude_buffer;
   std::vector<int> fix_status_buffer;
+  std::vector<int> gnss_index, velocity_index, index;
+  std::vector<double> provisional_heading_angle_buffer, base_heading_angle_buffer, base_heading_angle_buffer2, diff_buffer, heading_angle_buffer2;
 };
 
 struct HeadingInterpolateParameter
@@ -185,11 +252,11 @@ struct HeadingInterpolateStatus
   int number_buffer;
   int heading_estimate_status_count;
   bool heading_estimate_start_status;
-  double heading_stamp_last;
-  double time_last;
+  int64_t heading_stamp_last;
+  int64_t time_last;
   double provisional_heading_angle;
   std::vector<double> provisional_heading_angle_buffer;
-  std::vector<double> imu_stamp_buffer;
+  std::vector<int64_t> imu_stamp_buffer;
 };
 
 struct PositionParameter
@@ -219,13 +286,18 @@ struct PositionStatus
   int estimated_number;
   int tow_last;
   int heading_estimate_status_count;
-  double time_last;
+  int64_t time_last;
   double enu_relative_pos_x, enu_relative_pos_y, enu_relative_pos_z;
   double distance_last;
   std::vector<double> enu_pos_x_buffer, enu_pos_y_buffer,  enu_pos_z_buffer;
   std::vector<double> enu_relative_pos_x_buffer, enu_relative_pos_y_buffer, enu_relative_pos_z_buffer;
   std::vector<double> correction_velocity_buffer;
   std::vector<double> distance_buffer;
+  std::vector<int> distance_index, velocity_index, index;
+  std::vector<double> base_enu_pos_x_buffer, base_enu_pos_y_buffer, base_enu_pos_z_buffer;
+  std::vector<double> diff_x_buffer2, diff_y_buffer2, diff_z_buffer2;
+  std::vector<double> base_enu_pos_x_buffer2,  base_enu_pos_y_buffer2, base_enu_pos_z_buffer2;
+  std::vector<double> diff_x_buffer, diff_y_buffer, diff_z_buffer;
 };
 
 struct PositionInterpolateParameter
@@ -239,15 +311,15 @@ struct PositionInterpolateStatus
   int position_estimate_status_count;
   int number_buffer;
   bool position_estimate_start_status;
-  double position_stamp_last;
-  double time_last;
+  int64_t position_stamp_last;
+  int64_t time_last;
   double provisional_enu_pos_x;
   double provisional_enu_pos_y;
   double provisional_enu_pos_z;
   std::vector<double> provisional_enu_pos_x_buffer;
   std::vector<double> provisional_enu_pos_y_buffer;
   std::vector<double> provisional_enu_pos_z_buffer;
-  std::vector<double> imu_stamp_buffer;
+  std::vector<int64_t> imu_stamp_buffer;
 };
 
 struct SlipangleParameter
@@ -289,9 +361,10 @@ struct SmoothingStatus
 {
   int estimated_number;
   double last_pos[3];
-  std::vector<double> time_buffer;
+  std::vector<int64_t> time_buffer;
   std::vector<double> enu_pos_x_buffer, enu_pos_y_buffer,  enu_pos_z_buffer;
   std::vector<double> correction_velocity_buffer;
+  std::vector<int> velocity_index, index;
 };
 
 struct TrajectoryParameter
@@ -305,7 +378,7 @@ struct TrajectoryStatus
 {
   int estimate_status_count;
   double heading_last;
-  double time_last;
+  int64_t time_last;
 };
 
 struct HeightParameter
@@ -328,16 +401,17 @@ struct HeightStatus
   double acceleration_offset_linear_x_last;
   double acceleration_SF_linear_x_last;
   double height_last;
-  double time_last;
+  int64_t time_last;
   double distance_last;
   double correction_velocity_x_last;
-  double fix_time_last;
+  int64_t fix_time_last;
   double pitching_angle_last;
   bool height_estimate_start_status;
   bool estimate_start_status;
   bool acceleration_SF_estimate_status;
   int data_number;
   bool flag_reliability;
+  bool height_fit_status;
   std::vector<double> height_buffer;
   std::vector<double> height_buffer2;
   std::vector<double> relative_height_G_buffer;
@@ -348,6 +422,8 @@ struct HeightStatus
   std::vector<double> correction_velocity_buffer;
   std::vector<double> distance_buffer;
   std::vector<double> acc_buffer;
+  std::vector<int> distance_index, velocity_index, index, erase_number;
+  std::vector<double> base_height_buffer, base_height_buffer2, diff_height_buffer, diff_height_buffer2;
 };
 
 struct AngularVelocityOffsetStopParameter
@@ -394,23 +470,95 @@ struct RtkDeadreckoningStatus
   int number_buffer;
   bool position_estimate_start_status;
   bool ecef_base_pos_status;
-  double position_stamp_last;
-  double time_last;
+  int64_t position_stamp_last;
+  int64_t time_last;
   double provisional_enu_pos_x;
   double provisional_enu_pos_y;
   double provisional_enu_pos_z;
   std::vector<double> provisional_enu_pos_x_buffer;
   std::vector<double> provisional_enu_pos_y_buffer;
   std::vector<double> provisional_enu_pos_z_buffer;
-  std::vector<double> imu_stamp_buffer;
+  std::vector<int64_t> imu_stamp_buffer;
+};
+
+// Recursive filter mode, see ekf.cpp. The *_noise of a state are random walk
+// densities per square root of a second (pitch_noise: of a metre driven), the
+// others are standard deviations of one sample. The ecef base position and the
+// GNSS antenna translation are those of PositionParameter.
+struct EkfParameter
+{
+  bool reverse_imu;
+  double stop_judgment_velocity_threshold;
+  double estimated_velocity_threshold;
+  double yawrate_noise;
+  double yawrate_offset_noise;
+  double velocity_scale_factor_noise;
+  double pitch_noise;
+  double acc_x_offset_noise;
+  double position_noise;
+  double acc_noise;
+  double gnss_position_noise;
+  double gnss_height_noise;
+  double gnss_velocity_noise;
+  double outlier_threshold;
+  double yawrate_offset_std_threshold;
+  double velocity_scale_factor_std_threshold;
+  double ecef_base_pos_x;
+  double ecef_base_pos_y;
+  double ecef_base_pos_z;
+  double tf_gnss_translation_x;
+  double tf_gnss_translation_y;
+  double tf_gnss_translation_z;
+};
+
+enum EkfStateIndex
+{
+  EKF_E,
+  EKF_N,
+  EKF_U,
+  EKF_HEADING,
+  EKF_YAWRATE_OFFSET,
+  EKF_VELOCITY_SCALE_FACTOR,
+  EKF_PITCH,
+  EKF_ACC_X_OFFSET,
+  EKF_STATE_NUM
+};
+
+struct EkfStatus
+{
+  bool heading_status;
+  bool position_status;
+  bool height_status;
+  double state[EKF_STATE_NUM];
+  double covariance[EKF_STATE_NUM * EKF_STATE_NUM];
+  double ecef_base_pos[3];
+  double velocity_last;
+  int64_t time_last;
+  int64_t fix_time_last;
+  int tow_last;
+  int position_outlier_count;
+  // Counts the states restarted from a measurement, see EkfSmoother.
+  int reset_count;
+};
+
+// Prediction step of the last ekf_predict(), kept for the backward pass of
+// EkfSmoother. The jacobian is the identity apart from the entries below.
+struct EkfTransition
+{
+  double state[EKF_STATE_NUM];
+  double position_jacobian[3][3];
+  double heading_jacobian;
+  double process_noise[EKF_STATE_NUM];
 };
 
 extern void velocity_scale_factor_estimate(const rtklib_msgs::RtklibNav, const geometry_msgs::TwistStamped, const VelocityScaleFactorParameter, VelocityScaleFactorStatus*, eagleye_msgs::VelocityScaleFactor*);
 extern void distance_estimate(const eagleye_msgs::VelocityScaleFactor, DistanceStatus*,eagleye_msgs::Distance*);
 extern void yawrate_offset_stop_estimate(const geometry_msgs::TwistStamped, const sensor_msgs::Imu, const YawrateOffsetStopParameter, YawrateOffsetStopStatus*, eagleye_msgs::YawrateOffset*);
-extern void yawrate_offset_estimate(const eagleye_msgs::VelocityScaleFactor, const eagleye_msgs::YawrateOffset,const eagleye_msgs::Heading,const sensor_msgs::Imu, const YawrateOffsetParameter, YawrateOffsetStatus*, eagleye_msgs::YawrateOffset*);
-extern void heading_estimate(const rtklib_msgs::RtklibNav, const sensor_msgs::Imu, const eagleye_msgs::VelocityScaleFactor, const eagleye_msgs::YawrateOffset, const eagleye_msgs::YawrateOffset,  const eagleye_msgs::SlipAngle, const eagleye_msgs::Heading, const HeadingParameter, HeadingStatus*,eagleye_msgs::Heading*);
+extern void yawrate_offset_estimate(const eagleye_msgs::VelocityScaleFactor, const eagleye_msgs::YawrateOffset,const eagleye_msgs::Heading, const ImuHistory&, const YawrateOffsetParameter, YawrateOffsetStatus*, eagleye_msgs::YawrateOffset*);
+extern void heading_estimate(const rtklib_msgs::RtklibNav, const sensor_msgs::Imu, const ImuHistory&, const eagleye_msgs::VelocityScaleFactor, const eagleye_msgs::YawrateOffset, const eagleye_msgs::YawrateOffset,  const eagleye_msgs::SlipAngle, const eagleye_msgs::Heading, const HeadingParameter, HeadingStatus*,eagleye_msgs::Heading*);
 extern void position_estimate(const rtklib_msgs::RtklibNav, const eagleye_msgs::VelocityScaleFactor, const eagleye_msgs::Distance, const eagleye_msgs::Heading, const geometry_msgs::Vector3Stamped, const PositionParameter, PositionStatus*, eagleye_msgs::Position*);
+extern bool position_window_update(const rtklib_msgs::RtklibNav, const eagleye_msgs::VelocityScaleFactor, const eagleye_msgs::Distance, const eagleye_msgs::Heading, const geometry_msgs::Vector3Stamped, const PositionParameter, PositionStatus*, eagleye_msgs::Position*);
+extern void position_window_fit(const PositionParameter, PositionStatus*, eagleye_msgs::Position*);
 extern void slip_angle_estimate(const sensor_msgs::Imu,const eagleye_msgs::VelocityScaleFactor,const eagleye_msgs::YawrateOffset,const eagleye_msgs::YawrateOffset,const SlipangleParameter,eagleye_msgs::SlipAngle*);
 extern void slip_coefficient_estimate(const sensor_msgs::Imu,const rtklib_msgs::RtklibNav,const eagleye_msgs::VelocityScaleFactor,const eagleye_msgs::YawrateOffset,const eagleye_msgs::YawrateOffset,const eagleye_msgs::Heading,const SlipCoefficientParameter,SlipCoefficientStatus*,double*);
 extern void smoothing_estimate(const rtklib_msgs::RtklibNav,const eagleye_msgs::VelocityScaleFactor,const SmoothingParameter,SmoothingStatus*,eagleye_msgs::Position*);
@@ -418,9 +566,18 @@ extern void trajectory_estimate(const sensor_msgs::Imu,const eagleye_msgs::Veloc
 extern void heading_interpolate_estimate(const sensor_msgs::Imu,const eagleye_msgs::VelocityScaleFactor,const eagleye_msgs::YawrateOffset,const eagleye_msgs::YawrateOffset,const eagleye_msgs::Heading,const eagleye_msgs::SlipAngle,const HeadingInterpolateParameter,HeadingInterpolateStatus*,eagleye_msgs::Heading*);
 extern void position_interpolate_estimate(const eagleye_msgs::Position,const geometry_msgs::Vector3Stamped,const eagleye_msgs::Position,const eagleye_msgs::Height,const PositionInterpolateParameter,PositionInterpolateStatus*,eagleye_msgs::Position*,sensor_msgs::NavSatFix*);
 extern void pitching_estimate(const sensor_msgs::Imu,const sensor_msgs::NavSatFix,const eagleye_msgs::VelocityScaleFactor,const eagleye_msgs::Distance,const HeightParameter,HeightStatus*,eagleye_msgs::Height*,eagleye_msgs::Pitching*,eagleye_msgs::AccXOffset*,eagleye_msgs::AccXScaleFactor*);
+extern bool height_window_update(const sensor_msgs::Imu,const sensor_msgs::NavSatFix,const eagleye_msgs::VelocityScaleFactor,const eagleye_msgs::Distance,const HeightParameter,HeightStatus*);
+extern void height_window_fit(const HeightParameter,HeightStatus*,eagleye_msgs::Height*,eagleye_msgs::AccXOffset*,eagleye_msgs::AccXScaleFactor*);
+extern void height_propagate(const sensor_msgs::Imu,const eagleye_msgs::VelocityScaleFactor,const HeightParameter,HeightStatus*,eagleye_msgs::Height*,eagleye_msgs::Pitching*,eagleye_msgs::AccXOffset*,eagleye_msgs::AccXScaleFactor*);
 extern void trajectory3d_estimate(const sensor_msgs::Imu,const eagleye_msgs::VelocityScaleFactor,const eagleye_msgs::Heading,const eagleye_msgs::YawrateOffset,const eagleye_msgs::YawrateOffset,const eagleye_msgs::Pitching,const TrajectoryParameter,TrajectoryStatus*,geometry_msgs::Vector3Stamped*,eagleye_msgs::Position*,geometry_msgs::TwistStamped*);
 extern void angular_velocity_offset_stop_estimate(const geometry_msgs::TwistStamped, const sensor_msgs::Imu, const AngularVelocityOffsetStopParameter, AngularVelocityOffsetStopStatus*, eagleye_msgs::AngularVelocityOffset*);
 extern void rtk_deadreckoning_estimate(const rtklib_msgs::RtklibNav,const geometry_msgs::Vector3Stamped,const sensor_msgs::NavSatFix, const eagleye_msgs::Heading,const RtkDeadreckoningParameter,RtkDeadreckoningStatus*,eagleye_msgs::Position*,sensor_msgs::NavSatFix*);
-extern void rtk_heading_estimate(const sensor_msgs::NavSatFix, const sensor_msgs::Imu, const eagleye_msgs::VelocityScaleFactor, const eagleye_msgs::Distance,const eagleye_msgs::YawrateOffset, const eagleye_msgs::YawrateOffset,  const eagleye_msgs::SlipAngle, const eagleye_msgs::Heading, const RtkHeadingParameter, RtkHeadingStatus*,eagleye_msgs::Heading*);
+extern void rtk_heading_estimate(const sensor_msgs::NavSatFix, const sensor_msgs::Imu, const ImuHistory&, const eagleye_msgs::VelocityScaleFactor, const eagleye_msgs::Distance,const eagleye_msgs::YawrateOffset, const eagleye_msgs::YawrateOffset,  const eagleye_msgs::SlipAngle, const eagleye_msgs::Heading, const RtkHeadingParameter, RtkHeadingStatus*,eagleye_msgs::Heading*);
+
+extern void ekf_init(EkfStatus*);
+extern void ekf_jacobian(const EkfTransition&, double[EKF_STATE_NUM][EKF_STATE_NUM]);
+extern void ekf_predict(const sensor_msgs::Imu, const geometry_msgs::TwistStamped, const eagleye_msgs::SlipAngle, const EkfParameter, EkfStatus*, EkfTransition*);
+extern void ekf_rtklib_nav_update(const rtklib_msgs::RtklibNav, const eagleye_msgs::SlipAngle, const EkfParameter, EkfStatus*, bool*, bool*);
+extern bool ekf_fix_update(const sensor_msgs::NavSatFix, const EkfParameter, EkfStatus*);
 
 #endif /*NAVIGATION_H */
@@ -0,0 +1,172 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * synthetic_drive.hpp
+ * Author MapIV Sekino
+ */
+
+// Synthetic vehicle drive with consistent IMU, wheel speed and GNSS messages.
+// The sensor errors (gyro bias and its drift, acceleration offset and scale,
+// wheel speed scale factor, GNSS noise, outages, multipath and RTK fix/float
+// transitions) are configurable and reproducible from the seed. Besides the
+// raw sensor messages every sample carries the ground truth in the form of the
+// outputs a converged eagleye would publish at that instant, so each estimator
+// can be driven on its own or checked against the truth.
+
+#ifndef SYNTHETIC_DRIVE_H
+#define SYNTHETIC_DRIVE_H
+
+#include "navigation/navigation.hpp"
+#include <random>
+
+enum SyntheticGnssEventType
+{
+  GNSS_OUTAGE,
+  GNSS_MULTIPATH,
+  GNSS_FLOAT
+};
+
+// Injected GNSS event, start is the elapsed time from the start of the drive.
+// magnitude is the position error [m] of GNSS_MULTIPATH.
+struct SyntheticGnssEvent
+{
+  int type;
+  double start;
+  double duration;
+  double magnitude;
+};
+
+struct SyntheticDriveParameter
+{
+  double start_time;
+  double imu_rate;
+  double gnss_rate;
+  double route_period;
+  double cruise_velocity;
+  double slope_amplitude;
+  double slope_period;
+  double latitude;
+  double longitude;
+  double altitude;
+  double initial_heading;
+
+  double gyro_bias;
+  double gyro_bias_drift;
+  double gyro_noise;
+  double acc_offset;
+  double acc_scale;
+  double acc_noise;
+  double wheel_scale_factor;
+  double wheel_speed_noise;
+
+  double gnss_fix_position_noise;
+  double gnss_float_position_noise;
+  double gnss_velocity_noise;
+  double multipath_probability;
+  double multipath_magnitude;
+  double float_probability;
+  double float_duration;
+  std::vector<SyntheticGnssEvent> gnss_events;
+  unsigned int seed;
+};
+
+enum SyntheticGnssState
+{
+  GNSS_STATE_FIX,
+  GNSS_STATE_FLOAT,
+  GNSS_STATE_NONE
+};
+
+struct SyntheticDriveSample
+{
+  sensor_msgs::Imu imu;
+  geometry_msgs::TwistStamped twist;
+  bool gnss_updated;
+  rtklib_msgs::RtklibNav rtklib_nav;
+  sensor_msgs::NavSatFix fix;
+
+  int gnss_state;
+  bool multipath;
+  sensor_msgs::NavSatFix truth_fix;
+
+  eagleye_msgs::VelocityScaleFactor velocity_scale_factor;
+  eagleye_msgs::Distance distance;
+  eagleye_msgs::YawrateOffset yawrate_offset_stop;
+  eagleye_msgs::YawrateOffset yawrate_offset;
+  eagleye_msgs::SlipAngle slip_angle;
+  eagleye_msgs::Heading heading;
+  eagleye_msgs::Heading heading_interpolate;
+  eagleye_msgs::Pitching pitching;
+  eagleye_msgs::Height height;
+  geometry_msgs::Vector3Stamped enu_vel;
+  eagleye_msgs::Position enu_absolute_pos;
+  eagleye_msgs::Position gnss_smooth_pos;
+};
+
+extern void setDefaultSyntheticDriveParameter(SyntheticDriveParameter*);
+
+// The route repeats every route_period: a 20 s stop, then straights and
+// alternating quarter turns on a rolling slope, then a stop again. The default
+// parameter is an error free RTK fix drive with a constant gyro bias and wheel
+// speed scale factor, 50 Hz IMU and twist and 5 Hz GNSS.
+class SyntheticDrive
+{
+public:
+  SyntheticDrive();
+  explicit SyntheticDrive(const SyntheticDriveParameter&);
+
+  const SyntheticDriveSample& next();
+  const SyntheticDriveSample& sample() const { return sample_; }
+  double time() const { return time_; }
+
+private:
+  void init();
+  double velocity(double t) const;
+  double yawrate(double t) const;
+  double pitch(double t) const;
+  bool activeEvent(int type, double t, double* magnitude) const;
+  void updateGnss(double t, const double enu_vel[3], const ros::Time& stamp);
+
+  SyntheticDriveParameter parameter_;
+  SyntheticDriveSample sample_;
+  std::mt19937 random_;
+  std::normal_distribution<double> normal_;
+  std::uniform_real_distribution<double> uniform_;
+  double imu_period_;
+  unsigned long gnss_decimation_;
+  double time_;
+  unsigned long count_;
+  double heading_;
+  double distance_;
+  double gyro_bias_;
+  double float_end_time_;
+  double enu_pos_[3];
+  double ecef_base_pos_[3];
+  double llh_base_pos_[3];
+  unsigned int tow_;
+};
+
+#endif /*SYNTHETIC_DRIVE_H */
@@ -0,0 +1,275 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * checkpoint.cpp
+ * Author MapIV Sekino
+ */
+
+#include "navigation/checkpoint.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static const char CHECKPOINT_MAGIC[4] = {'E', 'G', 'C', 'P'};
+
+CheckpointWriter::CheckpointWriter()
+{
+  append(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+  append(&CHECKPOINT_VERSION, sizeof(CHECKPOINT_VERSION));
+}
+
+void CheckpointWriter::section(const std::string& name)
+{
+  field(name);
+}
+
+void CheckpointWriter::field(const bool& value)
+{
+  uint8_t byte = value ? 1 : 0;
+  append(&byte, 1);
+}
+
+void CheckpointWriter::field(const int& value)
+{
+  append(&value, sizeof(value));
+}
+
+void CheckpointWriter::field(const int64_t& value)
+{
+  append(&value, sizeof(value));
+}
+
+void CheckpointWriter::field(const uint64_t& value)
+{
+  append(&value, sizeof(value));
+}
+
+void CheckpointWriter::field(const double& value)
+{
+  append(&value, sizeof(value));
+}
+
+void CheckpointWriter::field(const std::vector<bool>& value)
+{
+  field(static_cast<uint64_t>(value.size()));
+  for (std::size_t i = 0; i < value.size(); i++)
+  {
+    field(static_cast<bool>(value[i]));
+  }
+}
+
+void CheckpointWriter::field(const std::vector<int>& value)
+{
+  field(static_cast<uint64_t>(value.size()));
+  append(value.data(), value.size() * sizeof(int));
+}
+
+void CheckpointWriter::field(const std::vector<int64_t>& value)
+{
+  field(static_cast<uint64_t>(value.size()));
+  append(value.data(), value.size() * sizeof(int64_t));
+}
+
+void CheckpointWriter::field(const std::vector<double>& value)
+{
+  field(static_cast<uint64_t>(value.size()));
+  append(value.data(), value.size() * sizeof(double));
+}
+
+void CheckpointWriter::field(const std::string& value)
+{
+  field(static_cast<uint64_t>(value.size()));
+  append(value.data(), value.size());
+}
+
+// Written to a temporary file and renamed, so a crash while saving leaves the
+// previous checkpoint.
+void CheckpointWriter::save(const std::string& file) const
+{
+  std::string tmp = file + ".tmp";
+  {
+    std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data_.data()), data_.size());
+    if (!out)
+    {
+      throw std::runtime_error("cannot write checkpoint " + tmp);
+    }
+  }
+  if (std::rename(tmp.c_str(), file.c_str()) != 0)
+  {
+    throw std::runtime_error("cannot rename checkpoint to " + file);
+  }
+}
+
+void CheckpointWriter::append(const void* data, std::size_t size)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  data_.insert(data_.end(), bytes, bytes + size);
+}
+
+CheckpointReader::CheckpointReader(const std::vector<uint8_t>& data)
+  : data_(data), offset_(0)
+{
+  checkHeader();
+}
+
+CheckpointReader::CheckpointReader(const std::string& file)
+  : offset_(0)
+{
+  std::ifstream in(file.c_str(), std::ios::binary);
+  if (!in)
+  {
+    throw std::runtime_error("cannot open checkpoint " + file);
+  }
+  data_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  checkHeader();
+}
+
+void CheckpointReader::checkHeader()
+{
+  char magic[sizeof(CHECKPOINT_MAGIC)];
+  uint32_t version;
+  take(magic, sizeof(magic));
+  if (std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0)
+  {
+    throw std::runtime_error("not an eagleye checkpoint");
+  }
+  take(&version, sizeof(version));
+  if (version != CHECKPOINT_VERSION)
+  {
+    throw std::runtime_error("checkpoint version " + std::to_string(version) + " is not supported");
+  }
+}
+
+void CheckpointReader::section(const std::string& name)
+{
+  std::string found;
+  field(found);
+  if (found != name)
+  {
+    throw std::runtime_error("checkpoint holds " + found + " where " + name + " was expected");
+  }
+}
+
+void CheckpointReader::field(bool& value)
+{
+  uint8_t byte;
+  take(&byte, 1);
+  value = byte != 0;
+}
+
+void CheckpointReader::field(int& value)
+{
+  take(&value, sizeof(value));
+}
+
+void CheckpointReader::field(int64_t& value)
+{
+  take(&value, sizeof(value));
+}
+
+void CheckpointReader::field(uint64_t& value)
+{
+  take(&value, sizeof(value));
+}
+
+void CheckpointReader::field(double& value)
+{
+  take(&value, sizeof(value));
+}
+
+void CheckpointReader::field(std::vector<bool>& value)
+{
+  uint64_t size;
+  field(size);
+  if (size > data_.size() - offset_)
+  {
+    throw std::runtime_error("checkpoint is truncated");
+  }
+  value.resize(size);
+  for (std::size_t i = 0; i < size; i++)
+  {
+    bool element;
+    field(element);
+    value[i] = element;
+  }
+}
+
+void CheckpointReader::field(std::vector<int>& value)
+{
+  takeVector(value);
+}
+
+void CheckpointReader::field(std::vector<int64_t>& value)
+{
+  takeVector(value);
+}
+
+void CheckpointReader::field(std::vector<double>& value)
+{
+  takeVector(value);
+}
+
+void CheckpointReader::field(std::string& value)
+{
+  uint64_t size;
+  field(size);
+  if (size > data_.size() - offset_)
+  {
+    throw std::runtime_error("checkpoint is truncated");
+  }
+  value.assign(reinterpret_cast<const char*>(&data_[offset_]), size);
+  offset_ += size;
+}
+
+// Keeps the capacity the estimator reserved when the window fits in it.
+template <class T>
+void CheckpointReader::takeVector(std::vector<T>& value)
+{
+  uint64_t size;
+  field(size);
+  if (size > (data_.size() - offset_) / sizeof(T))
+  {
+    throw std::runtime_error("checkpoint is truncated");
+  }
+  value.resize(size);
+  take(value.data(), size * sizeof(T));
+}
+
+void CheckpointReader::take(void* data, std::size_t size)
+{
+  if (size > data_.size() - offset_)
+  {
+    throw std::runtime_error("checkpoint is truncated");
+  }
+  if (size == 0)
+  {
+    return;
+  }
+  std::memcpy(data, &data_[offset_], size);
+  offset_ += size;
+}
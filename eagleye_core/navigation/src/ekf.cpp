@@ -0,0 +1,552 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * ekf.cpp
+ * Author MapIV Sekino
+ */
+
+// Extended Kalman filter over the quantities the windowed estimators fit:
+//
+//   e, n, u             position of base_link in the ENU frame of the ecef base position
+//   heading             clockwise from north, continuous like heading_interpolate
+//   yawrate_offset      added to the yaw rate, like eagleye_msgs/YawrateOffset
+//   velocity_scale_factor  correction_velocity = scale factor * wheel speed
+//   pitch               positive uphill
+//   acc_x_offset        of the raw acceleration; published with the opposite sign
+//
+// Every imu sample predicts the state from the yaw rate and the wheel speed,
+// and uses the acceleration along x as a measurement of pitch and
+// acc_x_offset. While stopped the yaw rate is a measurement of
+// yawrate_offset. The doppler velocity of rtklib_nav corrects heading,
+// velocity_scale_factor and pitch, its position corrects e and n, and the
+// altitude of navsat/fix corrects u. The cost of a sample is a fixed number of
+// 8x8 matrix products, whatever the distance the estimate is based on.
+
+#include "coordinate/coordinate.hpp"
+#include "navigation/navigation.hpp"
+#include <algorithm>
+#include <cmath>
+
+static const int N = EKF_STATE_NUM;
+static const double gravity = 9.80665;
+
+// Standard deviations of the states before the first measurement.
+static const double initial_yawrate_offset_std = 0.01;
+static const double initial_velocity_scale_factor_std = 0.1;
+static const double initial_pitch_std = 0.1;
+static const double initial_acc_x_offset_std = 0.5;
+
+// After this many rejected rtklib_nav positions in a row the filter is taken
+// to be off, not the GNSS, and the position restarts from the measurement.
+static const int position_outlier_reset_count = 25;
+
+static double& covariance(EkfStatus* ekf_status, int i, int j)
+{
+  return ekf_status->covariance[i * N + j];
+}
+
+static void resetState(int index, double value, double variance, EkfStatus* ekf_status)
+{
+  ekf_status->state[index] = value;
+  for (int i = 0; i < N; i++)
+  {
+    covariance(ekf_status, i, index) = 0;
+    covariance(ekf_status, index, i) = 0;
+  }
+  covariance(ekf_status, index, index) = variance;
+  ekf_status->reset_count++;
+}
+
+static bool invert(int m, const double* a, double* a_inv)
+{
+  double work[3][6];
+  for (int i = 0; i < m; i++)
+  {
+    for (int j = 0; j < m; j++)
+    {
+      work[i][j] = a[i * 3 + j];
+      work[i][m + j] = i == j ? 1 : 0;
+    }
+  }
+  for (int i = 0; i < m; i++)
+  {
+    int pivot = i;
+    for (int k = i + 1; k < m; k++)
+    {
+      if (std::abs(work[k][i]) > std::abs(work[pivot][i]))
+      {
+        pivot = k;
+      }
+    }
+    if (work[pivot][i] == 0)
+    {
+      return false;
+    }
+    for (int j = 0; j < 2 * m; j++)
+    {
+      std::swap(work[i][j], work[pivot][j]);
+    }
+    double d = work[i][i];
+    for (int j = 0; j < 2 * m; j++)
+    {
+      work[i][j] /= d;
+    }
+    for (int k = 0; k < m; k++)
+    {
+      if (k != i)
+      {
+        double f = work[k][i];
+        for (int j = 0; j < 2 * m; j++)
+        {
+          work[k][j] -= f * work[i][j];
+        }
+      }
+    }
+  }
+  for (int i = 0; i < m; i++)
+  {
+    for (int j = 0; j < m; j++)
+    {
+      a_inv[i * 3 + j] = work[i][m + j];
+    }
+  }
+  return true;
+}
+
+// Update with m (at most 3) measurements of independent noise: y is the
+// innovation, h the m x N Jacobian and r the measurement variances. The
+// update is rejected when the squared Mahalanobis distance of y exceeds
+// outlier_threshold.
+static bool update(int m, const double* y, const double* h, const double* r, double outlier_threshold, EkfStatus* ekf_status)
+{
+  double ph[N][3];
+  double s[9], s_inv[9];
+  double k[N][3];
+
+  for (int i = 0; i < N; i++)
+  {
+    for (int a = 0; a < m; a++)
+    {
+      ph[i][a] = 0;
+      for (int j = 0; j < N; j++)
+      {
+        ph[i][a] += covariance(ekf_status, i, j) * h[a * N + j];
+      }
+    }
+  }
+  for (int a = 0; a < m; a++)
+  {
+    for (int b = 0; b < m; b++)
+    {
+      s[a * 3 + b] = a == b ? r[a] : 0;
+      for (int i = 0; i < N; i++)
+      {
+        s[a * 3 + b] += h[a * N + i] * ph[i][b];
+      }
+    }
+  }
+  if (!invert(m, s, s_inv))
+  {
+    return false;
+  }
+
+  double distance = 0;
+  for (int a = 0; a < m; a++)
+  {
+    for (int b = 0; b < m; b++)
+    {
+      distance += y[a] * s_inv[a * 3 + b] * y[b];
+    }
+  }
+  if (!std::isfinite(distance) || distance > outlier_threshold)
+  {
+    return false;
+  }
+
+  for (int i = 0; i < N; i++)
+  {
+    for (int a = 0; a < m; a++)
+    {
+      k[i][a] = 0;
+      for (int b = 0; b < m; b++)
+      {
+        k[i][a] += ph[i][b] * s_inv[b * 3 + a];
+      }
+      ekf_status->state[i] += k[i][a] * y[a];
+    }
+  }
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = i; j < N; j++)
+    {
+      double kph = 0;
+      for (int a = 0; a < m; a++)
+      {
+        kph += k[i][a] * ph[j][a];
+      }
+      double value = covariance(ekf_status, i, j) - kph;
+      covariance(ekf_status, i, j) = value;
+      covariance(ekf_status, j, i) = value;
+    }
+  }
+  return true;
+}
+
+void ekf_init(EkfStatus* ekf_status)
+{
+  *ekf_status = EkfStatus();
+  resetState(EKF_E, 0, 0, ekf_status);
+  resetState(EKF_N, 0, 0, ekf_status);
+  resetState(EKF_U, 0, 0, ekf_status);
+  resetState(EKF_HEADING, 0, M_PI * M_PI, ekf_status);
+  resetState(EKF_YAWRATE_OFFSET, 0, initial_yawrate_offset_std * initial_yawrate_offset_std, ekf_status);
+  resetState(EKF_VELOCITY_SCALE_FACTOR, 1, initial_velocity_scale_factor_std * initial_velocity_scale_factor_std, ekf_status);
+  resetState(EKF_PITCH, 0, initial_pitch_std * initial_pitch_std, ekf_status);
+  resetState(EKF_ACC_X_OFFSET, 0, initial_acc_x_offset_std * initial_acc_x_offset_std, ekf_status);
+  ekf_status->reset_count = 0;
+}
+
+void ekf_jacobian(const EkfTransition& ekf_transition, double f[EKF_STATE_NUM][EKF_STATE_NUM])
+{
+  static const int position_column[3] = { EKF_HEADING, EKF_VELOCITY_SCALE_FACTOR, EKF_PITCH };
+
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = 0; j < N; j++)
+    {
+      f[i][j] = i == j ? 1 : 0;
+    }
+  }
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      f[EKF_E + i][position_column[j]] = ekf_transition.position_jacobian[i][j];
+    }
+  }
+  f[EKF_HEADING][EKF_YAWRATE_OFFSET] = ekf_transition.heading_jacobian;
+}
+
+void ekf_predict(const sensor_msgs::Imu imu, const geometry_msgs::TwistStamped velocity, const eagleye_msgs::SlipAngle slip_angle,
+  const EkfParameter ekf_parameter, EkfStatus* ekf_status, EkfTransition* ekf_transition)
+{
+  int64_t imu_stamp = stampToNSec(imu.header.stamp);
+  double* x = ekf_status->state;
+  double yawrate = ekf_parameter.reverse_imu == false ? imu.angular_velocity.z : -1 * imu.angular_velocity.z;
+  double wheel_velocity = velocity.twist.linear.x;
+  bool stop = std::abs(wheel_velocity) <= ekf_parameter.stop_judgment_velocity_threshold;
+
+  *ekf_transition = EkfTransition();
+  std::copy(x, x + N, ekf_transition->state);
+
+  if (ekf_status->time_last == 0 || imu_stamp <= ekf_status->time_last)
+  {
+    ekf_status->time_last = imu_stamp;
+    ekf_status->velocity_last = wheel_velocity;
+    return;
+  }
+  double dt = nsecToSec(imu_stamp - ekf_status->time_last);
+
+  double v = x[EKF_VELOCITY_SCALE_FACTOR] * wheel_velocity;
+  double course = x[EKF_HEADING] + slip_angle.slip_angle;
+  double sin_course = std::sin(course), cos_course = std::cos(course);
+  double sin_pitch = std::sin(x[EKF_PITCH]), cos_pitch = std::cos(x[EKF_PITCH]);
+
+  // F = I + df/dx dt
+  double (*g)[3] = ekf_transition->position_jacobian;
+  g[0][0] = v * cos_pitch * cos_course * dt;
+  g[0][1] = wheel_velocity * cos_pitch * sin_course * dt;
+  g[0][2] = -v * sin_pitch * sin_course * dt;
+  g[1][0] = -v * cos_pitch * sin_course * dt;
+  g[1][1] = wheel_velocity * cos_pitch * cos_course * dt;
+  g[1][2] = -v * sin_pitch * cos_course * dt;
+  g[2][0] = 0;
+  g[2][1] = wheel_velocity * sin_pitch * dt;
+  g[2][2] = v * cos_pitch * dt;
+
+  x[EKF_E] += v * cos_pitch * sin_course * dt;
+  x[EKF_N] += v * cos_pitch * cos_course * dt;
+  x[EKF_U] += v * sin_pitch * dt;
+  // Like heading_interpolate, the heading is held while stopped.
+  if (!stop)
+  {
+    ekf_transition->heading_jacobian = dt;
+    x[EKF_HEADING] += (yawrate + x[EKF_YAWRATE_OFFSET]) * dt;
+  }
+  std::copy(x, x + N, ekf_transition->state);
+
+  double f[N][N];
+  ekf_jacobian(*ekf_transition, f);
+
+  double fp[N][N];
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = 0; j < N; j++)
+    {
+      fp[i][j] = 0;
+      for (int k = 0; k < N; k++)
+      {
+        fp[i][j] += f[i][k] * covariance(ekf_status, k, j);
+      }
+    }
+  }
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = i; j < N; j++)
+    {
+      double value = 0;
+      for (int k = 0; k < N; k++)
+      {
+        value += fp[i][k] * f[j][k];
+      }
+      covariance(ekf_status, i, j) = value;
+      covariance(ekf_status, j, i) = value;
+    }
+  }
+
+  double* q = ekf_transition->process_noise;
+  double position_variance = ekf_parameter.position_noise * ekf_parameter.position_noise * (stop ? 0 : dt);
+  q[EKF_E] = position_variance;
+  q[EKF_N] = position_variance;
+  q[EKF_U] = position_variance;
+  q[EKF_HEADING] = stop ? 0 : ekf_parameter.yawrate_noise * ekf_parameter.yawrate_noise * dt;
+  q[EKF_YAWRATE_OFFSET] = ekf_parameter.yawrate_offset_noise * ekf_parameter.yawrate_offset_noise * dt;
+  q[EKF_VELOCITY_SCALE_FACTOR] = ekf_parameter.velocity_scale_factor_noise * ekf_parameter.velocity_scale_factor_noise * dt;
+  q[EKF_PITCH] = ekf_parameter.pitch_noise * ekf_parameter.pitch_noise * std::abs(v) * dt;
+  q[EKF_ACC_X_OFFSET] = ekf_parameter.acc_x_offset_noise * ekf_parameter.acc_x_offset_noise * dt;
+  for (int i = 0; i < N; i++)
+  {
+    covariance(ekf_status, i, i) += q[i];
+  }
+
+  double h[N];
+  double y, r;
+
+  // acc x = d(correction velocity)/dt + g sin(pitch) + acc_x_offset. The
+  // differenced wheel speed is far noisier than the scale factor is uncertain,
+  // so the scale factor is left to the doppler velocity; acc_noise covers the
+  // noise of both sides.
+  double wheel_acceleration = (wheel_velocity - ekf_status->velocity_last) / dt;
+  for (int i = 0; i < N; i++)
+  {
+    h[i] = 0;
+  }
+  h[EKF_PITCH] = gravity * cos_pitch;
+  h[EKF_ACC_X_OFFSET] = 1;
+  y = imu.linear_acceleration.x - (x[EKF_VELOCITY_SCALE_FACTOR] * wheel_acceleration + gravity * sin_pitch + x[EKF_ACC_X_OFFSET]);
+  r = ekf_parameter.acc_noise * ekf_parameter.acc_noise;
+  update(1, &y, h, &r, ekf_parameter.outlier_threshold, ekf_status);
+
+  // While stopped the corrected yaw rate is zero.
+  if (stop)
+  {
+    h[EKF_PITCH] = 0;
+    h[EKF_ACC_X_OFFSET] = 0;
+    h[EKF_YAWRATE_OFFSET] = 1;
+    y = -(yawrate + x[EKF_YAWRATE_OFFSET]);
+    r = ekf_parameter.yawrate_noise * ekf_parameter.yawrate_noise / dt;
+    update(1, &y, h, &r, ekf_parameter.outlier_threshold, ekf_status);
+  }
+
+  ekf_status->time_last = imu_stamp;
+  ekf_status->velocity_last = wheel_velocity;
+}
+
+void ekf_rtklib_nav_update(const rtklib_msgs::RtklibNav rtklib_nav, const eagleye_msgs::SlipAngle slip_angle, const EkfParameter ekf_parameter,
+  EkfStatus* ekf_status, bool* velocity_update, bool* position_update)
+{
+  double ecef_pos[3], ecef_vel[3], ecef_base_pos[3];
+  double enu_pos[3], enu_vel[3];
+  double* x = ekf_status->state;
+
+  *velocity_update = false;
+  *position_update = false;
+
+  if (ekf_status->tow_last == static_cast<int>(rtklib_nav.tow) || rtklib_nav.tow == 0)
+  {
+    ekf_status->tow_last = rtklib_nav.tow;
+    return;
+  }
+  ekf_status->tow_last = rtklib_nav.tow;
+
+  ecef_pos[0] = rtklib_nav.ecef_pos.x;
+  ecef_pos[1] = rtklib_nav.ecef_pos.y;
+  ecef_pos[2] = rtklib_nav.ecef_pos.z;
+  ecef_vel[0] = rtklib_nav.ecef_vel.x;
+  ecef_vel[1] = rtklib_nav.ecef_vel.y;
+  ecef_vel[2] = rtklib_nav.ecef_vel.z;
+
+  if (ekf_status->ecef_base_pos[0] == 0 && ekf_status->ecef_base_pos[1] == 0 && ekf_status->ecef_base_pos[2] == 0)
+  {
+    if (ekf_parameter.ecef_base_pos_x != 0 && ekf_parameter.ecef_base_pos_y != 0 && ekf_parameter.ecef_base_pos_z != 0)
+    {
+      ekf_status->ecef_base_pos[0] = ekf_parameter.ecef_base_pos_x;
+      ekf_status->ecef_base_pos[1] = ekf_parameter.ecef_base_pos_y;
+      ekf_status->ecef_base_pos[2] = ekf_parameter.ecef_base_pos_z;
+    }
+    else
+    {
+      ekf_status->ecef_base_pos[0] = ecef_pos[0];
+      ekf_status->ecef_base_pos[1] = ecef_pos[1];
+      ekf_status->ecef_base_pos[2] = ecef_pos[2];
+    }
+  }
+  ecef_base_pos[0] = ekf_status->ecef_base_pos[0];
+  ecef_base_pos[1] = ekf_status->ecef_base_pos[1];
+  ecef_base_pos[2] = ekf_status->ecef_base_pos[2];
+
+  xyz2enu_vel(ecef_vel, ecef_pos, enu_vel);
+  xyz2enu(ecef_pos, ecef_base_pos, enu_pos);
+
+  double wheel_velocity = ekf_status->velocity_last;
+  bool stop = std::abs(wheel_velocity) <= ekf_parameter.stop_judgment_velocity_threshold;
+  double gnss_velocity = std::sqrt(enu_vel[0] * enu_vel[0] + enu_vel[1] * enu_vel[1]);
+  double h[3 * N];
+  double y[3], r[3];
+
+  if (std::isfinite(gnss_velocity) && !stop && gnss_velocity > ekf_parameter.estimated_velocity_threshold)
+  {
+    if (!ekf_status->heading_status)
+    {
+      double heading_std = ekf_parameter.gnss_velocity_noise / gnss_velocity;
+      resetState(EKF_HEADING, std::atan2(enu_vel[0], enu_vel[1]) - slip_angle.slip_angle, heading_std * heading_std, ekf_status);
+      ekf_status->heading_status = true;
+      *velocity_update = true;
+    }
+    else
+    {
+      double s = x[EKF_VELOCITY_SCALE_FACTOR];
+      double v = s * wheel_velocity;
+      double course = x[EKF_HEADING] + slip_angle.slip_angle;
+      double sin_course = std::sin(course), cos_course = std::cos(course);
+      double sin_pitch = std::sin(x[EKF_PITCH]), cos_pitch = std::cos(x[EKF_PITCH]);
+
+      for (int i = 0; i < 3 * N; i++)
+      {
+        h[i] = 0;
+      }
+      h[0 * N + EKF_HEADING] = v * cos_pitch * cos_course;
+      h[0 * N + EKF_VELOCITY_SCALE_FACTOR] = wheel_velocity * cos_pitch * sin_course;
+      h[0 * N + EKF_PITCH] = -v * sin_pitch * sin_course;
+      h[1 * N + EKF_HEADING] = -v * cos_pitch * sin_course;
+      h[1 * N + EKF_VELOCITY_SCALE_FACTOR] = wheel_velocity * cos_pitch * cos_course;
+      h[1 * N + EKF_PITCH] = -v * sin_pitch * cos_course;
+      h[2 * N + EKF_VELOCITY_SCALE_FACTOR] = wheel_velocity * sin_pitch;
+      h[2 * N + EKF_PITCH] = v * cos_pitch;
+      y[0] = enu_vel[0] - v * cos_pitch * sin_course;
+      y[1] = enu_vel[1] - v * cos_pitch * cos_course;
+      y[2] = enu_vel[2] - v * sin_pitch;
+      r[0] = r[1] = r[2] = ekf_parameter.gnss_velocity_noise * ekf_parameter.gnss_velocity_noise;
+      *velocity_update = update(3, y, h, r, ekf_parameter.outlier_threshold, ekf_status);
+    }
+  }
+
+  if (!std::isfinite(enu_pos[0]) || !std::isfinite(enu_pos[1]) || !ekf_status->heading_status)
+  {
+    return;
+  }
+
+  // The antenna is at tf_gnss_translation in base_link, see position_estimate().
+  double sin_heading = std::sin(x[EKF_HEADING]), cos_heading = std::cos(x[EKF_HEADING]);
+  double lever_e = sin_heading * ekf_parameter.tf_gnss_translation_x - cos_heading * ekf_parameter.tf_gnss_translation_y;
+  double lever_n = cos_heading * ekf_parameter.tf_gnss_translation_x + sin_heading * ekf_parameter.tf_gnss_translation_y;
+  double position_variance = ekf_parameter.gnss_position_noise * ekf_parameter.gnss_position_noise;
+
+  if (ekf_status->position_status)
+  {
+    for (int i = 0; i < 2 * N; i++)
+    {
+      h[i] = 0;
+    }
+    h[0 * N + EKF_E] = 1;
+    h[0 * N + EKF_HEADING] = cos_heading * ekf_parameter.tf_gnss_translation_x + sin_heading * ekf_parameter.tf_gnss_translation_y;
+    h[1 * N + EKF_N] = 1;
+    h[1 * N + EKF_HEADING] = -sin_heading * ekf_parameter.tf_gnss_translation_x + cos_heading * ekf_parameter.tf_gnss_translation_y;
+    y[0] = enu_pos[0] - (x[EKF_E] + lever_e);
+    y[1] = enu_pos[1] - (x[EKF_N] + lever_n);
+    r[0] = r[1] = position_variance;
+    if (update(2, y, h, r, ekf_parameter.outlier_threshold, ekf_status))
+    {
+      ekf_status->position_outlier_count = 0;
+      *position_update = true;
+      return;
+    }
+    if (++ekf_status->position_outlier_count < position_outlier_reset_count)
+    {
+      return;
+    }
+  }
+
+  resetState(EKF_E, enu_pos[0] - lever_e, position_variance, ekf_status);
+  resetState(EKF_N, enu_pos[1] - lever_n, position_variance, ekf_status);
+  ekf_status->position_status = true;
+  ekf_status->position_outlier_count = 0;
+  *position_update = true;
+}
+
+bool ekf_fix_update(const sensor_msgs::NavSatFix fix, const EkfParameter ekf_parameter, EkfStatus* ekf_status)
+{
+  double llh_pos[3], ecef_pos[3], enu_pos[3];
+  int64_t fix_stamp = stampToNSec(fix.header.stamp);
+
+  if (ekf_status->fix_time_last == fix_stamp)
+  {
+    return false;
+  }
+  ekf_status->fix_time_last = fix_stamp;
+
+  if (fix.status.status == -1 || (ekf_status->ecef_base_pos[0] == 0 && ekf_status->ecef_base_pos[1] == 0 && ekf_status->ecef_base_pos[2] == 0))
+  {
+    return false;
+  }
+
+  llh_pos[0] = fix.latitude * M_PI / 180;
+  llh_pos[1] = fix.longitude * M_PI / 180;
+  llh_pos[2] = fix.altitude;
+  llh2xyz(llh_pos, ecef_pos);
+  xyz2enu(ecef_pos, ekf_status->ecef_base_pos, enu_pos);
+  if (!std::isfinite(enu_pos[2]))
+  {
+    return false;
+  }
+
+  double height_variance = ekf_parameter.gnss_height_noise * ekf_parameter.gnss_height_noise;
+  if (!ekf_status->height_status)
+  {
+    resetState(EKF_U, enu_pos[2] - ekf_parameter.tf_gnss_translation_z, height_variance, ekf_status);
+    ekf_status->height_status = true;
+    return true;
+  }
+
+  double h[N];
+  for (int i = 0; i < N; i++)
+  {
+    h[i] = 0;
+  }
+  h[EKF_U] = 1;
+  double y = enu_pos[2] - (ekf_status->state[EKF_U] + ekf_parameter.tf_gnss_translation_z);
+  return update(1, &y, h, &height_variance, ekf_parameter.outlier_threshold, ekf_status);
+}
@@ -0,0 +1,351 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*
+ * ekf_smoother.cpp
+ * Author MapIV Sekino
+ */
+
+#include "navigation/ekf_smoother.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+static const int N = EKF_STATE_NUM;
+
+// Pivots of the predicted covariance below this fraction of its largest
+// diagonal element are taken as zero, e.g. the position before the first
+// rtklib_nav position or the heading while stopped.
+static const double pivot_threshold = 1e-12;
+
+enum
+{
+  RECORD_HEADING_STATUS = 1,
+  RECORD_POSITION_STATUS = 2,
+  RECORD_HEIGHT_STATUS = 4,
+  RECORD_RESET = 8
+};
+
+// One imu sample of the forward run: the filtered state after it and the
+// prediction step that led to it.
+struct EkfSmootherRecord
+{
+  int64_t stamp;
+  int32_t flags;
+  int32_t reserved;
+  double state[EKF_STATE_NUM];
+  // Upper triangle, row by row.
+  double covariance[EKF_STATE_NUM * (EKF_STATE_NUM + 1) / 2];
+  double ecef_base_pos[3];
+  double slip_angle;
+  EkfTransition transition;
+};
+
+static void unpackCovariance(const double* packed, double p[N][N])
+{
+  int index = 0;
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = i; j < N; j++)
+    {
+      p[i][j] = packed[index];
+      p[j][i] = packed[index];
+      index++;
+    }
+  }
+}
+
+// Solves a x = b for the N columns of b, a symmetric positive semi-definite,
+// through a = L D L^T. Components along a zero pivot are set to zero.
+static void solve(const double a[N][N], const double b[N][N], double x[N][N])
+{
+  double l[N][N];
+  double d[N];
+  double diagonal_max = 0;
+  for (int i = 0; i < N; i++)
+  {
+    diagonal_max = std::max(diagonal_max, a[i][i]);
+  }
+  double threshold = pivot_threshold * diagonal_max;
+
+  for (int j = 0; j < N; j++)
+  {
+    d[j] = a[j][j];
+    for (int k = 0; k < j; k++)
+    {
+      d[j] -= l[j][k] * l[j][k] * d[k];
+    }
+    for (int i = j + 1; i < N; i++)
+    {
+      double value = a[i][j];
+      for (int k = 0; k < j; k++)
+      {
+        value -= l[i][k] * l[j][k] * d[k];
+      }
+      l[i][j] = d[j] > threshold ? value / d[j] : 0;
+    }
+  }
+
+  for (int c = 0; c < N; c++)
+  {
+    double y[N];
+    for (int i = 0; i < N; i++)
+    {
+      y[i] = b[i][c];
+      for (int k = 0; k < i; k++)
+      {
+        y[i] -= l[i][k] * y[k];
+      }
+    }
+    for (int i = 0; i < N; i++)
+    {
+      y[i] = d[i] > threshold ? y[i] / d[i] : 0;
+    }
+    for (int i = N - 1; i >= 0; i--)
+    {
+      for (int k = i + 1; k < N; k++)
+      {
+        y[i] -= l[k][i] * y[k];
+      }
+      x[i][c] = y[i];
+    }
+  }
+}
+
+// Backward step from the smoothed state of the next sample to that of
+// record, with the prediction step stored in next_record:
+//
+//   P-  = F P F^T + Q
+//   C   = P F^T (P-)^-1
+//   x_s = x + C (x_s,next - x-)
+//   P_s = P + C (P_s,next - P-) C^T
+static void smoothStep(const EkfSmootherRecord& record, const EkfSmootherRecord& next_record, const double* next_state,
+                       const double next_covariance[N][N], double* state, double covariance[N][N])
+{
+  double f[N][N], p[N][N], fp[N][N], predicted[N][N], gain_t[N][N];
+
+  ekf_jacobian(next_record.transition, f);
+  unpackCovariance(record.covariance, p);
+
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = 0; j < N; j++)
+    {
+      fp[i][j] = 0;
+      for (int k = 0; k < N; k++)
+      {
+        fp[i][j] += f[i][k] * p[k][j];
+      }
+    }
+  }
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = 0; j < N; j++)
+    {
+      predicted[i][j] = i == j ? next_record.transition.process_noise[i] : 0;
+      for (int k = 0; k < N; k++)
+      {
+        predicted[i][j] += fp[i][k] * f[j][k];
+      }
+    }
+  }
+
+  // C^T = (P-)^-1 F P
+  solve(predicted, fp, gain_t);
+
+  for (int i = 0; i < N; i++)
+  {
+    state[i] = record.state[i];
+    for (int k = 0; k < N; k++)
+    {
+      state[i] += gain_t[k][i] * (next_state[k] - next_record.transition.state[k]);
+    }
+  }
+
+  double difference[N][N], cd[N][N];
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = 0; j < N; j++)
+    {
+      difference[i][j] = next_covariance[i][j] - predicted[i][j];
+    }
+  }
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = 0; j < N; j++)
+    {
+      cd[i][j] = 0;
+      for (int k = 0; k < N; k++)
+      {
+        cd[i][j] += gain_t[k][i] * difference[k][j];
+      }
+    }
+  }
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = i; j < N; j++)
+    {
+      double value = p[i][j];
+      for (int k = 0; k < N; k++)
+      {
+        value += cd[i][k] * gain_t[k][j];
+      }
+      covariance[i][j] = value;
+      covariance[j][i] = value;
+    }
+  }
+}
+
+EkfSmoother::EkfSmoother(std::size_t segment_size)
+  : segment_size_(std::max<std::size_t>(segment_size, 1)), count_(0), read_count_(0), forward_file_(std::tmpfile()),
+    smoothed_file_(std::tmpfile()), reset_count_last_(0)
+{
+  if (!forward_file_ || !smoothed_file_)
+  {
+    if (forward_file_)
+    {
+      std::fclose(forward_file_);
+    }
+    if (smoothed_file_)
+    {
+      std::fclose(smoothed_file_);
+    }
+    throw std::runtime_error("ekf smoother: cannot create a temporary file");
+  }
+}
+
+EkfSmoother::~EkfSmoother()
+{
+  std::fclose(forward_file_);
+  std::fclose(smoothed_file_);
+}
+
+void EkfSmoother::add(int64_t stamp, const EkfStatus& ekf_status, const EkfTransition& ekf_transition, double slip_angle)
+{
+  EkfSmootherRecord record = EkfSmootherRecord();
+  record.stamp = stamp;
+  record.flags = (ekf_status.heading_status ? RECORD_HEADING_STATUS : 0) | (ekf_status.position_status ? RECORD_POSITION_STATUS : 0) |
+                 (ekf_status.height_status ? RECORD_HEIGHT_STATUS : 0) |
+                 (ekf_status.reset_count != reset_count_last_ ? RECORD_RESET : 0);
+  reset_count_last_ = ekf_status.reset_count;
+
+  std::copy(ekf_status.state, ekf_status.state + N, record.state);
+  int index = 0;
+  for (int i = 0; i < N; i++)
+  {
+    for (int j = i; j < N; j++)
+    {
+      record.covariance[index++] = ekf_status.covariance[i * N + j];
+    }
+  }
+  std::copy(ekf_status.ecef_base_pos, ekf_status.ecef_base_pos + 3, record.ecef_base_pos);
+  record.slip_angle = slip_angle;
+  record.transition = ekf_transition;
+
+  if (std::fwrite(&record, sizeof(record), 1, forward_file_) != 1)
+  {
+    throw std::runtime_error("ekf smoother: cannot write the temporary file");
+  }
+  count_++;
+}
+
+void EkfSmoother::smooth()
+{
+  std::vector<EkfSmootherRecord> records;
+  std::vector<EkfSmoothedState> smoothed;
+  EkfSmootherRecord next_record = EkfSmootherRecord();
+  double next_state[N];
+  double next_covariance[N][N];
+  bool next_status = false;
+
+  std::size_t end = count_;
+  while (end > 0)
+  {
+    std::size_t begin = end > segment_size_ ? end - segment_size_ : 0;
+    records.resize(end - begin);
+    smoothed.resize(end - begin);
+    if (std::fseek(forward_file_, static_cast<long>(begin * sizeof(EkfSmootherRecord)), SEEK_SET) != 0 ||
+        std::fread(&records[0], sizeof(EkfSmootherRecord), records.size(), forward_file_) != records.size())
+    {
+      throw std::runtime_error("ekf smoother: cannot read the temporary file");
+    }
+
+    for (std::size_t n = records.size(); n-- > 0;)
+    {
+      const EkfSmootherRecord& record = records[n];
+      double state[N];
+      double covariance[N][N];
+      if (next_status && !(next_record.flags & RECORD_RESET))
+      {
+        smoothStep(record, next_record, next_state, next_covariance, state, covariance);
+      }
+      else
+      {
+        std::copy(record.state, record.state + N, state);
+        unpackCovariance(record.covariance, covariance);
+      }
+
+      EkfSmoothedState& s = smoothed[n];
+      s.stamp = record.stamp;
+      s.heading_status = record.flags & RECORD_HEADING_STATUS;
+      s.position_status = record.flags & RECORD_POSITION_STATUS;
+      s.height_status = record.flags & RECORD_HEIGHT_STATUS;
+      for (int i = 0; i < N; i++)
+      {
+        s.state[i] = state[i];
+        s.variance[i] = covariance[i][i];
+      }
+      std::copy(record.ecef_base_pos, record.ecef_base_pos + 3, s.ecef_base_pos);
+      s.slip_angle = record.slip_angle;
+
+      next_record = record;
+      std::copy(state, state + N, next_state);
+      std::copy(&covariance[0][0], &covariance[0][0] + N * N, &next_covariance[0][0]);
+      next_status = true;
+    }
+
+    if (std::fseek(smoothed_file_, static_cast<long>(begin * sizeof(EkfSmoothedState)), SEEK_SET) != 0 ||
+        std::fwrite(&smoothed[0], sizeof(EkfSmoothedState), smoothed.size(), smoothed_file_) != smoothed.size())
+    {
+      throw std::runtime_error("ekf smoother: cannot write the temporary file");
+    }
+    end = begin;
+  }
+
+  read_count_ = 0;
+  std::rewind(smoothed_file_);
+}
+
+bool EkfSmoother::next(EkfSmoothedState* smoothed_state)
+{
+  if (read_count_ >= count_)
+  {
+    return false;
+  }
+  if (std::fread(smoothed_state, sizeof(EkfSmoothedState), 1, smoothed_file_) != 1)
+  {
+    throw std::runtime_error("ekf smoother: cannot read the temporary file");
+  }
+  read_count_++;
+  return true;
+}
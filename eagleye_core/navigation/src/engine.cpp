@@ -0,0 +1,607 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * engine.cpp
+ * Author MapIV Sekino
+ */
+
+#include "navigation/engine.hpp"
+
+EagleyeEngine::EagleyeEngine(const EagleyeEngineParameter& parameter)
+  : parameter_(parameter), output_(), trajectory_timer_last_(0)
+{
+  velocity_scale_factor_.setParameter(parameter_.velocity_scale_factor);
+  yawrate_offset_stop_.setParameter(parameter_.yawrate_offset_stop);
+  angular_velocity_offset_stop_.setParameter(parameter_.angular_velocity_offset_stop);
+  yawrate_offset_[0].setParameter(parameter_.yawrate_offset_1st);
+  yawrate_offset_[1].setParameter(parameter_.yawrate_offset_2nd);
+  yawrate_offset_[0].setImuHistory(&imu_history_);
+  yawrate_offset_[1].setImuHistory(&imu_history_);
+  for (int i = 0; i < 3; i++)
+  {
+    heading_[i].setParameter(parameter_.heading);
+    heading_[i].setImuHistory(&imu_history_);
+    rtk_heading_[i].setParameter(parameter_.rtk_heading);
+    rtk_heading_[i].setImuHistory(&imu_history_);
+    heading_interpolate_[i].setParameter(parameter_.heading_interpolate);
+  }
+  slip_angle_.setParameter(parameter_.slip_angle);
+  height_.setParameter(parameter_.height);
+  trajectory_.setParameter(parameter_.trajectory);
+  position_.setParameter(parameter_.position);
+  position_interpolate_.setParameter(parameter_.position_interpolate);
+  smoothing_.setParameter(parameter_.smoothing);
+  rtk_deadreckoning_.setParameter(parameter_.rtk_deadreckoning);
+  correction_imu_.setReverseImu(parameter_.reverse_imu);
+
+  // The ekf shares the base position, the antenna offset and the imu
+  // direction with the windowed estimators.
+  EkfParameter ekf_parameter = parameter_.ekf;
+  ekf_parameter.reverse_imu = parameter_.reverse_imu;
+  ekf_parameter.ecef_base_pos_x = parameter_.position.ecef_base_pos_x;
+  ekf_parameter.ecef_base_pos_y = parameter_.position.ecef_base_pos_y;
+  ekf_parameter.ecef_base_pos_z = parameter_.position.ecef_base_pos_z;
+  ekf_parameter.tf_gnss_translation_x = parameter_.position.tf_gnss_translation_x;
+  ekf_parameter.tf_gnss_translation_y = parameter_.position.tf_gnss_translation_y;
+  ekf_parameter.tf_gnss_translation_z = parameter_.position.tf_gnss_translation_z;
+  ekf_.setParameter(ekf_parameter);
+}
+
+void EagleyeEngine::reserve()
+{
+  yawrate_offset_stop_.reserve();
+  angular_velocity_offset_stop_.reserve();
+  smoothing_.reserve();
+  if (parameter_.use_ekf)
+  {
+    return;
+  }
+
+  velocity_scale_factor_.reserve();
+  yawrate_offset_[0].reserve();
+  yawrate_offset_[1].reserve();
+  for (int i = 0; i < 3; i++)
+  {
+    if (parameter_.use_rtk_heading)
+    {
+      rtk_heading_[i].reserve();
+    }
+    else
+    {
+      heading_[i].reserve();
+    }
+    heading_interpolate_[i].reserve();
+  }
+  height_.reserve();
+  position_.reserve();
+  position_interpolate_.reserve();
+}
+
+void EagleyeEngine::warmStart(const EagleyeWarmStart& warm_start)
+{
+  if (warm_start.slip_coefficient_status && parameter_.slip_angle.manual_coefficient == 0)
+  {
+    parameter_.slip_angle.manual_coefficient = warm_start.slip_coefficient;
+    slip_angle_.setParameter(parameter_.slip_angle);
+  }
+
+  if (parameter_.use_ekf)
+  {
+    if (warm_start.velocity_scale_factor_status)
+    {
+      ekf_.warmStartVelocityScaleFactor(warm_start.velocity_scale_factor);
+    }
+    if (warm_start.yawrate_offset_2nd_status)
+    {
+      ekf_.warmStartYawrateOffset(warm_start.yawrate_offset_2nd);
+    }
+    else if (warm_start.yawrate_offset_1st_status)
+    {
+      ekf_.warmStartYawrateOffset(warm_start.yawrate_offset_1st);
+    }
+    if (warm_start.acc_x_status)
+    {
+      ekf_.warmStartAccXOffset(warm_start.acc_x_offset);
+    }
+    return;
+  }
+
+  if (warm_start.velocity_scale_factor_status)
+  {
+    velocity_scale_factor_.warmStart(warm_start.velocity_scale_factor);
+  }
+  if (warm_start.yawrate_offset_1st_status)
+  {
+    yawrate_offset_[0].warmStart(warm_start.yawrate_offset_1st);
+  }
+  if (warm_start.yawrate_offset_2nd_status)
+  {
+    yawrate_offset_[1].warmStart(warm_start.yawrate_offset_2nd);
+  }
+  if (warm_start.acc_x_status)
+  {
+    height_.warmStart(warm_start.acc_x_offset, warm_start.acc_x_scale_factor);
+  }
+}
+
+void EagleyeEngine::clearUpdated()
+{
+  output_.velocity_scale_factor_updated = false;
+  output_.distance_updated = false;
+  output_.yawrate_offset_stop_updated = false;
+  output_.yawrate_offset_1st_updated = false;
+  output_.yawrate_offset_2nd_updated = false;
+  output_.heading_1st_updated = false;
+  output_.heading_2nd_updated = false;
+  output_.heading_3rd_updated = false;
+  output_.heading_interpolate_1st_updated = false;
+  output_.heading_interpolate_2nd_updated = false;
+  output_.heading_interpolate_3rd_updated = false;
+  output_.slip_angle_updated = false;
+  output_.height_updated = false;
+  output_.pitching_updated = false;
+  output_.acc_x_offset_updated = false;
+  output_.acc_x_scale_factor_updated = false;
+  output_.reliability_fix_updated = false;
+  output_.enu_vel_updated = false;
+  output_.enu_relative_pos_updated = false;
+  output_.twist_updated = false;
+  output_.enu_absolute_pos_updated = false;
+  output_.enu_absolute_pos_interpolate_updated = false;
+  output_.fix_updated = false;
+  output_.gnss_smooth_pos_enu_updated = false;
+  output_.angular_velocity_offset_stop_updated = false;
+  output_.imu_corrected_updated = false;
+  output_.enu_absolute_rtk_deadreckoning_updated = false;
+  output_.rtk_fix_updated = false;
+}
+
+const EagleyeEngineOutput& EagleyeEngine::addTwist(const geometry_msgs::TwistStamped& velocity)
+{
+  clearUpdated();
+  velocity_scale_factor_.setTwist(velocity);
+  yawrate_offset_stop_.setTwist(velocity);
+  angular_velocity_offset_stop_.setTwist(velocity);
+  trajectory_.setTwist(velocity);
+  ekf_.setTwist(velocity);
+  return output_;
+}
+
+const EagleyeEngineOutput& EagleyeEngine::addRtklibNav(const rtklib_msgs::RtklibNav& rtklib_nav)
+{
+  clearUpdated();
+  velocity_scale_factor_.setRtklibNav(rtklib_nav);
+  for (int i = 0; i < 3; i++)
+  {
+    heading_[i].setRtklibNav(rtklib_nav);
+  }
+  position_.setRtklibNav(rtklib_nav);
+  rtk_deadreckoning_.setRtklibNav(rtklib_nav);
+  ekf_.setRtklibNav(rtklib_nav);
+
+  smoothing_.setVelocityScaleFactor(output_.velocity_scale_factor);
+  if (smoothing_.rtklibNavStep(rtklib_nav))
+  {
+    output_.gnss_smooth_pos_enu = smoothing_.getGnssSmoothPos();
+    output_.gnss_smooth_pos_enu_updated = true;
+  }
+  return output_;
+}
+
+const EagleyeEngineOutput& EagleyeEngine::addNavSatFix(const sensor_msgs::NavSatFix& fix)
+{
+  clearUpdated();
+  height_.setNavSatFix(fix);
+  position_interpolate_.setNavSatFix(fix);
+  for (int i = 0; i < 3; i++)
+  {
+    rtk_heading_[i].setNavSatFix(fix);
+  }
+  rtk_deadreckoning_.setNavSatFix(fix);
+  ekf_.setNavSatFix(fix);
+  return output_;
+}
+
+bool EagleyeEngine::headingStep(int index, const sensor_msgs::Imu& imu, const eagleye_msgs::YawrateOffset& yawrate_offset,
+                                const eagleye_msgs::Heading& heading_interpolate, eagleye_msgs::Heading* heading)
+{
+  if (parameter_.use_rtk_heading)
+  {
+    RtkHeadingEstimator& estimator = rtk_heading_[index];
+    estimator.setVelocityScaleFactor(output_.velocity_scale_factor);
+    estimator.setDistance(output_.distance);
+    estimator.setYawrateOffsetStop(output_.yawrate_offset_stop);
+    estimator.setYawrateOffset(yawrate_offset);
+    estimator.setSlipAngle(output_.slip_angle);
+    estimator.setHeadingInterpolate(heading_interpolate);
+    if (!estimator.imuStep(imu))
+    {
+      return false;
+    }
+    *heading = estimator.getHeading();
+    return true;
+  }
+
+  HeadingEstimator& estimator = heading_[index];
+  estimator.setVelocityScaleFactor(output_.velocity_scale_factor);
+  estimator.setYawrateOffsetStop(output_.yawrate_offset_stop);
+  estimator.setYawrateOffset(yawrate_offset);
+  estimator.setSlipAngle(output_.slip_angle);
+  estimator.setHeadingInterpolate(heading_interpolate);
+  if (!estimator.imuStep(imu))
+  {
+    return false;
+  }
+  *heading = estimator.getHeading();
+  return true;
+}
+
+bool EagleyeEngine::headingInterpolateStep(int index, const sensor_msgs::Imu& imu, const eagleye_msgs::YawrateOffset& yawrate_offset,
+                                           const eagleye_msgs::Heading& heading, eagleye_msgs::Heading* heading_interpolate)
+{
+  HeadingInterpolateEstimator& estimator = heading_interpolate_[index];
+  estimator.setVelocityScaleFactor(output_.velocity_scale_factor);
+  estimator.setYawrateOffsetStop(output_.yawrate_offset_stop);
+  estimator.setYawrateOffset(yawrate_offset);
+  estimator.setHeading(heading);
+  estimator.setSlipAngle(output_.slip_angle);
+  if (!estimator.imuStep(imu))
+  {
+    return false;
+  }
+  *heading_interpolate = estimator.getHeadingInterpolate();
+  return true;
+}
+
+void EagleyeEngine::enuVelStep(const geometry_msgs::Vector3Stamped& enu_vel)
+{
+  // In ekf mode the positions come from EkfEstimator.
+  if (!parameter_.use_ekf)
+  {
+    position_.setVelocityScaleFactor(output_.velocity_scale_factor);
+    position_.setDistance(output_.distance);
+    position_.setHeadingInterpolate(output_.heading_interpolate_3rd);
+    if (position_.enuVelStep(enu_vel))
+    {
+      output_.enu_absolute_pos = position_.getEnuAbsolutePos();
+      output_.enu_absolute_pos_updated = true;
+    }
+
+    position_interpolate_.setEnuAbsolutePos(output_.enu_absolute_pos);
+    position_interpolate_.setGnssSmoothPos(output_.gnss_smooth_pos_enu);
+    position_interpolate_.setHeight(output_.height);
+    if (position_interpolate_.enuVelStep(enu_vel))
+    {
+      output_.enu_absolute_pos_interpolate = position_interpolate_.getEnuAbsolutePosInterpolate();
+      output_.enu_absolute_pos_interpolate_updated = true;
+    }
+    if (position_interpolate_.isFixUpdated())
+    {
+      output_.fix = position_interpolate_.getFix();
+      output_.fix_updated = true;
+    }
+  }
+
+  if (parameter_.use_rtk_deadreckoning)
+  {
+    rtk_deadreckoning_.setHeadingInterpolate(output_.heading_interpolate_3rd);
+    if (rtk_deadreckoning_.enuVelStep(enu_vel))
+    {
+      output_.enu_absolute_rtk_deadreckoning = rtk_deadreckoning_.getEnuAbsoluteRtkDeadreckoning();
+      output_.enu_absolute_rtk_deadreckoning_updated = true;
+    }
+    if (rtk_deadreckoning_.isFixUpdated())
+    {
+      output_.rtk_fix = rtk_deadreckoning_.getFix();
+      output_.rtk_fix_updated = true;
+    }
+  }
+}
+
+void EagleyeEngine::stopStep(const sensor_msgs::Imu& imu)
+{
+  if (yawrate_offset_stop_.imuStep(imu))
+  {
+    output_.yawrate_offset_stop = yawrate_offset_stop_.getYawrateOffset();
+    output_.yawrate_offset_stop_updated = true;
+  }
+
+  if (angular_velocity_offset_stop_.imuStep(imu))
+  {
+    output_.angular_velocity_offset_stop = angular_velocity_offset_stop_.getAngularVelocityOffset();
+    output_.angular_velocity_offset_stop_updated = true;
+  }
+}
+
+void EagleyeEngine::windowStep(const sensor_msgs::Imu& imu)
+{
+  imu_history_.append(imu);
+
+  if (velocity_scale_factor_.imuStep(imu))
+  {
+    output_.velocity_scale_factor = velocity_scale_factor_.getVelocityScaleFactor();
+    output_.velocity_scale_factor_updated = true;
+
+    if (distance_.velocityScaleFactorStep(output_.velocity_scale_factor))
+    {
+      output_.distance = distance_.getDistance();
+      output_.distance_updated = true;
+    }
+  }
+
+  stopStep(imu);
+
+  // heading -> heading_interpolate -> yawrate_offset, three times over. Each
+  // heading sees the heading_interpolate of the previous imu sample.
+  output_.heading_1st_updated = headingStep(0, imu, output_.yawrate_offset_stop, output_.heading_interpolate_1st, &output_.heading_1st);
+  output_.heading_interpolate_1st_updated = headingInterpolateStep(0, imu, output_.yawrate_offset_stop, output_.heading_1st, &output_.heading_interpolate_1st);
+
+  yawrate_offset_[0].setVelocityScaleFactor(output_.velocity_scale_factor);
+  yawrate_offset_[0].setYawrateOffsetStop(output_.yawrate_offset_stop);
+  yawrate_offset_[0].setHeadingInterpolate(output_.heading_interpolate_1st);
+  if (yawrate_offset_[0].imuStep(imu))
+  {
+    output_.yawrate_offset_1st = yawrate_offset_[0].getYawrateOffset();
+    output_.yawrate_offset_1st_updated = true;
+  }
+
+  output_.heading_2nd_updated = headingStep(1, imu, output_.yawrate_offset_1st, output_.heading_interpolate_2nd, &output_.heading_2nd);
+  output_.heading_interpolate_2nd_updated = headingInterpolateStep(1, imu, output_.yawrate_offset_1st, output_.heading_2nd, &output_.heading_interpolate_2nd);
+
+  yawrate_offset_[1].setVelocityScaleFactor(output_.velocity_scale_factor);
+  yawrate_offset_[1].setYawrateOffsetStop(output_.yawrate_offset_stop);
+  yawrate_offset_[1].setHeadingInterpolate(output_.heading_interpolate_2nd);
+  if (yawrate_offset_[1].imuStep(imu))
+  {
+    output_.yawrate_offset_2nd = yawrate_offset_[1].getYawrateOffset();
+    output_.yawrate_offset_2nd_updated = true;
+  }
+
+  output_.heading_3rd_updated = headingStep(2, imu, output_.yawrate_offset_2nd, output_.heading_interpolate_3rd, &output_.heading_3rd);
+  output_.heading_interpolate_3rd_updated = headingInterpolateStep(2, imu, output_.yawrate_offset_2nd, output_.heading_3rd, &output_.heading_interpolate_3rd);
+
+  slip_angle_.setVelocityScaleFactor(output_.velocity_scale_factor);
+  slip_angle_.setYawrateOffsetStop(output_.yawrate_offset_stop);
+  slip_angle_.setYawrateOffset(output_.yawrate_offset_2nd);
+  if (slip_angle_.imuStep(imu))
+  {
+    output_.slip_angle = slip_angle_.getSlipAngle();
+    output_.slip_angle_updated = true;
+  }
+
+  height_.setVelocityScaleFactor(output_.velocity_scale_factor);
+  height_.setDistance(output_.distance);
+  if (height_.imuStep(imu))
+  {
+    output_.height = height_.getHeight();
+    output_.pitching = height_.getPitching();
+    output_.acc_x_offset = height_.getAccXOffset();
+    output_.acc_x_scale_factor = height_.getAccXScaleFactor();
+    output_.height_updated = true;
+    output_.pitching_updated = true;
+    output_.acc_x_offset_updated = true;
+    output_.acc_x_scale_factor_updated = true;
+    if (height_.isReliabilityFixUpdated())
+    {
+      output_.reliability_fix = height_.getReliabilityFix();
+      output_.reliability_fix_updated = true;
+    }
+  }
+}
+
+void EagleyeEngine::ekfStep(const sensor_msgs::Imu& imu)
+{
+  stopStep(imu);
+
+  // The slip angle of the previous imu sample, as heading_interpolate sees it.
+  ekf_.setSlipAngle(output_.slip_angle);
+  ekf_.imuStep(imu);
+
+  output_.velocity_scale_factor = ekf_.getVelocityScaleFactor();
+  output_.velocity_scale_factor_updated = true;
+  if (distance_.velocityScaleFactorStep(output_.velocity_scale_factor))
+  {
+    output_.distance = distance_.getDistance();
+    output_.distance_updated = true;
+  }
+
+  output_.yawrate_offset_1st = ekf_.getYawrateOffset();
+  output_.yawrate_offset_2nd = ekf_.getYawrateOffset();
+  output_.yawrate_offset_1st_updated = true;
+  output_.yawrate_offset_2nd_updated = true;
+
+  if (ekf_.isHeadingUpdated())
+  {
+    output_.heading_1st = ekf_.getHeading();
+    output_.heading_2nd = ekf_.getHeading();
+    output_.heading_3rd = ekf_.getHeading();
+    output_.heading_1st_updated = true;
+    output_.heading_2nd_updated = true;
+    output_.heading_3rd_updated = true;
+  }
+  output_.heading_interpolate_1st = ekf_.getHeadingInterpolate();
+  output_.heading_interpolate_2nd = ekf_.getHeadingInterpolate();
+  output_.heading_interpolate_3rd = ekf_.getHeadingInterpolate();
+  output_.heading_interpolate_1st_updated = true;
+  output_.heading_interpolate_2nd_updated = true;
+  output_.heading_interpolate_3rd_updated = true;
+
+  slip_angle_.setVelocityScaleFactor(output_.velocity_scale_factor);
+  slip_angle_.setYawrateOffsetStop(output_.yawrate_offset_stop);
+  slip_angle_.setYawrateOffset(output_.yawrate_offset_2nd);
+  if (slip_angle_.imuStep(imu))
+  {
+    output_.slip_angle = slip_angle_.getSlipAngle();
+    output_.slip_angle_updated = true;
+  }
+
+  output_.height = ekf_.getHeight();
+  output_.pitching = ekf_.getPitching();
+  output_.acc_x_offset = ekf_.getAccXOffset();
+  output_.acc_x_scale_factor = ekf_.getAccXScaleFactor();
+  output_.height_updated = true;
+  output_.pitching_updated = true;
+  output_.acc_x_offset_updated = true;
+  output_.acc_x_scale_factor_updated = true;
+
+  if (ekf_.isEnuAbsolutePosUpdated())
+  {
+    output_.enu_absolute_pos = ekf_.getEnuAbsolutePos();
+    output_.enu_absolute_pos_updated = true;
+  }
+  if (ekf_.isEnuAbsolutePosInterpolateUpdated())
+  {
+    output_.enu_absolute_pos_interpolate = ekf_.getEnuAbsolutePosInterpolate();
+    output_.enu_absolute_pos_interpolate_updated = true;
+  }
+  if (ekf_.isFixUpdated())
+  {
+    output_.fix = ekf_.getFix();
+    output_.fix_updated = true;
+  }
+}
+
+const EagleyeEngineOutput& EagleyeEngine::addImu(const sensor_msgs::Imu& imu)
+{
+  clearUpdated();
+  if (parameter_.use_ekf)
+  {
+    ekfStep(imu);
+  }
+  else
+  {
+    windowStep(imu);
+  }
+
+  trajectory_.setVelocityScaleFactor(output_.velocity_scale_factor);
+  trajectory_.setHeadingInterpolate(output_.heading_interpolate_3rd);
+  trajectory_.setYawrateOffsetStop(output_.yawrate_offset_stop);
+  trajectory_.setYawrateOffset(output_.yawrate_offset_2nd);
+  trajectory_.setPitching(output_.pitching);
+  if (trajectory_.imuStep(imu))
+  {
+    output_.twist = trajectory_.getTwist();
+    output_.twist_updated = true;
+    if (trajectory_.isEnuVelUpdated())
+    {
+      output_.enu_vel = trajectory_.getEnuVel();
+      output_.enu_relative_pos = trajectory_.getEnuRelativePos();
+      output_.enu_vel_updated = true;
+      output_.enu_relative_pos_updated = true;
+      enuVelStep(output_.enu_vel);
+    }
+  }
+
+  correction_imu_.setAngularVelocityOffsetStop(output_.angular_velocity_offset_stop);
+  correction_imu_.setAccXOffset(output_.acc_x_offset);
+  correction_imu_.setAccXScaleFactor(output_.acc_x_scale_factor);
+  if (correction_imu_.imuStep(imu))
+  {
+    output_.imu_corrected = correction_imu_.getCorrectionImu();
+    output_.imu_corrected_updated = true;
+  }
+
+  // The trajectory node runs its deadlock check from a wall clock timer; here
+  // the same check is driven by the imu stamps.
+  int64_t imu_stamp = stampToNSec(imu.header.stamp);
+  if (nsecToSec(imu_stamp - trajectory_timer_last_) >= 1 / parameter_.trajectory_timer_update_rate)
+  {
+    trajectory_.checkInputStatus(parameter_.trajectory_th_deadlock_time);
+    trajectory_timer_last_ = imu_stamp;
+  }
+
+  return output_;
+}
+
+template <class Checkpoint>
+void EagleyeEngine::checkpointFields(Checkpoint* c)
+{
+  c->section("engine");
+  c->field(output_.velocity_scale_factor);
+  c->field(output_.distance);
+  c->field(output_.yawrate_offset_stop);
+  c->field(output_.yawrate_offset_1st);
+  c->field(output_.yawrate_offset_2nd);
+  c->field(output_.heading_1st);
+  c->field(output_.heading_2nd);
+  c->field(output_.heading_3rd);
+  c->field(output_.heading_interpolate_1st);
+  c->field(output_.heading_interpolate_2nd);
+  c->field(output_.heading_interpolate_3rd);
+  c->field(output_.slip_angle);
+  c->field(output_.height);
+  c->field(output_.pitching);
+  c->field(output_.acc_x_offset);
+  c->field(output_.acc_x_scale_factor);
+  c->field(output_.reliability_fix);
+  c->field(output_.enu_vel);
+  c->field(output_.enu_relative_pos);
+  c->field(output_.twist);
+  c->field(output_.enu_absolute_pos);
+  c->field(output_.enu_absolute_pos_interpolate);
+  c->field(output_.fix);
+  c->field(output_.gnss_smooth_pos_enu);
+  c->field(output_.angular_velocity_offset_stop);
+  c->field(output_.imu_corrected);
+  c->field(output_.enu_absolute_rtk_deadreckoning);
+  c->field(output_.rtk_fix);
+  c->field(trajectory_timer_last_);
+  checkpointPart(c, imu_history_);
+  checkpointPart(c, velocity_scale_factor_);
+  checkpointPart(c, distance_);
+  checkpointPart(c, yawrate_offset_stop_);
+  checkpointPart(c, angular_velocity_offset_stop_);
+  for (int i = 0; i < 2; i++)
+  {
+    checkpointPart(c, yawrate_offset_[i]);
+  }
+  for (int i = 0; i < 3; i++)
+  {
+    checkpointPart(c, heading_[i]);
+    checkpointPart(c, rtk_heading_[i]);
+    checkpointPart(c, heading_interpolate_[i]);
+  }
+  checkpointPart(c, slip_angle_);
+  checkpointPart(c, height_);
+  checkpointPart(c, trajectory_);
+  checkpointPart(c, position_);
+  checkpointPart(c, position_interpolate_);
+  checkpointPart(c, smoothing_);
+  checkpointPart(c, rtk_deadreckoning_);
+  checkpointPart(c, correction_imu_);
+  checkpointPart(c, ekf_);
+}
+
+void EagleyeEngine::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<EagleyeEngine*>(this)->checkpointFields(checkpoint);
+}
+
+void EagleyeEngine::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+  clearUpdated();
+}
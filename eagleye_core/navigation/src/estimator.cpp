@@ -0,0 +1,1662 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * estimator.cpp
+ * Author MapIV Sekino
+ */
+
+#include "navigation/estimator.hpp"
+#include "coordinate/coordinate.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Samples a distance window can hold when a sample is only buffered after
+// separation_distance has been travelled since the previous one.
+static std::size_t distanceWindowLength(double distance, double separation_distance)
+{
+  if (separation_distance <= 0)
+  {
+    return 0;
+  }
+  return static_cast<std::size_t>(distance / separation_distance) + 2;
+}
+
+static ImuHistory* activeImuHistory(ImuHistory* shared, ImuHistory* own)
+{
+  return shared != NULL ? shared : own;
+}
+
+// The imu history an estimator reads in its step. A shared history already
+// holds the imu, an own history is appended to here.
+static ImuHistory* stepImuHistory(ImuHistory* shared, ImuHistory* own, const sensor_msgs::Imu& imu, std::size_t capacity)
+{
+  ImuHistory* imu_history = activeImuHistory(shared, own);
+  imu_history->requireCapacity(capacity);
+  if (shared == NULL)
+  {
+    imu_history->append(imu);
+  }
+  return imu_history;
+}
+
+VelocityScaleFactorEstimator::VelocityScaleFactorEstimator()
+  : parameter_(), status_(), warm_start_status_(false), warm_start_scale_factor_(1.0)
+{
+}
+
+void VelocityScaleFactorEstimator::setParameter(const VelocityScaleFactorParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void VelocityScaleFactorEstimator::reserve()
+{
+  std::size_t number = parameter_.estimated_number_max + 1;
+  status_.gnss_status_buffer.reserve(number);
+  status_.doppler_velocity_buffer.reserve(number);
+  status_.velocity_buffer.reserve(number);
+  status_.gnss_index.reserve(number);
+  status_.velocity_index.reserve(number);
+  status_.index.reserve(number);
+  status_.velocity_scale_factor_buffer.reserve(number);
+}
+
+void VelocityScaleFactorEstimator::setRtklibNav(const rtklib_msgs::RtklibNav& rtklib_nav)
+{
+  rtklib_nav_ = rtklib_nav;
+}
+
+void VelocityScaleFactorEstimator::setTwist(const geometry_msgs::TwistStamped& velocity)
+{
+  velocity_ = velocity;
+}
+
+bool VelocityScaleFactorEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  velocity_scale_factor_.header = imu.header;
+  velocity_scale_factor_.header.frame_id = "base_link";
+  velocity_scale_factor_estimate(rtklib_nav_,velocity_,parameter_,&status_,&velocity_scale_factor_);
+  if (warm_start_status_)
+  {
+    if (status_.estimate_start_status == true)
+    {
+      warm_start_status_ = false;
+    }
+    else
+    {
+      velocity_scale_factor_.scale_factor = warm_start_scale_factor_;
+      velocity_scale_factor_.correction_velocity.linear.x = velocity_.twist.linear.x * warm_start_scale_factor_;
+      velocity_scale_factor_.status.enabled_status = true;
+    }
+  }
+  return true;
+}
+
+void VelocityScaleFactorEstimator::warmStart(double scale_factor)
+{
+  warm_start_status_ = true;
+  warm_start_scale_factor_ = scale_factor;
+}
+
+DistanceEstimator::DistanceEstimator()
+  : status_()
+{
+}
+
+bool DistanceEstimator::velocityScaleFactorStep(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  distance_.header = velocity_scale_factor.header;
+  distance_.header.frame_id = "base_link";
+  distance_estimate(velocity_scale_factor,&status_,&distance_);
+  return status_.time_last != 0;
+}
+
+YawrateOffsetStopEstimator::YawrateOffsetStopEstimator()
+  : parameter_(), status_()
+{
+}
+
+void YawrateOffsetStopEstimator::setParameter(const YawrateOffsetStopParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void YawrateOffsetStopEstimator::reserve()
+{
+  std::size_t number = 2 * parameter_.estimated_number + 1;
+  status_.yawrate_buffer.reserve(number);
+}
+
+void YawrateOffsetStopEstimator::setTwist(const geometry_msgs::TwistStamped& velocity)
+{
+  velocity_ = velocity;
+}
+
+bool YawrateOffsetStopEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  yawrate_offset_stop_.header = imu.header;
+  yawrate_offset_stop_estimate(velocity_,imu,parameter_,&status_,&yawrate_offset_stop_);
+  return true;
+}
+
+AngularVelocityOffsetStopEstimator::AngularVelocityOffsetStopEstimator()
+  : parameter_(), status_()
+{
+}
+
+void AngularVelocityOffsetStopEstimator::setParameter(const AngularVelocityOffsetStopParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void AngularVelocityOffsetStopEstimator::reserve()
+{
+  std::size_t number = 2 * parameter_.estimated_number + 1;
+  status_.rollrate_buffer.reserve(number);
+  status_.pitchrate_buffer.reserve(number);
+  status_.yawrate_buffer.reserve(number);
+}
+
+void AngularVelocityOffsetStopEstimator::setTwist(const geometry_msgs::TwistStamped& velocity)
+{
+  velocity_ = velocity;
+}
+
+bool AngularVelocityOffsetStopEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  angular_velocity_offset_stop_.header = imu.header;
+  angular_velocity_offset_stop_estimate(velocity_,imu,parameter_,&status_,&angular_velocity_offset_stop_);
+  return true;
+}
+
+// The nodes clear estimate_status right after publishing. Here it is cleared
+// at the start of the next step instead, so the getter still returns the
+// message exactly as it was published.
+
+YawrateOffsetEstimator::YawrateOffsetEstimator()
+  : parameter_(), status_(), own_imu_history_(), shared_imu_history_(NULL),
+    warm_start_status_(false), warm_start_yawrate_offset_(0)
+{
+}
+
+void YawrateOffsetEstimator::setParameter(const YawrateOffsetParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void YawrateOffsetEstimator::reserve()
+{
+  std::size_t number = parameter_.estimated_number_max + 1;
+  activeImuHistory(shared_imu_history_, &own_imu_history_)->requireCapacity(number);
+  status_.heading_angle_buffer.reserve(number);
+  status_.correction_velocity_buffer.reserve(number);
+  status_.heading_estimate_status_buffer.reserve(number);
+  status_.yawrate_offset_stop_buffer.reserve(number);
+  status_.velocity_index.reserve(number);
+  status_.heading_estimate_status_index.reserve(number);
+  status_.index.reserve(number);
+  status_.provisional_heading_angle_buffer.reserve(number);
+  status_.base_heading_angle_buffer.reserve(number);
+  status_.diff_buffer.reserve(number);
+  status_.time_buffer2.reserve(number);
+}
+
+void YawrateOffsetEstimator::setImuHistory(ImuHistory* imu_history)
+{
+  shared_imu_history_ = imu_history;
+}
+
+void YawrateOffsetEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+void YawrateOffsetEstimator::setYawrateOffsetStop(const eagleye_msgs::YawrateOffset& yawrate_offset_stop)
+{
+  yawrate_offset_stop_ = yawrate_offset_stop;
+}
+
+void YawrateOffsetEstimator::setHeadingInterpolate(const eagleye_msgs::Heading& heading_interpolate)
+{
+  heading_interpolate_ = heading_interpolate;
+}
+
+bool YawrateOffsetEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  yawrate_offset_.status.estimate_status = false;
+  yawrate_offset_.header = imu.header;
+  ImuHistory* imu_history = stepImuHistory(shared_imu_history_, &own_imu_history_, imu, parameter_.estimated_number_max + 1);
+  yawrate_offset_estimate(velocity_scale_factor_,yawrate_offset_stop_,heading_interpolate_,*imu_history,parameter_,&status_,&yawrate_offset_);
+  if (warm_start_status_)
+  {
+    if (yawrate_offset_.status.estimate_status == true)
+    {
+      warm_start_status_ = false;
+    }
+    else if (yawrate_offset_stop_.status.enabled_status == true &&
+      std::fabs(warm_start_yawrate_offset_ - yawrate_offset_stop_.yawrate_offset) > parameter_.outlier_threshold)
+    {
+      warm_start_status_ = false;
+      yawrate_offset_.yawrate_offset = yawrate_offset_stop_.yawrate_offset;
+      yawrate_offset_.status.enabled_status = false;
+    }
+    else
+    {
+      yawrate_offset_.yawrate_offset = warm_start_yawrate_offset_;
+      yawrate_offset_.status.enabled_status = true;
+    }
+  }
+  return true;
+}
+
+void YawrateOffsetEstimator::warmStart(double yawrate_offset)
+{
+  warm_start_status_ = true;
+  warm_start_yawrate_offset_ = yawrate_offset;
+}
+
+HeadingEstimator::HeadingEstimator()
+  : parameter_(), status_(), own_imu_history_(), shared_imu_history_(NULL)
+{
+}
+
+void HeadingEstimator::setParameter(const HeadingParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void HeadingEstimator::reserve()
+{
+  std::size_t number = parameter_.estimated_number_max + 1;
+  activeImuHistory(shared_imu_history_, &own_imu_history_)->requireCapacity(number);
+  status_.heading_angle_buffer.reserve(number);
+  status_.correction_velocity_buffer.reserve(number);
+  status_.yawrate_offset_stop_buffer.reserve(number);
+  status_.yawrate_offset_buffer.reserve(number);
+  status_.slip_angle_buffer.reserve(number);
+  status_.gnss_status_buffer.reserve(number);
+  status_.gnss_index.reserve(number);
+  status_.velocity_index.reserve(number);
+  status_.index.reserve(number);
+  status_.provisional_heading_angle_buffer.reserve(number);
+  status_.base_heading_angle_buffer.reserve(number);
+  status_.base_heading_angle_buffer2.reserve(number);
+  status_.diff_buffer.reserve(number);
+  status_.heading_angle_buffer2.reserve(number);
+}
+
+void HeadingEstimator::setImuHistory(ImuHistory* imu_history)
+{
+  shared_imu_history_ = imu_history;
+}
+
+void HeadingEstimator::setRtklibNav(const rtklib_msgs::RtklibNav& rtklib_nav)
+{
+  rtklib_nav_ = rtklib_nav;
+}
+
+void HeadingEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+void HeadingEstimator::setYawrateOffsetStop(const eagleye_msgs::YawrateOffset& yawrate_offset_stop)
+{
+  yawrate_offset_stop_ = yawrate_offset_stop;
+}
+
+void HeadingEstimator::setYawrateOffset(const eagleye_msgs::YawrateOffset& yawrate_offset)
+{
+  yawrate_offset_ = yawrate_offset;
+}
+
+void HeadingEstimator::setSlipAngle(const eagleye_msgs::SlipAngle& slip_angle)
+{
+  slip_angle_ = slip_angle;
+}
+
+void HeadingEstimator::setHeadingInterpolate(const eagleye_msgs::Heading& heading_interpolate)
+{
+  heading_interpolate_ = heading_interpolate;
+}
+
+bool HeadingEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  heading_.status.estimate_status = false;
+  heading_.header = imu.header;
+  heading_.header.frame_id = "base_link";
+  ImuHistory* imu_history = stepImuHistory(shared_imu_history_, &own_imu_history_, imu, parameter_.estimated_number_max + 1);
+  heading_estimate(rtklib_nav_,imu,*imu_history,velocity_scale_factor_,yawrate_offset_stop_,yawrate_offset_,slip_angle_,heading_interpolate_,parameter_,&status_,&heading_);
+  return heading_.status.estimate_status == true;
+}
+
+RtkHeadingEstimator::RtkHeadingEstimator()
+  : parameter_(), status_(), own_imu_history_(), shared_imu_history_(NULL)
+{
+}
+
+void RtkHeadingEstimator::setParameter(const RtkHeadingParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void RtkHeadingEstimator::reserve()
+{
+  std::size_t number = parameter_.estimated_number_max + 1;
+  activeImuHistory(shared_imu_history_, &own_imu_history_)->requireCapacity(number);
+  status_.heading_angle_buffer.reserve(number);
+  status_.correction_velocity_buffer.reserve(number);
+  status_.yawrate_offset_stop_buffer.reserve(number);
+  status_.yawrate_offset_buffer.reserve(number);
+  status_.slip_angle_buffer.reserve(number);
+  status_.gnss_status_buffer.reserve(number);
+  status_.gnss_index.reserve(number);
+  status_.velocity_index.reserve(number);
+  status_.index.reserve(number);
+  status_.provisional_heading_angle_buffer.reserve(number);
+  status_.base_heading_angle_buffer.reserve(number);
+  status_.base_heading_angle_buffer2.reserve(number);
+  status_.diff_buffer.reserve(number);
+  status_.heading_angle_buffer2.reserve(number);
+
+  // The distance window has no count limit. It is given the length of the
+  // time window, which only runs short while the vehicle is nearly stopped.
+  std::size_t distance_number = std::max(parameter_.estimated_number_max, parameter_.estimated_heading_buffer_min) + 1;
+  status_.distance_buffer.reserve(distance_number);
+  status_.latitude_buffer.reserve(distance_number);
+  status_.longitude_buffer.reserve(distance_number);
+  status_.altitude_buffer.reserve(distance_number);
+  status_.fix_status_buffer.reserve(distance_number);
+}
+
+void RtkHeadingEstimator::setImuHistory(ImuHistory* imu_history)
+{
+  shared_imu_history_ = imu_history;
+}
+
+void RtkHeadingEstimator::setNavSatFix(const sensor_msgs::NavSatFix& fix)
+{
+  fix_ = fix;
+}
+
+void RtkHeadingEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+void RtkHeadingEstimator::setDistance(const eagleye_msgs::Distance& distance)
+{
+  distance_ = distance;
+}
+
+void RtkHeadingEstimator::setYawrateOffsetStop(const eagleye_msgs::YawrateOffset& yawrate_offset_stop)
+{
+  yawrate_offset_stop_ = yawrate_offset_stop;
+}
+
+void RtkHeadingEstimator::setYawrateOffset(const eagleye_msgs::YawrateOffset& yawrate_offset)
+{
+  yawrate_offset_ = yawrate_offset;
+}
+
+void RtkHeadingEstimator::setSlipAngle(const eagleye_msgs::SlipAngle& slip_angle)
+{
+  slip_angle_ = slip_angle;
+}
+
+void RtkHeadingEstimator::setHeadingInterpolate(const eagleye_msgs::Heading& heading_interpolate)
+{
+  heading_interpolate_ = heading_interpolate;
+}
+
+bool RtkHeadingEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  heading_.status.estimate_status = false;
+  heading_.header = imu.header;
+  heading_.header.frame_id = "base_link";
+  ImuHistory* imu_history = stepImuHistory(shared_imu_history_, &own_imu_history_, imu, parameter_.estimated_number_max + 1);
+  rtk_heading_estimate(fix_,imu,*imu_history,velocity_scale_factor_,distance_,yawrate_offset_stop_,yawrate_offset_,slip_angle_,heading_interpolate_,parameter_,&status_,&heading_);
+  return heading_.status.estimate_status == true;
+}
+
+HeadingInterpolateEstimator::HeadingInterpolateEstimator()
+  : parameter_(), status_()
+{
+}
+
+void HeadingInterpolateEstimator::setParameter(const HeadingInterpolateParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void HeadingInterpolateEstimator::reserve()
+{
+  std::size_t number = parameter_.number_buffer_max + 1;
+  status_.provisional_heading_angle_buffer.reserve(number);
+  status_.imu_stamp_buffer.reserve(number);
+}
+
+void HeadingInterpolateEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+void HeadingInterpolateEstimator::setYawrateOffsetStop(const eagleye_msgs::YawrateOffset& yawrate_offset_stop)
+{
+  yawrate_offset_stop_ = yawrate_offset_stop;
+}
+
+void HeadingInterpolateEstimator::setYawrateOffset(const eagleye_msgs::YawrateOffset& yawrate_offset)
+{
+  yawrate_offset_ = yawrate_offset;
+}
+
+void HeadingInterpolateEstimator::setHeading(const eagleye_msgs::Heading& heading)
+{
+  heading_ = heading;
+}
+
+void HeadingInterpolateEstimator::setSlipAngle(const eagleye_msgs::SlipAngle& slip_angle)
+{
+  slip_angle_ = slip_angle;
+}
+
+bool HeadingInterpolateEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  heading_interpolate_.header = imu.header;
+  heading_interpolate_.header.frame_id = "base_link";
+  heading_interpolate_estimate(imu,velocity_scale_factor_,yawrate_offset_stop_,yawrate_offset_,heading_,slip_angle_,parameter_,&status_,&heading_interpolate_);
+  return true;
+}
+
+SlipAngleEstimator::SlipAngleEstimator()
+  : parameter_()
+{
+}
+
+void SlipAngleEstimator::setParameter(const SlipangleParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void SlipAngleEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+void SlipAngleEstimator::setYawrateOffsetStop(const eagleye_msgs::YawrateOffset& yawrate_offset_stop)
+{
+  yawrate_offset_stop_ = yawrate_offset_stop;
+}
+
+void SlipAngleEstimator::setYawrateOffset(const eagleye_msgs::YawrateOffset& yawrate_offset)
+{
+  yawrate_offset_2nd_ = yawrate_offset;
+}
+
+bool SlipAngleEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  slip_angle_.status.estimate_status = false;
+  slip_angle_.header = imu.header;
+  slip_angle_.header.frame_id = "base_link";
+  slip_angle_estimate(imu,velocity_scale_factor_,yawrate_offset_stop_,yawrate_offset_2nd_,parameter_,&slip_angle_);
+  return true;
+}
+
+static void reserveHeightStatus(const HeightParameter& parameter, HeightStatus* status)
+{
+  std::size_t number = distanceWindowLength(parameter.estimated_distance_max, parameter.separation_distance);
+  status->height_buffer.reserve(number);
+  status->height_buffer2.reserve(number);
+  status->relative_height_G_buffer.reserve(number);
+  status->relative_height_diffvel_buffer.reserve(number);
+  status->relative_height_offset_buffer.reserve(number);
+  status->correction_relative_height_buffer.reserve(number);
+  status->correction_relative_height_buffer2.reserve(number);
+  status->correction_velocity_buffer.reserve(number);
+  status->distance_buffer.reserve(number);
+  status->distance_index.reserve(number);
+  status->velocity_index.reserve(number);
+  status->index.reserve(number);
+  status->erase_number.reserve(number);
+  status->base_height_buffer.reserve(number);
+  status->base_height_buffer2.reserve(number);
+  status->diff_height_buffer.reserve(number);
+  status->diff_height_buffer2.reserve(number);
+  status->acc_buffer.reserve(parameter.average_num + 1);
+}
+
+HeightEstimator::HeightEstimator()
+  : parameter_(), status_(), deferred_fit_(false), fit_due_(false), fit_busy_(false), fit_ready_(false),
+    fit_distance_last_(0), fit_height_last_(0), fit_parameter_(), fit_status_()
+{
+}
+
+void HeightEstimator::setParameter(const HeightParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void HeightEstimator::reserve()
+{
+  reserveHeightStatus(parameter_, &status_);
+  if (deferred_fit_)
+  {
+    reserveHeightStatus(parameter_, &fit_status_);
+  }
+}
+
+void HeightEstimator::setNavSatFix(const sensor_msgs::NavSatFix& fix)
+{
+  fix_ = fix;
+}
+
+void HeightEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+void HeightEstimator::setDistance(const eagleye_msgs::Distance& distance)
+{
+  distance_ = distance;
+}
+
+bool HeightEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  status_.flag_reliability = false;
+  height_.status.estimate_status = false;
+  pitching_.status.estimate_status = false;
+  acc_x_offset_.status.estimate_status = false;
+  acc_x_scale_factor_.status.estimate_status = false;
+
+  height_.header = imu.header;
+  height_.header.frame_id = "base_link";
+  pitching_.header = imu.header;
+  pitching_.header.frame_id = "base_link";
+  acc_x_offset_.header = imu.header;
+  acc_x_scale_factor_.header = imu.header;
+  if (!deferred_fit_)
+  {
+    pitching_estimate(imu,fix_,velocity_scale_factor_,distance_,parameter_,&status_,&height_,&pitching_,&acc_x_offset_,&acc_x_scale_factor_);
+    return true;
+  }
+
+  bool merge = fit_ready_;
+  if (merge)
+  {
+    mergeFit();
+  }
+
+  fit_due_ = false;
+  if (height_window_update(imu,fix_,velocity_scale_factor_,distance_,parameter_,&status_) && !fit_busy_)
+  {
+    fit_distance_last_ = status_.distance_buffer.back();
+    fit_fix_ = fix_;
+    fit_height_ = height_;
+    fit_acc_x_offset_ = acc_x_offset_;
+    fit_acc_x_scale_factor_ = acc_x_scale_factor_;
+    fit_parameter_ = parameter_;
+    fit_status_ = status_;
+    fit_due_ = true;
+    fit_busy_ = true;
+  }
+  // The fit does not run in this step, so the height is dead-reckoned instead.
+  status_.height_fit_status = false;
+  height_propagate(imu,velocity_scale_factor_,parameter_,&status_,&height_,&pitching_,&acc_x_offset_,&acc_x_scale_factor_);
+  if (fit_due_)
+  {
+    fit_height_last_ = status_.height_last;
+  }
+
+  if (merge)
+  {
+    status_.flag_reliability = fit_status_.flag_reliability;
+    if (fit_height_.status.estimate_status == true)
+    {
+      height_.status = fit_height_.status;
+    }
+    acc_x_offset_.status = fit_acc_x_offset_.status;
+    acc_x_scale_factor_.status = fit_acc_x_scale_factor_.status;
+    fit_ready_ = false;
+    fit_busy_ = false;
+  }
+  return true;
+}
+
+void HeightEstimator::warmStart(double acc_x_offset, double acc_x_scale_factor)
+{
+  status_.acceleration_offset_linear_x_last = acc_x_offset;
+  status_.acceleration_SF_linear_x_last = acc_x_scale_factor;
+  acc_x_offset_.acc_x_offset = acc_x_offset;
+  acc_x_offset_.status.enabled_status = true;
+  acc_x_scale_factor_.acc_x_scale_factor = acc_x_scale_factor;
+  acc_x_scale_factor_.status.enabled_status = true;
+}
+
+void HeightEstimator::fitSnapshot()
+{
+  fit_height_.status.estimate_status = false;
+  fit_acc_x_offset_.status.estimate_status = false;
+  fit_acc_x_scale_factor_.status.estimate_status = false;
+  height_window_fit(fit_parameter_,&fit_status_,&fit_height_,&fit_acc_x_offset_,&fit_acc_x_scale_factor_);
+}
+
+// Takes the fit results into status_. The window has moved on since the copy:
+// samples were appended and old ones dropped. The buffered distance only
+// grows, so a sample is found in the copy by its distance.
+void HeightEstimator::mergeFit()
+{
+  status_.acceleration_offset_linear_x_last = fit_status_.acceleration_offset_linear_x_last;
+  status_.acceleration_SF_linear_x_last = fit_status_.acceleration_SF_linear_x_last;
+  status_.height_estimate_start_status = fit_status_.height_estimate_start_status;
+  if (fit_height_.status.estimate_status == true)
+  {
+    status_.height_last = fit_status_.height_last + (status_.height_last - fit_height_last_);
+  }
+
+  std::size_t fit_index = 0;
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < status_.distance_buffer.size(); i++)
+  {
+    double distance = status_.distance_buffer[i];
+    if (distance <= fit_distance_last_)
+    {
+      while (fit_index < fit_status_.distance_buffer.size() && fit_status_.distance_buffer[fit_index] < distance)
+      {
+        ++fit_index;
+      }
+      if (fit_index == fit_status_.distance_buffer.size() || fit_status_.distance_buffer[fit_index] != distance)
+      {
+        continue;
+      }
+      status_.correction_relative_height_buffer[i] = fit_status_.correction_relative_height_buffer[fit_index];
+    }
+    status_.height_buffer[length] = status_.height_buffer[i];
+    status_.relative_height_G_buffer[length] = status_.relative_height_G_buffer[i];
+    status_.relative_height_diffvel_buffer[length] = status_.relative_height_diffvel_buffer[i];
+    status_.relative_height_offset_buffer[length] = status_.relative_height_offset_buffer[i];
+    status_.correction_relative_height_buffer[length] = status_.correction_relative_height_buffer[i];
+    status_.correction_velocity_buffer[length] = status_.correction_velocity_buffer[i];
+    status_.distance_buffer[length] = distance;
+    ++length;
+  }
+  status_.height_buffer.resize(length);
+  status_.relative_height_G_buffer.resize(length);
+  status_.relative_height_diffvel_buffer.resize(length);
+  status_.relative_height_offset_buffer.resize(length);
+  status_.correction_relative_height_buffer.resize(length);
+  status_.correction_velocity_buffer.resize(length);
+  status_.distance_buffer.resize(length);
+  status_.data_number = length;
+}
+
+TrajectoryEstimator::TrajectoryEstimator()
+  : imu_time_last_(0), velocity_time_last_(0), input_status_(false), enu_vel_status_(false), parameter_(), status_()
+{
+}
+
+void TrajectoryEstimator::setParameter(const TrajectoryParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void TrajectoryEstimator::setTwist(const geometry_msgs::TwistStamped& velocity)
+{
+  velocity_ = velocity;
+}
+
+void TrajectoryEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+void TrajectoryEstimator::setHeadingInterpolate(const eagleye_msgs::Heading& heading_interpolate)
+{
+  heading_interpolate_3rd_ = heading_interpolate;
+}
+
+void TrajectoryEstimator::setYawrateOffsetStop(const eagleye_msgs::YawrateOffset& yawrate_offset_stop)
+{
+  yawrate_offset_stop_ = yawrate_offset_stop;
+}
+
+void TrajectoryEstimator::setYawrateOffset(const eagleye_msgs::YawrateOffset& yawrate_offset)
+{
+  yawrate_offset_2nd_ = yawrate_offset;
+}
+
+void TrajectoryEstimator::setPitching(const eagleye_msgs::Pitching& pitching)
+{
+  pitching_ = pitching;
+}
+
+bool TrajectoryEstimator::checkInputStatus(double th_deadlock_time)
+{
+  int64_t imu_time = stampToNSec(imu_.header.stamp);
+  int64_t velocity_time = stampToNSec(velocity_.header.stamp);
+
+  if (std::abs(nsecToSec(imu_time - imu_time_last_)) < th_deadlock_time &&
+      std::abs(nsecToSec(velocity_time - velocity_time_last_)) < th_deadlock_time &&
+      std::abs(nsecToSec(velocity_time - imu_time)) < th_deadlock_time)
+  {
+    input_status_ = true;
+  }
+  else
+  {
+    input_status_ = false;
+  }
+
+  imu_time_last_ = imu_time;
+  velocity_time_last_ = velocity_time;
+
+  return input_status_;
+}
+
+bool TrajectoryEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  imu_ = imu;
+  enu_vel_status_ = false;
+
+  if (!input_status_)
+  {
+    return false;
+  }
+
+  enu_vel_.header = imu.header;
+  enu_vel_.header.frame_id = "gnss";
+  enu_relative_pos_.header = imu.header;
+  enu_relative_pos_.header.frame_id = "base_link";
+  eagleye_twist_.header = imu.header;
+  eagleye_twist_.header.frame_id = "base_link";
+  trajectory3d_estimate(imu,velocity_scale_factor_,heading_interpolate_3rd_,yawrate_offset_stop_,yawrate_offset_2nd_,pitching_,parameter_,&status_,&enu_vel_,&enu_relative_pos_,&eagleye_twist_);
+
+  enu_vel_status_ = heading_interpolate_3rd_.status.enabled_status == true;
+  return true;
+}
+
+static void reservePositionStatus(const PositionParameter& parameter, PositionStatus* status)
+{
+  std::size_t number = distanceWindowLength(parameter.estimated_distance, parameter.separation_distance);
+  status->enu_pos_x_buffer.reserve(number);
+  status->enu_pos_y_buffer.reserve(number);
+  status->enu_pos_z_buffer.reserve(number);
+  status->enu_relative_pos_x_buffer.reserve(number);
+  status->enu_relative_pos_y_buffer.reserve(number);
+  status->enu_relative_pos_z_buffer.reserve(number);
+  status->correction_velocity_buffer.reserve(number);
+  status->distance_buffer.reserve(number);
+  status->distance_index.reserve(number);
+  status->velocity_index.reserve(number);
+  status->index.reserve(number);
+  status->base_enu_pos_x_buffer.reserve(number);
+  status->base_enu_pos_y_buffer.reserve(number);
+  status->base_enu_pos_z_buffer.reserve(number);
+  status->diff_x_buffer2.reserve(number);
+  status->diff_y_buffer2.reserve(number);
+  status->diff_z_buffer2.reserve(number);
+  status->base_enu_pos_x_buffer2.reserve(number);
+  status->base_enu_pos_y_buffer2.reserve(number);
+  status->base_enu_pos_z_buffer2.reserve(number);
+  status->diff_x_buffer.reserve(number);
+  status->diff_y_buffer.reserve(number);
+  status->diff_z_buffer.reserve(number);
+}
+
+PositionEstimator::PositionEstimator()
+  : parameter_(), status_(), deferred_fit_(false), fit_due_(false), fit_busy_(false), fit_parameter_(), fit_status_()
+{
+}
+
+void PositionEstimator::setParameter(const PositionParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void PositionEstimator::reserve()
+{
+  reservePositionStatus(parameter_, &status_);
+  if (deferred_fit_)
+  {
+    reservePositionStatus(parameter_, &fit_status_);
+  }
+}
+
+void PositionEstimator::setRtklibNav(const rtklib_msgs::RtklibNav& rtklib_nav)
+{
+  rtklib_nav_ = rtklib_nav;
+}
+
+void PositionEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+void PositionEstimator::setDistance(const eagleye_msgs::Distance& distance)
+{
+  distance_ = distance;
+}
+
+void PositionEstimator::setHeadingInterpolate(const eagleye_msgs::Heading& heading_interpolate)
+{
+  heading_interpolate_3rd_ = heading_interpolate;
+}
+
+bool PositionEstimator::enuVelStep(const geometry_msgs::Vector3Stamped& enu_vel)
+{
+  enu_absolute_pos_.status.estimate_status = false;
+  enu_absolute_pos_.header = enu_vel.header;
+  enu_absolute_pos_.header.frame_id = "base_link";
+  if (!deferred_fit_)
+  {
+    position_estimate(rtklib_nav_,velocity_scale_factor_,distance_,heading_interpolate_3rd_,enu_vel,parameter_,&status_,&enu_absolute_pos_);
+    return enu_absolute_pos_.status.estimate_status == true;
+  }
+
+  fit_due_ = false;
+  if (position_window_update(rtklib_nav_,velocity_scale_factor_,distance_,heading_interpolate_3rd_,enu_vel,parameter_,&status_,&enu_absolute_pos_) && !fit_busy_)
+  {
+    fit_enu_absolute_pos_ = enu_absolute_pos_;
+    fit_parameter_ = parameter_;
+    fit_status_ = status_;
+    fit_due_ = true;
+    fit_busy_ = true;
+  }
+  return false;
+}
+
+void PositionEstimator::fitSnapshot()
+{
+  position_window_fit(fit_parameter_,&fit_status_,&fit_enu_absolute_pos_);
+}
+
+bool PositionEstimator::applyFit()
+{
+  fit_busy_ = false;
+  if (fit_enu_absolute_pos_.status.estimate_status != true)
+  {
+    return false;
+  }
+  enu_absolute_pos_.header = fit_enu_absolute_pos_.header;
+  enu_absolute_pos_.enu_pos = fit_enu_absolute_pos_.enu_pos;
+  enu_absolute_pos_.status = fit_enu_absolute_pos_.status;
+  return true;
+}
+
+PositionInterpolateEstimator::PositionInterpolateEstimator()
+  : eagleye_fix_status_(false), fix_status_(false), parameter_(), status_()
+{
+}
+
+void PositionInterpolateEstimator::setParameter(const PositionInterpolateParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void PositionInterpolateEstimator::reserve()
+{
+  std::size_t number = parameter_.number_buffer_max + 1;
+  status_.provisional_enu_pos_x_buffer.reserve(number);
+  status_.provisional_enu_pos_y_buffer.reserve(number);
+  status_.provisional_enu_pos_z_buffer.reserve(number);
+  status_.imu_stamp_buffer.reserve(number);
+}
+
+void PositionInterpolateEstimator::setNavSatFix(const sensor_msgs::NavSatFix& fix)
+{
+  fix_ = fix;
+}
+
+void PositionInterpolateEstimator::setEnuAbsolutePos(const eagleye_msgs::Position& enu_absolute_pos)
+{
+  enu_absolute_pos_ = enu_absolute_pos;
+}
+
+void PositionInterpolateEstimator::setGnssSmoothPos(const eagleye_msgs::Position& gnss_smooth_pos)
+{
+  gnss_smooth_pos_ = gnss_smooth_pos;
+}
+
+void PositionInterpolateEstimator::setHeight(const eagleye_msgs::Height& height)
+{
+  height_ = height;
+}
+
+bool PositionInterpolateEstimator::enuVelStep(const geometry_msgs::Vector3Stamped& enu_vel)
+{
+  enu_absolute_pos_interpolate_.header = enu_vel.header;
+  enu_absolute_pos_interpolate_.header.frame_id = "base_link";
+  eagleye_fix_.header = enu_vel.header;
+  eagleye_fix_.header.frame_id = "gnss";
+  position_interpolate_estimate(enu_absolute_pos_,enu_vel,gnss_smooth_pos_,height_,parameter_,&status_,&enu_absolute_pos_interpolate_,&eagleye_fix_);
+
+  eagleye_fix_status_ = enu_absolute_pos_.status.enabled_status == true;
+  fix_status_ = eagleye_fix_status_ || !fix_.header.stamp.isZero();
+  return eagleye_fix_status_;
+}
+
+const sensor_msgs::NavSatFix& PositionInterpolateEstimator::getFix() const
+{
+  return eagleye_fix_status_ ? eagleye_fix_ : fix_;
+}
+
+SmoothingEstimator::SmoothingEstimator()
+  : parameter_(), status_()
+{
+}
+
+void SmoothingEstimator::setParameter(const SmoothingParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void SmoothingEstimator::reserve()
+{
+  std::size_t number = parameter_.estimated_number_max + 1;
+  status_.time_buffer.reserve(number);
+  status_.enu_pos_x_buffer.reserve(number);
+  status_.enu_pos_y_buffer.reserve(number);
+  status_.enu_pos_z_buffer.reserve(number);
+  status_.correction_velocity_buffer.reserve(number);
+  status_.velocity_index.reserve(number);
+  status_.index.reserve(number);
+}
+
+void SmoothingEstimator::setVelocityScaleFactor(const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor)
+{
+  velocity_scale_factor_ = velocity_scale_factor;
+}
+
+bool SmoothingEstimator::rtklibNavStep(const rtklib_msgs::RtklibNav& rtklib_nav)
+{
+  gnss_smooth_pos_enu_.header = rtklib_nav.header;
+  gnss_smooth_pos_enu_.header.frame_id = "base_link";
+  smoothing_estimate(rtklib_nav,velocity_scale_factor_,parameter_,&status_,&gnss_smooth_pos_enu_);
+  return true;
+}
+
+RtkDeadreckoningEstimator::RtkDeadreckoningEstimator()
+  : eagleye_fix_status_(false), fix_status_(false), parameter_(), status_()
+{
+}
+
+void RtkDeadreckoningEstimator::setParameter(const RtkDeadreckoningParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void RtkDeadreckoningEstimator::setRtklibNav(const rtklib_msgs::RtklibNav& rtklib_nav)
+{
+  rtklib_nav_ = rtklib_nav;
+}
+
+void RtkDeadreckoningEstimator::setNavSatFix(const sensor_msgs::NavSatFix& fix)
+{
+  fix_ = fix;
+}
+
+void RtkDeadreckoningEstimator::setHeadingInterpolate(const eagleye_msgs::Heading& heading_interpolate)
+{
+  heading_interpolate_3rd_ = heading_interpolate;
+}
+
+bool RtkDeadreckoningEstimator::enuVelStep(const geometry_msgs::Vector3Stamped& enu_vel)
+{
+  enu_absolute_rtk_deadreckoning_.header = enu_vel.header;
+  enu_absolute_rtk_deadreckoning_.header.frame_id = "base_link";
+  eagleye_fix_.header = enu_vel.header;
+  eagleye_fix_.header.frame_id = "gnss";
+  rtk_deadreckoning_estimate(rtklib_nav_,enu_vel,fix_,heading_interpolate_3rd_,parameter_,&status_,&enu_absolute_rtk_deadreckoning_,&eagleye_fix_);
+
+  eagleye_fix_status_ = enu_absolute_rtk_deadreckoning_.status.enabled_status == true;
+  fix_status_ = eagleye_fix_status_ || !fix_.header.stamp.isZero();
+  return eagleye_fix_status_;
+}
+
+const sensor_msgs::NavSatFix& RtkDeadreckoningEstimator::getFix() const
+{
+  return eagleye_fix_status_ ? eagleye_fix_ : fix_;
+}
+
+CorrectionImuEstimator::CorrectionImuEstimator()
+  : reverse_imu_(false)
+{
+}
+
+void CorrectionImuEstimator::setReverseImu(bool reverse_imu)
+{
+  reverse_imu_ = reverse_imu;
+}
+
+void CorrectionImuEstimator::setAngularVelocityOffsetStop(const eagleye_msgs::AngularVelocityOffset& angular_velocity_offset_stop)
+{
+  angular_velocity_offset_stop_ = angular_velocity_offset_stop;
+}
+
+void CorrectionImuEstimator::setAccXOffset(const eagleye_msgs::AccXOffset& acc_x_offset)
+{
+  acc_x_offset_ = acc_x_offset;
+}
+
+void CorrectionImuEstimator::setAccXScaleFactor(const eagleye_msgs::AccXScaleFactor& acc_x_scale_factor)
+{
+  acc_x_scale_factor_ = acc_x_scale_factor;
+}
+
+bool CorrectionImuEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  correction_imu_.header = imu.header;
+  correction_imu_.orientation = imu.orientation;
+  correction_imu_.orientation_covariance = imu.orientation_covariance;
+  correction_imu_.angular_velocity_covariance = imu.angular_velocity_covariance;
+  correction_imu_.linear_acceleration_covariance = imu.linear_acceleration_covariance;
+
+  if (acc_x_offset_.status.enabled_status == true && acc_x_scale_factor_.status.enabled_status)
+  {
+    correction_imu_.linear_acceleration.x = imu.linear_acceleration.x * acc_x_scale_factor_.acc_x_scale_factor + acc_x_offset_.acc_x_offset;
+    correction_imu_.linear_acceleration.y = imu.linear_acceleration.y;
+    correction_imu_.linear_acceleration.z = imu.linear_acceleration.z;
+  }
+  else
+  {
+    correction_imu_.linear_acceleration.x = imu.linear_acceleration.x;
+    correction_imu_.linear_acceleration.y = imu.linear_acceleration.y;
+    correction_imu_.linear_acceleration.z = imu.linear_acceleration.z;
+  }
+
+  if (reverse_imu_ == false)
+  {
+    correction_imu_.angular_velocity.x = imu.angular_velocity.x + angular_velocity_offset_stop_.angular_velocity_offset.x;
+    correction_imu_.angular_velocity.y = imu.angular_velocity.y + angular_velocity_offset_stop_.angular_velocity_offset.y;
+    correction_imu_.angular_velocity.z = -1 * (imu.angular_velocity.z + angular_velocity_offset_stop_.angular_velocity_offset.z);
+  }
+  else if (reverse_imu_ == true)
+  {
+    correction_imu_.angular_velocity.x = imu.angular_velocity.x + angular_velocity_offset_stop_.angular_velocity_offset.x;
+    correction_imu_.angular_velocity.y = imu.angular_velocity.y + angular_velocity_offset_stop_.angular_velocity_offset.y;
+    correction_imu_.angular_velocity.z = -1 * (-1 * (imu.angular_velocity.z + angular_velocity_offset_stop_.angular_velocity_offset.z));
+  }
+
+  return true;
+}
+
+EkfEstimator::EkfEstimator()
+  : heading_updated_(false), enu_absolute_pos_updated_(false), height_updated_(false), eagleye_fix_status_(false), fix_status_(false),
+    parameter_(), transition_()
+{
+  ekf_init(&status_);
+}
+
+void EkfEstimator::setParameter(const EkfParameter& parameter)
+{
+  parameter_ = parameter;
+}
+
+void EkfEstimator::setTwist(const geometry_msgs::TwistStamped& velocity)
+{
+  velocity_ = velocity;
+}
+
+void EkfEstimator::setRtklibNav(const rtklib_msgs::RtklibNav& rtklib_nav)
+{
+  rtklib_nav_ = rtklib_nav;
+}
+
+void EkfEstimator::setNavSatFix(const sensor_msgs::NavSatFix& fix)
+{
+  fix_ = fix;
+}
+
+void EkfEstimator::setSlipAngle(const eagleye_msgs::SlipAngle& slip_angle)
+{
+  slip_angle_ = slip_angle;
+}
+
+bool EkfEstimator::imuStep(const sensor_msgs::Imu& imu)
+{
+  ekf_predict(imu, velocity_, slip_angle_, parameter_, &status_, &transition_);
+  ekf_rtklib_nav_update(rtklib_nav_, slip_angle_, parameter_, &status_, &heading_updated_, &enu_absolute_pos_updated_);
+  height_updated_ = ekf_fix_update(fix_, parameter_, &status_);
+
+  const double* x = status_.state;
+  std_msgs::Header header = imu.header;
+  header.frame_id = "base_link";
+  bool stop = std::abs(velocity_.twist.linear.x) <= parameter_.stop_judgment_velocity_threshold;
+
+  velocity_scale_factor_.header = header;
+  velocity_scale_factor_.scale_factor = x[EKF_VELOCITY_SCALE_FACTOR];
+  velocity_scale_factor_.correction_velocity.linear.x = velocity_.twist.linear.x * x[EKF_VELOCITY_SCALE_FACTOR];
+  velocity_scale_factor_.status.enabled_status = velocity_scale_factor_.status.enabled_status ||
+    stateStd(EKF_VELOCITY_SCALE_FACTOR) < parameter_.velocity_scale_factor_std_threshold;
+  velocity_scale_factor_.status.estimate_status = heading_updated_;
+
+  yawrate_offset_.header = header;
+  yawrate_offset_.yawrate_offset = x[EKF_YAWRATE_OFFSET];
+  yawrate_offset_.status.enabled_status = yawrate_offset_.status.enabled_status ||
+    stateStd(EKF_YAWRATE_OFFSET) < parameter_.yawrate_offset_std_threshold;
+  yawrate_offset_.status.estimate_status = heading_updated_ || stop;
+
+  if (heading_updated_)
+  {
+    heading_.header = header;
+    heading_.heading_angle = x[EKF_HEADING];
+    heading_.status.enabled_status = true;
+    heading_.status.estimate_status = true;
+  }
+  heading_interpolate_.header = header;
+  heading_interpolate_.heading_angle = status_.heading_status ? x[EKF_HEADING] + slip_angle_.slip_angle : 0;
+  heading_interpolate_.status.enabled_status = status_.heading_status;
+  heading_interpolate_.status.estimate_status = heading_updated_;
+
+  // Pitch and acc x offset are only told apart once the doppler velocity is used.
+  pitching_.header = header;
+  pitching_.pitching_angle = x[EKF_PITCH];
+  pitching_.status.enabled_status = status_.heading_status;
+  pitching_.status.estimate_status = heading_updated_;
+  acc_x_offset_.header = header;
+  acc_x_offset_.acc_x_offset = -x[EKF_ACC_X_OFFSET];
+  acc_x_offset_.status = pitching_.status;
+  acc_x_scale_factor_.header = header;
+  acc_x_scale_factor_.acc_x_scale_factor = 1.0;
+  acc_x_scale_factor_.status = pitching_.status;
+
+  double enu_pos[3], llh_pos[3];
+  enu_pos[0] = x[EKF_E];
+  enu_pos[1] = x[EKF_N];
+  enu_pos[2] = x[EKF_U];
+  llh_pos[0] = llh_pos[1] = llh_pos[2] = 0;
+  if (status_.height_status || status_.position_status)
+  {
+    enu2llh(enu_pos, status_.ecef_base_pos, llh_pos);
+  }
+
+  height_.header = header;
+  height_.height = status_.height_status ? llh_pos[2] : 0;
+  height_.status.enabled_status = status_.height_status;
+  height_.status.estimate_status = height_updated_;
+
+  eagleye_fix_status_ = status_.position_status && status_.heading_status;
+  enu_absolute_pos_interpolate_.header = header;
+  enu_absolute_pos_interpolate_.ecef_base_pos.x = status_.ecef_base_pos[0];
+  enu_absolute_pos_interpolate_.ecef_base_pos.y = status_.ecef_base_pos[1];
+  enu_absolute_pos_interpolate_.ecef_base_pos.z = status_.ecef_base_pos[2];
+  enu_absolute_pos_interpolate_.enu_pos.x = eagleye_fix_status_ ? enu_pos[0] : 0;
+  enu_absolute_pos_interpolate_.enu_pos.y = eagleye_fix_status_ ? enu_pos[1] : 0;
+  enu_absolute_pos_interpolate_.enu_pos.z = eagleye_fix_status_ ? enu_pos[2] : 0;
+  enu_absolute_pos_interpolate_.status.enabled_status = eagleye_fix_status_;
+  enu_absolute_pos_interpolate_.status.estimate_status = enu_absolute_pos_updated_;
+  if (enu_absolute_pos_updated_)
+  {
+    enu_absolute_pos_ = enu_absolute_pos_interpolate_;
+  }
+
+  if (eagleye_fix_status_)
+  {
+    eagleye_fix_.header = header;
+    eagleye_fix_.header.frame_id = "gnss";
+    eagleye_fix_.latitude = llh_pos[0] * 180 / M_PI;
+    eagleye_fix_.longitude = llh_pos[1] * 180 / M_PI;
+    eagleye_fix_.altitude = llh_pos[2];
+  }
+  fix_status_ = eagleye_fix_status_ || !fix_.header.stamp.isZero();
+  return true;
+}
+
+void EkfEstimator::warmStartVelocityScaleFactor(double scale_factor)
+{
+  status_.state[EKF_VELOCITY_SCALE_FACTOR] = scale_factor;
+  status_.covariance[EKF_VELOCITY_SCALE_FACTOR * EKF_STATE_NUM + EKF_VELOCITY_SCALE_FACTOR] =
+    parameter_.velocity_scale_factor_std_threshold * parameter_.velocity_scale_factor_std_threshold;
+  velocity_scale_factor_.status.enabled_status = true;
+}
+
+void EkfEstimator::warmStartYawrateOffset(double yawrate_offset)
+{
+  status_.state[EKF_YAWRATE_OFFSET] = yawrate_offset;
+  status_.covariance[EKF_YAWRATE_OFFSET * EKF_STATE_NUM + EKF_YAWRATE_OFFSET] =
+    parameter_.yawrate_offset_std_threshold * parameter_.yawrate_offset_std_threshold;
+  yawrate_offset_.status.enabled_status = true;
+}
+
+void EkfEstimator::warmStartAccXOffset(double acc_x_offset)
+{
+  status_.state[EKF_ACC_X_OFFSET] = -acc_x_offset;
+}
+
+// A window fit running in the background is not part of a checkpoint; after
+// loadCheckpoint() the next due fit starts from the restored window.
+
+template <class Checkpoint>
+void VelocityScaleFactorEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("velocity_scale_factor");
+  c->field(rtklib_nav_);
+  c->field(velocity_);
+  c->field(velocity_scale_factor_);
+  checkpointStatus(c, status_);
+  c->field(warm_start_status_);
+  c->field(warm_start_scale_factor_);
+}
+
+void VelocityScaleFactorEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<VelocityScaleFactorEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void VelocityScaleFactorEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void DistanceEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("distance");
+  c->field(distance_);
+  checkpointStatus(c, status_);
+}
+
+void DistanceEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<DistanceEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void DistanceEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void YawrateOffsetStopEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("yawrate_offset_stop");
+  c->field(velocity_);
+  c->field(yawrate_offset_stop_);
+  checkpointStatus(c, status_);
+}
+
+void YawrateOffsetStopEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<YawrateOffsetStopEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void YawrateOffsetStopEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void AngularVelocityOffsetStopEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("angular_velocity_offset_stop");
+  c->field(velocity_);
+  c->field(angular_velocity_offset_stop_);
+  checkpointStatus(c, status_);
+}
+
+void AngularVelocityOffsetStopEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<AngularVelocityOffsetStopEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void AngularVelocityOffsetStopEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void YawrateOffsetEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("yawrate_offset");
+  c->field(velocity_scale_factor_);
+  c->field(yawrate_offset_stop_);
+  c->field(heading_interpolate_);
+  c->field(yawrate_offset_);
+  checkpointStatus(c, status_);
+  if (shared_imu_history_ == NULL)
+  {
+    checkpointPart(c, own_imu_history_);
+  }
+  c->field(warm_start_status_);
+  c->field(warm_start_yawrate_offset_);
+}
+
+void YawrateOffsetEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<YawrateOffsetEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void YawrateOffsetEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void HeadingEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("heading");
+  c->field(rtklib_nav_);
+  c->field(velocity_scale_factor_);
+  c->field(yawrate_offset_stop_);
+  c->field(yawrate_offset_);
+  c->field(slip_angle_);
+  c->field(heading_interpolate_);
+  c->field(heading_);
+  checkpointStatus(c, status_);
+  if (shared_imu_history_ == NULL)
+  {
+    checkpointPart(c, own_imu_history_);
+  }
+}
+
+void HeadingEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<HeadingEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void HeadingEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void RtkHeadingEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("rtk_heading");
+  c->field(fix_);
+  c->field(velocity_scale_factor_);
+  c->field(distance_);
+  c->field(yawrate_offset_stop_);
+  c->field(yawrate_offset_);
+  c->field(slip_angle_);
+  c->field(heading_interpolate_);
+  c->field(heading_);
+  checkpointStatus(c, status_);
+  if (shared_imu_history_ == NULL)
+  {
+    checkpointPart(c, own_imu_history_);
+  }
+}
+
+void RtkHeadingEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<RtkHeadingEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void RtkHeadingEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void HeadingInterpolateEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("heading_interpolate");
+  c->field(velocity_scale_factor_);
+  c->field(yawrate_offset_stop_);
+  c->field(yawrate_offset_);
+  c->field(heading_);
+  c->field(slip_angle_);
+  c->field(heading_interpolate_);
+  checkpointStatus(c, status_);
+}
+
+void HeadingInterpolateEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<HeadingInterpolateEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void HeadingInterpolateEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void SlipAngleEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("slip_angle");
+  c->field(velocity_scale_factor_);
+  c->field(yawrate_offset_stop_);
+  c->field(yawrate_offset_2nd_);
+  c->field(slip_angle_);
+}
+
+void SlipAngleEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<SlipAngleEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void SlipAngleEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void HeightEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("height");
+  c->field(fix_);
+  c->field(velocity_scale_factor_);
+  c->field(distance_);
+  c->field(height_);
+  c->field(pitching_);
+  c->field(acc_x_offset_);
+  c->field(acc_x_scale_factor_);
+  checkpointStatus(c, status_);
+}
+
+void HeightEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<HeightEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void HeightEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+  fit_due_ = false;
+  fit_busy_ = false;
+  fit_ready_ = false;
+}
+
+template <class Checkpoint>
+void TrajectoryEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("trajectory");
+  c->field(imu_);
+  c->field(velocity_);
+  c->field(velocity_scale_factor_);
+  c->field(heading_interpolate_3rd_);
+  c->field(yawrate_offset_stop_);
+  c->field(yawrate_offset_2nd_);
+  c->field(pitching_);
+  c->field(enu_vel_);
+  c->field(enu_relative_pos_);
+  c->field(eagleye_twist_);
+  c->field(imu_time_last_);
+  c->field(velocity_time_last_);
+  c->field(input_status_);
+  c->field(enu_vel_status_);
+  checkpointStatus(c, status_);
+}
+
+void TrajectoryEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<TrajectoryEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void TrajectoryEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void PositionEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("position");
+  c->field(rtklib_nav_);
+  c->field(velocity_scale_factor_);
+  c->field(distance_);
+  c->field(heading_interpolate_3rd_);
+  c->field(enu_absolute_pos_);
+  checkpointStatus(c, status_);
+}
+
+void PositionEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<PositionEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void PositionEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+  fit_due_ = false;
+  fit_busy_ = false;
+}
+
+template <class Checkpoint>
+void PositionInterpolateEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("position_interpolate");
+  c->field(fix_);
+  c->field(enu_absolute_pos_);
+  c->field(gnss_smooth_pos_);
+  c->field(height_);
+  c->field(enu_absolute_pos_interpolate_);
+  c->field(eagleye_fix_);
+  c->field(eagleye_fix_status_);
+  c->field(fix_status_);
+  checkpointStatus(c, status_);
+}
+
+void PositionInterpolateEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<PositionInterpolateEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void PositionInterpolateEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void SmoothingEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("smoothing");
+  c->field(velocity_scale_factor_);
+  c->field(gnss_smooth_pos_enu_);
+  checkpointStatus(c, status_);
+}
+
+void SmoothingEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<SmoothingEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void SmoothingEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void RtkDeadreckoningEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("rtk_deadreckoning");
+  c->field(rtklib_nav_);
+  c->field(fix_);
+  c->field(heading_interpolate_3rd_);
+  c->field(enu_absolute_rtk_deadreckoning_);
+  c->field(eagleye_fix_);
+  c->field(eagleye_fix_status_);
+  c->field(fix_status_);
+  checkpointStatus(c, status_);
+}
+
+void RtkDeadreckoningEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<RtkDeadreckoningEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void RtkDeadreckoningEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void CorrectionImuEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("correction_imu");
+  c->field(angular_velocity_offset_stop_);
+  c->field(acc_x_offset_);
+  c->field(acc_x_scale_factor_);
+  c->field(correction_imu_);
+}
+
+void CorrectionImuEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<CorrectionImuEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void CorrectionImuEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
+
+template <class Checkpoint>
+void EkfEstimator::checkpointFields(Checkpoint* c)
+{
+  c->section("ekf");
+  c->field(velocity_);
+  c->field(rtklib_nav_);
+  c->field(fix_);
+  c->field(slip_angle_);
+  c->field(velocity_scale_factor_);
+  c->field(yawrate_offset_);
+  c->field(heading_);
+  c->field(heading_interpolate_);
+  c->field(pitching_);
+  c->field(height_);
+  c->field(acc_x_offset_);
+  c->field(acc_x_scale_factor_);
+  c->field(enu_absolute_pos_);
+  c->field(enu_absolute_pos_interpolate_);
+  c->field(eagleye_fix_);
+  c->field(heading_updated_);
+  c->field(enu_absolute_pos_updated_);
+  c->field(height_updated_);
+  c->field(eagleye_fix_status_);
+  c->field(fix_status_);
+  checkpointStatus(c, status_);
+}
+
+void EkfEstimator::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  const_cast<EkfEstimator*>(this)->checkpointFields(checkpoint);
+}
+
+void EkfEstimator::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  checkpointFields(checkpoint);
+}
@@ -31,7 +31,7 @@
 #include "coordinate/coordinate.hpp"
 #include "navigation/navigation.hpp"
 
-void heading_estimate(rtklib_msgs::RtklibNav rtklib_nav,sensor_msgs::Imu imu,eagleye_msgs::VelocityScaleFactor velocity_scale_factor,eagleye_msgs::YawrateOffset yawrate_offset_stop,eagleye_msgs::YawrateOffset yawrate_offset,eagleye_msgs::SlipAngle slip_angle,eagleye_msgs::Heading heading_interpolate,HeadingParameter heading_parameter, HeadingStatus* heading_status,eagleye_msgs::Heading* heading)
+void heading_estimate(rtklib_msgs::RtklibNav rtklib_nav,sensor_msgs::Imu imu,const ImuHistory& imu_history,eagleye_msgs::VelocityScaleFactor velocity_scale_factor,eagleye_msgs::YawrateOffset yawrate_offset_stop,eagleye_msgs::YawrateOffset yawrate_offset,eagleye_msgs::SlipAngle slip_angle,eagleye_msgs::Heading heading_interpolate,HeadingParameter heading_parameter, HeadingStatus* heading_status,eagleye_msgs::Heading* heading)
 {
 
   double ecef_vel[3];
@@ -39,11 +39,11 @@ void heading_estimate(rtklib_msgs::RtklibNav rtklib_nav,sensor_msgs::Imu imu,eag
   double enu_vel[3];
 
   int i,index_max;
-  double yawrate = 0.0 , doppler_heading_angle = 0.0;
+  double yawrate = 0.0 , yawrate_sign = 1.0, doppler_heading_angle = 0.0;
   double avg = 0.0,tmp_heading_angle;
   bool gnss_status,gnss_update;
   std::size_t index_length;
-  std::size_t time_buffer_length;
+  std::size_t buffer_length;
   std::size_t inversion_up_index_length;
   std::size_t inversion_down_index_length;
   std::vector<double>::iterator max;
@@ -74,6 +74,21 @@ void heading_estimate(rtklib_msgs::RtklibNav rtklib_nav,sensor_msgs::Imu imu,eag
     doppler_heading_angle = doppler_heading_angle + 2*M_PI;
   }
 
+  // The window is the last buffer_length samples of the imu history, see
+  // yawrate_offset_estimate().
+  buffer_length = heading_status->heading_angle_buffer.size();
+  if (buffer_length > 0 && (!imu_history.contains(heading_status->imu_history_cursor) ||
+      heading_status->imu_history_cursor + buffer_length + 1 != imu_history.end()))
+  {
+    heading_status->heading_angle_buffer.clear();
+    heading_status->correction_velocity_buffer.clear();
+    heading_status->yawrate_offset_stop_buffer.clear();
+    heading_status->yawrate_offset_buffer.clear();
+    heading_status->slip_angle_buffer.clear();
+    heading_status->gnss_status_buffer.clear();
+    heading_status->estimated_number = 0;
+  }
+
   if (heading_status->estimated_number  < heading_parameter.estimated_number_max)
   {
     ++heading_status->estimated_number ;
@@ -85,10 +100,12 @@ void heading_estimate(rtklib_msgs::RtklibNav rtklib_nav,sensor_msgs::Imu imu,eag
 
   if (heading_parameter.reverse_imu == false)
   {
+    yawrate_sign = 1.0;
     yawrate = imu.angular_velocity.z;
   }
   else if (heading_parameter.reverse_imu == true)
   {
+    yawrate_sign = -1.0;
     yawrate = -1 * imu.angular_velocity.z;
   }
 
@@ -106,34 +123,35 @@ void heading_estimate(rtklib_msgs::RtklibNav rtklib_nav,sensor_msgs::Imu imu,eag
   }
 
   // data buffer generate
-  heading_status->time_buffer .push_back(imu.header.stamp.toSec());
   heading_status->heading_angle_buffer .push_back(doppler_heading_angle);
-  heading_status->yawrate_buffer .push_back(yawrate);
   heading_status->correction_velocity_buffer .push_back(velocity_scale_factor.correction_velocity.linear.x);
   heading_status->yawrate_offset_stop_buffer .push_back(yawrate_offset_stop.yawrate_offset);
   heading_status->yawrate_offset_buffer .push_back(yawrate_offset.yawrate_offset);
   heading_status->slip_angle_buffer .push_back(slip_angle.slip_angle);
   heading_status->gnss_status_buffer .push_back(gnss_status);
 
-  time_buffer_length = std::distance(heading_status->time_buffer .begin(), heading_status->time_buffer .end());
+  buffer_length = std::distance(heading_status->heading_angle_buffer .begin(), heading_status->heading_angle_buffer .end());
 
-  if (time_buffer_length > heading_parameter.estimated_number_max)
+  if (buffer_length > heading_parameter.estimated_number_max)
   {
-    heading_status->time_buffer .erase(heading_status->time_buffer .begin());
     heading_status->heading_angle_buffer .erase(heading_status->heading_angle_buffer .begin());
-    heading_status->yawrate_buffer .erase(heading_status->yawrate_buffer .begin());
     heading_status->correction_velocity_buffer .erase(heading_status->correction_velocity_buffer .begin());
     heading_status->yawrate_offset_stop_buffer .erase(heading_status->yawrate_offset_stop_buffer .begin());
     heading_status->yawrate_offset_buffer .erase(heading_status->yawrate_offset_buffer .begin());
     heading_status->slip_angle_buffer .erase(heading_status->slip_angle_buffer .begin());
     heading_status->gnss_status_buffer .erase(heading_status->gnss_status_buffer .begin());
+    --buffer_length;
   }
+  heading_status->imu_history_cursor = imu_history.end() - buffer_length;
 
-  std::vector<int> gnss_index;
-  std::vector<int> velocity_index;
-  std::vector<int> index;
+  std::vector<int>& gnss_index = heading_status->gnss_index;
+  std::vector<int>& velocity_index = heading_status->velocity_index;
+  std::vector<int>& index = heading_status->index;
+  gnss_index.clear();
+  velocity_index.clear();
+  index.clear();
 
-  if (heading_status->estimated_number  > heading_parameter.estimated_number_min && heading_status->gnss_status_buffer [heading_status->estimated_number -1] == true && heading_status->correction_velocity_buffer [heading_status->estimated_number -1] > heading_parameter.estimated_velocity_threshold && fabsf(heading_status->yawrate_buffer [heading_status->estimated_number -1]) < heading_parameter.estimated_yawrate_threshold)
+  if (heading_status->estimated_number  > heading_parameter.estimated_number_min && heading_status->gnss_status_buffer [heading_status->estimated_number -1] == true && heading_status->correction_velocity_buffer [heading_status->estimated_number -1] > heading_parameter.estimated_velocity_threshold && fabsf(yawrate) < heading_parameter.estimated_yawrate_threshold)
   {
     heading->status.enabled_status = true;
   }
@@ -163,26 +181,34 @@ void heading_estimate(rtklib_msgs::RtklibNav rtklib_nav,sensor_msgs::Imu imu,eag
 
     if (index_length > heading_status->estimated_number  * heading_parameter.estimated_gnss_coefficient)
     {
-      std::vector<double> provisional_heading_angle_buffer(heading_status->estimated_number , 0);
+      std::vector<double>& provisional_heading_angle_buffer = heading_status->provisional_heading_angle_buffer;
+      provisional_heading_angle_buffer.assign(heading_status->estimated_number , 0);
+
+      // The yaw rate part comes from the integral cached in the imu history,
+      // only the offset of this stage is integrated here.
+      uint64_t cursor = heading_status->imu_history_cursor;
+      double offset_integral = 0.0;
 
       for (i = 0; i < heading_status->estimated_number ; i++)
       {
         if (i > 0)
         {
+          double dt = nsecToSec(imu_history.stamp(cursor + i) - imu_history.stamp(cursor + i - 1));
           if (std::abs(heading_status->correction_velocity_buffer [heading_status->estimated_number -1]) > heading_parameter.stop_judgment_velocity_threshold)
           {
-            provisional_heading_angle_buffer[i] = provisional_heading_angle_buffer[i-1] + ((heading_status->yawrate_buffer [i] + heading_status->yawrate_offset_buffer [i]) * (heading_status->time_buffer [i] - heading_status->time_buffer [i-1]));
+            offset_integral += heading_status->yawrate_offset_buffer [i] * dt;
           }
           else
           {
-            provisional_heading_angle_buffer[i] = provisional_heading_angle_buffer[i-1] + ((heading_status->yawrate_buffer [i] + heading_status->yawrate_offset_stop_buffer [i]) * (heading_status->time_buffer [i] - heading_status->time_buffer [i-1]));
+            offset_integral += heading_status->yawrate_offset_stop_buffer [i] * dt;
           }
+          provisional_heading_angle_buffer[i] = yawrate_sign * imu_history.yawIntegral(cursor, cursor + i) + offset_integral;
         }
       }
 
-      std::vector<double> base_heading_angle_buffer;
-      std::vector<double> base_heading_angle_buffer2;
-      std::vector<double> diff_buffer;
+      std::vector<double>& base_heading_angle_buffer = heading_status->base_heading_angle_buffer;
+      std::vector<double>& base_heading_angle_buffer2 = heading_status->base_heading_angle_buffer2;
+      std::vector<double>& diff_buffer = heading_status->diff_buffer;
       std::vector<double> inversion_up_index;
       std::vector<double> inversion_down_index;
 
@@ -192,10 +218,11 @@ void heading_estimate(rtklib_msgs::RtklibNav rtklib_nav,sensor_msgs::Imu imu,eag
      }
 
       int ref_cnt;
-      std::vector<double> heading_angle_buffer2;
+      std::vector<double>& heading_angle_buffer2 = heading_status->heading_angle_buffer2;
 
-      copy(heading_status->heading_angle_buffer .begin(), heading_status->heading_angle_buffer .end(), back_inserter(heading_angle_buffer2) );
+      heading_angle_buffer2.assign(heading_status->heading_angle_buffer .begin(), heading_status->heading_angle_buffer .end());
 
+      base_heading_angle_buffer.clear();
       for (i = 0; i < heading_status->estimated_number ; i++)
       {
         base_heading_angle_buffer.push_back(heading_interpolate.heading_angle - provisional_heading_angle_buffer[index[index_length-1]] + provisional_heading_angle_buffer[i]);
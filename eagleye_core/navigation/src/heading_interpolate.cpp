@@ -39,6 +39,8 @@ void heading_interpolate_estimate(const sensor_msgs::Imu imu, const eagleye_msgs
   double diff_estimate_heading_angle = 0.0;
   bool heading_estimate_status;
   std::size_t imu_stamp_buffer_length;
+  int64_t imu_stamp = stampToNSec(imu.header.stamp);
+  int64_t heading_stamp = stampToNSec(heading.header.stamp);
 
   if (heading_interpolate_parameter.reverse_imu == false)
   {
@@ -67,7 +69,7 @@ void heading_interpolate_estimate(const sensor_msgs::Imu imu, const eagleye_msgs
     heading_interpolate_status->number_buffer = heading_interpolate_parameter.number_buffer_max;
   }
 
-  if (heading_interpolate_status->heading_stamp_last != heading.header.stamp.toSec() && heading.status.estimate_status == true)
+  if (heading_interpolate_status->heading_stamp_last != heading_stamp && heading.status.estimate_status == true)
   {
     heading_estimate_status = true;
     heading_interpolate_status->heading_estimate_start_status = true;
@@ -80,12 +82,12 @@ void heading_interpolate_estimate(const sensor_msgs::Imu imu, const eagleye_msgs
 
   if(heading_interpolate_status->time_last != 0 && std::abs(velocity_scale_factor.correction_velocity.linear.x) > heading_interpolate_parameter.stop_judgment_velocity_threshold)
   {
-    heading_interpolate_status->provisional_heading_angle = heading_interpolate_status->provisional_heading_angle + (yawrate * (imu.header.stamp.toSec() - heading_interpolate_status->time_last));
+    heading_interpolate_status->provisional_heading_angle = heading_interpolate_status->provisional_heading_angle + (yawrate * nsecToSec(imu_stamp - heading_interpolate_status->time_last));
   }
 
   // data buffer generate
   heading_interpolate_status->provisional_heading_angle_buffer.push_back(heading_interpolate_status->provisional_heading_angle);
-  heading_interpolate_status->imu_stamp_buffer.push_back(imu.header.stamp.toSec());
+  heading_interpolate_status->imu_stamp_buffer.push_back(imu_stamp);
   imu_stamp_buffer_length = std::distance(heading_interpolate_status->imu_stamp_buffer.begin(), heading_interpolate_status->imu_stamp_buffer.end());
 
   if (imu_stamp_buffer_length > heading_interpolate_parameter.number_buffer_max)
@@ -100,7 +102,7 @@ void heading_interpolate_estimate(const sensor_msgs::Imu imu, const eagleye_msgs
     {
       for (estimate_index = heading_interpolate_status->number_buffer; estimate_index > 0; estimate_index--)
       {
-        if (heading_interpolate_status->imu_stamp_buffer[estimate_index-1] == heading.header.stamp.toSec())
+        if (heading_interpolate_status->imu_stamp_buffer[estimate_index-1] == heading_stamp)
         {
           break;
         }
@@ -142,7 +144,7 @@ void heading_interpolate_estimate(const sensor_msgs::Imu imu, const eagleye_msgs
     heading_interpolate->status.estimate_status = false;
   }
 
-  heading_interpolate_status->time_last = imu.header.stamp.toSec();
-  heading_interpolate_status->heading_stamp_last = heading.header.stamp.toSec();
+  heading_interpolate_status->time_last = imu_stamp;
+  heading_interpolate_status->heading_stamp_last = heading_stamp;
 
 }
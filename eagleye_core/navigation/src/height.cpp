@@ -33,51 +33,29 @@
 
 #define g 9.80665
 
-void pitching_estimate(const sensor_msgs::Imu imu,const sensor_msgs::NavSatFix fix,const eagleye_msgs::VelocityScaleFactor velocity_scale_factor,const eagleye_msgs::Distance distance,const HeightParameter height_parameter,HeightStatus* height_status,eagleye_msgs::Height* height,eagleye_msgs::Pitching* pitching,eagleye_msgs::AccXOffset* acc_x_offset,eagleye_msgs::AccXScaleFactor* acc_x_scale_factor)
+bool height_window_update(const sensor_msgs::Imu imu,const sensor_msgs::NavSatFix fix,const eagleye_msgs::VelocityScaleFactor velocity_scale_factor,const eagleye_msgs::Distance distance,const HeightParameter height_parameter,HeightStatus* height_status)
 {
+  int64_t imu_stamp = stampToNSec(imu.header.stamp);
   int gps_quality = 0;
   double gnss_height = 0.0;
-  double diff_height = 0.0;
-  double diff_relative_height = 0.0;
-  double diff_relative_height_G = 0.0;
-  double diff_relative_height_diffvel = 0.0;
-  double diff_relative_height_offset = 0.0;
   double correction_relative_height = 0.0;
   bool gnss_status;
   bool data_status = false;
-  int i;
-  int data_num = 0;
-  int max_height_index;
-  double A, B, C, D, E;
-  double avg_height;
-  double tmp_height;
-  double tmp_pitch;
-  int data_num_acc = 0;
-  double sum_acc = 0;
-  double mean_acc = 0;
-  double pitch = 0;
-  double correction_acceleration_linear_x = 0;
-  std::size_t index_length;
-  std::size_t velocity_index_length;
-  std::size_t distance_index_length;
-  std::vector<double>::iterator max_height;
-
-  int buffer_erase_count = 0;
 
 /// GNSS FLAG ///
-  if (height_status->fix_time_last == fix.header.stamp.toSec())
+  if (height_status->fix_time_last == stampToNSec(fix.header.stamp))
   {
     gnss_status = false;
     gnss_height = 0.0;
     gps_quality = 0;
-    height_status->fix_time_last = fix.header.stamp.toSec();
+    height_status->fix_time_last = stampToNSec(fix.header.stamp);
   }
   else
   {
     gnss_status = true;
     gnss_height = fix.altitude;
     gps_quality = fix.status.status;
-    height_status->fix_time_last = fix.header.stamp.toSec();
+    height_status->fix_time_last = stampToNSec(fix.header.stamp);
   }
 
   height_status->flag_reliability = false;
@@ -85,9 +63,9 @@ void pitching_estimate(const sensor_msgs::Imu imu,const sensor_msgs::NavSatFix f
 ///  relative_height  ///
   if (velocity_scale_factor.correction_velocity.linear.x > 0 && height_status->time_last != 0)
   {
-    height_status->relative_height_G += imu.linear_acceleration.x * velocity_scale_factor.correction_velocity.linear.x*(imu.header.stamp.toSec()-height_status->time_last)/g;
+    height_status->relative_height_G += imu.linear_acceleration.x * velocity_scale_factor.correction_velocity.linear.x*nsecToSec(imu_stamp - height_status->time_last)/g;
     height_status->relative_height_diffvel += - (velocity_scale_factor.correction_velocity.linear.x-height_status->correction_velocity_x_last) * velocity_scale_factor.correction_velocity.linear.x/g;
-    height_status->relative_height_offset += velocity_scale_factor.correction_velocity.linear.x*(imu.header.stamp.toSec()-height_status->time_last)/g;
+    height_status->relative_height_offset += velocity_scale_factor.correction_velocity.linear.x*nsecToSec(imu_stamp - height_status->time_last)/g;
     correction_relative_height = height_status->relative_height_G + height_status->relative_height_offset + height_status->relative_height_diffvel;
   }
 
@@ -132,239 +110,274 @@ void pitching_estimate(const sensor_msgs::Imu imu,const sensor_msgs::NavSatFix f
 
   height_status->data_number = height_status->distance_buffer.size();
 
+  height_status->height_fit_status = height_status->estimate_start_status == true && distance.distance > height_parameter.estimated_distance &&
+    gnss_status == true && gps_quality != -1 && data_status == true && velocity_scale_factor.correction_velocity.linear.x > height_parameter.estimated_velocity_threshold;
+
+  return height_status->estimate_start_status == true && gnss_status == true && data_status == true;
+}
+
+void height_window_fit(const HeightParameter height_parameter,HeightStatus* height_status,eagleye_msgs::Height* height,eagleye_msgs::AccXOffset* acc_x_offset,eagleye_msgs::AccXScaleFactor* acc_x_scale_factor)
+{
+  double diff_height = 0.0;
+  double diff_relative_height = 0.0;
+  double diff_relative_height_G = 0.0;
+  double diff_relative_height_diffvel = 0.0;
+  double diff_relative_height_offset = 0.0;
+  int i;
+  int max_height_index;
+  double A, B, C, D, E;
+  double avg_height;
+  double tmp_height;
+  std::size_t index_length;
+  std::size_t velocity_index_length;
+  std::vector<double>::iterator max_height;
+
+  int buffer_erase_count = 0;
+
 ///  acc_x error estimate   ///
-  if (height_status->estimate_start_status == true && gnss_status == true && data_status == true)
-  {
 
 ///  Explanation  ///
 
-    A = 0.0;
-    B = 0.0;
-    C = 0.0;
-    D = 0.0;
-    E = 0.0;
+  A = 0.0;
+  B = 0.0;
+  C = 0.0;
+  D = 0.0;
+  E = 0.0;
 
-    if (height_status->acceleration_SF_estimate_status == true)
-    {
-      for (i = 0; i < height_status->data_number; i++)
-      {
-        diff_height = height_status->height_buffer[i] - height_status->height_buffer[0];
-        diff_relative_height_G = height_status->relative_height_G_buffer[i] - height_status->relative_height_G_buffer[0];
-        diff_relative_height_diffvel = height_status->relative_height_diffvel_buffer[i] - height_status->relative_height_diffvel_buffer[0];
-        diff_relative_height_offset = height_status->relative_height_offset_buffer[i] - height_status->relative_height_offset_buffer[0];
-        A += diff_relative_height_G * diff_relative_height_G;
-        B += 2 * diff_relative_height_G * (diff_relative_height_diffvel - diff_height);
-        C += 2 * diff_relative_height_G * diff_relative_height_offset;
-        D += 2 * diff_relative_height_offset * (diff_relative_height_diffvel - diff_height);
-        E += diff_relative_height_offset * diff_relative_height_offset;
-      }
-      height_status->acceleration_offset_linear_x_last = (2*A*D - C*B)/(C*C - 4*A*E);
-      height_status->acceleration_SF_linear_x_last = (2*E*B - C*D)/(C*C - 4*A*E);
-
-      acc_x_offset->status.enabled_status = true;
-      acc_x_offset->status.estimate_status = true;
-      acc_x_scale_factor->status.enabled_status = true;
-      acc_x_scale_factor->status.estimate_status = true;
-    }
-    else
+  if (height_status->acceleration_SF_estimate_status == true)
+  {
+    for (i = 0; i < height_status->data_number; i++)
     {
-      for (i = 0; i < height_status->data_number; i++)
-      {
-        diff_height = height_status->height_buffer[i] - height_status->height_buffer[0];
-        diff_relative_height = (height_status->relative_height_G_buffer[i] + height_status->relative_height_diffvel_buffer[i])- (height_status->relative_height_G_buffer[0] + height_status->relative_height_diffvel_buffer[0]);
-        diff_relative_height_offset = height_status->relative_height_offset_buffer[i] - height_status->relative_height_offset_buffer[0];
-        A += diff_relative_height_offset * diff_relative_height_offset;
-        B += 2 * diff_relative_height_offset * (diff_height - diff_relative_height);
-      }
-      height_status->acceleration_offset_linear_x_last = B/A/2;
-      height_status->acceleration_SF_linear_x_last = 1;
-      acc_x_offset->status.enabled_status = true;
-      acc_x_offset->status.estimate_status = true;
-      acc_x_scale_factor->status.enabled_status = false;
-      acc_x_scale_factor->status.estimate_status = false;
+      diff_height = height_status->height_buffer[i] - height_status->height_buffer[0];
+      diff_relative_height_G = height_status->relative_height_G_buffer[i] - height_status->relative_height_G_buffer[0];
+      diff_relative_height_diffvel = height_status->relative_height_diffvel_buffer[i] - height_status->relative_height_diffvel_buffer[0];
+      diff_relative_height_offset = height_status->relative_height_offset_buffer[i] - height_status->relative_height_offset_buffer[0];
+      A += diff_relative_height_G * diff_relative_height_G;
+      B += 2 * diff_relative_height_G * (diff_relative_height_diffvel - diff_height);
+      C += 2 * diff_relative_height_G * diff_relative_height_offset;
+      D += 2 * diff_relative_height_offset * (diff_relative_height_diffvel - diff_height);
+      E += diff_relative_height_offset * diff_relative_height_offset;
     }
+    height_status->acceleration_offset_linear_x_last = (2*A*D - C*B)/(C*C - 4*A*E);
+    height_status->acceleration_SF_linear_x_last = (2*E*B - C*D)/(C*C - 4*A*E);
 
+    acc_x_offset->status.enabled_status = true;
+    acc_x_offset->status.estimate_status = true;
+    acc_x_scale_factor->status.enabled_status = true;
+    acc_x_scale_factor->status.estimate_status = true;
+  }
+  else
+  {
     for (i = 0; i < height_status->data_number; i++)
     {
-      height_status->correction_relative_height_buffer[i] = height_status->acceleration_SF_linear_x_last * height_status->relative_height_G_buffer[i] + height_status->relative_height_diffvel_buffer[i] + height_status->acceleration_offset_linear_x_last * height_status->relative_height_offset_buffer[i];
+      diff_height = height_status->height_buffer[i] - height_status->height_buffer[0];
+      diff_relative_height = (height_status->relative_height_G_buffer[i] + height_status->relative_height_diffvel_buffer[i])- (height_status->relative_height_G_buffer[0] + height_status->relative_height_diffvel_buffer[0]);
+      diff_relative_height_offset = height_status->relative_height_offset_buffer[i] - height_status->relative_height_offset_buffer[0];
+      A += diff_relative_height_offset * diff_relative_height_offset;
+      B += 2 * diff_relative_height_offset * (diff_height - diff_relative_height);
     }
+    height_status->acceleration_offset_linear_x_last = B/A/2;
+    height_status->acceleration_SF_linear_x_last = 1;
+    acc_x_offset->status.enabled_status = true;
+    acc_x_offset->status.estimate_status = true;
+    acc_x_scale_factor->status.enabled_status = false;
+    acc_x_scale_factor->status.estimate_status = false;
+  }
+
+  for (i = 0; i < height_status->data_number; i++)
+  {
+    height_status->correction_relative_height_buffer[i] = height_status->acceleration_SF_linear_x_last * height_status->relative_height_G_buffer[i] + height_status->relative_height_diffvel_buffer[i] + height_status->acceleration_offset_linear_x_last * height_status->relative_height_offset_buffer[i];
   }
 
 ///  height estimate  ///
-  if (height_status->estimate_start_status == true)
+  if (height_status->height_fit_status == true)
   {
-    if (distance.distance > height_parameter.estimated_distance && gnss_status == true && gps_quality != -1 && data_status == true && velocity_scale_factor.correction_velocity.linear.x > height_parameter.estimated_velocity_threshold )
+    height_status->correction_relative_height_buffer2.clear();
+    height_status->height_buffer2.clear();
+    for (i = 0; i < height_status->data_number; i++)
     {
-      height_status->correction_relative_height_buffer2.clear();
-      height_status->height_buffer2.clear();
-      for (i = 0; i < height_status->data_number; i++)
-      {
-        height_status->correction_relative_height_buffer2.push_back(height_status->correction_relative_height_buffer[i]);
-        height_status->height_buffer2.push_back(height_status->height_buffer[i]);
-      }
+      height_status->correction_relative_height_buffer2.push_back(height_status->correction_relative_height_buffer[i]);
+      height_status->height_buffer2.push_back(height_status->height_buffer[i]);
+    }
 
-      std::vector<int> distance_index;
-      std::vector<int> velocity_index;
-      std::vector<int> index;
+    std::vector<int>& distance_index = height_status->distance_index;
+    std::vector<int>& velocity_index = height_status->velocity_index;
+    std::vector<int>& index = height_status->index;
+    distance_index.clear();
+    velocity_index.clear();
+    index.clear();
 
-      for (i = 0; i < height_status->data_number; i++)
+    for (i = 0; i < height_status->data_number; i++)
+    {
+      if (height_status->distance_buffer[height_status->data_number-1] - height_status->distance_buffer[i]  <= height_parameter.estimated_distance)
       {
-        if (height_status->distance_buffer[height_status->data_number-1] - height_status->distance_buffer[i]  <= height_parameter.estimated_distance)
-        {
-          distance_index.push_back(i);
+        distance_index.push_back(i);
 
-          if (height_status->correction_velocity_buffer[i] > height_parameter.estimated_velocity_threshold)
-          {
-            velocity_index.push_back(i);
-          }
+        if (height_status->correction_velocity_buffer[i] > height_parameter.estimated_velocity_threshold)
+        {
+          velocity_index.push_back(i);
         }
       }
+    }
 
-      set_intersection(velocity_index.begin(), velocity_index.end(), distance_index.begin(), distance_index.end(),
-                       inserter(index, index.end()));
+    set_intersection(velocity_index.begin(), velocity_index.end(), distance_index.begin(), distance_index.end(),
+                     inserter(index, index.end()));
 
-      index_length = std::distance(index.begin(), index.end());
-      velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
+    index_length = std::distance(index.begin(), index.end());
+    velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
 
-      std::vector<double> base_height_buffer;
-      std::vector<double> base_height_buffer2;
-      std::vector<double> diff_height_buffer;
-      std::vector<double> diff_height_buffer2;
-      std::vector<int> erase_number;
+    std::vector<double>& base_height_buffer = height_status->base_height_buffer;
+    std::vector<double>& base_height_buffer2 = height_status->base_height_buffer2;
+    std::vector<double>& diff_height_buffer = height_status->diff_height_buffer;
+    std::vector<double>& diff_height_buffer2 = height_status->diff_height_buffer2;
+    std::vector<int>& erase_number = height_status->erase_number;
+    erase_number.clear();
 
 
 
-      if (index_length > velocity_index_length * height_parameter.estimated_velocity_coefficient)
+    if (index_length > velocity_index_length * height_parameter.estimated_velocity_coefficient)
+    {
+
+      while (1)
       {
+        index_length = std::distance(index.begin(), index.end());
+        base_height_buffer.clear();
 
-        while (1)
+        for (i = 0; i < height_status->data_number; i++)
         {
-          index_length = std::distance(index.begin(), index.end());
-          base_height_buffer.clear();
-
-          for (i = 0; i < height_status->data_number; i++)
-          {
-            base_height_buffer.push_back(height_status->height_buffer2[index[index_length-1]] - height_status->correction_relative_height_buffer2[index[index_length-1]] +
-                                height_status->correction_relative_height_buffer2[i]);
-          }
+          base_height_buffer.push_back(height_status->height_buffer2[index[index_length-1]] - height_status->correction_relative_height_buffer2[index[index_length-1]] +
+                              height_status->correction_relative_height_buffer2[i]);
+        }
 
-          diff_height_buffer2.clear();
+        diff_height_buffer2.clear();
 
-          for (i = 0; i < index_length; i++)
-          {
-            diff_height_buffer2.push_back(base_height_buffer[index[i]] - height_status->height_buffer2[index[i]]);
-          }
+        for (i = 0; i < index_length; i++)
+        {
+          diff_height_buffer2.push_back(base_height_buffer[index[i]] - height_status->height_buffer2[index[i]]);
+        }
 
-          avg_height = std::accumulate(diff_height_buffer2.begin(), diff_height_buffer2.end(), 0.0) / index_length;
-          tmp_height = height_status->height_buffer2[index[index_length - 1]] - avg_height;
-          base_height_buffer2.clear();
+        avg_height = std::accumulate(diff_height_buffer2.begin(), diff_height_buffer2.end(), 0.0) / index_length;
+        tmp_height = height_status->height_buffer2[index[index_length - 1]] - avg_height;
+        base_height_buffer2.clear();
 
-          for (i = 0; i < height_status->data_number; i++)
-          {
-            base_height_buffer2.push_back(tmp_height - height_status->correction_relative_height_buffer2[index[index_length - 1]] + height_status->correction_relative_height_buffer2[i]);
-          }
+        for (i = 0; i < height_status->data_number; i++)
+        {
+          base_height_buffer2.push_back(tmp_height - height_status->correction_relative_height_buffer2[index[index_length - 1]] + height_status->correction_relative_height_buffer2[i]);
+        }
 
-          diff_height_buffer.clear();
+        diff_height_buffer.clear();
 
-          for (i = 0; i < index_length; i++)
-          {
-            diff_height_buffer.push_back(std::fabs(base_height_buffer2[index[i]] - height_status->height_buffer2[index[i]]));
-          }
+        for (i = 0; i < index_length; i++)
+        {
+          diff_height_buffer.push_back(std::fabs(base_height_buffer2[index[i]] - height_status->height_buffer2[index[i]]));
+        }
 
-          max_height = std::max_element(diff_height_buffer.begin(), diff_height_buffer.end());
-          max_height_index = std::distance(diff_height_buffer.begin(), max_height);
+        max_height = std::max_element(diff_height_buffer.begin(), diff_height_buffer.end());
+        max_height_index = std::distance(diff_height_buffer.begin(), max_height);
 
-          if (diff_height_buffer[max_height_index] > height_parameter.outlier_threshold)
+        if (diff_height_buffer[max_height_index] > height_parameter.outlier_threshold)
+        {
+          if (height_status->height_estimate_start_status != true)
           {
-            if (height_status->height_estimate_start_status != true)
-            {
-              erase_number.push_back(index[max_height_index]);
-              buffer_erase_count =  buffer_erase_count + 1;
-            }
-            else if (index[max_height_index] == height_status->data_number-1)
-            {
-              height_status->height_buffer.erase(height_status->height_buffer.begin() + index[max_height_index]);
-              height_status->relative_height_G_buffer.erase(height_status->relative_height_G_buffer.begin() + index[max_height_index]);
-              height_status->relative_height_diffvel_buffer.erase(height_status->relative_height_diffvel_buffer.begin() + index[max_height_index]);
-              height_status->relative_height_offset_buffer.erase(height_status->relative_height_offset_buffer.begin() + index[max_height_index]);
-              height_status->correction_relative_height_buffer.erase(height_status->correction_relative_height_buffer.begin() + index[max_height_index]);
-              height_status->correction_velocity_buffer.erase(height_status->correction_velocity_buffer.begin() + index[max_height_index]);
-              height_status->distance_buffer.erase(height_status->distance_buffer.begin() + index[max_height_index]);
-            }
-            index.erase(index.begin() + max_height_index);
-
+            erase_number.push_back(index[max_height_index]);
+            buffer_erase_count =  buffer_erase_count + 1;
           }
-          else
+          else if (index[max_height_index] == height_status->data_number-1)
           {
-            break;
+            height_status->height_buffer.erase(height_status->height_buffer.begin() + index[max_height_index]);
+            height_status->relative_height_G_buffer.erase(height_status->relative_height_G_buffer.begin() + index[max_height_index]);
+            height_status->relative_height_diffvel_buffer.erase(height_status->relative_height_diffvel_buffer.begin() + index[max_height_index]);
+            height_status->relative_height_offset_buffer.erase(height_status->relative_height_offset_buffer.begin() + index[max_height_index]);
+            height_status->correction_relative_height_buffer.erase(height_status->correction_relative_height_buffer.begin() + index[max_height_index]);
+            height_status->correction_velocity_buffer.erase(height_status->correction_velocity_buffer.begin() + index[max_height_index]);
+            height_status->distance_buffer.erase(height_status->distance_buffer.begin() + index[max_height_index]);
           }
+          index.erase(index.begin() + max_height_index);
 
+        }
+        else
+        {
+          break;
+        }
 
 
-          index_length = std::distance(index.begin(), index.end());
-          velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
 
-          if (index_length < velocity_index_length * height_parameter.estimated_height_coefficient)
-          {
-            break;
-          }
+        index_length = std::distance(index.begin(), index.end());
+        velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
+
+        if (index_length < velocity_index_length * height_parameter.estimated_height_coefficient)
+        {
+          break;
         }
+      }
 
-        if(height_status->height_estimate_start_status != true)
+      if(height_status->height_estimate_start_status != true)
+      {
+        std::sort(erase_number.begin(), erase_number.end(), std::greater<int>() );
+        for(i=0;i<buffer_erase_count;i++)
         {
-          std::sort(erase_number.begin(), erase_number.end(), std::greater<int>() );
-          for(i=0;i<buffer_erase_count;i++)
-          {
-            height_status->height_buffer.erase(height_status->height_buffer.begin() + erase_number[i]);
-            height_status->relative_height_G_buffer.erase(height_status->relative_height_G_buffer.begin() + erase_number[i]);
-            height_status->relative_height_diffvel_buffer.erase(height_status->relative_height_diffvel_buffer.begin() + erase_number[i]);
-            height_status->relative_height_offset_buffer.erase(height_status->relative_height_offset_buffer.begin() + erase_number[i]);
-            height_status->correction_relative_height_buffer.erase(height_status->correction_relative_height_buffer.begin() + erase_number[i]);
-            height_status->correction_velocity_buffer.erase(height_status->correction_velocity_buffer.begin() + erase_number[i]);
-            height_status->distance_buffer.erase(height_status->distance_buffer.begin() + erase_number[i]);
-          }
+          height_status->height_buffer.erase(height_status->height_buffer.begin() + erase_number[i]);
+          height_status->relative_height_G_buffer.erase(height_status->relative_height_G_buffer.begin() + erase_number[i]);
+          height_status->relative_height_diffvel_buffer.erase(height_status->relative_height_diffvel_buffer.begin() + erase_number[i]);
+          height_status->relative_height_offset_buffer.erase(height_status->relative_height_offset_buffer.begin() + erase_number[i]);
+          height_status->correction_relative_height_buffer.erase(height_status->correction_relative_height_buffer.begin() + erase_number[i]);
+          height_status->correction_velocity_buffer.erase(height_status->correction_velocity_buffer.begin() + erase_number[i]);
+          height_status->distance_buffer.erase(height_status->distance_buffer.begin() + erase_number[i]);
         }
+      }
 
 
 
-        height_status->height_estimate_start_status = true;
+      height_status->height_estimate_start_status = true;
 
-        index_length = std::distance(index.begin(), index.end());
-        velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
+      index_length = std::distance(index.begin(), index.end());
+      velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
 
-        if (index_length >= velocity_index_length * height_parameter.estimated_height_coefficient)
+      if (index_length >= velocity_index_length * height_parameter.estimated_height_coefficient)
+      {
+        if (index[index_length - 1] == height_status->data_number-1)
         {
-          if (index[index_length - 1] == height_status->data_number-1)
-          {
-            height_status->height_last = tmp_height;
-            height->status.enabled_status = true;
-            height->status.estimate_status = true;
-            height_status->flag_reliability = true;
-          }
-          else
-          {
-            height_status->height_last = tmp_height + (height_status->correction_relative_height_buffer2[height_status->data_number - 1]
-              - height_status->correction_relative_height_buffer2[index[index_length - 1]]);
-            height->status.enabled_status = true;
-            height->status.estimate_status = true;
-            height_status->flag_reliability = false;
-          }
+          height_status->height_last = tmp_height;
+          height->status.enabled_status = true;
+          height->status.estimate_status = true;
+          height_status->flag_reliability = true;
+        }
+        else
+        {
+          height_status->height_last = tmp_height + (height_status->correction_relative_height_buffer2[height_status->data_number - 1]
+            - height_status->correction_relative_height_buffer2[index[index_length - 1]]);
+          height->status.enabled_status = true;
+          height->status.estimate_status = true;
+          height_status->flag_reliability = false;
         }
       }
     }
-    else
-    {
-      height_status->height_last += ((imu.linear_acceleration.x * height_status->acceleration_SF_linear_x_last + height_status->acceleration_offset_linear_x_last)
-      - (velocity_scale_factor.correction_velocity.linear.x-height_status->correction_velocity_x_last)/(imu.header.stamp.toSec()-height_status->time_last))
-      * velocity_scale_factor.correction_velocity.linear.x*(imu.header.stamp.toSec()-height_status->time_last)/g;
-      height->status.enabled_status = true;
-      height->status.estimate_status = false;
-    }
+  }
+}
+
+void height_propagate(const sensor_msgs::Imu imu,const eagleye_msgs::VelocityScaleFactor velocity_scale_factor,const HeightParameter height_parameter,HeightStatus* height_status,eagleye_msgs::Height* height,eagleye_msgs::Pitching* pitching,eagleye_msgs::AccXOffset* acc_x_offset,eagleye_msgs::AccXScaleFactor* acc_x_scale_factor)
+{
+  int64_t imu_stamp = stampToNSec(imu.header.stamp);
+  int i;
+  double tmp_pitch;
+  int data_num_acc = 0;
+  double sum_acc = 0;
+  double mean_acc = 0;
+  double correction_acceleration_linear_x = 0;
+
+///  height dead reckoning between fits  ///
+  if (height_status->estimate_start_status == true && height_status->height_fit_status != true)
+  {
+    height_status->height_last += ((imu.linear_acceleration.x * height_status->acceleration_SF_linear_x_last + height_status->acceleration_offset_linear_x_last)
+    - (velocity_scale_factor.correction_velocity.linear.x-height_status->correction_velocity_x_last)/nsecToSec(imu_stamp - height_status->time_last))
+    * velocity_scale_factor.correction_velocity.linear.x*nsecToSec(imu_stamp - height_status->time_last)/g;
+    height->status.enabled_status = true;
+    height->status.estimate_status = false;
   }
 
 ///  pitch  ///
   correction_acceleration_linear_x = imu.linear_acceleration.x * height_status->acceleration_SF_linear_x_last + height_status->acceleration_offset_linear_x_last;
-  height_status->acc_buffer.push_back((correction_acceleration_linear_x - (velocity_scale_factor.correction_velocity.linear.x-height_status->correction_velocity_x_last)/(imu.header.stamp.toSec()-height_status->time_last)));
+  height_status->acc_buffer.push_back((correction_acceleration_linear_x - (velocity_scale_factor.correction_velocity.linear.x-height_status->correction_velocity_x_last)/nsecToSec(imu_stamp - height_status->time_last)));
   data_num_acc = height_status->acc_buffer.size();
 
   if (data_num_acc > height_parameter.average_num)
@@ -408,7 +421,16 @@ if (data_num_acc >= height_parameter.average_num && height_status->estimate_star
   height->height = height_status->height_last;
   pitching->pitching_angle = tmp_pitch;
 
-  height_status->time_last = imu.header.stamp.toSec();
+  height_status->time_last = imu_stamp;
   height_status->correction_velocity_x_last = velocity_scale_factor.correction_velocity.linear.x;
   height_status->pitching_angle_last = tmp_pitch;
 }
+
+void pitching_estimate(const sensor_msgs::Imu imu,const sensor_msgs::NavSatFix fix,const eagleye_msgs::VelocityScaleFactor velocity_scale_factor,const eagleye_msgs::Distance distance,const HeightParameter height_parameter,HeightStatus* height_status,eagleye_msgs::Height* height,eagleye_msgs::Pitching* pitching,eagleye_msgs::AccXOffset* acc_x_offset,eagleye_msgs::AccXScaleFactor* acc_x_scale_factor)
+{
+  if (height_window_update(imu, fix, velocity_scale_factor, distance, height_parameter, height_status))
+  {
+    height_window_fit(height_parameter, height_status, height, acc_x_offset, acc_x_scale_factor);
+  }
+  height_propagate(imu, velocity_scale_factor, height_parameter, height_status, height, pitching, acc_x_offset, acc_x_scale_factor);
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * imu_history.cpp
+ * Author MapIV Sekino
+ */
+
+#include "navigation/navigation.hpp"
+#include "navigation/checkpoint.hpp"
+
+ImuHistory::ImuHistory()
+  : samples_(), end_(0)
+{
+}
+
+void ImuHistory::requireCapacity(std::size_t capacity)
+{
+  if (samples_.capacity() < capacity)
+  {
+    samples_.set_capacity(capacity);
+  }
+}
+
+void ImuHistory::append(const sensor_msgs::Imu& imu)
+{
+  Sample sample;
+  sample.stamp = stampToNSec(imu.header.stamp);
+  sample.yaw_integral = 0;
+  if (!samples_.empty())
+  {
+    const Sample& last = samples_.back();
+    sample.yaw_integral = last.yaw_integral + imu.angular_velocity.z * nsecToSec(sample.stamp - last.stamp);
+  }
+  if (samples_.capacity() == 0)
+  {
+    samples_.set_capacity(1);
+  }
+  samples_.push_back(sample);
+  ++end_;
+}
+
+void ImuHistory::saveCheckpoint(CheckpointWriter* checkpoint) const
+{
+  checkpoint->section("imu_history");
+  checkpoint->field(static_cast<uint64_t>(samples_.capacity()));
+  checkpoint->field(end_);
+  checkpoint->field(static_cast<uint64_t>(samples_.size()));
+  for (std::size_t i = 0; i < samples_.size(); i++)
+  {
+    checkpoint->field(samples_[i].stamp);
+    checkpoint->field(samples_[i].yaw_integral);
+  }
+}
+
+void ImuHistory::loadCheckpoint(CheckpointReader* checkpoint)
+{
+  uint64_t capacity, size;
+  checkpoint->section("imu_history");
+  checkpoint->field(capacity);
+  checkpoint->field(end_);
+  checkpoint->field(size);
+  if (size > capacity || size > end_)
+  {
+    throw std::runtime_error("checkpoint holds an invalid imu history");
+  }
+  samples_.clear();
+  requireCapacity(capacity);
+  for (uint64_t i = 0; i < size; i++)
+  {
+    Sample sample;
+    checkpoint->field(sample.stamp);
+    checkpoint->field(sample.yaw_integral);
+    samples_.push_back(sample);
+  }
+}
@@ -31,25 +31,17 @@
 #include "coordinate/coordinate.hpp"
 #include "navigation/navigation.hpp"
 
-void position_estimate(rtklib_msgs::RtklibNav rtklib_nav,eagleye_msgs::VelocityScaleFactor velocity_scale_factor,eagleye_msgs::Distance distance,eagleye_msgs::Heading heading_interpolate_3rd,geometry_msgs::Vector3Stamped enu_vel,PositionParameter position_parameter, PositionStatus* position_status, eagleye_msgs::Position* enu_absolute_pos)
+bool position_window_update(rtklib_msgs::RtklibNav rtklib_nav,eagleye_msgs::VelocityScaleFactor velocity_scale_factor,eagleye_msgs::Distance distance,eagleye_msgs::Heading heading_interpolate_3rd,geometry_msgs::Vector3Stamped enu_vel,PositionParameter position_parameter, PositionStatus* position_status, eagleye_msgs::Position* enu_absolute_pos)
 {
+  int64_t imu_stamp = stampToNSec(enu_vel.header.stamp);
 
-  int i;
   int estimated_number_max = position_parameter.estimated_distance/position_parameter.separation_distance;
-  int max_x_index, max_y_index;
   double ecef_pos[3];
   double ecef_base_pos[3];
-  double avg_x, avg_y, avg_z;
-  double tmp_enu_pos_x, tmp_enu_pos_y, tmp_enu_pos_z;
   double enu_pos[3];
-  bool data_status, gnss_status, gnss_update;
-  std::size_t index_length;
-  std::size_t velocity_index_length;
-  std::vector<double> base_enu_pos_x_buffer, base_enu_pos_y_buffer, base_enu_pos_z_buffer;
-  std::vector<double> diff_x_buffer2, diff_y_buffer2, diff_z_buffer2;
-  std::vector<double> base_enu_pos_x_buffer2,  base_enu_pos_y_buffer2, base_enu_pos_z_buffer2;
-  std::vector<double> diff_x_buffer, diff_y_buffer, diff_z_buffer;
-  std::vector<double>::iterator max_x, max_y;
+  bool data_status = false;
+  bool gnss_status, gnss_update;
+  bool fit_status;
 
   if(enu_absolute_pos->ecef_base_pos.x == 0 && enu_absolute_pos->ecef_base_pos.y == 0 && enu_absolute_pos->ecef_base_pos.z == 0)
   {
@@ -133,9 +125,9 @@ void position_estimate(rtklib_msgs::RtklibNav rtklib_nav,eagleye_msgs::VelocityS
 
   if(position_status->time_last != 0)
   {
-    position_status->enu_relative_pos_x = position_status->enu_relative_pos_x + enu_vel.vector.x * (enu_vel.header.stamp.toSec() - position_status->time_last);
-    position_status->enu_relative_pos_y = position_status->enu_relative_pos_y + enu_vel.vector.y * (enu_vel.header.stamp.toSec() - position_status->time_last);
-    position_status->enu_relative_pos_z = position_status->enu_relative_pos_z + enu_vel.vector.z * (enu_vel.header.stamp.toSec() - position_status->time_last);
+    position_status->enu_relative_pos_x = position_status->enu_relative_pos_x + enu_vel.vector.x * nsecToSec(imu_stamp - position_status->time_last);
+    position_status->enu_relative_pos_y = position_status->enu_relative_pos_y + enu_vel.vector.y * nsecToSec(imu_stamp - position_status->time_last);
+    position_status->enu_relative_pos_z = position_status->enu_relative_pos_z + enu_vel.vector.z * nsecToSec(imu_stamp - position_status->time_last);
   }
 
 
@@ -178,153 +170,184 @@ void position_estimate(rtklib_msgs::RtklibNav rtklib_nav,eagleye_msgs::VelocityS
     position_status->distance_last = distance.distance;
   }
 
-  if (data_status == true)
+  fit_status = data_status == true && distance.distance > position_parameter.estimated_distance && gnss_status == true &&
+    velocity_scale_factor.correction_velocity.linear.x > position_parameter.estimated_velocity_threshold && position_status->heading_estimate_status_count > 0;
+
+  position_status->time_last = imu_stamp;
+  return fit_status;
+}
+
+void position_window_fit(const PositionParameter position_parameter, PositionStatus* position_status, eagleye_msgs::Position* enu_absolute_pos)
+{
+  int i;
+  int max_x_index, max_y_index;
+  double avg_x, avg_y, avg_z;
+  double tmp_enu_pos_x, tmp_enu_pos_y, tmp_enu_pos_z;
+  std::size_t index_length;
+  std::size_t velocity_index_length;
+  std::vector<double>& base_enu_pos_x_buffer = position_status->base_enu_pos_x_buffer;
+  std::vector<double>& base_enu_pos_y_buffer = position_status->base_enu_pos_y_buffer;
+  std::vector<double>& base_enu_pos_z_buffer = position_status->base_enu_pos_z_buffer;
+  std::vector<double>& diff_x_buffer2 = position_status->diff_x_buffer2;
+  std::vector<double>& diff_y_buffer2 = position_status->diff_y_buffer2;
+  std::vector<double>& diff_z_buffer2 = position_status->diff_z_buffer2;
+  std::vector<double>& base_enu_pos_x_buffer2 = position_status->base_enu_pos_x_buffer2;
+  std::vector<double>& base_enu_pos_y_buffer2 = position_status->base_enu_pos_y_buffer2;
+  std::vector<double>& base_enu_pos_z_buffer2 = position_status->base_enu_pos_z_buffer2;
+  std::vector<double>& diff_x_buffer = position_status->diff_x_buffer;
+  std::vector<double>& diff_y_buffer = position_status->diff_y_buffer;
+  std::vector<double>& diff_z_buffer = position_status->diff_z_buffer;
+  std::vector<double>::iterator max_x, max_y;
+
+  std::vector<int>& distance_index = position_status->distance_index;
+  std::vector<int>& velocity_index = position_status->velocity_index;
+  std::vector<int>& index = position_status->index;
+  distance_index.clear();
+  velocity_index.clear();
+  index.clear();
+
+  for (i = 0; i < position_status->estimated_number; i++)
+  {
+    if (position_status->distance_buffer[position_status->estimated_number-1] - position_status->distance_buffer[i]  <= position_parameter.estimated_distance)
+    {
+      distance_index.push_back(i);
+
+      if (position_status->correction_velocity_buffer[i] > position_parameter.estimated_velocity_threshold)
+      {
+        velocity_index.push_back(i);
+      }
+
+    }
+  }
+
+  set_intersection(velocity_index.begin(), velocity_index.end(), distance_index.begin(), distance_index.end(),
+                   inserter(index, index.end()));
+
+  index_length = std::distance(index.begin(), index.end());
+  velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
+
+  if (index_length > velocity_index_length * position_parameter.estimated_enu_vel_coefficient)
   {
 
-    if (distance.distance > position_parameter.estimated_distance && gnss_status == true && velocity_scale_factor.correction_velocity.linear.x > position_parameter.estimated_velocity_threshold && position_status->heading_estimate_status_count > 0)
+    while (1)
     {
-      std::vector<int> distance_index;
-      std::vector<int> velocity_index;
-      std::vector<int> index;
+      index_length = std::distance(index.begin(), index.end());
+
+      base_enu_pos_x_buffer.clear();
+      base_enu_pos_y_buffer.clear();
+      base_enu_pos_z_buffer.clear();
 
       for (i = 0; i < position_status->estimated_number; i++)
       {
-        if (position_status->distance_buffer[position_status->estimated_number-1] - position_status->distance_buffer[i]  <= position_parameter.estimated_distance)
-        {
-          distance_index.push_back(i);
+        base_enu_pos_x_buffer.push_back(position_status->enu_pos_x_buffer[index[index_length-1]] - position_status->enu_relative_pos_x_buffer[index[index_length-1]] +
+                            position_status->enu_relative_pos_x_buffer[i]);
+        base_enu_pos_y_buffer.push_back(position_status->enu_pos_y_buffer[index[index_length-1]] - position_status->enu_relative_pos_y_buffer[index[index_length-1]] +
+                            position_status->enu_relative_pos_y_buffer[i]);
+        base_enu_pos_z_buffer.push_back(position_status->enu_pos_z_buffer[index[index_length-1]] - position_status->enu_relative_pos_z_buffer[index[index_length-1]] +
+                            position_status->enu_relative_pos_z_buffer[i]);
+      }
 
-          if (position_status->correction_velocity_buffer[i] > position_parameter.estimated_velocity_threshold)
-          {
-            velocity_index.push_back(i);
-          }
+      diff_x_buffer2.clear();
+      diff_y_buffer2.clear();
+      diff_z_buffer2.clear();
 
-        }
+      for (i = 0; i < index_length; i++)
+      {
+        diff_x_buffer2.push_back(base_enu_pos_x_buffer[index[i]] - position_status->enu_pos_x_buffer[index[i]]);
+        diff_y_buffer2.push_back(base_enu_pos_y_buffer[index[i]] - position_status->enu_pos_y_buffer[index[i]]);
+        diff_z_buffer2.push_back(base_enu_pos_z_buffer[index[i]] - position_status->enu_pos_z_buffer[index[i]]);
       }
 
-      set_intersection(velocity_index.begin(), velocity_index.end(), distance_index.begin(), distance_index.end(),
-                       inserter(index, index.end()));
+      avg_x = std::accumulate(diff_x_buffer2.begin(), diff_x_buffer2.end(), 0.0) / index_length;
+      avg_y = std::accumulate(diff_y_buffer2.begin(), diff_y_buffer2.end(), 0.0) / index_length;
+      avg_z = std::accumulate(diff_z_buffer2.begin(), diff_z_buffer2.end(), 0.0) / index_length;
 
-      index_length = std::distance(index.begin(), index.end());
-      velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
+      tmp_enu_pos_x = position_status->enu_pos_x_buffer[index[index_length - 1]] - avg_x;
+      tmp_enu_pos_y = position_status->enu_pos_y_buffer[index[index_length - 1]] - avg_y;
+      tmp_enu_pos_z = position_status->enu_pos_z_buffer[index[index_length - 1]] - avg_z;
+
+      base_enu_pos_x_buffer2.clear();
+      base_enu_pos_y_buffer2.clear();
+      base_enu_pos_z_buffer2.clear();
 
-      if (index_length > velocity_index_length * position_parameter.estimated_enu_vel_coefficient)
+      for (i = 0; i < position_status->estimated_number; i++)
       {
+        base_enu_pos_x_buffer2.push_back(tmp_enu_pos_x - position_status->enu_relative_pos_x_buffer[index[index_length - 1]] + position_status->enu_relative_pos_x_buffer[i]);
+        base_enu_pos_y_buffer2.push_back(tmp_enu_pos_y - position_status->enu_relative_pos_y_buffer[index[index_length - 1]] + position_status->enu_relative_pos_y_buffer[i]);
+        base_enu_pos_z_buffer2.push_back(tmp_enu_pos_z - position_status->enu_relative_pos_z_buffer[index[index_length - 1]] + position_status->enu_relative_pos_z_buffer[i]);
+      }
 
-        while (1)
-        {
-          index_length = std::distance(index.begin(), index.end());
-
-          base_enu_pos_x_buffer.clear();
-          base_enu_pos_y_buffer.clear();
-          base_enu_pos_z_buffer.clear();
-
-          for (i = 0; i < position_status->estimated_number; i++)
-          {
-            base_enu_pos_x_buffer.push_back(position_status->enu_pos_x_buffer[index[index_length-1]] - position_status->enu_relative_pos_x_buffer[index[index_length-1]] +
-                                position_status->enu_relative_pos_x_buffer[i]);
-            base_enu_pos_y_buffer.push_back(position_status->enu_pos_y_buffer[index[index_length-1]] - position_status->enu_relative_pos_y_buffer[index[index_length-1]] +
-                                position_status->enu_relative_pos_y_buffer[i]);
-            base_enu_pos_z_buffer.push_back(position_status->enu_pos_z_buffer[index[index_length-1]] - position_status->enu_relative_pos_z_buffer[index[index_length-1]] +
-                                position_status->enu_relative_pos_z_buffer[i]);
-          }
-
-          diff_x_buffer2.clear();
-          diff_y_buffer2.clear();
-          diff_z_buffer2.clear();
-
-          for (i = 0; i < index_length; i++)
-          {
-            diff_x_buffer2.push_back(base_enu_pos_x_buffer[index[i]] - position_status->enu_pos_x_buffer[index[i]]);
-            diff_y_buffer2.push_back(base_enu_pos_y_buffer[index[i]] - position_status->enu_pos_y_buffer[index[i]]);
-            diff_z_buffer2.push_back(base_enu_pos_z_buffer[index[i]] - position_status->enu_pos_z_buffer[index[i]]);
-          }
-
-          avg_x = std::accumulate(diff_x_buffer2.begin(), diff_x_buffer2.end(), 0.0) / index_length;
-          avg_y = std::accumulate(diff_y_buffer2.begin(), diff_y_buffer2.end(), 0.0) / index_length;
-          avg_z = std::accumulate(diff_z_buffer2.begin(), diff_z_buffer2.end(), 0.0) / index_length;
-
-          tmp_enu_pos_x = position_status->enu_pos_x_buffer[index[index_length - 1]] - avg_x;
-          tmp_enu_pos_y = position_status->enu_pos_y_buffer[index[index_length - 1]] - avg_y;
-          tmp_enu_pos_z = position_status->enu_pos_z_buffer[index[index_length - 1]] - avg_z;
-
-          base_enu_pos_x_buffer2.clear();
-          base_enu_pos_y_buffer2.clear();
-          base_enu_pos_z_buffer2.clear();
-
-          for (i = 0; i < position_status->estimated_number; i++)
-          {
-            base_enu_pos_x_buffer2.push_back(tmp_enu_pos_x - position_status->enu_relative_pos_x_buffer[index[index_length - 1]] + position_status->enu_relative_pos_x_buffer[i]);
-            base_enu_pos_y_buffer2.push_back(tmp_enu_pos_y - position_status->enu_relative_pos_y_buffer[index[index_length - 1]] + position_status->enu_relative_pos_y_buffer[i]);
-            base_enu_pos_z_buffer2.push_back(tmp_enu_pos_z - position_status->enu_relative_pos_z_buffer[index[index_length - 1]] + position_status->enu_relative_pos_z_buffer[i]);
-          }
-
-          diff_x_buffer.clear();
-          diff_y_buffer.clear();
-          diff_z_buffer.clear();
-
-          for (i = 0; i < index_length; i++)
-          {
-            diff_x_buffer.push_back(fabsf(base_enu_pos_x_buffer2[index[i]] - position_status->enu_pos_x_buffer[index[i]]));
-            diff_y_buffer.push_back(fabsf(base_enu_pos_y_buffer2[index[i]] - position_status->enu_pos_y_buffer[index[i]]));
-            diff_z_buffer.push_back(fabsf(base_enu_pos_z_buffer2[index[i]] - position_status->enu_pos_z_buffer[index[i]]));
-          }
-
-          max_x = std::max_element(diff_x_buffer.begin(), diff_x_buffer.end());
-          max_y = std::max_element(diff_y_buffer.begin(), diff_y_buffer.end());
-
-          max_x_index = std::distance(diff_x_buffer.begin(), max_x);
-          max_y_index = std::distance(diff_y_buffer.begin(), max_y);
-
-          if(diff_x_buffer[max_x_index] < diff_y_buffer[max_y_index])
-          {
-            if (diff_x_buffer[max_x_index] > position_parameter.outlier_threshold)
-            {
-              index.erase(index.begin() + max_x_index);
-            }
-            else
-            {
-              break;
-            }
-          }
-          else
-          {
-            if (diff_y_buffer[max_y_index] > position_parameter.outlier_threshold)
-            {
-              index.erase(index.begin() + max_y_index);
-            }
-            else
-            {
-              break;
-            }
-          }
-
-          index_length = std::distance(index.begin(), index.end());
-          velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
-
-          if (index_length < velocity_index_length * position_parameter.estimated_position_coefficient)
-          {
-            break;
-          }
+      diff_x_buffer.clear();
+      diff_y_buffer.clear();
+      diff_z_buffer.clear();
 
-        }
+      for (i = 0; i < index_length; i++)
+      {
+        diff_x_buffer.push_back(fabsf(base_enu_pos_x_buffer2[index[i]] - position_status->enu_pos_x_buffer[index[i]]));
+        diff_y_buffer.push_back(fabsf(base_enu_pos_y_buffer2[index[i]] - position_status->enu_pos_y_buffer[index[i]]));
+        diff_z_buffer.push_back(fabsf(base_enu_pos_z_buffer2[index[i]] - position_status->enu_pos_z_buffer[index[i]]));
+      }
+
+      max_x = std::max_element(diff_x_buffer.begin(), diff_x_buffer.end());
+      max_y = std::max_element(diff_y_buffer.begin(), diff_y_buffer.end());
 
-        index_length = std::distance(index.begin(), index.end());
-        velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
+      max_x_index = std::distance(diff_x_buffer.begin(), max_x);
+      max_y_index = std::distance(diff_y_buffer.begin(), max_y);
 
-        if (index_length >= velocity_index_length * position_parameter.estimated_position_coefficient)
+      if(diff_x_buffer[max_x_index] < diff_y_buffer[max_y_index])
+      {
+        if (diff_x_buffer[max_x_index] > position_parameter.outlier_threshold)
+        {
+          index.erase(index.begin() + max_x_index);
+        }
+        else
+        {
+          break;
+        }
+      }
+      else
+      {
+        if (diff_y_buffer[max_y_index] > position_parameter.outlier_threshold)
+        {
+          index.erase(index.begin() + max_y_index);
+        }
+        else
         {
-          if (index[index_length - 1] == position_status->estimated_number-1)
-          {
-            enu_absolute_pos->enu_pos.x = tmp_enu_pos_x;
-            enu_absolute_pos->enu_pos.y = tmp_enu_pos_y;
-            enu_absolute_pos->enu_pos.z = tmp_enu_pos_z;
-            enu_absolute_pos->status.enabled_status = true;
-            enu_absolute_pos->status.estimate_status = true;
-          }
+          break;
         }
       }
+
+      index_length = std::distance(index.begin(), index.end());
+      velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
+
+      if (index_length < velocity_index_length * position_parameter.estimated_position_coefficient)
+      {
+        break;
+      }
+
     }
+
+    index_length = std::distance(index.begin(), index.end());
+    velocity_index_length = std::distance(velocity_index.begin(), velocity_index.end());
+
+    if (index_length >= velocity_index_length * position_parameter.estimated_position_coefficient)
+    {
+      if (index[index_length - 1] == position_status->estimated_number-1)
+      {
+        enu_absolute_pos->enu_pos.x = tmp_enu_pos_x;
+        enu_absolute_pos->enu_pos.y = tmp_enu_pos_y;
+        enu_absolute_pos->enu_pos.z = tmp_enu_pos_z;
+        enu_absolute_pos->status.enabled_status = true;
+        enu_absolute_pos->status.estimate_status = true;
+      }
+    }
+  }
+}
+
+void position_estimate(rtklib_msgs::RtklibNav rtklib_nav,eagleye_msgs::VelocityScaleFactor velocity_scale_factor,eagleye_msgs::Distance distance,eagleye_msgs::Heading heading_interpolate_3rd,geometry_msgs::Vector3Stamped enu_vel,PositionParameter position_parameter, PositionStatus* position_status, eagleye_msgs::Position* enu_absolute_pos)
+{
+  if (position_window_update(rtklib_nav, velocity_scale_factor, distance, heading_interpolate_3rd, enu_vel, position_parameter, position_status, enu_absolute_pos))
+  {
+    position_window_fit(position_parameter, position_status, enu_absolute_pos);
   }
-  position_status->time_last = enu_vel.header.stamp.toSec();
-  data_status = false;
 }
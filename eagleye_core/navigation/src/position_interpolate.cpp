@@ -45,6 +45,8 @@ void position_interpolate_estimate(eagleye_msgs::Position enu_absolute_pos, geom
   double diff_estimate_enu_pos_z = 0.0;
   bool position_estimate_status;
   std::size_t imu_stamp_buffer_length;
+  int64_t imu_stamp = stampToNSec(enu_vel.header.stamp);
+  int64_t position_stamp = stampToNSec(enu_absolute_pos.header.stamp);
 
   enu_absolute_pos_interpolate->ecef_base_pos = enu_absolute_pos.ecef_base_pos;
 
@@ -57,7 +59,7 @@ void position_interpolate_estimate(eagleye_msgs::Position enu_absolute_pos, geom
     position_interpolate_status->number_buffer = position_interpolate_parameter.number_buffer_max;
   }
 
-  if (position_interpolate_status->position_stamp_last != enu_absolute_pos.header.stamp.toSec() && enu_absolute_pos.status.estimate_status == true)
+  if (position_interpolate_status->position_stamp_last != position_stamp && enu_absolute_pos.status.estimate_status == true)
   {
     position_estimate_status = true;
     position_interpolate_status->position_estimate_start_status = true;
@@ -70,16 +72,16 @@ void position_interpolate_estimate(eagleye_msgs::Position enu_absolute_pos, geom
 
   if(position_interpolate_status->time_last != 0 && std::sqrt((enu_vel.vector.x * enu_vel.vector.x) + (enu_vel.vector.y * enu_vel.vector.y) + (enu_vel.vector.z * enu_vel.vector.z)) > position_interpolate_parameter.stop_judgment_velocity_threshold)
   {
-    position_interpolate_status->provisional_enu_pos_x = enu_absolute_pos_interpolate->enu_pos.x + enu_vel.vector.x * (enu_vel.header.stamp.toSec() - position_interpolate_status->time_last);
-    position_interpolate_status->provisional_enu_pos_y = enu_absolute_pos_interpolate->enu_pos.y + enu_vel.vector.y * (enu_vel.header.stamp.toSec() - position_interpolate_status->time_last);
-    position_interpolate_status->provisional_enu_pos_z = enu_absolute_pos_interpolate->enu_pos.z + enu_vel.vector.z * (enu_vel.header.stamp.toSec() - position_interpolate_status->time_last);
+    position_interpolate_status->provisional_enu_pos_x = enu_absolute_pos_interpolate->enu_pos.x + enu_vel.vector.x * nsecToSec(imu_stamp - position_interpolate_status->time_last);
+    position_interpolate_status->provisional_enu_pos_y = enu_absolute_pos_interpolate->enu_pos.y + enu_vel.vector.y * nsecToSec(imu_stamp - position_interpolate_status->time_last);
+    position_interpolate_status->provisional_enu_pos_z = enu_absolute_pos_interpolate->enu_pos.z + enu_vel.vector.z * nsecToSec(imu_stamp - position_interpolate_status->time_last);
   }
 
   // data buffer generate
   position_interpolate_status->provisional_enu_pos_x_buffer.push_back(position_interpolate_status->provisional_enu_pos_x);
   position_interpolate_status->provisional_enu_pos_y_buffer.push_back(position_interpolate_status->provisional_enu_pos_y);
   position_interpolate_status->provisional_enu_pos_z_buffer.push_back(position_interpolate_status->provisional_enu_pos_z);
-  position_interpolate_status->imu_stamp_buffer.push_back(enu_vel.header.stamp.toSec());
+  position_interpolate_status->imu_stamp_buffer.push_back(imu_stamp);
   imu_stamp_buffer_length = std::distance(position_interpolate_status->imu_stamp_buffer.begin(), position_interpolate_status->imu_stamp_buffer.end());
 
   if (imu_stamp_buffer_length > position_interpolate_parameter.number_buffer_max)
@@ -96,7 +98,7 @@ void position_interpolate_estimate(eagleye_msgs::Position enu_absolute_pos, geom
     {
       for (estimate_index = position_interpolate_status->number_buffer; estimate_index > 0; estimate_index--)
       {
-        if (position_interpolate_status->imu_stamp_buffer[estimate_index-1] == enu_absolute_pos.header.stamp.toSec())
+        if (position_interpolate_status->imu_stamp_buffer[estimate_index-1] == position_stamp)
         {
           break;
         }
@@ -176,6 +178,6 @@ void position_interpolate_estimate(eagleye_msgs::Position enu_absolute_pos, geom
     eagleye_fix->altitude = 0;
   }
 
-  position_interpolate_status->time_last = enu_vel.header.stamp.toSec();
-  position_interpolate_status->position_stamp_last = enu_absolute_pos.header.stamp.toSec();
+  position_interpolate_status->time_last = imu_stamp;
+  position_interpolate_status->position_stamp_last = position_stamp;
 }
@@ -33,6 +33,7 @@
 
 void rtk_deadreckoning_estimate(rtklib_msgs::RtklibNav rtklib_nav,geometry_msgs::Vector3Stamped enu_vel, sensor_msgs::NavSatFix fix,  eagleye_msgs::Heading heading, RtkDeadreckoningParameter rtk_deadreckoning_parameter, RtkDeadreckoningStatus* rtk_deadreckoning_status, eagleye_msgs::Position* enu_absolute_rtk_deadreckoning,sensor_msgs::NavSatFix* eagleye_fix)
 {
+  int64_t imu_stamp = stampToNSec(enu_vel.header.stamp);
 
   double enu_pos[3],enu_rtk[3];
   double ecef_base_pos[3];
@@ -47,7 +48,7 @@ void rtk_deadreckoning_estimate(rtklib_msgs::RtklibNav rtklib_nav,geometry_msgs:
     rtk_deadreckoning_status->ecef_base_pos_status = true;
     rtk_deadreckoning_status->position_estimate_start_status = true;
   }
-  else if(!rtk_deadreckoning_status->ecef_base_pos_status && rtklib_nav.header.stamp.toSec() != 0)
+  else if(!rtk_deadreckoning_status->ecef_base_pos_status && !rtklib_nav.header.stamp.isZero())
   {
     enu_absolute_rtk_deadreckoning->ecef_base_pos.x = rtklib_nav.ecef_pos.x;
     enu_absolute_rtk_deadreckoning->ecef_base_pos.y = rtklib_nav.ecef_pos.y;
@@ -94,7 +95,7 @@ void rtk_deadreckoning_estimate(rtklib_msgs::RtklibNav rtklib_nav,geometry_msgs:
     enu_rtk[1] = tmp_pos.getY();
     enu_rtk[2] = tmp_pos.getZ();
 
-    if (rtk_deadreckoning_status->position_stamp_last != fix.header.stamp.toSec() && fix.status.status == 0)
+    if (rtk_deadreckoning_status->position_stamp_last != stampToNSec(fix.header.stamp) && fix.status.status == 0)
     {
       rtk_deadreckoning_status->provisional_enu_pos_x = enu_rtk[0];
       rtk_deadreckoning_status->provisional_enu_pos_y = enu_rtk[1];
@@ -104,9 +105,9 @@ void rtk_deadreckoning_estimate(rtklib_msgs::RtklibNav rtklib_nav,geometry_msgs:
     }
     else if(rtk_deadreckoning_status->time_last != 0 && sqrt((enu_vel.vector.x * enu_vel.vector.x) + (enu_vel.vector.y * enu_vel.vector.y) + (enu_vel.vector.z * enu_vel.vector.z)) > rtk_deadreckoning_parameter.stop_judgment_velocity_threshold)
     {
-      rtk_deadreckoning_status->provisional_enu_pos_x = enu_absolute_rtk_deadreckoning->enu_pos.x + enu_vel.vector.x * (enu_vel.header.stamp.toSec() - rtk_deadreckoning_status->time_last);
-      rtk_deadreckoning_status->provisional_enu_pos_y = enu_absolute_rtk_deadreckoning->enu_pos.y + enu_vel.vector.y * (enu_vel.header.stamp.toSec() - rtk_deadreckoning_status->time_last);
-      rtk_deadreckoning_status->provisional_enu_pos_z = enu_absolute_rtk_deadreckoning->enu_pos.z + enu_vel.vector.z * (enu_vel.header.stamp.toSec() - rtk_deadreckoning_status->time_last);
+      rtk_deadreckoning_status->provisional_enu_pos_x = enu_absolute_rtk_deadreckoning->enu_pos.x + enu_vel.vector.x * nsecToSec(imu_stamp - rtk_deadreckoning_status->time_last);
+      rtk_deadreckoning_status->provisional_enu_pos_y = enu_absolute_rtk_deadreckoning->enu_pos.y + enu_vel.vector.y * nsecToSec(imu_stamp - rtk_deadreckoning_status->time_last);
+      rtk_deadreckoning_status->provisional_enu_pos_z = enu_absolute_rtk_deadreckoning->enu_pos.z + enu_vel.vector.z * nsecToSec(imu_stamp - rtk_deadreckoning_status->time_last);
       enu_absolute_rtk_deadreckoning->status.enabled_status = true;
       enu_absolute_rtk_deadreckoning->status.estimate_status = false;
     }
@@ -125,8 +126,8 @@ void rtk_deadreckoning_estimate(rtklib_msgs::RtklibNav rtklib_nav,geometry_msgs:
     enu_absolute_rtk_deadreckoning->enu_pos.y = enu_pos[1];
     enu_absolute_rtk_deadreckoning->enu_pos.z = enu_pos[2];
 
-    rtk_deadreckoning_status->time_last = enu_vel.header.stamp.toSec();
-    rtk_deadreckoning_status->position_stamp_last = fix.header.stamp.toSec();
+    rtk_deadreckoning_status->time_last = imu_stamp;
+    rtk_deadreckoning_status->position_stamp_last = stampToNSec(fix.header.stamp);
   }
   else
   {
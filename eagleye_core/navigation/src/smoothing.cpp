@@ -44,8 +44,8 @@ void smoothing_estimate(rtklib_msgs::RtklibNav rtklib_nav, eagleye_msgs::Velocit
   std::size_t index_length;
   std::size_t time_buffer_length;
   std::size_t velocity_index_length;
-  std::vector<int> velocity_index;
-  std::vector<int> index;
+  std::vector<int>& velocity_index = smoothing_status->velocity_index;
+  std::vector<int>& index = smoothing_status->index;
 
 
   if(gnss_smooth_pos_enu->ecef_base_pos.x == 0 && gnss_smooth_pos_enu->ecef_base_pos.y == 0 && gnss_smooth_pos_enu->ecef_base_pos.z == 0)
@@ -85,7 +85,7 @@ void smoothing_estimate(rtklib_msgs::RtklibNav rtklib_nav, eagleye_msgs::Velocit
   }
 
   if(gnss_update == true){
-    smoothing_status->time_buffer.push_back(rtklib_nav.header.stamp.toSec());
+    smoothing_status->time_buffer.push_back(stampToNSec(rtklib_nav.header.stamp));
     smoothing_status->enu_pos_x_buffer.push_back(enu_pos[0]);
     smoothing_status->enu_pos_y_buffer.push_back(enu_pos[1]);
     smoothing_status->enu_pos_z_buffer.push_back(enu_pos[2]);
@@ -114,6 +114,8 @@ void smoothing_estimate(rtklib_msgs::RtklibNav rtklib_nav, eagleye_msgs::Velocit
     }
 
     if (smoothing_status->estimated_number == smoothing_parameter.estimated_number_max){
+      velocity_index.clear();
+      index.clear();
       for (i = 0; i < smoothing_status->estimated_number; i++)
       {
         index.push_back(i);
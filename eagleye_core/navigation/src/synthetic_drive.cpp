@@ -0,0 +1,386 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * synthetic_drive.cpp
+ * Author MapIV Sekino
+ */
+
+#include "navigation/synthetic_drive.hpp"
+#include "coordinate/coordinate.hpp"
+#include <algorithm>
+#include <cmath>
+
+static const double gravity = 9.80665;
+
+void setDefaultSyntheticDriveParameter(SyntheticDriveParameter* parameter)
+{
+  *parameter = SyntheticDriveParameter();
+  parameter->start_time = 1.6e9;
+  parameter->imu_rate = 50;
+  parameter->gnss_rate = 5;
+  parameter->route_period = 600;
+  parameter->cruise_velocity = 12;
+  parameter->slope_amplitude = 0.03;
+  parameter->slope_period = 200;
+  parameter->latitude = 35.0;
+  parameter->longitude = 137.0;
+  parameter->altitude = 50.0;
+  parameter->initial_heading = 0.5;
+
+  parameter->gyro_bias = 0.002;
+  parameter->gyro_bias_drift = 0;
+  parameter->gyro_noise = 0;
+  parameter->acc_offset = 0;
+  parameter->acc_scale = 1;
+  parameter->acc_noise = 0;
+  parameter->wheel_scale_factor = 1.02;
+  parameter->wheel_speed_noise = 0;
+
+  parameter->gnss_fix_position_noise = 0;
+  parameter->gnss_float_position_noise = 0.5;
+  parameter->gnss_velocity_noise = 0;
+  parameter->multipath_probability = 0;
+  parameter->multipath_magnitude = 10;
+  parameter->float_probability = 0;
+  parameter->float_duration = 30;
+  parameter->seed = 0;
+}
+
+SyntheticDrive::SyntheticDrive()
+{
+  setDefaultSyntheticDriveParameter(&parameter_);
+  init();
+}
+
+SyntheticDrive::SyntheticDrive(const SyntheticDriveParameter& parameter) : parameter_(parameter)
+{
+  init();
+}
+
+void SyntheticDrive::init()
+{
+  sample_ = SyntheticDriveSample();
+  random_.seed(parameter_.seed);
+  imu_period_ = 1 / parameter_.imu_rate;
+  gnss_decimation_ = static_cast<unsigned long>(std::max(1.0, std::round(parameter_.imu_rate / parameter_.gnss_rate)));
+  time_ = parameter_.start_time;
+  count_ = 0;
+  heading_ = parameter_.initial_heading;
+  distance_ = 0;
+  gyro_bias_ = parameter_.gyro_bias;
+  float_end_time_ = -1;
+  tow_ = 0;
+  enu_pos_[0] = 0;
+  enu_pos_[1] = 0;
+  enu_pos_[2] = 0;
+  llh_base_pos_[0] = parameter_.latitude * M_PI / 180;
+  llh_base_pos_[1] = parameter_.longitude * M_PI / 180;
+  llh_base_pos_[2] = parameter_.altitude;
+  llh2xyz(llh_base_pos_, ecef_base_pos_);
+  sample_.gnss_state = GNSS_STATE_NONE;
+}
+
+double SyntheticDrive::velocity(double t) const
+{
+  double period = parameter_.route_period;
+  double tau = std::fmod(t, period);
+  if (tau < 20 || tau >= period - 10)
+  {
+    return 0;
+  }
+  if (tau < 30)
+  {
+    return parameter_.cruise_velocity * (tau - 20) / 10;
+  }
+  if (tau >= period - 20)
+  {
+    return parameter_.cruise_velocity * (period - 10 - tau) / 10;
+  }
+  return parameter_.cruise_velocity;
+}
+
+// 28 s straight followed by a 12 s quarter turn, alternating left and right.
+double SyntheticDrive::yawrate(double t) const
+{
+  double period = parameter_.route_period;
+  double tau = std::fmod(t, period);
+  if (tau < 30 || tau >= period - 20)
+  {
+    return 0;
+  }
+  int segment = static_cast<int>((tau - 30) / 40);
+  double segment_time = std::fmod(tau - 30, 40);
+  if (segment_time < 28 || tau - segment_time + 40 > period - 20)
+  {
+    return 0;
+  }
+  return (segment % 2 == 0 ? 1 : -1) * (M_PI / 2) / 12;
+}
+
+double SyntheticDrive::pitch(double t) const
+{
+  return parameter_.slope_amplitude * std::sin(2 * M_PI * t / parameter_.slope_period);
+}
+
+bool SyntheticDrive::activeEvent(int type, double t, double* magnitude) const
+{
+  for (std::size_t i = 0; i < parameter_.gnss_events.size(); i++)
+  {
+    const SyntheticGnssEvent& event = parameter_.gnss_events[i];
+    if (event.type == type && t >= event.start && t < event.start + event.duration)
+    {
+      *magnitude = event.magnitude;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void enu2ecef(const double enu[3], const double llh_base_pos[3], double ecef[3])
+{
+  double sin_lat = std::sin(llh_base_pos[0]), cos_lat = std::cos(llh_base_pos[0]);
+  double sin_lon = std::sin(llh_base_pos[1]), cos_lon = std::cos(llh_base_pos[1]);
+
+  ecef[0] = -sin_lon * enu[0] - sin_lat * cos_lon * enu[1] + cos_lat * cos_lon * enu[2];
+  ecef[1] = cos_lon * enu[0] - sin_lat * sin_lon * enu[1] + cos_lat * sin_lon * enu[2];
+  ecef[2] = cos_lat * enu[1] + sin_lat * enu[2];
+}
+
+void SyntheticDrive::updateGnss(double t, const double enu_vel[3], const ros::Time& stamp)
+{
+  SyntheticDriveSample& s = sample_;
+  double magnitude = 0;
+
+  tow_ += static_cast<unsigned int>(1000 * gnss_decimation_ * imu_period_ + 0.5);
+
+  if (activeEvent(GNSS_OUTAGE, t, &magnitude))
+  {
+    s.gnss_updated = false;
+    s.gnss_state = GNSS_STATE_NONE;
+    s.multipath = false;
+    return;
+  }
+
+  if (activeEvent(GNSS_FLOAT, t, &magnitude) || t < float_end_time_)
+  {
+    s.gnss_state = GNSS_STATE_FLOAT;
+  }
+  else if (parameter_.float_probability > 0 && uniform_(random_) < parameter_.float_probability)
+  {
+    s.gnss_state = GNSS_STATE_FLOAT;
+    float_end_time_ = t + parameter_.float_duration;
+  }
+  else
+  {
+    s.gnss_state = GNSS_STATE_FIX;
+  }
+
+  s.multipath = activeEvent(GNSS_MULTIPATH, t, &magnitude);
+  if (!s.multipath && parameter_.multipath_probability > 0 && uniform_(random_) < parameter_.multipath_probability)
+  {
+    s.multipath = true;
+    magnitude = parameter_.multipath_magnitude;
+  }
+
+  double sigma = s.gnss_state == GNSS_STATE_FIX ? parameter_.gnss_fix_position_noise : parameter_.gnss_float_position_noise;
+  double enu_pos[3], enu_vel_error[3];
+  for (int i = 0; i < 3; i++)
+  {
+    enu_pos[i] = enu_pos_[i] + sigma * normal_(random_);
+    enu_vel_error[i] = enu_vel[i] + parameter_.gnss_velocity_noise * normal_(random_);
+  }
+  if (s.multipath)
+  {
+    double direction = 2 * M_PI * uniform_(random_);
+    enu_pos[0] += magnitude * std::sin(direction);
+    enu_pos[1] += magnitude * std::cos(direction);
+    enu_pos[2] += magnitude / 2;
+  }
+
+  double ecef_pos[3], ecef_vel[3], llh_pos[3];
+  enu2ecef(enu_pos, llh_base_pos_, ecef_pos);
+  for (int i = 0; i < 3; i++)
+  {
+    ecef_pos[i] += ecef_base_pos_[i];
+  }
+  enu2ecef(enu_vel_error, llh_base_pos_, ecef_vel);
+  ecef2llh(ecef_pos, llh_pos);
+
+  s.gnss_updated = true;
+  s.rtklib_nav.header.stamp = stamp;
+  s.rtklib_nav.header.frame_id = "gnss";
+  s.rtklib_nav.tow = tow_;
+  s.rtklib_nav.ecef_pos.x = ecef_pos[0];
+  s.rtklib_nav.ecef_pos.y = ecef_pos[1];
+  s.rtklib_nav.ecef_pos.z = ecef_pos[2];
+  s.rtklib_nav.ecef_vel.x = ecef_vel[0];
+  s.rtklib_nav.ecef_vel.y = ecef_vel[1];
+  s.rtklib_nav.ecef_vel.z = ecef_vel[2];
+  s.rtklib_nav.status.header.stamp = stamp;
+  s.rtklib_nav.status.header.frame_id = "gnss";
+  s.rtklib_nav.status.status.status = s.gnss_state == GNSS_STATE_FIX ? 0 : -1;
+  s.rtklib_nav.status.latitude = llh_pos[0] * 180 / M_PI;
+  s.rtklib_nav.status.longitude = llh_pos[1] * 180 / M_PI;
+  s.rtklib_nav.status.altitude = llh_pos[2];
+
+  s.fix = s.rtklib_nav.status;
+}
+
+const SyntheticDriveSample& SyntheticDrive::next()
+{
+  double t = time_ - parameter_.start_time;
+  double v = velocity(t);
+  double w = yawrate(t);
+  double theta = pitch(t);
+  double dv = (velocity(t + imu_period_) - v) / imu_period_;
+
+  heading_ += w * imu_period_;
+  enu_pos_[0] += v * std::sin(heading_) * std::cos(theta) * imu_period_;
+  enu_pos_[1] += v * std::cos(heading_) * std::cos(theta) * imu_period_;
+  enu_pos_[2] += v * std::sin(theta) * imu_period_;
+  distance_ += v * imu_period_;
+  gyro_bias_ += parameter_.gyro_bias_drift * std::sqrt(imu_period_) * normal_(random_);
+
+  ros::Time stamp;
+  stamp.fromSec(time_);
+  bool moving = v > 0.01;
+  double wheel_scale_factor = parameter_.wheel_scale_factor;
+
+  SyntheticDriveSample& s = sample_;
+
+  s.imu.header.stamp = stamp;
+  s.imu.header.frame_id = "imu";
+  s.imu.angular_velocity.x = 0;
+  s.imu.angular_velocity.y = 0;
+  s.imu.angular_velocity.z = w + gyro_bias_ + parameter_.gyro_noise * normal_(random_);
+  s.imu.linear_acceleration.x = parameter_.acc_scale * (dv + gravity * std::sin(theta)) + parameter_.acc_offset +
+                                parameter_.acc_noise * normal_(random_);
+  s.imu.linear_acceleration.y = parameter_.acc_scale * v * w + parameter_.acc_noise * normal_(random_);
+  s.imu.linear_acceleration.z = parameter_.acc_scale * gravity * std::cos(theta) + parameter_.acc_noise * normal_(random_);
+
+  s.twist.header.stamp = stamp;
+  s.twist.header.frame_id = "base_link";
+  s.twist.twist.linear.x = moving ? v * wheel_scale_factor + parameter_.wheel_speed_noise * normal_(random_) : 0;
+  s.twist.twist.angular.z = w;
+
+  double enu_vel[3];
+  enu_vel[0] = v * std::sin(heading_) * std::cos(theta);
+  enu_vel[1] = v * std::cos(heading_) * std::cos(theta);
+  enu_vel[2] = v * std::sin(theta);
+
+  s.gnss_updated = false;
+  if (count_ % gnss_decimation_ == 0)
+  {
+    updateGnss(t, enu_vel, stamp);
+  }
+  bool gnss_updated = s.gnss_updated;
+
+  double ecef_pos[3], llh_pos[3];
+  enu2ecef(enu_pos_, llh_base_pos_, ecef_pos);
+  for (int i = 0; i < 3; i++)
+  {
+    ecef_pos[i] += ecef_base_pos_[i];
+  }
+  ecef2llh(ecef_pos, llh_pos);
+  s.truth_fix.header.stamp = stamp;
+  s.truth_fix.header.frame_id = "gnss";
+  s.truth_fix.status.status = 0;
+  s.truth_fix.latitude = llh_pos[0] * 180 / M_PI;
+  s.truth_fix.longitude = llh_pos[1] * 180 / M_PI;
+  s.truth_fix.altitude = llh_pos[2];
+
+  s.velocity_scale_factor.header.stamp = stamp;
+  s.velocity_scale_factor.scale_factor = 1 / wheel_scale_factor;
+  s.velocity_scale_factor.correction_velocity.linear.x = v;
+  s.velocity_scale_factor.correction_velocity.angular.z = w;
+  s.velocity_scale_factor.status.enabled_status = true;
+  s.velocity_scale_factor.status.estimate_status = gnss_updated && v > 2.78;
+
+  s.distance.header.stamp = stamp;
+  s.distance.distance = distance_;
+  s.distance.status.enabled_status = true;
+  s.distance.status.estimate_status = true;
+
+  s.yawrate_offset_stop.header.stamp = stamp;
+  s.yawrate_offset_stop.yawrate_offset = -gyro_bias_;
+  s.yawrate_offset_stop.status.enabled_status = true;
+  s.yawrate_offset_stop.status.estimate_status = !moving;
+
+  s.yawrate_offset.header.stamp = stamp;
+  s.yawrate_offset.yawrate_offset = -gyro_bias_;
+  s.yawrate_offset.status.enabled_status = true;
+  s.yawrate_offset.status.estimate_status = false;
+  s.slip_angle.header.stamp = stamp;
+  s.slip_angle.slip_angle = 0;
+  s.slip_angle.status.enabled_status = true;
+
+  double heading_angle = std::fmod(heading_, 2 * M_PI);
+  if (heading_angle < 0)
+  {
+    heading_angle += 2 * M_PI;
+  }
+  s.heading.header.stamp = stamp;
+  s.heading.heading_angle = heading_angle;
+  s.heading.status.enabled_status = gnss_updated && v > 2.78;
+  s.heading.status.estimate_status = gnss_updated && v > 2.78 && w == 0;
+
+  s.heading_interpolate.header.stamp = stamp;
+  s.heading_interpolate.heading_angle = heading_angle;
+  s.heading_interpolate.status.enabled_status = distance_ > 0;
+  s.heading_interpolate.status.estimate_status = s.heading.status.estimate_status;
+
+  s.pitching.header.stamp = stamp;
+  s.pitching.pitching_angle = theta;
+  s.pitching.status.enabled_status = true;
+  s.pitching.status.estimate_status = true;
+
+  s.height.header.stamp = stamp;
+  s.height.height = llh_base_pos_[2] + enu_pos_[2];
+  s.height.status.enabled_status = true;
+  s.height.status.estimate_status = gnss_updated;
+
+  s.enu_vel.header.stamp = stamp;
+  s.enu_vel.vector.x = enu_vel[0];
+  s.enu_vel.vector.y = enu_vel[1];
+  s.enu_vel.vector.z = enu_vel[2];
+
+  s.enu_absolute_pos.header.stamp = stamp;
+  s.enu_absolute_pos.enu_pos.x = enu_pos_[0];
+  s.enu_absolute_pos.enu_pos.y = enu_pos_[1];
+  s.enu_absolute_pos.enu_pos.z = enu_pos_[2];
+  s.enu_absolute_pos.ecef_base_pos.x = ecef_base_pos_[0];
+  s.enu_absolute_pos.ecef_base_pos.y = ecef_base_pos_[1];
+  s.enu_absolute_pos.ecef_base_pos.z = ecef_base_pos_[2];
+  s.enu_absolute_pos.status.enabled_status = true;
+  s.enu_absolute_pos.status.estimate_status = gnss_updated && v > 2.78;
+
+  s.gnss_smooth_pos = s.enu_absolute_pos;
+  s.gnss_smooth_pos.status.estimate_status = gnss_updated;
+
+  count_++;
+  time_ = parameter_.start_time + count_ * imu_period_;
+  return sample_;
+}
@@ -103,10 +103,14 @@ void velocity_scale_factor_estimate(const rtklib_msgs::RtklibNav rtklib_nav, con
     velocity_scale_factor_status->velocity_buffer.erase(velocity_scale_factor_status->velocity_buffer.begin());
   }
 
-  std::vector<int> gnss_index;
-  std::vector<int> velocity_index;
-  std::vector<int> index;
-  std::vector<double> velocity_scale_factor_buffer;
+  std::vector<int>& gnss_index = velocity_scale_factor_status->gnss_index;
+  std::vector<int>& velocity_index = velocity_scale_factor_status->velocity_index;
+  std::vector<int>& index = velocity_scale_factor_status->index;
+  std::vector<double>& velocity_scale_factor_buffer = velocity_scale_factor_status->velocity_scale_factor_buffer;
+  gnss_index.clear();
+  velocity_index.clear();
+  index.clear();
+  velocity_scale_factor_buffer.clear();
 
   if (velocity_scale_factor_status->estimated_number > velocity_scale_factor_parameter.estimated_number_min && velocity_scale_factor_status->gnss_status_buffer[velocity_scale_factor_status->estimated_number - 1] == true && velocity_scale_factor_status->velocity_buffer[velocity_scale_factor_status->estimated_number - 1] > velocity_scale_factor_parameter.estimated_velocity_threshold)
   {
@@ -151,11 +155,9 @@ void velocity_scale_factor_estimate(const rtklib_msgs::RtklibNav rtklib_nav, con
   {
     // median
     size_t size = velocity_scale_factor_buffer.size();
-    double* t = new double[size];
-    std::copy(velocity_scale_factor_buffer.begin(), velocity_scale_factor_buffer.end(), t);
+    double* t = velocity_scale_factor_buffer.data();
     std::sort(t, &t[size]);
     raw_velocity_scale_factor = size % 2 ? t[size / 2] : (t[(size / 2) - 1] + t[size / 2]) / 2;
-    delete[] t;
     velocity_scale_factor->scale_factor = raw_velocity_scale_factor;
   }
   else if (velocity_scale_factor->status.estimate_status == false)
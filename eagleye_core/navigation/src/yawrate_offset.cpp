@@ -31,18 +31,32 @@
 #include "coordinate/coordinate.hpp"
 #include "navigation/navigation.hpp"
 
-void yawrate_offset_estimate(const eagleye_msgs::VelocityScaleFactor velocity_scale_factor, const eagleye_msgs::YawrateOffset yawrate_offset_stop,const eagleye_msgs::Heading heading_interpolate,const sensor_msgs::Imu imu, const YawrateOffsetParameter yawrate_offset_parameter, YawrateOffsetStatus* yawrate_offset_status, eagleye_msgs::YawrateOffset* yawrate_offset)
+void yawrate_offset_estimate(const eagleye_msgs::VelocityScaleFactor velocity_scale_factor, const eagleye_msgs::YawrateOffset yawrate_offset_stop,const eagleye_msgs::Heading heading_interpolate, const ImuHistory& imu_history, const YawrateOffsetParameter yawrate_offset_parameter, YawrateOffsetStatus* yawrate_offset_status, eagleye_msgs::YawrateOffset* yawrate_offset)
 {
   int i;
-  double yawrate = 0.0;
+  double yawrate_sign = 1.0;
   double sum_xy, sum_x, sum_y, sum_x2;
   bool estimated_condition_status;
 
   std::size_t index_length;
-  std::size_t time_buffer_length;
+  std::size_t buffer_length;
   std::size_t inversion_up_index_length;
   std::size_t inversion_down_index_length;
 
+  // The window is the last buffer_length samples of the imu history. If the
+  // history moved on without this estimator, the window no longer lines up
+  // with it and is started over.
+  buffer_length = yawrate_offset_status->heading_angle_buffer.size();
+  if (buffer_length > 0 && (!imu_history.contains(yawrate_offset_status->imu_history_cursor) ||
+      yawrate_offset_status->imu_history_cursor + buffer_length + 1 != imu_history.end()))
+  {
+    yawrate_offset_status->heading_angle_buffer.clear();
+    yawrate_offset_status->correction_velocity_buffer.clear();
+    yawrate_offset_status->heading_estimate_status_buffer.clear();
+    yawrate_offset_status->yawrate_offset_stop_buffer.clear();
+    yawrate_offset_status->estimated_number = 0;
+  }
+
   if (yawrate_offset_status->estimated_number < yawrate_offset_parameter.estimated_number_max)
   {
     ++yawrate_offset_status->estimated_number;
@@ -54,32 +68,30 @@ void yawrate_offset_estimate(const eagleye_msgs::VelocityScaleFactor velocity_sc
 
   if (yawrate_offset_parameter.reverse_imu == false)
   {
-    yawrate = imu.angular_velocity.z;
+    yawrate_sign = 1.0;
   }
   else if (yawrate_offset_parameter.reverse_imu == true)
   {
-    yawrate = -1 * imu.angular_velocity.z;
+    yawrate_sign = -1.0;
   }
 
   // data buffer generate
-  yawrate_offset_status->time_buffer.push_back(imu.header.stamp.toSec());
-  yawrate_offset_status->yawrate_buffer.push_back(yawrate);
   yawrate_offset_status->heading_angle_buffer.push_back(heading_interpolate.heading_angle);
   yawrate_offset_status->correction_velocity_buffer.push_back(velocity_scale_factor.correction_velocity.linear.x);
   yawrate_offset_status->heading_estimate_status_buffer.push_back(heading_interpolate.status.estimate_status);
   yawrate_offset_status->yawrate_offset_stop_buffer.push_back(yawrate_offset_stop.yawrate_offset);
 
-  time_buffer_length = std::distance(yawrate_offset_status->time_buffer.begin(), yawrate_offset_status->time_buffer.end());
+  buffer_length = std::distance(yawrate_offset_status->heading_angle_buffer.begin(), yawrate_offset_status->heading_angle_buffer.end());
 
-  if (time_buffer_length > yawrate_offset_parameter.estimated_number_max)
+  if (buffer_length > yawrate_offset_parameter.estimated_number_max)
   {
-    yawrate_offset_status->time_buffer.erase(yawrate_offset_status->time_buffer.begin());
-    yawrate_offset_status->yawrate_buffer.erase(yawrate_offset_status->yawrate_buffer.begin());
     yawrate_offset_status->heading_angle_buffer.erase(yawrate_offset_status->heading_angle_buffer.begin());
     yawrate_offset_status->correction_velocity_buffer.erase(yawrate_offset_status->correction_velocity_buffer.begin());
     yawrate_offset_status->heading_estimate_status_buffer.erase(yawrate_offset_status->heading_estimate_status_buffer.begin());
     yawrate_offset_status->yawrate_offset_stop_buffer.erase(yawrate_offset_status->yawrate_offset_stop_buffer.begin());
+    --buffer_length;
   }
+  yawrate_offset_status->imu_history_cursor = imu_history.end() - buffer_length;
 
   if (yawrate_offset_status->estimated_preparation_conditions == 0 && yawrate_offset_status->heading_estimate_status_buffer[yawrate_offset_status->estimated_number - 1] == true)
   {
@@ -106,9 +118,12 @@ void yawrate_offset_estimate(const eagleye_msgs::VelocityScaleFactor velocity_sc
     estimated_condition_status = false;
   }
 
-  std::vector<int> velocity_index;
-  std::vector<int> heading_estimate_status_index;
-  std::vector<int> index;
+  std::vector<int>& velocity_index = yawrate_offset_status->velocity_index;
+  std::vector<int>& heading_estimate_status_index = yawrate_offset_status->heading_estimate_status_index;
+  std::vector<int>& index = yawrate_offset_status->index;
+  velocity_index.clear();
+  heading_estimate_status_index.clear();
+  index.clear();
 
   if (estimated_condition_status == true)
   {
@@ -131,31 +146,34 @@ void yawrate_offset_estimate(const eagleye_msgs::VelocityScaleFactor velocity_sc
 
     if (index_length > yawrate_offset_status->estimated_number * yawrate_offset_parameter.estimated_coefficient)
     {
-      std::vector<double> provisional_heading_angle_buffer(yawrate_offset_status->estimated_number, 0);
+      std::vector<double>& provisional_heading_angle_buffer = yawrate_offset_status->provisional_heading_angle_buffer;
+      provisional_heading_angle_buffer.assign(yawrate_offset_status->estimated_number, 0);
+
+      uint64_t cursor = yawrate_offset_status->imu_history_cursor;
 
       for (i = 0; i < yawrate_offset_status->estimated_number; i++)
       {
         if (i > 0)
         {
-          provisional_heading_angle_buffer[i] = provisional_heading_angle_buffer[i-1] + yawrate_offset_status->yawrate_buffer[i] * (yawrate_offset_status->time_buffer[i] - yawrate_offset_status->time_buffer[i-1]);
+          provisional_heading_angle_buffer[i] = yawrate_sign * imu_history.yawIntegral(cursor, cursor + i);
         }
       }
 
-      std::vector<double> base_heading_angle_buffer;
-      std::vector<double> diff_buffer;
-      std::vector<double> time_buffer2;
+      std::vector<double>& base_heading_angle_buffer = yawrate_offset_status->base_heading_angle_buffer;
+      std::vector<double>& diff_buffer = yawrate_offset_status->diff_buffer;
+      std::vector<double>& time_buffer2 = yawrate_offset_status->time_buffer2;
       std::vector<double> inversion_up_index;
       std::vector<double> inversion_down_index;
 
       index_length = std::distance(index.begin(), index.end());
 
-      //base_heading_angle_buffer.clear();
+      base_heading_angle_buffer.clear();
       for (i = 0; i < yawrate_offset_status->estimated_number; i++)
       {
         base_heading_angle_buffer.push_back(yawrate_offset_status->heading_angle_buffer[index[index_length-1]] - provisional_heading_angle_buffer[index[index_length-1]] + provisional_heading_angle_buffer[i]);
       }
 
-      //diff_buffer.clear();
+      diff_buffer.clear();
       for (i = 0; i < index_length; i++)
       {
         // diff_buffer.push_back(base_heading_angle_buffer[index[i]] - heading_angle_buffer[index[i]]);
@@ -166,7 +184,7 @@ void yawrate_offset_estimate(const eagleye_msgs::VelocityScaleFactor velocity_sc
       time_buffer2.clear();
       for (i = 0; i < index_length; i++)
       {
-        time_buffer2.push_back(yawrate_offset_status->time_buffer[index[i]] - yawrate_offset_status->time_buffer[index[0]]);
+        time_buffer2.push_back(nsecToSec(imu_history.stamp(cursor + index[i]) - imu_history.stamp(cursor + index[0])));
       }
 
       // Least-square
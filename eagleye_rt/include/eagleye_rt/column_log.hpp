@@ -0,0 +1,155 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * column_log.hpp
+ * Author MapIV Sekino
+ */
+
+// Columnar log of sensor inputs and eagleye outputs for offline work. A log
+// is one file with a number of tables, one per topic. Every table has an
+// int64 stamp column [ns], sorted, and float64 data columns of the same
+// length, each stored as one contiguous array. The reader maps the file and
+// hands out pointers into the mapping, so nothing is parsed or copied, and
+// lowerBound() seeks a table by stamp with a binary search.
+//
+// Layout, little endian, every offset a multiple of 8 from the file start:
+//   ColumnLogHeader
+//   per table: ColumnLogTableEntry, then column_count ColumnLogColumnEntry
+//   the stamp and data arrays
+// Errors are reported as std::runtime_error.
+
+#ifndef COLUMN_LOG_H
+#define COLUMN_LOG_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+const uint32_t COLUMN_LOG_VERSION = 1;
+
+struct ColumnLogHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t table_count;
+};
+
+struct ColumnLogTableEntry
+{
+  char name[64];
+  char frame_id[64];
+  uint64_t row_count;
+  uint64_t column_count;
+  uint64_t stamp_offset;
+};
+
+struct ColumnLogColumnEntry
+{
+  char name[64];
+  uint64_t offset;
+};
+
+class ColumnTable
+{
+public:
+  const std::string& name() const { return name_; }
+  // frame_id of the header of every message in the table.
+  const std::string& frameId() const { return frame_id_; }
+  std::size_t size() const { return size_; }
+  const int64_t* stamp() const { return stamp_; }
+  bool hasColumn(const std::string& name) const { return columns_.count(name) != 0; }
+  std::vector<std::string> columnNames() const;
+  // Throws if the table has no such column.
+  const double* column(const std::string& name) const;
+  // First row stamped at or after stamp.
+  std::size_t lowerBound(int64_t stamp) const;
+
+private:
+  friend class ColumnLog;
+  std::string name_;
+  std::string frame_id_;
+  std::size_t size_;
+  const int64_t* stamp_;
+  std::map<std::string, const double*> columns_;
+};
+
+class ColumnLog
+{
+public:
+  explicit ColumnLog(const std::string& file);
+  ~ColumnLog();
+
+  // NULL if the log has no such table.
+  const ColumnTable* table(const std::string& name) const;
+  std::vector<std::string> tableNames() const;
+
+private:
+  ColumnLog(const ColumnLog&);
+  ColumnLog& operator=(const ColumnLog&);
+
+  void* data_;
+  std::size_t length_;
+  std::map<std::string, ColumnTable> tables_;
+};
+
+// Collects rows in memory and writes the whole log in save(). Every row of a
+// table has to add the same columns in the same order, and rows are expected
+// in stamp order; save() sorts a table that is not.
+class ColumnLogWriter
+{
+public:
+  ColumnLogWriter() : row_table_(NULL), row_column_(0) {}
+
+  void beginRow(const std::string& table, int64_t stamp, const std::string& frame_id);
+  void add(const char* column, double value);
+  void save(const std::string& file);
+
+  bool empty() const { return tables_.empty(); }
+
+private:
+  struct Table
+  {
+    std::string name;
+    std::string frame_id;
+    std::vector<int64_t> stamp;
+    std::vector<std::string> column_names;
+    std::vector<std::vector<double> > columns;
+  };
+
+  void endRow();
+
+  std::vector<Table> tables_;
+  std::map<std::string, std::size_t> table_index_;
+  Table* row_table_;
+  std::size_t row_column_;
+};
+
+// Whether a file name is one of a column log rather than a rosbag.
+extern bool isColumnLogFile(const std::string&);
+
+#endif /*COLUMN_LOG_H */
@@ -0,0 +1,115 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * column_log_messages.hpp
+ * Author MapIV Sekino
+ */
+
+// Rows of a ColumnLog for the messages eagleye reads and writes. One table
+// per topic, one row per message, the header stamp as row stamp and the
+// header frame_id of the first message as table frame_id. Covariances of
+// sensor_msgs/Imu are not kept, eagleye only passes them through.
+
+#ifndef COLUMN_LOG_MESSAGES_H
+#define COLUMN_LOG_MESSAGES_H
+
+#include "eagleye_rt/column_log.hpp"
+#include <sensor_msgs/Imu.h>
+#include <sensor_msgs/NavSatFix.h>
+#include <geometry_msgs/TwistStamped.h>
+#include <geometry_msgs/Vector3Stamped.h>
+#include <geometry_msgs/TransformStamped.h>
+#include <rtklib_msgs/RtklibNav.h>
+#include <eagleye_msgs/Distance.h>
+#include <eagleye_msgs/YawrateOffset.h>
+#include <eagleye_msgs/VelocityScaleFactor.h>
+#include <eagleye_msgs/Heading.h>
+#include <eagleye_msgs/Position.h>
+#include <eagleye_msgs/SlipAngle.h>
+#include <eagleye_msgs/AccXScaleFactor.h>
+#include <eagleye_msgs/AccXOffset.h>
+#include <eagleye_msgs/Height.h>
+#include <eagleye_msgs/Pitching.h>
+
+// Table names of the inputs of replay.
+const char* const COLUMN_LOG_IMU_TABLE = "imu";
+const char* const COLUMN_LOG_TWIST_TABLE = "twist";
+const char* const COLUMN_LOG_RTKLIB_NAV_TABLE = "rtklib_nav";
+const char* const COLUMN_LOG_NAVSATFIX_TABLE = "navsat/fix";
+// Ground truth NavSatFix, for sweep.
+const char* const COLUMN_LOG_REFERENCE_TABLE = "reference";
+
+// Table of one /tf_static transform, parent and child without leading slash.
+extern std::string columnLogTfTable(const std::string& parent, const std::string& child);
+
+// Types without a row are not written and return false.
+template <class T>
+bool addColumnRow(ColumnLogWriter*, const std::string&, const T&)
+{
+  return false;
+}
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const sensor_msgs::Imu&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const geometry_msgs::TwistStamped&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const rtklib_msgs::RtklibNav&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const sensor_msgs::NavSatFix&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const geometry_msgs::TransformStamped&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const geometry_msgs::Vector3Stamped&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::VelocityScaleFactor&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::Distance&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::YawrateOffset&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::Heading&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::SlipAngle&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::Height&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::Pitching&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::AccXOffset&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::AccXScaleFactor&);
+extern bool addColumnRow(ColumnLogWriter*, const std::string&, const eagleye_msgs::Position&);
+
+// Reads messages back from a table, the columns are looked up once.
+template <class T>
+class ColumnReader
+{
+public:
+  explicit ColumnReader(const ColumnTable& table);
+  void read(std::size_t row, T* msg) const;
+
+private:
+  const ColumnTable& table_;
+  std::vector<const double*> columns_;
+};
+
+template <> ColumnReader<sensor_msgs::Imu>::ColumnReader(const ColumnTable&);
+template <> void ColumnReader<sensor_msgs::Imu>::read(std::size_t, sensor_msgs::Imu*) const;
+template <> ColumnReader<geometry_msgs::TwistStamped>::ColumnReader(const ColumnTable&);
+template <> void ColumnReader<geometry_msgs::TwistStamped>::read(std::size_t, geometry_msgs::TwistStamped*) const;
+template <> ColumnReader<rtklib_msgs::RtklibNav>::ColumnReader(const ColumnTable&);
+template <> void ColumnReader<rtklib_msgs::RtklibNav>::read(std::size_t, rtklib_msgs::RtklibNav*) const;
+template <> ColumnReader<sensor_msgs::NavSatFix>::ColumnReader(const ColumnTable&);
+template <> void ColumnReader<sensor_msgs::NavSatFix>::read(std::size_t, sensor_msgs::NavSatFix*) const;
+template <> ColumnReader<geometry_msgs::TransformStamped>::ColumnReader(const ColumnTable&);
+template <> void ColumnReader<geometry_msgs::TransformStamped>::read(std::size_t, geometry_msgs::TransformStamped*) const;
+
+#endif /*COLUMN_LOG_MESSAGES_H */
@@ -0,0 +1,108 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * eagleye_state.hpp
+ * Author MapIV Sekino
+ */
+
+// Collects the outputs of EagleyeEngine into one eagleye_msgs/EagleyeState
+// per IMU message. Outputs of the GNSS and velocity steps in between are
+// merged into the next state, and the updated bits tell which estimates were
+// published since the previous one.
+
+#ifndef EAGLEYE_STATE_H
+#define EAGLEYE_STATE_H
+
+#include "navigation/engine.hpp"
+#include "eagleye_msgs/EagleyeState.h"
+
+class EagleyeStateBuilder
+{
+public:
+  EagleyeStateBuilder() : cleared_(false) { state_.updated = 0; }
+
+  // Merges the output of one add*() call of EagleyeEngine.
+  void add(const EagleyeEngineOutput& o)
+  {
+    typedef eagleye_msgs::EagleyeState S;
+    if (cleared_)
+    {
+      state_.updated = 0;
+      cleared_ = false;
+    }
+    merge(o.velocity_scale_factor_updated, o.velocity_scale_factor, &state_.velocity_scale_factor, S::VELOCITY_SCALE_FACTOR);
+    merge(o.distance_updated, o.distance, &state_.distance, S::DISTANCE);
+    merge(o.yawrate_offset_stop_updated, o.yawrate_offset_stop, &state_.yawrate_offset_stop, S::YAWRATE_OFFSET_STOP);
+    merge(o.yawrate_offset_1st_updated, o.yawrate_offset_1st, &state_.yawrate_offset_1st, S::YAWRATE_OFFSET_1ST);
+    merge(o.yawrate_offset_2nd_updated, o.yawrate_offset_2nd, &state_.yawrate_offset_2nd, S::YAWRATE_OFFSET_2ND);
+    merge(o.heading_1st_updated, o.heading_1st, &state_.heading_1st, S::HEADING_1ST);
+    merge(o.heading_2nd_updated, o.heading_2nd, &state_.heading_2nd, S::HEADING_2ND);
+    merge(o.heading_3rd_updated, o.heading_3rd, &state_.heading_3rd, S::HEADING_3RD);
+    merge(o.heading_interpolate_1st_updated, o.heading_interpolate_1st, &state_.heading_interpolate_1st, S::HEADING_INTERPOLATE_1ST);
+    merge(o.heading_interpolate_2nd_updated, o.heading_interpolate_2nd, &state_.heading_interpolate_2nd, S::HEADING_INTERPOLATE_2ND);
+    merge(o.heading_interpolate_3rd_updated, o.heading_interpolate_3rd, &state_.heading_interpolate_3rd, S::HEADING_INTERPOLATE_3RD);
+    merge(o.slip_angle_updated, o.slip_angle, &state_.slip_angle, S::SLIP_ANGLE);
+    merge(o.height_updated, o.height, &state_.height, S::HEIGHT);
+    merge(o.pitching_updated, o.pitching, &state_.pitching, S::PITCHING);
+    merge(o.acc_x_offset_updated, o.acc_x_offset, &state_.acc_x_offset, S::ACC_X_OFFSET);
+    merge(o.acc_x_scale_factor_updated, o.acc_x_scale_factor, &state_.acc_x_scale_factor, S::ACC_X_SCALE_FACTOR);
+    merge(o.reliability_fix_updated, o.reliability_fix, &state_.reliability_fix, S::RELIABILITY_FIX);
+    merge(o.enu_vel_updated, o.enu_vel, &state_.enu_vel, S::ENU_VEL);
+    merge(o.enu_relative_pos_updated, o.enu_relative_pos, &state_.enu_relative_pos, S::ENU_RELATIVE_POS);
+    merge(o.twist_updated, o.twist, &state_.twist, S::TWIST);
+    merge(o.enu_absolute_pos_updated, o.enu_absolute_pos, &state_.enu_absolute_pos, S::ENU_ABSOLUTE_POS);
+    merge(o.enu_absolute_pos_interpolate_updated, o.enu_absolute_pos_interpolate, &state_.enu_absolute_pos_interpolate, S::ENU_ABSOLUTE_POS_INTERPOLATE);
+    merge(o.fix_updated, o.fix, &state_.fix, S::FIX);
+    merge(o.gnss_smooth_pos_enu_updated, o.gnss_smooth_pos_enu, &state_.gnss_smooth_pos_enu, S::GNSS_SMOOTH_POS_ENU);
+    merge(o.angular_velocity_offset_stop_updated, o.angular_velocity_offset_stop, &state_.angular_velocity_offset_stop, S::ANGULAR_VELOCITY_OFFSET_STOP);
+    merge(o.enu_absolute_rtk_deadreckoning_updated, o.enu_absolute_rtk_deadreckoning, &state_.enu_absolute_rtk_deadreckoning, S::ENU_ABSOLUTE_RTK_DEADRECKONING);
+    merge(o.rtk_fix_updated, o.rtk_fix, &state_.rtk_fix, S::RTK_FIX);
+  }
+
+  // State at the given IMU stamp. The next add() starts a new set of updated bits.
+  const eagleye_msgs::EagleyeState& get(const ros::Time& stamp)
+  {
+    state_.header.stamp = stamp;
+    cleared_ = true;
+    return state_;
+  }
+
+private:
+  template <class T>
+  void merge(bool updated, const T& msg, T* field, uint32_t bit)
+  {
+    if (updated)
+    {
+      *field = msg;
+      state_.updated |= bit;
+    }
+  }
+
+  eagleye_msgs::EagleyeState state_;
+  bool cleared_;
+};
+
+#endif /*EAGLEYE_STATE_H */
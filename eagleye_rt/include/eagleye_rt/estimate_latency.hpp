@@ -0,0 +1,219 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * estimate_latency.hpp
+ * Author MapIV Sekino
+ */
+
+// Execution time of the estimate call of an eagleye_rt node. Every call is
+// timed with the steady clock into an HDR style histogram; once per period the
+// call rate and the p50/p99/max of the period are reported through
+// diagnostic_updater and published as eagleye_msgs/EstimateLatency on
+// estimate_latency. Build with -DEAGLEYE_ESTIMATE_LATENCY=OFF to compile the
+// timing out, start() and stop() are then empty.
+//
+// Not thread safe: start(), stop() and the report timer must run on the same
+// callback queue, as they do on the node handle of a node or a nodelet.
+
+#ifndef ESTIMATE_LATENCY_H
+#define ESTIMATE_LATENCY_H
+
+#include "ros/ros.h"
+#include "eagleye_msgs/EstimateLatency.h"
+#include <diagnostic_updater/diagnostic_updater.h>
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+// Log-linear histogram of nanosecond values: below 32 ns one bucket per
+// nanosecond, above that 32 buckets per power of two, so a bucket is at most
+// about 3 % wide and record() is a few instructions without allocation.
+class LatencyHistogram
+{
+public:
+  LatencyHistogram() { reset(); }
+
+  void record(uint64_t value)
+  {
+    counts_[index(value)]++;
+    count_++;
+    max_ = std::max(max_, value);
+  }
+
+  void reset()
+  {
+    std::memset(counts_, 0, sizeof(counts_));
+    count_ = 0;
+    max_ = 0;
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t max() const { return max_; }
+
+  // Upper bound of the bucket holding the given quantile (0-1), clamped to max().
+  uint64_t percentile(double ratio) const
+  {
+    if (count_ == 0)
+    {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(ratio * (count_ - 1)) + 1;
+    uint64_t sum = 0;
+    for (int i = 0; i < bucket_num; i++)
+    {
+      sum += counts_[i];
+      if (sum >= rank)
+      {
+        return std::min(upperBound(i), max_);
+      }
+    }
+    return max_;
+  }
+
+private:
+  static const int sub_bucket_bits = 5;
+  static const int sub_bucket_num = 1 << sub_bucket_bits;
+  static const int bucket_num = sub_bucket_num * (64 - sub_bucket_bits + 1);
+
+  static int index(uint64_t value)
+  {
+    if (value < static_cast<uint64_t>(sub_bucket_num))
+    {
+      return static_cast<int>(value);
+    }
+    int shift = 63 - __builtin_clzll(value) - sub_bucket_bits;
+    return sub_bucket_num * (shift + 1) + static_cast<int>((value >> shift) & (sub_bucket_num - 1));
+  }
+
+  static uint64_t upperBound(int index)
+  {
+    if (index < sub_bucket_num)
+    {
+      return index;
+    }
+    int shift = index / sub_bucket_num - 1;
+    uint64_t sub_bucket = sub_bucket_num + index % sub_bucket_num;
+    return ((sub_bucket + 1) << shift) - 1;
+  }
+
+  uint32_t counts_[bucket_num];
+  uint64_t count_;
+  uint64_t max_;
+};
+
+class EstimateLatency
+{
+public:
+  EstimateLatency() : total_count_(0), total_max_(0), warn_threshold_(0.01), last_report_(0) {}
+
+  void init(ros::NodeHandle& nh, ros::NodeHandle& private_nh, const std::string& name)
+  {
+#ifndef EAGLEYE_DISABLE_ESTIMATE_LATENCY
+    double period = 1.0;
+    nh.getParam("estimate_latency/period", period);
+    nh.getParam("estimate_latency/warn_threshold", warn_threshold_);
+
+    msg_.node = name;
+    pub_ = nh.advertise<eagleye_msgs::EstimateLatency>("estimate_latency", 10);
+    updater_.reset(new diagnostic_updater::Updater(nh, private_nh, name));
+    updater_->setHardwareID("eagleye");
+    updater_->add(name + " estimate latency", this, &EstimateLatency::diagnose);
+    timer_ = nh.createTimer(ros::Duration(period), &EstimateLatency::report, this);
+#endif
+  }
+
+  void start()
+  {
+#ifndef EAGLEYE_DISABLE_ESTIMATE_LATENCY
+    start_ = std::chrono::steady_clock::now();
+#endif
+  }
+
+  void stop()
+  {
+#ifndef EAGLEYE_DISABLE_ESTIMATE_LATENCY
+    histogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+#endif
+  }
+
+private:
+  void report(const ros::TimerEvent& e)
+  {
+    double now = e.current_real.toSec();
+    double elapsed = last_report_ > 0 ? now - last_report_ : 0;
+    last_report_ = now;
+
+    total_count_ += histogram_.count();
+    total_max_ = std::max(total_max_, histogram_.max());
+
+    msg_.header.stamp = e.current_real;
+    msg_.count = total_count_;
+    msg_.rate = elapsed > 0 ? histogram_.count() / elapsed : 0;
+    msg_.latency_p50 = histogram_.percentile(0.5) * 1e-9;
+    msg_.latency_p99 = histogram_.percentile(0.99) * 1e-9;
+    msg_.latency_max = histogram_.max() * 1e-9;
+    msg_.latency_max_total = total_max_ * 1e-9;
+    histogram_.reset();
+
+    pub_.publish(msg_);
+    updater_->force_update();
+  }
+
+  void diagnose(diagnostic_updater::DiagnosticStatusWrapper& stat)
+  {
+    if (msg_.latency_max > warn_threshold_)
+    {
+      stat.summaryf(diagnostic_msgs::DiagnosticStatus::WARN, "max %.3f ms exceeds %.3f ms", msg_.latency_max * 1e3,
+                    warn_threshold_ * 1e3);
+    }
+    else
+    {
+      stat.summaryf(diagnostic_msgs::DiagnosticStatus::OK, "max %.3f ms", msg_.latency_max * 1e3);
+    }
+    stat.add("count", msg_.count);
+    stat.add("rate [Hz]", msg_.rate);
+    stat.add("p50 [ms]", msg_.latency_p50 * 1e3);
+    stat.add("p99 [ms]", msg_.latency_p99 * 1e3);
+    stat.add("max [ms]", msg_.latency_max * 1e3);
+    stat.add("max since start [ms]", msg_.latency_max_total * 1e3);
+  }
+
+  LatencyHistogram histogram_;
+  std::chrono::steady_clock::time_point start_;
+  uint64_t total_count_;
+  uint64_t total_max_;
+  double warn_threshold_;
+  double last_report_;
+  eagleye_msgs::EstimateLatency msg_;
+  ros::Publisher pub_;
+  ros::Timer timer_;
+  boost::shared_ptr<diagnostic_updater::Updater> updater_;
+};
+
+#endif /*ESTIMATE_LATENCY_H */
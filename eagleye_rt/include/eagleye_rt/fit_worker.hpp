@@ -0,0 +1,144 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * fit_worker.hpp
+ * Author MapIV Sekino
+ */
+
+// Background thread for the window fits of position and height, enabled with
+// fit_worker/enable. The estimator copies its window when a fit is due (see
+// PositionEstimator::setDeferredFit()) and post() runs the fit on that copy
+// here, so the spin thread goes on with the next messages instead of waiting
+// for the outlier loop. When the fit is done, the done callback is put on the
+// callback queue of the node handle and runs on the spin thread like any
+// subscription callback, so the estimator is only ever touched from there.
+
+#ifndef FIT_WORKER_H
+#define FIT_WORKER_H
+
+#include "ros/ros.h"
+#include "ros/callback_queue_interface.h"
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+class FitWorker
+{
+public:
+  FitWorker() : enable_(false), queue_(NULL), stop_(false) {}
+
+  ~FitWorker() { stop(); }
+
+  // Returns true when the worker is enabled.
+  bool init(ros::NodeHandle& nh)
+  {
+    nh.getParam("fit_worker/enable", enable_);
+    if (!enable_)
+    {
+      return false;
+    }
+    queue_ = nh.getCallbackQueue();
+    thread_ = boost::thread(&FitWorker::run, this);
+    return true;
+  }
+
+  bool enabled() const { return enable_; }
+
+  // Runs fit on the worker thread and then done on the spin thread. The
+  // estimator has at most one fit pending, so a job is never replaced.
+  void post(const boost::function<void()>& fit, const boost::function<void()>& done)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    fit_ = fit;
+    done_ = done;
+    condition_.notify_one();
+  }
+
+  // Call when the node shuts down, before the callback queue goes away.
+  void stop()
+  {
+    if (!thread_.joinable())
+    {
+      return;
+    }
+    {
+      boost::lock_guard<boost::mutex> lock(mutex_);
+      stop_ = true;
+      condition_.notify_one();
+    }
+    thread_.join();
+    queue_->removeByID(reinterpret_cast<uint64_t>(this));
+  }
+
+private:
+  class DoneCallback : public ros::CallbackInterface
+  {
+  public:
+    explicit DoneCallback(const boost::function<void()>& done) : done_(done) {}
+
+    CallResult call()
+    {
+      done_();
+      return Success;
+    }
+
+  private:
+    boost::function<void()> done_;
+  };
+
+  void run()
+  {
+    while (true)
+    {
+      boost::function<void()> fit, done;
+      {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        while (!stop_ && fit_.empty())
+        {
+          condition_.wait(lock);
+        }
+        if (stop_)
+        {
+          return;
+        }
+        fit.swap(fit_);
+        done.swap(done_);
+      }
+      fit();
+      queue_->addCallback(ros::CallbackInterfacePtr(new DoneCallback(done)), reinterpret_cast<uint64_t>(this));
+    }
+  }
+
+  bool enable_;
+  ros::CallbackQueueInterface* queue_;
+  bool stop_;
+  boost::function<void()> fit_;
+  boost::function<void()> done_;
+  boost::mutex mutex_;
+  boost::condition_variable condition_;
+  boost::thread thread_;
+};
+
+#endif /*FIT_WORKER_H */
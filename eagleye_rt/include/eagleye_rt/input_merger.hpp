@@ -0,0 +1,546 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * input_merger.hpp
+ * Author MapIV Sekino
+ */
+
+// Header stamp ordered delivery of the inputs of an eagleye_rt node, enabled
+// with input_merger/enable. Without it every callback runs on arrival, so
+// which value of an input an estimate sees depends on socket timing. With it
+// the message that triggers an estimate is held until every other input of
+// the node has reached its stamp, and the inputs up to that stamp are
+// delivered before it. On equal stamps the other inputs come first, as in
+// EagleyeEngine. Each input is given one of these kinds at subscribe():
+//
+// - INPUT, a sensor message. It has reached a stamp when a message at or
+//   after the stamp arrived, or when the stamp is less than the shortest
+//   interval seen on it after its last message. A trigger waits at most
+//   input_merger/lateness behind the newest sensor message for it.
+// - DERIVED, the output of an upstream node for the same trigger stamp. It
+//   has reached a stamp when a message at or after the stamp arrived. A node
+//   with a sparse output calls advertiseProgress(), which publishes on
+//   <topic>/progress how far it has processed its triggers; that counts too.
+// - FEEDBACK, the output of a node downstream of this one, as
+//   heading_interpolate is for heading. It must carry the trigger stamps of
+//   this node. A feedback message is delivered input_merger/feedback_lag
+//   after its stamp, behind the trigger of that time, so that the loop has
+//   that long to come back. With 0 every estimate sees the feedback of the
+//   previous trigger, as in EagleyeEngine.
+//
+// A trigger waits at most input_merger/hold_timeout for a derived or
+// feedback input. That input is then not waited for until it catches up
+// again. A derived or feedback input without a publisher is not waited for.
+// A message older than a trigger already delivered is delivered at once and
+// counted as late. If no input arrives for input_merger/timeout the held
+// messages are flushed, so the last messages of a drive are not kept back.
+// input_merger/test_delay holds every trigger that long after it arrived, to
+// check the order when the upstream nodes are slow.
+
+#ifndef INPUT_MERGER_H
+#define INPUT_MERGER_H
+
+#include "ros/ros.h"
+#include "eagleye_msgs/InputProgress.h"
+#include "eagleye_rt/shm_transport.hpp"
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+class InputMerger
+{
+public:
+  // A trigger published by an upstream node, as enu_vel, is DERIVED | TRIGGER.
+  enum Kind
+  {
+    INPUT = 0,
+    TRIGGER = 1,
+    DERIVED = 2,
+    FEEDBACK = 4
+  };
+
+  InputMerger()
+    : enable_(false), lateness_(100000000), feedback_lag_(50000000), hold_timeout_(0.5), test_delay_(0.0),
+      timeout_(1.0), newest_(NONE), triggered_(NONE), progress_(NONE), last_output_(NONE),
+      sequence_(0), holding_(false), hold_sequence_(0), late_count_(0), feedback_(false), progress_enabled_(false)
+  {
+  }
+
+  void init(ros::NodeHandle& nh)
+  {
+    nh.getParam("input_merger/enable", enable_);
+    if (!enable_)
+    {
+      return;
+    }
+    double lateness = 0.1;
+    double feedback_lag = 0.05;
+    nh.getParam("input_merger/lateness", lateness);
+    nh.getParam("input_merger/feedback_lag", feedback_lag);
+    nh.getParam("input_merger/hold_timeout", hold_timeout_);
+    nh.getParam("input_merger/test_delay", test_delay_);
+    nh.getParam("input_merger/timeout", timeout_);
+    lateness_ = static_cast<int64_t>(lateness * 1e9);
+    feedback_lag_ = static_cast<int64_t>(feedback_lag * 1e9);
+    timer_ = nh.createWallTimer(ros::WallDuration(std::min(timeout_, hold_timeout_) / 2),
+                                boost::bind(&InputMerger::timerCallback, this, _1));
+  }
+
+  template <class M, class T>
+  ShmSubscriber subscribe(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size,
+                          void (T::*callback)(const boost::shared_ptr<M const>&), T* obj, int kind = INPUT)
+  {
+    return subscribe<M>(nh, topic, queue_size, boost::bind(callback, obj, _1), kind);
+  }
+
+  template <class M>
+  ShmSubscriber subscribe(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size,
+                          const typename ShmReader<M>::Callback& callback, int kind = INPUT)
+  {
+    if (!enable_)
+    {
+      return ShmSubscriber(nh.subscribe<M>(topic, queue_size, callback, ros::VoidConstPtr(),
+                                           ros::TransportHints().tcpNoDelay()));
+    }
+    int stream = addStream(kind);
+    streams_[stream].subscriber = nh.subscribe<M>(topic, queue_size, wrap<M>(stream, callback), ros::VoidConstPtr(),
+                                                  ros::TransportHints().tcpNoDelay());
+    streams_[stream].check_publishers = true;
+    if (kind & DERIVED)
+    {
+      boost::function<void(const eagleye_msgs::InputProgress::ConstPtr&)> progress_callback =
+        boost::bind(&InputMerger::progressCallback, this, stream, _1);
+      streams_[stream].progress_subscriber = nh.subscribe<eagleye_msgs::InputProgress>(
+        topic + "/progress", queue_size, progress_callback, ros::VoidConstPtr(), ros::TransportHints().tcpNoDelay());
+    }
+    return ShmSubscriber(streams_[stream].subscriber);
+  }
+
+  // Same as subscribe() for the sensor inputs that can come from shm_bridge.
+  template <class M, class T>
+  ShmSubscriber subscribeShm(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size,
+                             void (T::*callback)(const boost::shared_ptr<M const>&), T* obj, int kind = INPUT)
+  {
+    return subscribeShm<M>(nh, topic, queue_size, boost::bind(callback, obj, _1), kind);
+  }
+
+  template <class M>
+  ShmSubscriber subscribeShm(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size,
+                             const typename ShmReader<M>::Callback& callback, int kind = INPUT)
+  {
+    if (!enable_)
+    {
+      return ::subscribeShm<M>(nh, topic, queue_size, callback, ros::TransportHints().tcpNoDelay());
+    }
+    int stream = addStream(kind);
+    return ::subscribeShm<M>(nh, topic, queue_size, wrap<M>(stream, callback), ros::TransportHints().tcpNoDelay());
+  }
+
+  // Publishes on <topic>/progress how far the triggers of this node have been
+  // processed, for the nodes that take the sparse output on topic as DERIVED.
+  void advertiseProgress(ros::NodeHandle& nh, const std::string& topic)
+  {
+    if (enable_)
+    {
+      progress_pub_ = nh.advertise<eagleye_msgs::InputProgress>(topic + "/progress", 1000);
+      progress_enabled_ = true;
+    }
+  }
+
+  // Call after publishing on the topic of advertiseProgress().
+  void published(const ros::Time& stamp)
+  {
+    last_output_ = std::max(last_output_, static_cast<int64_t>(stamp.toNSec()));
+  }
+
+  uint64_t lateCount() const { return late_count_; }
+
+private:
+  static const int64_t NONE = std::numeric_limits<int64_t>::min();
+  static const int64_t ALL = std::numeric_limits<int64_t>::max();
+
+  struct Stream
+  {
+    int kind;
+    int64_t last;
+    // Shortest interval seen between two messages of a sensor input, 0 until known.
+    int64_t interval;
+    // Stamp a derived or feedback input has reached, with its progress messages.
+    int64_t reached;
+    // Derived or feedback input that is not waited for until it catches up.
+    bool stalled;
+    bool check_publishers;
+    // (stamp reached, last output stamp) of the progress messages whose output has not arrived yet.
+    std::deque<std::pair<int64_t, int64_t> > progress;
+    ros::Subscriber subscriber;
+    ros::Subscriber progress_subscriber;
+  };
+
+  struct Entry
+  {
+    int64_t stamp;
+    int order;
+    uint64_t sequence;
+    bool trigger;
+    ros::WallTime receive_time;
+    boost::function<void()> deliver;
+
+    // Makes std::priority_queue a min-heap on (stamp, order, sequence).
+    bool operator<(const Entry& e) const
+    {
+      if (stamp != e.stamp)
+      {
+        return stamp > e.stamp;
+      }
+      if (order != e.order)
+      {
+        return order > e.order;
+      }
+      return sequence > e.sequence;
+    }
+  };
+
+  static int64_t shift(int64_t stamp, int64_t duration)
+  {
+    if (stamp == NONE || stamp == ALL)
+    {
+      return stamp;
+    }
+    if (duration > 0 && stamp > ALL - duration)
+    {
+      return ALL;
+    }
+    if (duration < 0 && stamp < NONE + 1 - duration)
+    {
+      return NONE;
+    }
+    return stamp + duration;
+  }
+
+  int addStream(int kind)
+  {
+    Stream stream;
+    stream.kind = kind;
+    stream.last = NONE;
+    stream.interval = 0;
+    stream.reached = NONE;
+    stream.stalled = false;
+    stream.check_publishers = false;
+    streams_.push_back(stream);
+    feedback_ = feedback_ || (kind & FEEDBACK);
+    return streams_.size() - 1;
+  }
+
+  template <class M>
+  typename ShmReader<M>::Callback wrap(int stream, const typename ShmReader<M>::Callback& callback)
+  {
+    return boost::bind(&InputMerger::receive<M>, this, stream, callback, _1);
+  }
+
+  template <class M>
+  void receive(int index, const typename ShmReader<M>::Callback& callback, const boost::shared_ptr<M const>& msg)
+  {
+    last_receive_ = ros::WallTime::now();
+    Stream& stream = streams_[index];
+    int64_t stamp = static_cast<int64_t>(msg->header.stamp.toNSec());
+    if (!(stream.kind & (DERIVED | FEEDBACK)))
+    {
+      if (stream.last != NONE && stamp > stream.last && (stream.interval == 0 || stamp - stream.last < stream.interval))
+      {
+        stream.interval = stamp - stream.last;
+      }
+    }
+    stream.last = std::max(stream.last, stamp);
+    newest_ = std::max(newest_, stamp);
+    updateReached(stream);
+
+    Entry entry;
+    entry.stamp = stamp;
+    entry.order = 0;
+    entry.trigger = stream.kind & TRIGGER;
+    if (entry.trigger)
+    {
+      entry.order = 1;
+    }
+    else if (stream.kind & FEEDBACK)
+    {
+      entry.stamp = shift(stamp, feedback_lag_);
+      entry.order = 2;
+    }
+    if (entry.stamp < triggered_ || (entry.stamp == triggered_ && entry.order == 0))
+    {
+      ++late_count_;
+      ROS_WARN_THROTTLE(1.0, "input_merger: %lu messages arrived after the trigger they belong to",
+                        (unsigned long)late_count_);
+      callback(msg);
+      return;
+    }
+    entry.sequence = sequence_++;
+    entry.receive_time = last_receive_;
+    entry.deliver = boost::bind(callback, msg);
+    queue_.push(entry);
+    release(false);
+  }
+
+  void progressCallback(int index, const eagleye_msgs::InputProgress::ConstPtr& msg)
+  {
+    Stream& stream = streams_[index];
+    int64_t stamp = static_cast<int64_t>(msg->header.stamp.toNSec());
+    int64_t last_output = static_cast<int64_t>(msg->last_output_stamp.toNSec());
+    if (last_output == 0)
+    {
+      last_output = NONE;
+    }
+    if (!stream.progress.empty() && stream.progress.back().second == last_output)
+    {
+      stream.progress.back().first = stamp;
+    }
+    else
+    {
+      stream.progress.push_back(std::make_pair(stamp, last_output));
+    }
+    updateReached(stream);
+    release(false);
+  }
+
+  void updateReached(Stream& stream)
+  {
+    stream.reached = std::max(stream.reached, stream.last);
+    // The progress can overtake the output it covers, so it counts once that output arrived.
+    while (!stream.progress.empty() && stream.progress.front().second <= stream.last)
+    {
+      stream.reached = std::max(stream.reached, stream.progress.front().first);
+      stream.progress.pop_front();
+    }
+    if (stream.stalled && stream.reached >= triggered_)
+    {
+      stream.stalled = false;
+    }
+  }
+
+  bool waited(const Stream& stream) const
+  {
+    return !stream.stalled && (!stream.check_publishers || stream.subscriber.getNumPublishers() > 0);
+  }
+
+  // Stamp up to which no more message of a non-feedback input is expected.
+  int64_t reached(const Stream& stream) const
+  {
+    if (!waited(stream))
+    {
+      return ALL;
+    }
+    if (stream.kind & DERIVED)
+    {
+      return stream.reached;
+    }
+    int64_t next = stream.interval > 0 ? shift(stream.last, stream.interval - 1) : stream.last;
+    return std::max(next, shift(newest_, -lateness_));
+  }
+
+  // Stamp up to which no more trigger is expected.
+  int64_t triggersReached() const
+  {
+    int64_t stamp = ALL;
+    for (std::size_t i = 0; i < streams_.size(); ++i)
+    {
+      if (streams_[i].kind & TRIGGER)
+      {
+        stamp = std::min(stamp, reached(streams_[i]));
+      }
+    }
+    return stamp;
+  }
+
+  // Feedback stamp the trigger at stamp has to see: the last trigger more than feedback_lag before it.
+  int64_t feedbackRequired(int64_t stamp)
+  {
+    while (triggers_.size() > 1 && shift(triggers_[1], feedback_lag_) < stamp)
+    {
+      triggers_.pop_front();
+    }
+    if (!triggers_.empty() && shift(triggers_.front(), feedback_lag_) < stamp)
+    {
+      return triggers_.front();
+    }
+    return NONE;
+  }
+
+  // Appends the inputs the trigger at stamp waits for to blocking, and returns
+  // whether any of them is a sensor input, which is not held by hold_timeout.
+  bool blocking(int64_t stamp, bool trigger, std::vector<int>* blocking)
+  {
+    bool input = false;
+    int64_t required = trigger ? feedbackRequired(stamp) : NONE;
+    for (std::size_t i = 0; i < streams_.size(); ++i)
+    {
+      const Stream& stream = streams_[i];
+      bool wait;
+      if (stream.kind & FEEDBACK)
+      {
+        wait = trigger && required != NONE && waited(stream) && stream.reached < required;
+      }
+      else if (trigger || (stream.kind & TRIGGER))
+      {
+        wait = reached(stream) < stamp;
+      }
+      else
+      {
+        wait = false;
+      }
+      if (wait)
+      {
+        blocking->push_back(i);
+        input = input || !(stream.kind & (DERIVED | FEEDBACK));
+      }
+    }
+    return input;
+  }
+
+  void release(bool flush)
+  {
+    ros::WallTime now = ros::WallTime::now();
+    while (!queue_.empty())
+    {
+      const Entry& top = queue_.top();
+      if (!flush)
+      {
+        if (top.trigger && test_delay_ > 0.0 && (now - top.receive_time).toSec() < test_delay_)
+        {
+          break;
+        }
+        std::vector<int> streams;
+        bool input = blocking(top.stamp, top.trigger, &streams);
+        if (!streams.empty())
+        {
+          if (input)
+          {
+            break;
+          }
+          if (!holding_ || hold_sequence_ != top.sequence)
+          {
+            holding_ = true;
+            hold_sequence_ = top.sequence;
+            hold_since_ = now;
+            break;
+          }
+          if ((now - hold_since_).toSec() < hold_timeout_)
+          {
+            break;
+          }
+          for (std::size_t i = 0; i < streams.size(); ++i)
+          {
+            streams_[streams[i]].stalled = true;
+          }
+          ROS_WARN("input_merger: %lu derived or feedback inputs did not arrive within input_merger/hold_timeout",
+                   (unsigned long)streams.size());
+        }
+      }
+      // Copied out first, the callback may not run with the entry still in the queue.
+      Entry entry = top;
+      queue_.pop();
+      holding_ = false;
+      if (entry.trigger)
+      {
+        triggered_ = entry.stamp;
+        if (feedback_)
+        {
+          triggers_.push_back(entry.stamp);
+        }
+      }
+      entry.deliver();
+    }
+    publishProgress(flush);
+  }
+
+  void publishProgress(bool flush)
+  {
+    if (!progress_enabled_)
+    {
+      return;
+    }
+    int64_t stamp = flush ? newest_ : std::min(triggersReached(), newest_);
+    if (!queue_.empty())
+    {
+      stamp = std::min(stamp, shift(queue_.top().stamp, -1));
+    }
+    if (stamp == NONE || stamp <= progress_)
+    {
+      return;
+    }
+    progress_ = stamp;
+    boost::shared_ptr<eagleye_msgs::InputProgress> msg = boost::make_shared<eagleye_msgs::InputProgress>();
+    msg->header.stamp.fromNSec(stamp);
+    if (last_output_ != NONE)
+    {
+      msg->last_output_stamp.fromNSec(last_output_);
+    }
+    progress_pub_.publish(msg);
+  }
+
+  void timerCallback(const ros::WallTimerEvent&)
+  {
+    if (queue_.empty())
+    {
+      return;
+    }
+    release((ros::WallTime::now() - last_receive_).toSec() > timeout_);
+  }
+
+  bool enable_;
+  int64_t lateness_;
+  int64_t feedback_lag_;
+  double hold_timeout_;
+  double test_delay_;
+  double timeout_;
+  int64_t newest_;
+  // Stamp of the last trigger delivered, and of the recent ones for the feedback inputs.
+  int64_t triggered_;
+  std::deque<int64_t> triggers_;
+  int64_t progress_;
+  int64_t last_output_;
+  uint64_t sequence_;
+  bool holding_;
+  uint64_t hold_sequence_;
+  ros::WallTime hold_since_;
+  uint64_t late_count_;
+  bool feedback_;
+  std::vector<Stream> streams_;
+  std::priority_queue<Entry> queue_;
+  ros::WallTime last_receive_;
+  ros::WallTimer timer_;
+  bool progress_enabled_;
+  ros::Publisher progress_pub_;
+};
+
+#endif /*INPUT_MERGER_H */
@@ -0,0 +1,89 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * latency_trace.hpp
+ * Author MapIV Sekino
+ */
+
+// Optional end-to-end latency tracing. Eagleye messages keep the header stamp
+// of the sensor message that triggered them, so with latency_trace/enable set
+// every node publishes one eagleye_msgs/LatencyTrace on latency_trace per
+// output: the header stamp of the output together with the wall times the
+// triggering message was received and the output was published. The
+// latency_trace tool joins the events of all nodes by stamp.
+
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include "ros/ros.h"
+#include "eagleye_msgs/LatencyTrace.h"
+#include <string>
+
+class LatencyTrace
+{
+public:
+  LatencyTrace() : enabled_(false) {}
+
+  void init(ros::NodeHandle& nh, const std::string& name)
+  {
+    nh.getParam("latency_trace/enable", enabled_);
+    if (enabled_)
+    {
+      msg_.node = name;
+      pub_ = nh.advertise<eagleye_msgs::LatencyTrace>("latency_trace", 1000);
+    }
+  }
+
+  // Call first thing in the callback of the triggering message.
+  void receive()
+  {
+    if (enabled_)
+    {
+      receive_time_ = ros::WallTime::now();
+    }
+  }
+
+  // Call after the output with the given stamp has been published.
+  void publish(const ros::Time& stamp)
+  {
+    if (enabled_)
+    {
+      ros::WallTime publish_time = ros::WallTime::now();
+      msg_.header.stamp = stamp;
+      msg_.receive_time = ros::Time(receive_time_.sec, receive_time_.nsec);
+      msg_.publish_time = ros::Time(publish_time.sec, publish_time.nsec);
+      pub_.publish(msg_);
+    }
+  }
+
+private:
+  bool enabled_;
+  ros::WallTime receive_time_;
+  eagleye_msgs::LatencyTrace msg_;
+  ros::Publisher pub_;
+};
+
+#endif /*LATENCY_TRACE_H */
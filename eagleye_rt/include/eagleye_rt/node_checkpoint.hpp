@@ -0,0 +1,195 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * node_checkpoint.hpp
+ * Author MapIV Sekino
+ */
+
+// Checkpoint of the estimator of a node, enabled with checkpoint/enable. The
+// whole estimator state (see navigation/checkpoint.hpp) is written to
+// checkpoint/directory (default $ROS_HOME/eagleye_checkpoint) in a file named
+// after the node, every checkpoint/period, on a std_msgs/Empty message on the
+// checkpoint_request topic and by save() when the node shuts down. init()
+// loads the file, so a node restarted after a crash or an update continues
+// where the previous one stopped instead of estimating everything again.
+//
+// A checkpoint older than checkpoint/max_age is not loaded: the windows would
+// span the gap and mix data from before and after it. A checkpoint that does
+// not match the estimator, e.g. after a change of the Status structs, is
+// reported and the node starts from scratch. The parameters must be the same
+// as when it was written.
+
+#ifndef NODE_CHECKPOINT_H
+#define NODE_CHECKPOINT_H
+
+#include "ros/ros.h"
+#include "navigation/checkpoint.hpp"
+#include <std_msgs/Empty.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+template <class Estimator>
+class NodeCheckpoint
+{
+public:
+  NodeCheckpoint() : enable_(false), period_(10.0), max_age_(60.0), estimator_(NULL) {}
+
+  // Call after the estimator got its parameters and before the first
+  // message. The file is named after node_name.
+  // Returns true when the checkpoint was loaded.
+  bool init(ros::NodeHandle& nh, const std::string& node_name, Estimator* estimator)
+  {
+    nh.getParam("checkpoint/enable", enable_);
+    if (!enable_)
+    {
+      return false;
+    }
+    nh.getParam("checkpoint/directory", directory_);
+    nh.getParam("checkpoint/period", period_);
+    nh.getParam("checkpoint/max_age", max_age_);
+    if (directory_.empty())
+    {
+      const char* ros_home = std::getenv("ROS_HOME");
+      const char* home = std::getenv("HOME");
+      directory_ = ros_home ? ros_home : std::string(home ? home : ".") + "/.ros";
+      directory_ += "/eagleye_checkpoint";
+    }
+    std::string name = node_name;
+    for (std::size_t i = 0; i < name.size(); i++)
+    {
+      if (name[i] == '/')
+      {
+        name[i] = '_';
+      }
+    }
+    file_ = directory_ + "/" + name.substr(name.find_first_not_of('_')) + ".checkpoint";
+    estimator_ = estimator;
+
+    bool loaded = load();
+    if (period_ > 0)
+    {
+      timer_ = nh.createWallTimer(ros::WallDuration(period_), boost::bind(&NodeCheckpoint::timerCallback, this, _1));
+    }
+    request_sub_ = nh.subscribe("checkpoint_request", 1, &NodeCheckpoint::requestCallback, this);
+    return loaded;
+  }
+
+  void save()
+  {
+    if (!enable_ || !makeDirectory())
+    {
+      return;
+    }
+    try
+    {
+      CheckpointWriter checkpoint;
+      checkpoint.section("node");
+      checkpoint.field(ros::WallTime::now().toSec());
+      estimator_->saveCheckpoint(&checkpoint);
+      checkpoint.save(file_);
+    }
+    catch (const std::runtime_error& e)
+    {
+      ROS_WARN("checkpoint: %s", e.what());
+    }
+  }
+
+private:
+  bool load()
+  {
+    struct stat file_stat;
+    if (stat(file_.c_str(), &file_stat) != 0)
+    {
+      return false;
+    }
+    // A failed load can leave the estimator half overwritten.
+    Estimator backup(*estimator_);
+    try
+    {
+      CheckpointReader checkpoint(file_);
+      double wall_time;
+      checkpoint.section("node");
+      checkpoint.field(wall_time);
+      double age = ros::WallTime::now().toSec() - wall_time;
+      if (age > max_age_)
+      {
+        ROS_WARN("checkpoint: %s is %.0f s old, not loaded", file_.c_str(), age);
+        return false;
+      }
+      estimator_->loadCheckpoint(&checkpoint);
+      std::cout << "checkpoint " << file_ << " loaded (" << age << " s old)" << std::endl;
+      return true;
+    }
+    catch (const std::runtime_error& e)
+    {
+      *estimator_ = backup;
+      ROS_WARN("checkpoint: %s not loaded: %s", file_.c_str(), e.what());
+      return false;
+    }
+  }
+
+  bool makeDirectory() const
+  {
+    for (std::size_t i = 1; i <= directory_.size(); i++)
+    {
+      if (i < directory_.size() && directory_[i] != '/')
+      {
+        continue;
+      }
+      std::string parent = directory_.substr(0, i);
+      if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+      {
+        ROS_WARN("checkpoint: cannot create %s", parent.c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void timerCallback(const ros::WallTimerEvent&)
+  {
+    save();
+  }
+
+  void requestCallback(const std_msgs::Empty::ConstPtr&)
+  {
+    save();
+  }
+
+  bool enable_;
+  std::string directory_;
+  double period_;
+  double max_age_;
+  std::string file_;
+  Estimator* estimator_;
+  ros::WallTimer timer_;
+  ros::Subscriber request_sub_;
+};
+
+#endif /*NODE_CHECKPOINT_H */
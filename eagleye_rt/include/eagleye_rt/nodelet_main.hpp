@@ -0,0 +1,62 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * nodelet_main.hpp
+ * Author MapIV Sekino
+ */
+
+// main() of the node executables of the estimation stages. Each stage is
+// implemented once, as a nodelet in src/nodelet, and its node executable
+// loads that nodelet into its own process under the node name, with the
+// remappings and the arguments (1st/2nd/3rd) of the node. The nodelet runs its
+// callbacks one at a time on its own queue, as a node does on its spin thread.
+// The node and the nodelet launch files therefore run the same code.
+
+#ifndef NODELET_MAIN_H
+#define NODELET_MAIN_H
+
+#include "ros/ros.h"
+#include <nodelet/loader.h>
+#include <string>
+#include <vector>
+
+inline int runNodelet(int argc, char** argv, const std::string& name, const std::string& type)
+{
+  ros::init(argc, argv, name);
+  // ros::init() removed the remapping arguments, the rest are for the nodelet.
+  std::vector<std::string> my_argv(argv + 1, argv + argc);
+  nodelet::Loader loader(false);
+  if (!loader.load(ros::this_node::getName(), type, ros::names::getRemappings(), my_argv))
+  {
+    ROS_ERROR("Failed to load %s", type.c_str());
+    return 1;
+  }
+
+  ros::spin();
+  return 0;
+}
+
+#endif /*NODELET_MAIN_H */
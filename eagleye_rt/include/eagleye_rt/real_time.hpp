@@ -0,0 +1,148 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * real_time.hpp
+ * Author MapIV Sekino
+ */
+
+// Real-time mode of an eagleye_rt node, enabled with real_time/enable. init()
+// locks all current and future pages of the process (mlockall), keeps the
+// heap from being trimmed or served by mmap and prefaults the stack, so that
+// the estimate call does not take page faults. The node then reserves the
+// windows of its estimator, see VelocityScaleFactorEstimator::reserve().
+//
+// start() and stop() wrap the estimate call and count the operator new calls
+// made in between. Once real_time/warm_up_time has passed, a call that
+// allocates is reported, or aborts the node with real_time/abort_on_allocation.
+// The counter is src/real_time/allocation_counter.cpp, which replaces operator
+// new of the node executables. A nodelet manager keeps its own operator new,
+// so for nodelets loaded into a manager only the memory locking and the
+// reservation apply.
+
+#ifndef REAL_TIME_H
+#define REAL_TIME_H
+
+#include "ros/ros.h"
+#include <malloc.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Operator new calls of the calling thread, null when the allocation counter
+// is not linked in.
+extern uint64_t eagleyeAllocationCount() __attribute__((weak));
+
+class RealTime
+{
+public:
+  RealTime()
+    : enable_(false), abort_on_allocation_(false), warm_up_time_(10.0), warm_up_end_(0), start_count_(0),
+      allocation_count_(0)
+  {
+  }
+
+  // Returns true when the real-time mode is enabled.
+  bool init(ros::NodeHandle& nh, const std::string& name)
+  {
+    nh.getParam("real_time/enable", enable_);
+    if (!enable_)
+    {
+      return false;
+    }
+    nh.getParam("real_time/warm_up_time", warm_up_time_);
+    nh.getParam("real_time/abort_on_allocation", abort_on_allocation_);
+    name_ = name;
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+      ROS_WARN("%s: mlockall failed, memory is not locked: %s", name_.c_str(), std::strerror(errno));
+    }
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    prefaultStack();
+
+    if (!eagleyeAllocationCount)
+    {
+      ROS_WARN("%s: allocation check is not available in this process", name_.c_str());
+    }
+    warm_up_end_ = ros::WallTime::now().toSec() + warm_up_time_;
+    return true;
+  }
+
+  bool enabled() const { return enable_; }
+
+  void start()
+  {
+    if (enable_ && eagleyeAllocationCount)
+    {
+      start_count_ = eagleyeAllocationCount();
+    }
+  }
+
+  void stop()
+  {
+    if (!enable_ || !eagleyeAllocationCount)
+    {
+      return;
+    }
+    uint64_t count = eagleyeAllocationCount() - start_count_;
+    if (count == 0 || ros::WallTime::now().toSec() < warm_up_end_)
+    {
+      return;
+    }
+    allocation_count_ += count;
+    if (abort_on_allocation_)
+    {
+      ROS_FATAL("%s: estimate call allocated %lu times after warm-up", name_.c_str(), static_cast<unsigned long>(count));
+      std::abort();
+    }
+    ROS_WARN_THROTTLE(1.0, "%s: estimate call allocated %lu times after warm-up (%lu in total)", name_.c_str(),
+                      static_cast<unsigned long>(count), static_cast<unsigned long>(allocation_count_));
+  }
+
+private:
+  static const int stack_prefault_size = 512 * 1024;
+
+  static void __attribute__((noinline)) prefaultStack()
+  {
+    unsigned char stack[stack_prefault_size];
+    std::memset(stack, 0, sizeof(stack));
+    asm volatile("" : : "r"(stack) : "memory");
+  }
+
+  bool enable_;
+  bool abort_on_allocation_;
+  double warm_up_time_;
+  double warm_up_end_;
+  uint64_t start_count_;
+  uint64_t allocation_count_;
+  std::string name_;
+};
+
+#endif /*REAL_TIME_H */
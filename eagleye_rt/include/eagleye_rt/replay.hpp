@@ -0,0 +1,119 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * replay.hpp
+ * Author MapIV Sekino
+ */
+
+// Offline replay of recorded sensor data through EagleyeEngine. Inputs are
+// merged across topics in header stamp order and processed as fast as
+// possible, the published messages are written to an output bag under the
+// same topic names as eagleye_rt.launch, together with one
+// eagleye_msgs/EagleyeState per IMU message. A column log (see column_log.hpp)
+// can stand in for the input bag and for the output bag; as output it keeps
+// the estimates but not eagleye_state. With smooth set the log is run
+// in ekf mode and the smoothed states of EkfSmoother are written as well,
+// under <output_namespace>/smoothed/.
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "navigation/engine.hpp"
+#include "eagleye_rt/eagleye_state.hpp"
+#include "eagleye_rt/trajectory_error.hpp"
+#include <yaml-cpp/yaml.h>
+#include <string>
+#include <ostream>
+
+struct ReplayParameter
+{
+  std::string imu_topic;
+  std::string twist_topic;
+  std::string rtklib_nav_topic;
+  std::string navsatfix_topic;
+  std::string output_namespace;
+  bool use_tf_static;
+  bool publish_state;
+  bool publish_topics;
+  // Engine checkpoint written after the first IMU message stamped at or after
+  // save_checkpoint_time, and loaded before the replay starts. Inputs up to
+  // the IMU stamp stored in a loaded checkpoint are skipped.
+  std::string save_checkpoint_file;
+  double save_checkpoint_time;
+  std::string load_checkpoint_file;
+  bool smooth;
+  // Only inputs stamped in [start_time, end_time) are processed, 0 for no
+  // limit. Outputs are written from output_start_time on, the inputs before
+  // it only warm the estimators up. Used by chunk_replay.
+  double start_time;
+  double end_time;
+  double output_start_time;
+};
+
+// The main estimates after one IMU message, to compare two runs at the same
+// instant.
+struct ReplayBoundaryState
+{
+  double stamp;
+  bool fix_status;
+  double latitude;
+  double longitude;
+  double altitude;
+  bool heading_status;
+  double heading;
+  bool velocity_scale_factor_status;
+  double velocity_scale_factor;
+  double yawrate_offset;
+};
+
+struct ReplaySummary
+{
+  unsigned long imu_count;
+  unsigned long twist_count;
+  unsigned long rtklib_nav_count;
+  unsigned long navsatfix_count;
+  unsigned long output_count;
+  double start_time;
+  double end_time;
+  double processing_time;
+  // After the last IMU message before output_start_time, and after the last
+  // IMU message of the replay.
+  ReplayBoundaryState warm_up_end;
+  ReplayBoundaryState end;
+};
+
+extern void setDefaultReplayParameter(EagleyeEngineParameter*, ReplayParameter*);
+extern void loadEagleyeConfig(const YAML::Node&, EagleyeEngineParameter*, ReplayParameter*);
+extern void loadEagleyeConfig(const std::string&, EagleyeEngineParameter*, ReplayParameter*);
+// Every written fix is also appended to the trajectory, if one is given.
+extern void replayBag(const std::string&, const std::string&, const EagleyeEngineParameter&, const ReplayParameter&,
+                      ReplaySummary*, Trajectory* = NULL);
+// Stamp range of the IMU input of a log [s]. For a bag the record time range
+// of the IMU topic, for a column log its header stamp range.
+extern void replayTimeRange(const std::string&, const ReplayParameter&, double*, double*);
+extern void printReplaySummary(std::ostream&, const std::string&, const ReplaySummary&);
+
+#endif /*REPLAY_H */
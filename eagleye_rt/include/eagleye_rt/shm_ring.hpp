@@ -0,0 +1,342 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * shm_ring.hpp
+ * Author MapIV Sekino
+ */
+
+// Single-producer multi-consumer ring of serialized messages in POSIX shared
+// memory. The producer owns the segment; every consumer keeps its own read
+// cursor, so a slow consumer only loses the messages it fell behind on and
+// never holds up the producer or the other consumers. Every slot is guarded by
+// a sequence number (a seqlock), so a reader that is overtaken while copying
+// notices and drops the slot instead of returning a torn message. Readers
+// block on a futex in the header; the producer only issues the wake-up system
+// call while somebody is waiting.
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+class ShmRing
+{
+public:
+  ShmRing() : fd_(-1), inode_(0), base_(NULL), length_(0), header_(NULL), owner_(false) {}
+  ~ShmRing() { close(); }
+
+  // Name of the segment that carries the given resolved topic.
+  static std::string nameForTopic(const std::string& topic)
+  {
+    std::string name = "/eagleye_shm";
+    for (size_t i = 0; i < topic.size(); ++i)
+    {
+      name += topic[i] == '/' ? '_' : topic[i];
+    }
+    return name;
+  }
+
+  // Producer side. Replaces any segment left behind under the same name.
+  // The segment is readable and writable by the producer's user only, or also
+  // by the given group when group is not (gid_t)-1.
+  bool create(const std::string& name, uint32_t slot_count, uint32_t slot_size,
+              const std::string& datatype, const std::string& md5sum, gid_t group = (gid_t)-1)
+  {
+    close();
+    if (slot_count == 0 || slot_size == 0 || datatype.size() >= sizeof(header_->datatype) ||
+        md5sum.size() >= sizeof(header_->md5sum))
+    {
+      return false;
+    }
+    shm_unlink(name.c_str());
+    bool shared = group != (gid_t)-1;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, shared ? 0660 : 0600);
+    if (fd < 0)
+    {
+      return false;
+    }
+    // The consumers write the waiter count, so the group needs write access,
+    // which the umask usually takes away at shm_open.
+    if (shared && (fchown(fd, (uid_t)-1, group) != 0 || fchmod(fd, 0660) != 0))
+    {
+      ::close(fd);
+      shm_unlink(name.c_str());
+      return false;
+    }
+    uint64_t stride = alignUp(sizeof(Slot) + slot_size);
+    size_t length = alignUp(sizeof(Header)) + stride * slot_count;
+    if (ftruncate(fd, length) != 0 || !map(fd, length))
+    {
+      ::close(fd);
+      shm_unlink(name.c_str());
+      return false;
+    }
+    name_ = name;
+    owner_ = true;
+    header_->slot_count = slot_count;
+    header_->slot_size = slot_size;
+    header_->slot_stride = stride;
+    std::memcpy(header_->datatype, datatype.c_str(), datatype.size() + 1);
+    std::memcpy(header_->md5sum, md5sum.c_str(), md5sum.size() + 1);
+    header_->write_sequence.store(0, std::memory_order_relaxed);
+    header_->futex.store(0, std::memory_order_relaxed);
+    header_->waiters.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < slot_count; ++i)
+    {
+      slot(i)->state.store(0, std::memory_order_relaxed);
+    }
+    header_->magic.store(kMagic, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Fails until the producer has finished creating the segment.
+  bool open(const std::string& name)
+  {
+    close();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header) || !map(fd, st.st_size))
+    {
+      ::close(fd);
+      return false;
+    }
+    if (header_->magic.load(std::memory_order_acquire) != kMagic ||
+        length_ < alignUp(sizeof(Header)) + header_->slot_stride * header_->slot_count)
+    {
+      close();
+      return false;
+    }
+    name_ = name;
+    owner_ = false;
+    return true;
+  }
+
+  void close()
+  {
+    if (base_)
+    {
+      munmap(base_, length_);
+      ::close(fd_);
+      if (owner_)
+      {
+        shm_unlink(name_.c_str());
+      }
+    }
+    fd_ = -1;
+    base_ = NULL;
+    header_ = NULL;
+    length_ = 0;
+  }
+
+  bool isOpen() const { return header_ != NULL; }
+
+  // True once the segment was removed or replaced by a restarted producer.
+  bool stale() const
+  {
+    struct stat st;
+    std::string path = "/dev/shm" + name_;
+    return !header_ || stat(path.c_str(), &st) != 0 || st.st_ino != inode_;
+  }
+
+  std::string datatype() const { return header_->datatype; }
+  std::string md5sum() const { return header_->md5sum; }
+  uint32_t slotSize() const { return header_->slot_size; }
+
+  // Sequence number the next message will be written with.
+  uint64_t writeSequence() const { return header_->write_sequence.load(std::memory_order_acquire); }
+
+  // Producer side. Returns the payload area of the next slot, or NULL if the
+  // message does not fit; the message is published by endWrite().
+  uint8_t* beginWrite(uint32_t size)
+  {
+    if (size > header_->slot_size)
+    {
+      return NULL;
+    }
+    uint64_t sequence = header_->write_sequence.load(std::memory_order_relaxed);
+    Slot* s = slot(sequence % header_->slot_count);
+    s->state.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s->size = size;
+    return payload(s);
+  }
+
+  void endWrite()
+  {
+    uint64_t sequence = header_->write_sequence.load(std::memory_order_relaxed);
+    slot(sequence % header_->slot_count)->state.store(2 * sequence + 2, std::memory_order_release);
+    header_->write_sequence.store(sequence + 1, std::memory_order_release);
+    header_->futex.fetch_add(1, std::memory_order_release);
+    if (header_->waiters.load(std::memory_order_seq_cst) != 0)
+    {
+      syscall(SYS_futex, &header_->futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+  }
+
+  bool write(const uint8_t* data, uint32_t size)
+  {
+    uint8_t* p = beginWrite(size);
+    if (!p)
+    {
+      return false;
+    }
+    std::memcpy(p, data, size);
+    endWrite();
+    return true;
+  }
+
+  // Consumer side. Copies the message at *cursor into buffer and advances the
+  // cursor. Messages the producer already overwrote are skipped and added to
+  // *dropped. Returns false when there is nothing new.
+  bool read(uint64_t* cursor, std::vector<uint8_t>* buffer, uint64_t* dropped)
+  {
+    for (;;)
+    {
+      uint64_t sequence = header_->write_sequence.load(std::memory_order_acquire);
+      if (*cursor >= sequence)
+      {
+        return false;
+      }
+      if (sequence - *cursor > header_->slot_count)
+      {
+        *dropped += sequence - header_->slot_count - *cursor;
+        *cursor = sequence - header_->slot_count;
+      }
+      Slot* s = slot(*cursor % header_->slot_count);
+      uint64_t expected = 2 * *cursor + 2;
+      if (s->state.load(std::memory_order_acquire) == expected)
+      {
+        uint32_t size = s->size;
+        if (size <= header_->slot_size)
+        {
+          buffer->resize(size);
+          std::memcpy(buffer->data(), payload(s), size);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->state.load(std::memory_order_relaxed) == expected && size <= header_->slot_size)
+        {
+          ++*cursor;
+          return true;
+        }
+      }
+      // Overwritten while copying.
+      ++*dropped;
+      ++*cursor;
+    }
+  }
+
+  // Blocks until a message past cursor is written or the timeout expires.
+  void wait(uint64_t cursor, double timeout)
+  {
+    uint32_t futex = header_->futex.load(std::memory_order_acquire);
+    header_->waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (writeSequence() <= cursor)
+    {
+      struct timespec ts;
+      ts.tv_sec = (time_t)timeout;
+      ts.tv_nsec = (long)((timeout - ts.tv_sec) * 1e9);
+      syscall(SYS_futex, &header_->futex, FUTEX_WAIT, futex, &ts, NULL, 0);
+    }
+    header_->waiters.fetch_sub(1, std::memory_order_seq_cst);
+  }
+
+private:
+  static const uint64_t kMagic = 0x6561676c65796531ULL;  // "eagleye1"
+
+  struct Header
+  {
+    std::atomic<uint64_t> magic;
+    uint64_t slot_stride;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    char datatype[128];
+    char md5sum[40];
+    alignas(64) std::atomic<uint64_t> write_sequence;
+    std::atomic<uint32_t> futex;
+    std::atomic<uint32_t> waiters;
+  };
+
+  struct Slot
+  {
+    std::atomic<uint64_t> state;
+    uint32_t size;
+    uint32_t reserved;
+  };
+
+  static uint64_t alignUp(uint64_t n) { return (n + 63) & ~(uint64_t)63; }
+
+  bool map(int fd, size_t length)
+  {
+    void* base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+      return false;
+    }
+    struct stat st;
+    fstat(fd, &st);
+    fd_ = fd;
+    inode_ = st.st_ino;
+    base_ = base;
+    length_ = length;
+    header_ = static_cast<Header*>(base);
+    return true;
+  }
+
+  Slot* slot(uint64_t index) const
+  {
+    return reinterpret_cast<Slot*>(static_cast<uint8_t*>(base_) + alignUp(sizeof(Header)) +
+                                   index * header_->slot_stride);
+  }
+
+  static uint8_t* payload(Slot* s) { return reinterpret_cast<uint8_t*>(s + 1); }
+
+  int fd_;
+  ino_t inode_;
+  void* base_;
+  size_t length_;
+  Header* header_;
+  std::string name_;
+  bool owner_;
+};
+
+#endif /*SHM_RING_H */
@@ -0,0 +1,214 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * shm_transport.hpp
+ * Author MapIV Sekino
+ */
+
+// Subscription that takes a high-rate input from the shared-memory ring of
+// the shm_bridge node instead of a TCPROS connection, when
+// shm_transport/enable is set. The bridge receives each sensor message once
+// and every node reads the serialized bytes straight out of the ring, so the
+// publisher no longer serializes and sends the message once per node. A
+// background thread reads the ring and hands the deserialized messages to the
+// callback queue of the node handle, so the callbacks still run on the spin
+// thread, in order, exactly as with ros::Subscriber. Without the option the
+// subscription is an ordinary ros::Subscriber.
+
+#ifndef SHM_TRANSPORT_H
+#define SHM_TRANSPORT_H
+
+#include "ros/ros.h"
+#include "ros/callback_queue_interface.h"
+#include "eagleye_rt/shm_ring.hpp"
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <atomic>
+#include <string>
+#include <vector>
+
+template<class M>
+class ShmReader
+{
+public:
+  typedef boost::function<void(const boost::shared_ptr<M const>&)> Callback;
+
+  ShmReader(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size, const Callback& callback)
+    : queue_(nh.getCallbackQueue()), topic_(topic), name_(ShmRing::nameForTopic(topic)),
+      queue_size_(queue_size == 0 ? 1 : queue_size), callback_(callback),
+      pending_(new std::atomic<uint32_t>(0)), stop_(false)
+  {
+    thread_ = boost::thread(&ShmReader::run, this);
+  }
+
+  ~ShmReader()
+  {
+    stop_ = true;
+    thread_.join();
+    queue_->removeByID(reinterpret_cast<uint64_t>(this));
+  }
+
+private:
+  class MessageCallback : public ros::CallbackInterface
+  {
+  public:
+    MessageCallback(const Callback& callback, const boost::shared_ptr<M const>& msg,
+                    const boost::shared_ptr<std::atomic<uint32_t> >& pending)
+      : callback_(callback), msg_(msg), pending_(pending) {}
+
+    ~MessageCallback() { --*pending_; }
+
+    CallResult call()
+    {
+      callback_(msg_);
+      return Success;
+    }
+
+  private:
+    Callback callback_;
+    boost::shared_ptr<M const> msg_;
+    boost::shared_ptr<std::atomic<uint32_t> > pending_;
+  };
+
+  bool connect()
+  {
+    if (!ring_.open(name_))
+    {
+      return false;
+    }
+    if (ring_.md5sum() != ros::message_traits::md5sum<M>())
+    {
+      ROS_ERROR("%s carries %s, expected %s", name_.c_str(), ring_.datatype().c_str(),
+                ros::message_traits::datatype<M>());
+      ring_.close();
+      return false;
+    }
+    cursor_ = ring_.writeSequence();
+    ROS_INFO("Reading %s from shared memory %s", topic_.c_str(), name_.c_str());
+    return true;
+  }
+
+  void run()
+  {
+    std::vector<uint8_t> buffer;
+    uint64_t dropped = 0;
+    while (!stop_)
+    {
+      if (!ring_.isOpen() && !connect())
+      {
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(500));
+        continue;
+      }
+      // Leave the messages in the ring while the node is behind; once the
+      // producer laps the cursor the oldest ones are dropped, like a full
+      // subscriber queue.
+      if (*pending_ >= queue_size_)
+      {
+        boost::this_thread::sleep_for(boost::chrono::microseconds(200));
+        continue;
+      }
+      uint64_t dropped_before = dropped;
+      if (!ring_.read(&cursor_, &buffer, &dropped))
+      {
+        ring_.wait(cursor_, 0.1);
+        if (ring_.writeSequence() <= cursor_ && ring_.stale())
+        {
+          ring_.close();
+        }
+        continue;
+      }
+      if (dropped != dropped_before)
+      {
+        ROS_WARN_THROTTLE(1.0, "%s: %lu messages dropped from shared memory", topic_.c_str(),
+                          (unsigned long)dropped);
+      }
+
+      boost::shared_ptr<M> msg(new M);
+      try
+      {
+        ros::serialization::IStream stream(buffer.data(), buffer.size());
+        ros::serialization::deserialize(stream, *msg);
+      }
+      catch (ros::serialization::StreamOverrunException& e)
+      {
+        ROS_ERROR("%s: %s", topic_.c_str(), e.what());
+        continue;
+      }
+      ++*pending_;
+      queue_->addCallback(ros::CallbackInterfacePtr(new MessageCallback(callback_, msg, pending_)),
+                          reinterpret_cast<uint64_t>(this));
+    }
+  }
+
+  ros::CallbackQueueInterface* queue_;
+  std::string topic_;
+  std::string name_;
+  uint32_t queue_size_;
+  Callback callback_;
+  boost::shared_ptr<std::atomic<uint32_t> > pending_;
+  std::atomic<bool> stop_;
+  ShmRing ring_;
+  uint64_t cursor_;
+  boost::thread thread_;
+};
+
+// Keeps either the ros::Subscriber or the shared-memory reader alive.
+class ShmSubscriber
+{
+public:
+  ShmSubscriber() {}
+  explicit ShmSubscriber(const ros::Subscriber& sub) : sub_(sub) {}
+  explicit ShmSubscriber(const boost::shared_ptr<void>& reader) : reader_(reader) {}
+
+private:
+  ros::Subscriber sub_;
+  boost::shared_ptr<void> reader_;
+};
+
+template<class M>
+ShmSubscriber subscribeShm(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size,
+                           const boost::function<void(const boost::shared_ptr<M const>&)>& callback,
+                           const ros::TransportHints& hints = ros::TransportHints())
+{
+  bool enable = false;
+  nh.getParam("shm_transport/enable", enable);
+  if (!enable)
+  {
+    return ShmSubscriber(nh.subscribe<M>(topic, queue_size, callback, ros::VoidConstPtr(), hints));
+  }
+  return ShmSubscriber(boost::shared_ptr<void>(new ShmReader<M>(nh, nh.resolveName(topic), queue_size, callback)));
+}
+
+template<class M>
+ShmSubscriber subscribeShm(ros::NodeHandle& nh, const std::string& topic, uint32_t queue_size,
+                           void (*callback)(const boost::shared_ptr<M const>&),
+                           const ros::TransportHints& hints = ros::TransportHints())
+{
+  return subscribeShm<M>(nh, topic, queue_size, typename ShmReader<M>::Callback(callback), hints);
+}
+
+#endif /*SHM_TRANSPORT_H */
@@ -0,0 +1,144 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * trajectory_error.hpp
+ * Author MapIV Sekino
+ */
+
+// Error of an estimated trajectory against a reference trajectory, e.g. the
+// fix of a replay against an RTK or post-processed INS solution. The
+// reference is interpolated linearly to every estimate stamp; estimates
+// outside the reference or in a reference gap are left out.
+
+#ifndef TRAJECTORY_ERROR_H
+#define TRAJECTORY_ERROR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+struct Trajectory
+{
+  std::vector<int64_t> stamp;
+  // [deg], [deg], [m]
+  std::vector<double> latitude;
+  std::vector<double> longitude;
+  std::vector<double> altitude;
+};
+
+// [rad] clockwise from north, as eagleye_msgs/Heading.
+struct HeadingTrajectory
+{
+  std::vector<int64_t> stamp;
+  std::vector<double> heading;
+};
+
+struct TrajectoryErrorParameter
+{
+  // Longest reference interval interpolated over [s].
+  double max_reference_gap;
+  // Estimates before reference start + skip_time are left out [s].
+  double skip_time;
+  // A reference epoch counts as available if an estimate is this close [s].
+  double max_estimate_gap;
+  // Along/cross-track and heading errors need the reference direction of
+  // travel, they are left out below this reference speed [m/s].
+  double min_speed;
+  // Added to the reference stamps, e.g. for a reference in GPS time [s].
+  double reference_time_offset;
+};
+
+struct TrajectoryError
+{
+  std::size_t count;
+  double horizontal_rms;
+  double horizontal_p95;
+  double horizontal_max;
+  double vertical_rms;
+  double vertical_max;
+  // Sums over the compared estimates, to pool several logs.
+  double horizontal_square_sum;
+  double vertical_square_sum;
+};
+
+// Running count, mean, RMS, max and percentiles of one error in constant
+// memory. Percentiles are of the absolute error and come from a histogram
+// with bins 1 % wide, so two statistics can be merged without their samples.
+class ErrorStatistics
+{
+public:
+  ErrorStatistics();
+  void add(double error);
+  void merge(const ErrorStatistics&);
+  std::size_t count() const { return count_; }
+  double mean() const;
+  double rms() const;
+  double max() const { return max_; }
+  // Upper bound of the bin holding the ratio * count() smallest |error|.
+  double percentile(double ratio) const;
+
+private:
+  std::size_t count_;
+  double sum_;
+  double square_sum_;
+  double max_;
+  std::vector<uint64_t> histogram_;
+};
+
+struct TrajectoryEvaluation
+{
+  // Reference epochs after skip_time, and those with an estimate.
+  std::size_t reference_count;
+  std::size_t available_count;
+  // [m], along-track positive ahead, cross-track positive to the right.
+  ErrorStatistics horizontal;
+  ErrorStatistics along_track;
+  ErrorStatistics cross_track;
+  ErrorStatistics height;
+  // [rad], against the reference course over ground.
+  ErrorStatistics heading;
+
+  TrajectoryEvaluation() : reference_count(0), available_count(0) {}
+  void merge(const TrajectoryEvaluation&);
+};
+
+// sensor_msgs/NavSatFix or eagleye_msgs/Position rows of a column log table,
+// or messages of a bag topic, sorted by header stamp. Position messages are
+// converted with their ecef_base_pos and only the enabled ones are kept.
+extern void loadTrajectory(const std::string& file, const std::string& table, Trajectory*);
+// The enabled eagleye_msgs/Heading rows or messages.
+extern void loadHeadingTrajectory(const std::string& file, const std::string& table, HeadingTrajectory*);
+extern void setDefaultTrajectoryErrorParameter(TrajectoryErrorParameter*);
+extern void evaluateTrajectory(const Trajectory& estimate, const Trajectory& reference, const TrajectoryErrorParameter&,
+                               TrajectoryError*);
+// Add the errors of one log to evaluation.
+extern void evaluateTrajectory(const Trajectory& estimate, const Trajectory& reference, const TrajectoryErrorParameter&,
+                               TrajectoryEvaluation*);
+extern void evaluateTrajectory(const HeadingTrajectory& estimate, const Trajectory& reference,
+                               const TrajectoryErrorParameter&, TrajectoryEvaluation*);
+
+#endif /*TRAJECTORY_ERROR_H */
@@ -0,0 +1,208 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * warm_start.hpp
+ * Author MapIV Sekino
+ */
+
+// Keeps the calibrations of a node across restarts, enabled with
+// warm_start/enable. Each quantity is a yaml file in warm_start/directory
+// (default $ROS_HOME/eagleye_warm_start) holding the value, the stamp of the
+// estimate it came from, the wall time it was saved at and the number of
+// estimates made in that run. A node loads its quantities before the first
+// message and hands them to its estimator, which uses them until it has
+// estimated its own, see VelocityScaleFactorEstimator::warmStart(). A saved
+// value older than warm_start/max_age is not loaded; yawrate offsets drift with
+// the temperature of the gyro and have the shorter warm_start/yawrate_offset_max_age.
+//
+// update() records a value estimated in this run. The recorded values are
+// written every warm_start/save_period and by save(), which the node calls
+// when it shuts down. A quantity not estimated in this run is not
+// written, so its saved value keeps its age. Files are written to a temporary
+// name and renamed, so a node killed while saving leaves the old file.
+
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include "ros/ros.h"
+#include <yaml-cpp/yaml.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+class WarmStart
+{
+public:
+  WarmStart() : enable_(false), max_age_(604800.0), yawrate_offset_max_age_(86400.0), save_period_(60.0) {}
+
+  // Returns true when warm start is enabled.
+  bool init(ros::NodeHandle& nh)
+  {
+    nh.getParam("warm_start/enable", enable_);
+    if (!enable_)
+    {
+      return false;
+    }
+    nh.getParam("warm_start/directory", directory_);
+    nh.getParam("warm_start/max_age", max_age_);
+    nh.getParam("warm_start/yawrate_offset_max_age", yawrate_offset_max_age_);
+    nh.getParam("warm_start/save_period", save_period_);
+    if (directory_.empty())
+    {
+      const char* ros_home = std::getenv("ROS_HOME");
+      const char* home = std::getenv("HOME");
+      directory_ = ros_home ? ros_home : std::string(home ? home : ".") + "/.ros";
+      directory_ += "/eagleye_warm_start";
+    }
+    if (save_period_ > 0)
+    {
+      timer_ = nh.createWallTimer(ros::WallDuration(save_period_), boost::bind(&WarmStart::timerCallback, this, _1));
+    }
+    return true;
+  }
+
+  bool enabled() const { return enable_; }
+  double maxAge() const { return max_age_; }
+  double yawrateOffsetMaxAge() const { return yawrate_offset_max_age_; }
+
+  // Reads the saved value of name into value. Returns false when warm start
+  // is disabled or the value is missing, unreadable or older than max_age.
+  bool load(const std::string& name, double max_age, double* value) const
+  {
+    if (!enable_)
+    {
+      return false;
+    }
+    try
+    {
+      YAML::Node node = YAML::LoadFile(path(name));
+      double age = ros::WallTime::now().toSec() - node["wall_time"].as<double>();
+      if (age > max_age)
+      {
+        ROS_WARN("warm_start: %s is %.0f s old, not used", name.c_str(), age);
+        return false;
+      }
+      *value = node["value"].as<double>();
+      std::cout << "warm_start " << name << " " << *value << " (" << age << " s old, "
+                << node["estimates"].as<int>() << " estimates)" << std::endl;
+      return true;
+    }
+    catch (const YAML::Exception&)
+    {
+      return false;
+    }
+  }
+
+  // Records value as the latest estimate of name.
+  void update(const std::string& name, double value, const ros::Time& stamp)
+  {
+    if (!enable_)
+    {
+      return;
+    }
+    Entry& entry = entries_[name];
+    entry.value = value;
+    entry.stamp = stamp.toSec();
+    ++entry.estimates;
+  }
+
+  void save()
+  {
+    if (!enable_ || entries_.empty() || !makeDirectory())
+    {
+      return;
+    }
+    double wall_time = ros::WallTime::now().toSec();
+    for (std::map<std::string, Entry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it)
+    {
+      std::string file = path(it->first);
+      std::string tmp = file + ".tmp";
+      {
+        std::ofstream out(tmp.c_str());
+        out.precision(17);
+        out << "value: " << it->second.value << "\n"
+            << "stamp: " << it->second.stamp << "\n"
+            << "wall_time: " << wall_time << "\n"
+            << "estimates: " << it->second.estimates << "\n";
+        if (!out)
+        {
+          ROS_WARN("warm_start: cannot write %s", tmp.c_str());
+          continue;
+        }
+      }
+      std::rename(tmp.c_str(), file.c_str());
+    }
+  }
+
+private:
+  struct Entry
+  {
+    Entry() : value(0), stamp(0), estimates(0) {}
+    double value;
+    double stamp;
+    int estimates;
+  };
+
+  std::string path(const std::string& name) const { return directory_ + "/" + name + ".yaml"; }
+
+  bool makeDirectory() const
+  {
+    for (std::size_t i = 1; i <= directory_.size(); i++)
+    {
+      if (i < directory_.size() && directory_[i] != '/')
+      {
+        continue;
+      }
+      std::string parent = directory_.substr(0, i);
+      if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST)
+      {
+        ROS_WARN("warm_start: cannot create %s", parent.c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void timerCallback(const ros::WallTimerEvent&)
+  {
+    save();
+  }
+
+  bool enable_;
+  std::string directory_;
+  double max_age_;
+  double yawrate_offset_max_age_;
+  double save_period_;
+  ros::WallTimer timer_;
+  std::map<std::string, Entry> entries_;
+};
+
+#endif /*WARM_START_H */
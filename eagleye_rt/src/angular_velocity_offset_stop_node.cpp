@@ -28,65 +28,9 @@
  * Author MapIV Sekino
  */
 
-#include "ros/ros.h"
-#include "coordinate/coordinate.hpp"
-#include "navigation/navigation.hpp"
-
-static geometry_msgs::TwistStamped velocity;
-static ros::Publisher pub;
-static eagleye_msgs::AngularVelocityOffset angular_velocity_offset_stop;
-static sensor_msgs::Imu imu;
-
-struct AngularVelocityOffsetStopParameter angular_velocity_offset_stop_parameter;
-struct AngularVelocityOffsetStopStatus angular_velocity_offset_stop_status;
-
-void velocity_callback(const geometry_msgs::TwistStamped::ConstPtr& msg)
-{
-  velocity.header = msg->header;
-  velocity.twist = msg->twist;
-}
-
-void imu_callback(const sensor_msgs::Imu::ConstPtr& msg)
-{
-  imu.header = msg->header;
-  imu.orientation = msg->orientation;
-  imu.orientation_covariance = msg->orientation_covariance;
-  imu.angular_velocity = msg->angular_velocity;
-  imu.angular_velocity_covariance = msg->angular_velocity_covariance;
-  imu.linear_acceleration = msg->linear_acceleration;
-  imu.linear_acceleration_covariance = msg->linear_acceleration_covariance;
-  angular_velocity_offset_stop.header = msg->header;
-  angular_velocity_offset_stop_estimate(velocity, imu, angular_velocity_offset_stop_parameter, &angular_velocity_offset_stop_status, &angular_velocity_offset_stop);
-  pub.publish(angular_velocity_offset_stop);
-}
+#include "eagleye_rt/nodelet_main.hpp"
 
 int main(int argc, char** argv)
 {
-  ros::init(argc, argv, "angular_velocity_offset_stop");
-  ros::NodeHandle n;
-
-  std::string subscribe_twist_topic_name = "/can_twist";
-  std::string subscribe_imu_topic_name = "/imu/data_raw";
-
-  n.getParam("twist_topic",subscribe_twist_topic_name);
-  n.getParam("imu_topic",subscribe_imu_topic_name);
-  n.getParam("reverse_imu", angular_velocity_offset_stop_parameter.reverse_imu);
-  n.getParam("angular_velocity_offset_stop/stop_judgment_velocity_threshold",angular_velocity_offset_stop_parameter.stop_judgment_velocity_threshold);
-  n.getParam("angular_velocity_offset_stop/estimated_number",angular_velocity_offset_stop_parameter.estimated_number);
-  n.getParam("angular_velocity_offset_stop/outlier_threshold",angular_velocity_offset_stop_parameter.outlier_threshold);
-
-  std::cout<< "subscribe_twist_topic_name "<<subscribe_twist_topic_name<<std::endl;
-  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
-  std::cout<< "reverse_imu "<<angular_velocity_offset_stop_parameter.reverse_imu<<std::endl;
-  std::cout<< "stop_judgment_velocity_threshold "<<angular_velocity_offset_stop_parameter.stop_judgment_velocity_threshold<<std::endl;
-  std::cout<< "estimated_number "<<angular_velocity_offset_stop_parameter.estimated_number<<std::endl;
-  std::cout<< "outlier_threshold "<<angular_velocity_offset_stop_parameter.outlier_threshold<<std::endl;
-
-  ros::Subscriber sub1 = n.subscribe(subscribe_twist_topic_name, 1000, velocity_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub2 = n.subscribe(subscribe_imu_topic_name, 1000, imu_callback, ros::TransportHints().tcpNoDelay());
-  pub = n.advertise<eagleye_msgs::AngularVelocityOffset>("angular_velocity_offset_stop", 1000);
-
-  ros::spin();
-
-  return 0;
+  return runNodelet(argc, argv, "angular_velocity_offset_stop", "eagleye_rt/AngularVelocityOffsetStopNodelet");
 }
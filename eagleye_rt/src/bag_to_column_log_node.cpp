@@ -0,0 +1,169 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * bag_to_column_log_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Converts the inputs of a rosbag, as selected by eagleye_config.yaml, and
+// its /tf_static into a column log for replay, batch_replay and chunk_replay.
+// A ground truth NavSatFix topic can be added as the reference of sweep.
+
+#include "eagleye_rt/replay.hpp"
+#include "eagleye_rt/column_log_messages.hpp"
+#include <ros/package.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <tf2_msgs/TFMessage.h>
+#include <sys/stat.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+static void printUsage()
+{
+  std::cerr << "Usage: rosrun eagleye_rt bag_to_column_log [options] input.bag output.elog" << std::endl;
+  std::cerr << "  --config FILE            eagleye_config.yaml with the input topics, later files override earlier ones" << std::endl;
+  std::cerr << "                           (default: eagleye_rt/config/eagleye_config.yaml)" << std::endl;
+  std::cerr << "  --reference_topic TOPIC  NavSatFix ground truth stored as the reference trajectory" << std::endl;
+}
+
+template <class T>
+static unsigned long convertTopic(const rosbag::Bag& bag, const std::string& topic, const std::string& table,
+                                  ColumnLogWriter* writer)
+{
+  unsigned long count = 0;
+  rosbag::View view(bag, rosbag::TopicQuery(topic));
+  for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+  {
+    boost::shared_ptr<T> msg = it->instantiate<T>();
+    if (msg)
+    {
+      addColumnRow(writer, table, *msg);
+      count++;
+    }
+  }
+  std::cout << "  " << topic << " -> " << table << " " << count << " rows" << std::endl;
+  return count;
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> config_files;
+  std::vector<std::string> files;
+  std::string reference_topic;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--config" && i + 1 < argc)
+    {
+      config_files.push_back(argv[++i]);
+    }
+    else if (arg == "--reference_topic" && i + 1 < argc)
+    {
+      reference_topic = argv[++i];
+    }
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      printUsage();
+      return 1;
+    }
+    else
+    {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.size() != 2 || !isColumnLogFile(files[1]))
+  {
+    printUsage();
+    return 1;
+  }
+  if (config_files.empty())
+  {
+    config_files.push_back(ros::package::getPath("eagleye_rt") + "/config/eagleye_config.yaml");
+  }
+
+  ros::WallTime start = ros::WallTime::now();
+  try
+  {
+    EagleyeEngineParameter engine_parameter;
+    ReplayParameter replay_parameter;
+    setDefaultReplayParameter(&engine_parameter, &replay_parameter);
+    for (std::size_t i = 0; i < config_files.size(); i++)
+    {
+      std::cout << "config " << config_files[i] << std::endl;
+      loadEagleyeConfig(config_files[i], &engine_parameter, &replay_parameter);
+    }
+
+    rosbag::Bag bag;
+    bag.open(files[0], rosbag::bagmode::Read);
+    std::cout << "input " << files[0] << std::endl;
+
+    ColumnLogWriter writer;
+    convertTopic<sensor_msgs::Imu>(bag, replay_parameter.imu_topic, COLUMN_LOG_IMU_TABLE, &writer);
+    convertTopic<geometry_msgs::TwistStamped>(bag, replay_parameter.twist_topic, COLUMN_LOG_TWIST_TABLE, &writer);
+    convertTopic<rtklib_msgs::RtklibNav>(bag, replay_parameter.rtklib_nav_topic, COLUMN_LOG_RTKLIB_NAV_TABLE, &writer);
+    convertTopic<sensor_msgs::NavSatFix>(bag, replay_parameter.navsatfix_topic, COLUMN_LOG_NAVSATFIX_TABLE, &writer);
+    if (!reference_topic.empty() &&
+        convertTopic<sensor_msgs::NavSatFix>(bag, reference_topic, COLUMN_LOG_REFERENCE_TABLE, &writer) == 0)
+    {
+      throw std::runtime_error("no reference messages on " + reference_topic);
+    }
+
+    rosbag::View view(bag, rosbag::TopicQuery("/tf_static"));
+    for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+    {
+      tf2_msgs::TFMessage::ConstPtr tf = it->instantiate<tf2_msgs::TFMessage>();
+      for (std::size_t i = 0; tf && i < tf->transforms.size(); i++)
+      {
+        const geometry_msgs::TransformStamped& t = tf->transforms[i];
+        std::string table = columnLogTfTable(t.header.frame_id, t.child_frame_id);
+        addColumnRow(&writer, table, t);
+        std::cout << "  /tf_static -> " << table << std::endl;
+      }
+    }
+    bag.close();
+
+    writer.save(files[1]);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "bag_to_column_log failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  struct stat st;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "output " << files[1];
+  if (stat(files[1].c_str(), &st) == 0)
+  {
+    std::cout << " " << st.st_size / 1e6 << " [MB]";
+  }
+  std::cout << std::endl;
+  std::cout << "  processing time " << (ros::WallTime::now() - start).toSec() << " [s]" << std::endl;
+  return 0;
+}
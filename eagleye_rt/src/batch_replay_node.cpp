@@ -0,0 +1,355 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * batch_replay_node.cpp
+ * Author MapIV Sekino
+ */
+
+#include "eagleye_rt/replay.hpp"
+#include <ros/package.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+struct BatchJob
+{
+  std::string input_file;
+  std::string override_file;
+  std::string output_file;
+  ReplaySummary summary;
+  bool succeeded;
+  std::string error;
+};
+
+struct BatchOption
+{
+  std::string list_file;
+  std::string output_dir;
+  std::vector<std::string> config_files;
+  unsigned int jobs;
+  bool scaling;
+  bool use_rtk_heading;
+  bool use_rtk_deadreckoning;
+  bool use_ekf;
+};
+
+static std::mutex print_mutex;
+
+static void printUsage()
+{
+  std::cerr << "Usage: rosrun eagleye_rt batch_replay [options] list.txt" << std::endl;
+  std::cerr << "  list.txt has one log per line: input.bag [override.yaml]" << std::endl;
+  std::cerr << "  --output_dir DIR         write one output bag per log and summary.csv to DIR" << std::endl;
+  std::cerr << "  --config FILE            base eagleye_config.yaml (default: eagleye_rt/config/eagleye_config.yaml)" << std::endl;
+  std::cerr << "  --jobs N                 number of worker threads (default: number of cores)" << std::endl;
+  std::cerr << "  --scaling                process the list with 1, 2, 4, ... workers up to --jobs and print the throughput" << std::endl;
+  std::cerr << "  --use_rtk_heading        same as use_rtk_heading:=true of eagleye_rt.launch" << std::endl;
+  std::cerr << "  --use_rtk_deadreckoning  same as use_rtk_deadreckoning:=true of eagleye_rt.launch" << std::endl;
+  std::cerr << "  --use_ekf                same as ekf/enable: true of eagleye_config.yaml" << std::endl;
+}
+
+static std::string fileStem(const std::string& path)
+{
+  std::string name = path.substr(path.find_last_of('/') + 1);
+  std::string::size_type dot = name.find_last_of('.');
+  return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+static bool readList(const std::string& list_file, const std::string& output_dir, std::vector<BatchJob>* jobs)
+{
+  std::ifstream ifs(list_file.c_str());
+  if (!ifs)
+  {
+    std::cerr << "cannot open " << list_file << std::endl;
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(ifs, line))
+  {
+    std::string::size_type comment = line.find('#');
+    if (comment != std::string::npos)
+    {
+      line = line.substr(0, comment);
+    }
+
+    std::istringstream iss(line);
+    BatchJob job = BatchJob();
+    if (!(iss >> job.input_file))
+    {
+      continue;
+    }
+    iss >> job.override_file;
+
+    // Logs of different vehicles often share a file name, so outputs are numbered.
+    if (!output_dir.empty())
+    {
+      std::ostringstream oss;
+      oss << output_dir << "/" << std::setw(4) << std::setfill('0') << jobs->size() << "_" << fileStem(job.input_file) << ".bag";
+      job.output_file = oss.str();
+    }
+    jobs->push_back(job);
+  }
+  return true;
+}
+
+static void runJob(const BatchOption& option, BatchJob* job)
+{
+  try
+  {
+    EagleyeEngineParameter engine_parameter;
+    ReplayParameter replay_parameter;
+    setDefaultReplayParameter(&engine_parameter, &replay_parameter);
+    for (std::size_t i = 0; i < option.config_files.size(); i++)
+    {
+      loadEagleyeConfig(option.config_files[i], &engine_parameter, &replay_parameter);
+    }
+    if (!job->override_file.empty())
+    {
+      loadEagleyeConfig(job->override_file, &engine_parameter, &replay_parameter);
+    }
+    engine_parameter.use_rtk_heading = engine_parameter.use_rtk_heading || option.use_rtk_heading;
+    engine_parameter.use_rtk_deadreckoning = engine_parameter.use_rtk_deadreckoning || option.use_rtk_deadreckoning;
+    engine_parameter.use_ekf = engine_parameter.use_ekf || option.use_ekf;
+
+    replayBag(job->input_file, job->output_file, engine_parameter, replay_parameter, &job->summary);
+    job->succeeded = true;
+  }
+  catch (std::exception& e)
+  {
+    job->succeeded = false;
+    job->error = e.what();
+  }
+}
+
+// Every log gets its own EagleyeEngine, so logs are independent and the only
+// shared state is the index of the next log to take.
+static double runBatch(const BatchOption& option, unsigned int thread_num, bool verbose, std::vector<BatchJob>* jobs)
+{
+  std::atomic<std::size_t> next_job(0);
+  ros::WallTime start = ros::WallTime::now();
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < thread_num; i++)
+  {
+    threads.push_back(std::thread([&]()
+    {
+      std::size_t index;
+      while ((index = next_job++) < jobs->size())
+      {
+        BatchJob& job = (*jobs)[index];
+        runJob(option, &job);
+
+        if (!verbose)
+        {
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(print_mutex);
+        if (job.succeeded)
+        {
+          printReplaySummary(std::cout, job.input_file, job.summary);
+        }
+        else
+        {
+          std::cout << "input " << job.input_file << std::endl;
+          std::cout << "  failed: " << job.error << std::endl;
+        }
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i].join();
+  }
+
+  return (ros::WallTime::now() - start).toSec();
+}
+
+static double totalLogDuration(const std::vector<BatchJob>& jobs)
+{
+  double duration = 0;
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    if (jobs[i].succeeded)
+    {
+      duration += jobs[i].summary.end_time - jobs[i].summary.start_time;
+    }
+  }
+  return duration;
+}
+
+static void writeSummaryCsv(const std::string& file, const std::vector<BatchJob>& jobs)
+{
+  std::ofstream ofs(file.c_str());
+  ofs << std::fixed << std::setprecision(3);
+  ofs << "input,override,output,status,imu,twist,rtklib_nav,navsat_fix,output_messages,log_duration,processing_time,real_time_factor" << std::endl;
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    const BatchJob& job = jobs[i];
+    const ReplaySummary& s = job.summary;
+    double log_duration = s.end_time - s.start_time;
+    ofs << job.input_file << "," << job.override_file << "," << job.output_file << ","
+        << (job.succeeded ? "ok" : "failed") << ","
+        << s.imu_count << "," << s.twist_count << "," << s.rtklib_nav_count << "," << s.navsatfix_count << ","
+        << s.output_count << "," << log_duration << "," << s.processing_time << ","
+        << (s.processing_time > 0 ? log_duration / s.processing_time : 0) << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  BatchOption option = BatchOption();
+  option.jobs = std::thread::hardware_concurrency();
+  if (option.jobs == 0)
+  {
+    option.jobs = 1;
+  }
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--output_dir" && i + 1 < argc)
+    {
+      option.output_dir = argv[++i];
+    }
+    else if (arg == "--config" && i + 1 < argc)
+    {
+      option.config_files.push_back(argv[++i]);
+    }
+    else if (arg == "--jobs" && i + 1 < argc)
+    {
+      option.jobs = std::max(1, atoi(argv[++i]));
+    }
+    else if (arg == "--scaling")
+    {
+      option.scaling = true;
+    }
+    else if (arg == "--use_rtk_heading")
+    {
+      option.use_rtk_heading = true;
+    }
+    else if (arg == "--use_rtk_deadreckoning")
+    {
+      option.use_rtk_deadreckoning = true;
+    }
+    else if (arg == "--use_ekf")
+    {
+      option.use_ekf = true;
+    }
+    else if (arg.compare(0, 2, "--") != 0 && option.list_file.empty())
+    {
+      option.list_file = arg;
+    }
+    else
+    {
+      printUsage();
+      return 1;
+    }
+  }
+
+  if (option.list_file.empty())
+  {
+    printUsage();
+    return 1;
+  }
+
+  if (option.config_files.empty())
+  {
+    option.config_files.push_back(ros::package::getPath("eagleye_rt") + "/config/eagleye_config.yaml");
+  }
+
+  if (!option.output_dir.empty() && !option.scaling)
+  {
+    mkdir(option.output_dir.c_str(), 0755);
+  }
+
+  std::vector<BatchJob> jobs;
+  if (!readList(option.list_file, option.scaling ? "" : option.output_dir, &jobs))
+  {
+    return 1;
+  }
+  std::cout << "logs " << jobs.size() << " workers " << option.jobs << std::endl;
+
+  if (option.scaling)
+  {
+    // Outputs are not written so that only the estimation and the bag reading are measured.
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "workers, wall time [s], log time / wall time, speedup, efficiency" << std::endl;
+    double base_time = 0;
+    for (unsigned int thread_num = 1; ; thread_num = std::min(thread_num * 2, option.jobs))
+    {
+      std::vector<BatchJob> scaling_jobs = jobs;
+      double wall_time = runBatch(option, thread_num, false, &scaling_jobs);
+      if (thread_num == 1)
+      {
+        base_time = wall_time;
+      }
+      double speedup = wall_time > 0 ? base_time / wall_time : 0;
+      std::cout << thread_num << ", " << wall_time << ", " << (wall_time > 0 ? totalLogDuration(scaling_jobs) / wall_time : 0)
+                << ", " << speedup << ", " << speedup / thread_num << std::endl;
+      if (thread_num == option.jobs)
+      {
+        break;
+      }
+    }
+    return 0;
+  }
+
+  double wall_time = runBatch(option, option.jobs, true, &jobs);
+
+  std::size_t failed = 0;
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    failed += jobs[i].succeeded ? 0 : 1;
+  }
+  double log_duration = totalLogDuration(jobs);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "total" << std::endl;
+  std::cout << "  logs " << jobs.size() << " failed " << failed << std::endl;
+  std::cout << "  log duration " << log_duration << " [s]" << std::endl;
+  std::cout << "  wall time " << wall_time << " [s]" << std::endl;
+  if (wall_time > 0)
+  {
+    std::cout << "  log time / wall time " << log_duration / wall_time << std::endl;
+  }
+
+  if (!option.output_dir.empty())
+  {
+    writeSummaryCsv(option.output_dir + "/summary.csv", jobs);
+    std::cout << "summary " << option.output_dir << "/summary.csv" << std::endl;
+  }
+
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,423 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * chunk_replay_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Replays one long log on several cores. The log is cut into chunks by
+// header stamp; every chunk gets its own EagleyeEngine, which starts
+// --overlap seconds before the chunk so that the windows and calibrations
+// have converged when the chunk begins, and only writes the chunk itself.
+// The chunk outputs are then joined into one bag, and at every boundary the
+// end of one chunk is compared with the warmed-up start of the next.
+
+#include "eagleye_rt/replay.hpp"
+#include "eagleye_rt/column_log.hpp"
+#include <ros/package.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+struct ChunkJob
+{
+  ReplayParameter replay_parameter;
+  std::string output_file;
+  ReplaySummary summary;
+  bool succeeded;
+  std::string error;
+};
+
+struct ChunkOption
+{
+  std::string input_file;
+  std::string output_file;
+  std::vector<std::string> config_files;
+  unsigned int chunks;
+  unsigned int jobs;
+  double overlap;
+  double max_position_jump;
+  double max_heading_jump;
+  double max_velocity_scale_factor_jump;
+  bool use_rtk_heading;
+  bool use_rtk_deadreckoning;
+  bool use_ekf;
+};
+
+static void printUsage()
+{
+  std::cerr << "Usage: rosrun eagleye_rt chunk_replay [options] input.bag output.bag" << std::endl;
+  std::cerr << "  --config FILE            eagleye_config.yaml to use, later files override earlier ones" << std::endl;
+  std::cerr << "                           (default: eagleye_rt/config/eagleye_config.yaml)" << std::endl;
+  std::cerr << "  --chunks N               number of chunks (default: --jobs)" << std::endl;
+  std::cerr << "  --jobs N                 number of worker threads (default: number of cores)" << std::endl;
+  std::cerr << "  --overlap SEC            warm-up before every chunk but the first (default: 1200)" << std::endl;
+  std::cerr << "  --max_position_jump M    allowed fix difference at a boundary (default: 0.5)" << std::endl;
+  std::cerr << "  --max_heading_jump DEG   allowed heading difference at a boundary (default: 0.2)" << std::endl;
+  std::cerr << "  --max_velocity_scale_factor_jump R" << std::endl;
+  std::cerr << "                           allowed velocity scale factor difference at a boundary (default: 0.002)" << std::endl;
+  std::cerr << "  --use_rtk_heading        same as use_rtk_heading:=true of eagleye_rt.launch" << std::endl;
+  std::cerr << "  --use_rtk_deadreckoning  same as use_rtk_deadreckoning:=true of eagleye_rt.launch" << std::endl;
+  std::cerr << "  --use_ekf                same as ekf/enable: true of eagleye_config.yaml" << std::endl;
+}
+
+static void runChunk(const EagleyeEngineParameter& engine_parameter, const std::string& input_file, ChunkJob* job)
+{
+  try
+  {
+    replayBag(input_file, job->output_file, engine_parameter, job->replay_parameter, &job->summary);
+    job->succeeded = true;
+  }
+  catch (std::exception& e)
+  {
+    job->succeeded = false;
+    job->error = e.what();
+  }
+}
+
+// Chunks are written in time order, so the joined log is in time order too.
+static void joinColumnLogChunks(const std::vector<ChunkJob>& jobs, const std::string& output_file)
+{
+  ColumnLogWriter writer;
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    ColumnLog log(jobs[i].output_file);
+    std::vector<std::string> table_names = log.tableNames();
+    for (std::size_t j = 0; j < table_names.size(); j++)
+    {
+      const ColumnTable& table = *log.table(table_names[j]);
+      std::vector<std::string> column_names = table.columnNames();
+      std::vector<const double*> columns;
+      for (std::size_t k = 0; k < column_names.size(); k++)
+      {
+        columns.push_back(table.column(column_names[k]));
+      }
+      for (std::size_t row = 0; row < table.size(); row++)
+      {
+        writer.beginRow(table.name(), table.stamp()[row], table.frameId());
+        for (std::size_t k = 0; k < columns.size(); k++)
+        {
+          writer.add(column_names[k].c_str(), columns[k][row]);
+        }
+      }
+    }
+  }
+  writer.save(output_file);
+}
+
+static void joinChunks(const std::vector<ChunkJob>& jobs, const std::string& output_file)
+{
+  if (isColumnLogFile(output_file))
+  {
+    joinColumnLogChunks(jobs, output_file);
+    return;
+  }
+
+  rosbag::Bag output_bag;
+  output_bag.open(output_file, rosbag::bagmode::Write);
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    rosbag::Bag chunk_bag;
+    chunk_bag.open(jobs[i].output_file, rosbag::bagmode::Read);
+    rosbag::View view(chunk_bag);
+    for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+    {
+      output_bag.write(it->getTopic(), it->getTime(), *it);
+    }
+    chunk_bag.close();
+  }
+  output_bag.close();
+}
+
+// Returns false if the next chunk does not continue the previous one.
+static bool checkBoundary(const ReplayBoundaryState& previous, const ReplayBoundaryState& next, const ChunkOption& option)
+{
+  std::cout << "  boundary " << previous.stamp;
+  bool consistent = true;
+
+  if (previous.fix_status && next.fix_status)
+  {
+    double north = (next.latitude - previous.latitude) * M_PI / 180 * 6378137;
+    double east = (next.longitude - previous.longitude) * M_PI / 180 * 6378137 * std::cos(previous.latitude * M_PI / 180);
+    double jump = std::sqrt(east * east + north * north);
+    std::cout << " position " << jump << " [m]";
+    consistent = consistent && jump <= option.max_position_jump;
+  }
+  if (previous.heading_status && next.heading_status)
+  {
+    double jump = std::abs(std::remainder(next.heading - previous.heading, 2 * M_PI)) * 180 / M_PI;
+    std::cout << " heading " << jump << " [deg]";
+    consistent = consistent && jump <= option.max_heading_jump;
+  }
+  if (previous.velocity_scale_factor_status && next.velocity_scale_factor_status)
+  {
+    double jump = std::abs(next.velocity_scale_factor - previous.velocity_scale_factor);
+    std::cout << " velocity_scale_factor " << jump;
+    consistent = consistent && jump <= option.max_velocity_scale_factor_jump;
+  }
+
+  // An estimate the previous chunk had but the next one has not reached yet.
+  bool converged = (!previous.fix_status || next.fix_status) && (!previous.heading_status || next.heading_status) &&
+                   (!previous.velocity_scale_factor_status || next.velocity_scale_factor_status);
+
+  if (!converged)
+  {
+    std::cout << " not converged, increase --overlap" << std::endl;
+  }
+  else if (!consistent)
+  {
+    std::cout << " inconsistent" << std::endl;
+  }
+  else
+  {
+    std::cout << " ok" << std::endl;
+  }
+  return converged && consistent;
+}
+
+int main(int argc, char** argv)
+{
+  ChunkOption option = ChunkOption();
+  option.jobs = std::thread::hardware_concurrency();
+  if (option.jobs == 0)
+  {
+    option.jobs = 1;
+  }
+  option.overlap = 1200;
+  option.max_position_jump = 0.5;
+  option.max_heading_jump = 0.2;
+  option.max_velocity_scale_factor_jump = 0.002;
+
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--config" && i + 1 < argc)
+    {
+      option.config_files.push_back(argv[++i]);
+    }
+    else if (arg == "--chunks" && i + 1 < argc)
+    {
+      option.chunks = std::max(1, atoi(argv[++i]));
+    }
+    else if (arg == "--jobs" && i + 1 < argc)
+    {
+      option.jobs = std::max(1, atoi(argv[++i]));
+    }
+    else if (arg == "--overlap" && i + 1 < argc)
+    {
+      option.overlap = std::max(0.0, atof(argv[++i]));
+    }
+    else if (arg == "--max_position_jump" && i + 1 < argc)
+    {
+      option.max_position_jump = atof(argv[++i]);
+    }
+    else if (arg == "--max_heading_jump" && i + 1 < argc)
+    {
+      option.max_heading_jump = atof(argv[++i]);
+    }
+    else if (arg == "--max_velocity_scale_factor_jump" && i + 1 < argc)
+    {
+      option.max_velocity_scale_factor_jump = atof(argv[++i]);
+    }
+    else if (arg == "--use_rtk_heading")
+    {
+      option.use_rtk_heading = true;
+    }
+    else if (arg == "--use_rtk_deadreckoning")
+    {
+      option.use_rtk_deadreckoning = true;
+    }
+    else if (arg == "--use_ekf")
+    {
+      option.use_ekf = true;
+    }
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      printUsage();
+      return 1;
+    }
+    else
+    {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.size() != 2)
+  {
+    printUsage();
+    return 1;
+  }
+  option.input_file = files[0];
+  option.output_file = files[1];
+  if (option.chunks == 0)
+  {
+    option.chunks = option.jobs;
+  }
+  if (option.config_files.empty())
+  {
+    option.config_files.push_back(ros::package::getPath("eagleye_rt") + "/config/eagleye_config.yaml");
+  }
+
+  EagleyeEngineParameter engine_parameter;
+  ReplayParameter replay_parameter;
+  double log_begin, log_end;
+  try
+  {
+    setDefaultReplayParameter(&engine_parameter, &replay_parameter);
+    for (std::size_t i = 0; i < option.config_files.size(); i++)
+    {
+      std::cout << "config " << option.config_files[i] << std::endl;
+      loadEagleyeConfig(option.config_files[i], &engine_parameter, &replay_parameter);
+    }
+    engine_parameter.use_rtk_heading = engine_parameter.use_rtk_heading || option.use_rtk_heading;
+    engine_parameter.use_rtk_deadreckoning = engine_parameter.use_rtk_deadreckoning || option.use_rtk_deadreckoning;
+    engine_parameter.use_ekf = engine_parameter.use_ekf || option.use_ekf;
+
+    // The first and the last chunk are open ended so that no input is lost.
+    replayTimeRange(option.input_file, replay_parameter, &log_begin, &log_end);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "chunk_replay failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  double chunk_length = (log_end - log_begin) / option.chunks;
+  if (chunk_length < option.overlap)
+  {
+    std::cout << "chunks of " << chunk_length << " [s] are shorter than the overlap, most of the work is warm-up" << std::endl;
+  }
+
+  std::vector<ChunkJob> jobs(option.chunks);
+  for (unsigned int i = 0; i < option.chunks; i++)
+  {
+    ChunkJob& job = jobs[i];
+    job.replay_parameter = replay_parameter;
+    job.replay_parameter.smooth = false;
+    if (i > 0)
+    {
+      job.replay_parameter.output_start_time = log_begin + i * chunk_length;
+      job.replay_parameter.start_time = std::max(job.replay_parameter.output_start_time - option.overlap, 0.0);
+    }
+    if (i + 1 < option.chunks)
+    {
+      job.replay_parameter.end_time = log_begin + (i + 1) * chunk_length;
+    }
+    // Keeps the extension, which selects the output format.
+    std::string::size_type dot = option.output_file.find_last_of('.');
+    std::ostringstream oss;
+    oss << option.output_file.substr(0, dot) << ".chunk" << i
+        << (dot == std::string::npos ? "" : option.output_file.substr(dot));
+    job.output_file = oss.str();
+  }
+
+  std::cout << "log " << option.input_file << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "  chunks " << option.chunks << " of " << chunk_length << " [s], overlap " << option.overlap
+            << " [s], workers " << option.jobs << std::endl;
+
+  ros::WallTime start = ros::WallTime::now();
+  std::atomic<std::size_t> next_job(0);
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < std::min(option.jobs, option.chunks); i++)
+  {
+    threads.push_back(std::thread([&]()
+    {
+      std::size_t index;
+      while ((index = next_job++) < jobs.size())
+      {
+        runChunk(engine_parameter, option.input_file, &jobs[index]);
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i].join();
+  }
+  double replay_time = (ros::WallTime::now() - start).toSec();
+
+  bool succeeded = true;
+  double processing_time = 0;
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    if (!jobs[i].succeeded)
+    {
+      std::cout << "  chunk " << i << " failed: " << jobs[i].error << std::endl;
+      succeeded = false;
+    }
+    processing_time += jobs[i].summary.processing_time;
+  }
+
+  if (succeeded)
+  {
+    try
+    {
+      joinChunks(jobs, option.output_file);
+    }
+    catch (std::exception& e)
+    {
+      std::cout << "  join failed: " << e.what() << std::endl;
+      succeeded = false;
+    }
+  }
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    std::remove(jobs[i].output_file.c_str());
+  }
+  if (!succeeded)
+  {
+    return 1;
+  }
+
+  bool consistent = true;
+  for (std::size_t i = 1; i < jobs.size(); i++)
+  {
+    consistent = checkBoundary(jobs[i - 1].summary.end, jobs[i].summary.warm_up_end, option) && consistent;
+  }
+
+  double wall_time = (ros::WallTime::now() - start).toSec();
+  double log_duration = log_end - log_begin;
+  std::cout << "  log duration " << log_duration << " [s]" << std::endl;
+  std::cout << "  chunk processing time " << processing_time << " [s] in total" << std::endl;
+  std::cout << "  replay time " << replay_time << " [s], wall time " << wall_time << " [s]" << std::endl;
+  if (wall_time > 0)
+  {
+    std::cout << "  real-time factor " << log_duration / wall_time << std::endl;
+  }
+  std::cout << "output " << option.output_file << std::endl;
+
+  return consistent ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*
+ * compare_outputs_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Compares two recorded bags of eagleye outputs message by message, for
+// example two runs of launch/input_merger_check.launch on the same input bag:
+//
+//   rosrun eagleye_rt compare_outputs run1.bag run2.bag
+//
+// Every topic of either bag is compared in recording order, on the
+// serialized bytes. For each topic the message counts and the number of
+// differing messages are printed, with the header stamp of the first one.
+// Returns 0 only when all topics are identical.
+
+#include "ros/ros.h"
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::vector<std::vector<uint8_t> > SerializedMessages;
+
+struct TopicMessages
+{
+  bool has_header;
+  SerializedMessages messages;
+};
+
+static void printUsage()
+{
+  std::cerr << "Usage: compare_outputs BAG1 BAG2" << std::endl;
+}
+
+static void readBag(const std::string& bag_file, std::map<std::string, TopicMessages>* topics)
+{
+  rosbag::Bag bag;
+  bag.open(bag_file, rosbag::bagmode::Read);
+  rosbag::View view(bag);
+  for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+  {
+    TopicMessages& topic = (*topics)[it->getTopic()];
+    topic.has_header = it->getMessageDefinition().compare(0, 13, "Header header") == 0;
+    topic.messages.push_back(std::vector<uint8_t>(it->size()));
+    ros::serialization::OStream stream(topic.messages.back().data(), it->size());
+    it->write(stream);
+  }
+}
+
+// Header stamp of a serialized message whose first field is its header.
+static double serializedStamp(const std::vector<uint8_t>& message)
+{
+  uint32_t sec = 0;
+  uint32_t nsec = 0;
+  if (message.size() >= 12)
+  {
+    std::memcpy(&sec, &message[4], 4);
+    std::memcpy(&nsec, &message[8], 4);
+  }
+  return sec + nsec * 1e-9;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc != 3)
+  {
+    printUsage();
+    return 1;
+  }
+
+  std::map<std::string, TopicMessages> topics[2];
+  try
+  {
+    readBag(argv[1], &topics[0]);
+    readBag(argv[2], &topics[1]);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "compare_outputs failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::map<std::string, bool> names;
+  for (int i = 0; i < 2; ++i)
+  {
+    for (std::map<std::string, TopicMessages>::const_iterator it = topics[i].begin(); it != topics[i].end(); ++it)
+    {
+      names[it->first] = it->second.has_header;
+    }
+  }
+
+  bool identical = true;
+  std::printf("%-40s %10s %10s %10s  %s\n", "topic", "count1", "count2", "differing", "first stamp");
+  for (std::map<std::string, bool>::const_iterator it = names.begin(); it != names.end(); ++it)
+  {
+    const SerializedMessages& a = topics[0][it->first].messages;
+    const SerializedMessages& b = topics[1][it->first].messages;
+    std::size_t common = std::min(a.size(), b.size());
+    std::size_t differing = 0;
+    std::size_t first = common;
+    for (std::size_t i = 0; i < common; ++i)
+    {
+      if (a[i] != b[i])
+      {
+        if (differing == 0)
+        {
+          first = i;
+        }
+        ++differing;
+      }
+    }
+    if (differing == 0 && a.size() == b.size())
+    {
+      std::printf("%-40s %10zu %10zu %10zu\n", it->first.c_str(), a.size(), b.size(), differing);
+      continue;
+    }
+    identical = false;
+    const SerializedMessages& longer = a.size() > b.size() ? a : b;
+    if (it->second && first < longer.size())
+    {
+      std::printf("%-40s %10zu %10zu %10zu  %.9f\n", it->first.c_str(), a.size(), b.size(), differing,
+                  serializedStamp(first < common ? a[first] : longer[first]));
+    }
+    else
+    {
+      std::printf("%-40s %10zu %10zu %10zu\n", it->first.c_str(), a.size(), b.size(), differing);
+    }
+  }
+  std::printf(identical ? "identical\n" : "different\n");
+  return identical ? 0 : 1;
+}
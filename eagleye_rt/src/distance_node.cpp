@@ -28,41 +28,9 @@
  * Author MapIV Sekino
  */
 
-#include "ros/ros.h"
-#include "coordinate/coordinate.hpp"
-#include "navigation/navigation.hpp"
-
-static ros::Publisher pub;
-static eagleye_msgs::VelocityScaleFactor velocity_scale_factor;
-static eagleye_msgs::Distance distance;
-
-struct DistanceStatus distance_status;
-
-void velocity_scale_factor_callback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
-{
-  distance.header = msg->header;
-  distance.header.frame_id = "base_link";
-  velocity_scale_factor.header = msg->header;
-  velocity_scale_factor.scale_factor = msg->scale_factor;
-  velocity_scale_factor.correction_velocity = msg->correction_velocity;
-  velocity_scale_factor.status = msg->status;
-  distance_estimate(velocity_scale_factor,&distance_status,&distance);
-
-  if(distance_status.time_last != 0)
-  {
-    pub.publish(distance);
-  }
-}
+#include "eagleye_rt/nodelet_main.hpp"
 
 int main(int argc, char** argv)
 {
-  ros::init(argc, argv, "distance");
-
-  ros::NodeHandle n;
-  ros::Subscriber sub1 = n.subscribe("velocity_scale_factor", 1000, velocity_scale_factor_callback);
-  pub = n.advertise<eagleye_msgs::Distance>("distance", 1000);
-
-  ros::spin();
-
-  return 0;
+  return runNodelet(argc, argv, "distance", "eagleye_rt/DistanceNodelet");
 }
@@ -0,0 +1,359 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * engine_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Runs the whole eagleye_rt.launch graph in one node through EagleyeEngine
+// and publishes every estimate once per IMU message as eagleye_state
+// (eagleye_msgs/EagleyeState). The individual topics of eagleye_rt.launch
+// are published as well unless eagleye_state/publish_topics is false;
+// imu/data_corrected is always published. Parameters are read from
+// eagleye_config.yaml like replay:
+//
+//   rosrun eagleye_rt eagleye_engine [--config FILE]... [--use_rtk_heading] [--use_rtk_deadreckoning] [--use_ekf]
+
+#include "ros/ros.h"
+#include "eagleye_rt/replay.hpp"
+#include "eagleye_rt/eagleye_state.hpp"
+#include "eagleye_rt/shm_transport.hpp"
+#include "eagleye_rt/warm_start.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+#include <ros/package.h>
+#include <tf2_ros/transform_listener.h>
+#include <boost/scoped_ptr.hpp>
+#include <iostream>
+#include <vector>
+
+class EngineTopics
+{
+public:
+  void init(ros::NodeHandle& nh)
+  {
+    velocity_scale_factor_ = nh.advertise<eagleye_msgs::VelocityScaleFactor>("velocity_scale_factor", 1000);
+    distance_ = nh.advertise<eagleye_msgs::Distance>("distance", 1000);
+    yawrate_offset_stop_ = nh.advertise<eagleye_msgs::YawrateOffset>("yawrate_offset_stop", 1000);
+    yawrate_offset_1st_ = nh.advertise<eagleye_msgs::YawrateOffset>("yawrate_offset_1st", 1000);
+    yawrate_offset_2nd_ = nh.advertise<eagleye_msgs::YawrateOffset>("yawrate_offset_2nd", 1000);
+    heading_1st_ = nh.advertise<eagleye_msgs::Heading>("heading_1st", 1000);
+    heading_2nd_ = nh.advertise<eagleye_msgs::Heading>("heading_2nd", 1000);
+    heading_3rd_ = nh.advertise<eagleye_msgs::Heading>("heading_3rd", 1000);
+    heading_interpolate_1st_ = nh.advertise<eagleye_msgs::Heading>("heading_interpolate_1st", 1000);
+    heading_interpolate_2nd_ = nh.advertise<eagleye_msgs::Heading>("heading_interpolate_2nd", 1000);
+    heading_interpolate_3rd_ = nh.advertise<eagleye_msgs::Heading>("heading_interpolate_3rd", 1000);
+    slip_angle_ = nh.advertise<eagleye_msgs::SlipAngle>("slip_angle", 1000);
+    height_ = nh.advertise<eagleye_msgs::Height>("height", 1000);
+    pitching_ = nh.advertise<eagleye_msgs::Pitching>("pitching", 1000);
+    acc_x_offset_ = nh.advertise<eagleye_msgs::AccXOffset>("acc_x_offset", 1000);
+    acc_x_scale_factor_ = nh.advertise<eagleye_msgs::AccXScaleFactor>("acc_x_scale_factor", 1000);
+    reliability_fix_ = nh.advertise<sensor_msgs::NavSatFix>("navsat/reliability_fix", 1000);
+    enu_vel_ = nh.advertise<geometry_msgs::Vector3Stamped>("enu_vel", 1000);
+    enu_relative_pos_ = nh.advertise<eagleye_msgs::Position>("enu_relative_pos", 1000);
+    twist_ = nh.advertise<geometry_msgs::TwistStamped>("twist", 1000);
+    enu_absolute_pos_ = nh.advertise<eagleye_msgs::Position>("enu_absolute_pos", 1000);
+    enu_absolute_pos_interpolate_ = nh.advertise<eagleye_msgs::Position>("enu_absolute_pos_interpolate", 1000);
+    fix_ = nh.advertise<sensor_msgs::NavSatFix>("fix", 1000);
+    gnss_smooth_pos_enu_ = nh.advertise<eagleye_msgs::Position>("gnss_smooth_pos_enu", 1000);
+    angular_velocity_offset_stop_ = nh.advertise<eagleye_msgs::AngularVelocityOffset>("angular_velocity_offset_stop", 1000);
+    enu_absolute_rtk_deadreckoning_ = nh.advertise<eagleye_msgs::Position>("enu_absolute_rtk_deadreckoning", 1000);
+    rtk_fix_ = nh.advertise<sensor_msgs::NavSatFix>("rtk_fix", 1000);
+  }
+
+  void publish(const EagleyeEngineOutput& o)
+  {
+    publish(o.velocity_scale_factor_updated, o.velocity_scale_factor, velocity_scale_factor_);
+    publish(o.distance_updated, o.distance, distance_);
+    publish(o.yawrate_offset_stop_updated, o.yawrate_offset_stop, yawrate_offset_stop_);
+    publish(o.yawrate_offset_1st_updated, o.yawrate_offset_1st, yawrate_offset_1st_);
+    publish(o.yawrate_offset_2nd_updated, o.yawrate_offset_2nd, yawrate_offset_2nd_);
+    publish(o.heading_1st_updated, o.heading_1st, heading_1st_);
+    publish(o.heading_2nd_updated, o.heading_2nd, heading_2nd_);
+    publish(o.heading_3rd_updated, o.heading_3rd, heading_3rd_);
+    publish(o.heading_interpolate_1st_updated, o.heading_interpolate_1st, heading_interpolate_1st_);
+    publish(o.heading_interpolate_2nd_updated, o.heading_interpolate_2nd, heading_interpolate_2nd_);
+    publish(o.heading_interpolate_3rd_updated, o.heading_interpolate_3rd, heading_interpolate_3rd_);
+    publish(o.slip_angle_updated, o.slip_angle, slip_angle_);
+    publish(o.height_updated, o.height, height_);
+    publish(o.pitching_updated, o.pitching, pitching_);
+    publish(o.acc_x_offset_updated, o.acc_x_offset, acc_x_offset_);
+    publish(o.acc_x_scale_factor_updated, o.acc_x_scale_factor, acc_x_scale_factor_);
+    publish(o.reliability_fix_updated, o.reliability_fix, reliability_fix_);
+    publish(o.enu_vel_updated, o.enu_vel, enu_vel_);
+    publish(o.enu_relative_pos_updated, o.enu_relative_pos, enu_relative_pos_);
+    publish(o.twist_updated, o.twist, twist_);
+    publish(o.enu_absolute_pos_updated, o.enu_absolute_pos, enu_absolute_pos_);
+    publish(o.enu_absolute_pos_interpolate_updated, o.enu_absolute_pos_interpolate, enu_absolute_pos_interpolate_);
+    publish(o.fix_updated, o.fix, fix_);
+    publish(o.gnss_smooth_pos_enu_updated, o.gnss_smooth_pos_enu, gnss_smooth_pos_enu_);
+    publish(o.angular_velocity_offset_stop_updated, o.angular_velocity_offset_stop, angular_velocity_offset_stop_);
+    publish(o.enu_absolute_rtk_deadreckoning_updated, o.enu_absolute_rtk_deadreckoning, enu_absolute_rtk_deadreckoning_);
+    publish(o.rtk_fix_updated, o.rtk_fix, rtk_fix_);
+  }
+
+private:
+  template <class T>
+  static void publish(bool updated, const T& msg, const ros::Publisher& pub)
+  {
+    if (updated)
+    {
+      pub.publish(msg);
+    }
+  }
+
+  ros::Publisher velocity_scale_factor_, distance_, yawrate_offset_stop_, yawrate_offset_1st_, yawrate_offset_2nd_;
+  ros::Publisher heading_1st_, heading_2nd_, heading_3rd_;
+  ros::Publisher heading_interpolate_1st_, heading_interpolate_2nd_, heading_interpolate_3rd_;
+  ros::Publisher slip_angle_, height_, pitching_, acc_x_offset_, acc_x_scale_factor_, reliability_fix_;
+  ros::Publisher enu_vel_, enu_relative_pos_, twist_, enu_absolute_pos_, enu_absolute_pos_interpolate_, fix_;
+  ros::Publisher gnss_smooth_pos_enu_, angular_velocity_offset_stop_, enu_absolute_rtk_deadreckoning_, rtk_fix_;
+};
+
+// The GNSS antenna offset is fixed when the engine is constructed, so it is
+// looked up from tf once at startup instead of periodically like position_node.
+static void lookupTfGnss(EagleyeEngineParameter* p)
+{
+  tf2_ros::Buffer buffer;
+  tf2_ros::TransformListener listener(buffer);
+  geometry_msgs::TransformStamped t;
+  try
+  {
+    t = buffer.lookupTransform(p->position.tf_gnss_parent_flame, p->position.tf_gnss_child_flame, ros::Time(0), ros::Duration(2.0));
+  }
+  catch (tf2::TransformException& ex)
+  {
+    ROS_WARN("%s, the GNSS antenna offset is not applied", ex.what());
+    return;
+  }
+  p->position.tf_gnss_translation_x = t.transform.translation.x;
+  p->position.tf_gnss_translation_y = t.transform.translation.y;
+  p->position.tf_gnss_translation_z = t.transform.translation.z;
+  p->position.tf_gnss_rotation_x = t.transform.rotation.x;
+  p->position.tf_gnss_rotation_y = t.transform.rotation.y;
+  p->position.tf_gnss_rotation_z = t.transform.rotation.z;
+  p->position.tf_gnss_rotation_w = t.transform.rotation.w;
+  p->rtk_deadreckoning.tf_gnss_translation_x = t.transform.translation.x;
+  p->rtk_deadreckoning.tf_gnss_translation_y = t.transform.translation.y;
+  p->rtk_deadreckoning.tf_gnss_translation_z = t.transform.translation.z;
+  p->rtk_deadreckoning.tf_gnss_rotation_x = t.transform.rotation.x;
+  p->rtk_deadreckoning.tf_gnss_rotation_y = t.transform.rotation.y;
+  p->rtk_deadreckoning.tf_gnss_rotation_z = t.transform.rotation.z;
+  p->rtk_deadreckoning.tf_gnss_rotation_w = t.transform.rotation.w;
+}
+
+static boost::scoped_ptr<EagleyeEngine> engine;
+static EagleyeStateBuilder state_builder;
+static EngineTopics topics;
+static ros::Publisher state_pub;
+static ros::Publisher imu_corrected_pub;
+static bool publish_state = true;
+static bool publish_topics = true;
+static WarmStart warm_start;
+static NodeCheckpoint<EagleyeEngine> checkpoint;
+
+static void updateWarmStart(const EagleyeEngineOutput& o)
+{
+  if (o.velocity_scale_factor_updated && o.velocity_scale_factor.status.estimate_status)
+  {
+    warm_start.update("velocity_scale_factor", o.velocity_scale_factor.scale_factor, o.velocity_scale_factor.header.stamp);
+  }
+  if (o.yawrate_offset_1st_updated && o.yawrate_offset_1st.status.estimate_status)
+  {
+    warm_start.update("yawrate_offset_1st", o.yawrate_offset_1st.yawrate_offset, o.yawrate_offset_1st.header.stamp);
+  }
+  if (o.yawrate_offset_2nd_updated && o.yawrate_offset_2nd.status.estimate_status)
+  {
+    warm_start.update("yawrate_offset_2nd", o.yawrate_offset_2nd.yawrate_offset, o.yawrate_offset_2nd.header.stamp);
+  }
+  if (o.acc_x_offset_updated && o.acc_x_offset.status.estimate_status)
+  {
+    warm_start.update("acc_x_offset", o.acc_x_offset.acc_x_offset, o.acc_x_offset.header.stamp);
+  }
+  if (o.acc_x_scale_factor_updated && o.acc_x_scale_factor.status.estimate_status)
+  {
+    warm_start.update("acc_x_scale_factor", o.acc_x_scale_factor.acc_x_scale_factor, o.acc_x_scale_factor.header.stamp);
+  }
+}
+
+// Loads the calibrations saved by the nodes or by a previous engine run. The
+// engine has no slip coefficient estimator, so that one only comes from the
+// slip_coefficient node.
+static void loadWarmStart(EagleyeWarmStart* w)
+{
+  w->velocity_scale_factor_status = warm_start.load("velocity_scale_factor", warm_start.maxAge(), &w->velocity_scale_factor);
+  w->yawrate_offset_1st_status = warm_start.load("yawrate_offset_1st", warm_start.yawrateOffsetMaxAge(), &w->yawrate_offset_1st);
+  w->yawrate_offset_2nd_status = warm_start.load("yawrate_offset_2nd", warm_start.yawrateOffsetMaxAge(), &w->yawrate_offset_2nd);
+  w->slip_coefficient_status = warm_start.load("slip_coefficient", warm_start.maxAge(), &w->slip_coefficient);
+  w->acc_x_status = warm_start.load("acc_x_offset", warm_start.maxAge(), &w->acc_x_offset) &&
+                    warm_start.load("acc_x_scale_factor", warm_start.maxAge(), &w->acc_x_scale_factor);
+}
+
+static void publish(const EagleyeEngineOutput& o)
+{
+  updateWarmStart(o);
+  if (o.imu_corrected_updated)
+  {
+    imu_corrected_pub.publish(o.imu_corrected);
+  }
+  if (publish_topics)
+  {
+    topics.publish(o);
+  }
+  if (publish_state)
+  {
+    state_builder.add(o);
+  }
+}
+
+void imu_callback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  publish(engine->addImu(*msg));
+  if (publish_state)
+  {
+    state_pub.publish(state_builder.get(msg->header.stamp));
+  }
+}
+
+void velocity_callback(const geometry_msgs::TwistStamped::ConstPtr& msg)
+{
+  publish(engine->addTwist(*msg));
+}
+
+void rtklib_nav_callback(const rtklib_msgs::RtklibNav::ConstPtr& msg)
+{
+  publish(engine->addRtklibNav(*msg));
+}
+
+void navsatfix_callback(const sensor_msgs::NavSatFix::ConstPtr& msg)
+{
+  publish(engine->addNavSatFix(*msg));
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "eagleye_engine");
+  ros::NodeHandle n;
+
+  std::vector<std::string> config_files;
+  bool use_rtk_heading = false;
+  bool use_rtk_deadreckoning = false;
+  bool use_ekf = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--config" && i + 1 < argc)
+    {
+      config_files.push_back(argv[++i]);
+    }
+    else if (arg == "--use_rtk_heading")
+    {
+      use_rtk_heading = true;
+    }
+    else if (arg == "--use_rtk_deadreckoning")
+    {
+      use_rtk_deadreckoning = true;
+    }
+    else if (arg == "--use_ekf")
+    {
+      use_ekf = true;
+    }
+    else
+    {
+      std::cerr << "Usage: rosrun eagleye_rt eagleye_engine [--config FILE]... [--use_rtk_heading] [--use_rtk_deadreckoning] [--use_ekf]" << std::endl;
+      return 1;
+    }
+  }
+
+  if (config_files.empty())
+  {
+    config_files.push_back(ros::package::getPath("eagleye_rt") + "/config/eagleye_config.yaml");
+  }
+
+  EagleyeEngineParameter engine_parameter;
+  ReplayParameter replay_parameter;
+
+  try
+  {
+    setDefaultReplayParameter(&engine_parameter, &replay_parameter);
+    for (std::size_t i = 0; i < config_files.size(); i++)
+    {
+      std::cout << "config " << config_files[i] << std::endl;
+      loadEagleyeConfig(config_files[i], &engine_parameter, &replay_parameter);
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "eagleye_engine: " << e.what() << std::endl;
+    return 1;
+  }
+  engine_parameter.use_rtk_heading = engine_parameter.use_rtk_heading || use_rtk_heading;
+  engine_parameter.use_rtk_deadreckoning = engine_parameter.use_rtk_deadreckoning || use_rtk_deadreckoning;
+  engine_parameter.use_ekf = engine_parameter.use_ekf || use_ekf;
+  publish_state = replay_parameter.publish_state;
+  publish_topics = replay_parameter.publish_topics;
+
+  std::cout<< "subscribe_imu_topic_name "<<replay_parameter.imu_topic<<std::endl;
+  std::cout<< "subscribe_twist_topic_name "<<replay_parameter.twist_topic<<std::endl;
+  std::cout<< "subscribe_rtklib_nav_topic_name "<<replay_parameter.rtklib_nav_topic<<std::endl;
+  std::cout<< "subscribe_navsatfix_topic_name "<<replay_parameter.navsatfix_topic<<std::endl;
+  std::cout<< "use_rtk_heading "<<engine_parameter.use_rtk_heading<<std::endl;
+  std::cout<< "use_rtk_deadreckoning "<<engine_parameter.use_rtk_deadreckoning<<std::endl;
+  std::cout<< "use_ekf "<<engine_parameter.use_ekf<<std::endl;
+  std::cout<< "publish_state "<<publish_state<<std::endl;
+  std::cout<< "publish_topics "<<publish_topics<<std::endl;
+
+  lookupTfGnss(&engine_parameter);
+  engine.reset(new EagleyeEngine(engine_parameter));
+  if (warm_start.init(n))
+  {
+    EagleyeWarmStart engine_warm_start;
+    loadWarmStart(&engine_warm_start);
+    engine->warmStart(engine_warm_start);
+  }
+  checkpoint.init(n, ros::this_node::getName(), engine.get());
+
+  imu_corrected_pub = n.advertise<sensor_msgs::Imu>("imu/data_corrected", 1000);
+  if (publish_state)
+  {
+    state_pub = n.advertise<eagleye_msgs::EagleyeState>("eagleye_state", 1000);
+  }
+  if (publish_topics)
+  {
+    topics.init(n);
+  }
+
+  ShmSubscriber sub1 = subscribeShm(n, replay_parameter.imu_topic, 1000, imu_callback, ros::TransportHints().tcpNoDelay());
+  ShmSubscriber sub2 = subscribeShm(n, replay_parameter.rtklib_nav_topic, 1000, rtklib_nav_callback, ros::TransportHints().tcpNoDelay());
+  ros::Subscriber sub3 = n.subscribe(replay_parameter.twist_topic, 1000, velocity_callback, ros::TransportHints().tcpNoDelay());
+  ros::Subscriber sub4 = n.subscribe(replay_parameter.navsatfix_topic, 1000, navsatfix_callback, ros::TransportHints().tcpNoDelay());
+
+  ros::spin();
+  checkpoint.save();
+  warm_start.save();
+
+  return 0;
+}
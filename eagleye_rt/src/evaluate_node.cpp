@@ -0,0 +1,385 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * evaluate_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Scores eagleye outputs against a reference trajectory: eagleye/fix,
+// enu_absolute_pos_interpolate and heading_interpolate_3rd are aligned to the
+// reference by stamp, and their horizontal, along-track, cross-track, height
+// and heading errors and availability are accumulated over a list of logs.
+// Logs are evaluated in parallel. Only one log per worker is held in memory,
+// and the statistics are histograms of constant size, so the length of the
+// dataset does not matter.
+
+#include "eagleye_rt/trajectory_error.hpp"
+#include "eagleye_rt/column_log.hpp"
+#include "eagleye_rt/column_log_messages.hpp"
+#include <ros/ros.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+static const int SOURCE_COUNT = 3;
+static const char* const SOURCE_TOPICS[SOURCE_COUNT] = {"fix", "enu_absolute_pos_interpolate", "heading_interpolate_3rd"};
+static const int HEADING_SOURCE = 2;
+
+struct EvaluationJob
+{
+  std::string output_file;
+  std::string reference_file;
+  bool succeeded;
+  std::string error;
+  // Summary of the log, one csv row per source.
+  std::string rows[SOURCE_COUNT];
+};
+
+struct EvaluationOption
+{
+  std::string list_file;
+  std::string csv_file;
+  std::string reference_table;
+  std::string output_namespace;
+  unsigned int jobs;
+  TrajectoryErrorParameter parameter;
+};
+
+static std::mutex print_mutex;
+
+static void printUsage()
+{
+  std::cerr << "Usage: rosrun eagleye_rt evaluate [options] list.txt" << std::endl;
+  std::cerr << "  list.txt has one log per line: eagleye_output [reference]" << std::endl;
+  std::cerr << "  the eagleye output is a bag or a column log written by replay, the reference is" << std::endl;
+  std::cerr << "  taken from the output file if no reference file is given" << std::endl;
+  std::cerr << "  --reference_topic NAME   NavSatFix topic or table of the reference (default: reference)" << std::endl;
+  std::cerr << "  --namespace NS           namespace of the eagleye topics in a bag (default: /eagleye)" << std::endl;
+  std::cerr << "  --skip SEC               leave the first SEC of every log out (default: 0)" << std::endl;
+  std::cerr << "  --time_offset SEC        added to the reference stamps (default: 0)" << std::endl;
+  std::cerr << "  --max_reference_gap SEC  longest reference gap to interpolate over (default: 1)" << std::endl;
+  std::cerr << "  --max_estimate_gap SEC   an output this close to a reference epoch makes it available (default: 0.5)" << std::endl;
+  std::cerr << "  --min_speed M/S          reference speed for along/cross-track and heading errors (default: 1)" << std::endl;
+  std::cerr << "  --jobs N                 number of worker threads (default: number of cores)" << std::endl;
+  std::cerr << "  --output FILE            write one csv row per log and output (default: evaluation.csv)" << std::endl;
+}
+
+static bool readList(const std::string& list_file, std::vector<EvaluationJob>* jobs)
+{
+  std::ifstream ifs(list_file.c_str());
+  if (!ifs)
+  {
+    std::cerr << "cannot open " << list_file << std::endl;
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(ifs, line))
+  {
+    std::string::size_type comment = line.find('#');
+    if (comment != std::string::npos)
+    {
+      line = line.substr(0, comment);
+    }
+    std::istringstream iss(line);
+    EvaluationJob job = EvaluationJob();
+    if (!(iss >> job.output_file))
+    {
+      continue;
+    }
+    if (!(iss >> job.reference_file))
+    {
+      job.reference_file = job.output_file;
+    }
+    jobs->push_back(job);
+  }
+  return true;
+}
+
+// Heading errors are written in [deg].
+static void writeStatistics(std::ostream& os, const ErrorStatistics& s, double scale)
+{
+  os << "," << s.count() << "," << s.mean() * scale << "," << s.rms() * scale << "," << s.percentile(0.5) * scale << ","
+     << s.percentile(0.95) * scale << "," << s.percentile(0.99) * scale << "," << s.max() * scale;
+}
+
+static void writeCsvHeader(std::ostream& os)
+{
+  const char* names[] = {"horizontal", "along_track", "cross_track", "height", "heading"};
+  os << "log,output,reference_count,available_count,availability";
+  for (int i = 0; i < 5; i++)
+  {
+    os << "," << names[i] << "_count," << names[i] << "_mean," << names[i] << "_rms," << names[i] << "_p50," << names[i]
+       << "_p95," << names[i] << "_p99," << names[i] << "_max";
+  }
+  os << std::endl;
+}
+
+static std::string csvRow(const std::string& log, const std::string& source, const TrajectoryEvaluation& e)
+{
+  std::ostringstream oss;
+  oss << std::setprecision(6);
+  oss << log << "," << source << "," << e.reference_count << "," << e.available_count << ","
+      << (e.reference_count > 0 ? static_cast<double>(e.available_count) / e.reference_count : 0);
+  writeStatistics(oss, e.horizontal, 1);
+  writeStatistics(oss, e.along_track, 1);
+  writeStatistics(oss, e.cross_track, 1);
+  writeStatistics(oss, e.height, 1);
+  writeStatistics(oss, e.heading, 180 / M_PI);
+  return oss.str();
+}
+
+static void evaluateLog(const EvaluationOption& option, EvaluationJob* job, TrajectoryEvaluation* total)
+{
+  Trajectory reference;
+  loadTrajectory(job->reference_file, option.reference_table, &reference);
+  if (reference.stamp.size() < 2)
+  {
+    throw std::runtime_error("no reference in " + job->reference_file);
+  }
+
+  // A column log written by replay names its tables by topic without namespace.
+  std::string prefix = isColumnLogFile(job->output_file) ? "" : option.output_namespace + "/";
+  for (int i = 0; i < SOURCE_COUNT; i++)
+  {
+    TrajectoryEvaluation evaluation;
+    if (i == HEADING_SOURCE)
+    {
+      HeadingTrajectory heading;
+      loadHeadingTrajectory(job->output_file, prefix + SOURCE_TOPICS[i], &heading);
+      evaluateTrajectory(heading, reference, option.parameter, &evaluation);
+    }
+    else
+    {
+      Trajectory position;
+      loadTrajectory(job->output_file, prefix + SOURCE_TOPICS[i], &position);
+      evaluateTrajectory(position, reference, option.parameter, &evaluation);
+    }
+    job->rows[i] = csvRow(job->output_file, SOURCE_TOPICS[i], evaluation);
+    total[i].merge(evaluation);
+  }
+}
+
+static void printStatistics(const std::string& label, const ErrorStatistics& s, double scale)
+{
+  std::cout << "  " << std::left << std::setw(17) << label << std::right;
+  double values[] = {s.mean(), s.rms(), s.percentile(0.5), s.percentile(0.95), s.percentile(0.99), s.max()};
+  for (int i = 0; i < 6; i++)
+  {
+    std::cout << std::setw(9) << values[i] * scale;
+  }
+  std::cout << std::setw(11) << s.count() << std::endl;
+}
+
+static void printEvaluation(const std::string& source, const TrajectoryEvaluation& e, bool heading)
+{
+  std::cout << source << std::endl;
+  std::cout << "  availability " << std::setprecision(2)
+            << (e.reference_count > 0 ? 100.0 * e.available_count / e.reference_count : 0) << " % ("
+            << e.available_count << " of " << e.reference_count << " reference epochs)" << std::endl;
+  std::cout << std::setprecision(3);
+  std::cout << "  " << std::left << std::setw(17) << "error" << std::right;
+  const char* columns[] = {"mean", "rms", "p50", "p95", "p99", "max"};
+  for (int i = 0; i < 6; i++)
+  {
+    std::cout << std::setw(9) << columns[i];
+  }
+  std::cout << std::setw(11) << "count" << std::endl;
+  if (heading)
+  {
+    printStatistics("heading [deg]", e.heading, 180 / M_PI);
+    return;
+  }
+  printStatistics("horizontal [m]", e.horizontal, 1);
+  printStatistics("along-track [m]", e.along_track, 1);
+  printStatistics("cross-track [m]", e.cross_track, 1);
+  printStatistics("height [m]", e.height, 1);
+}
+
+int main(int argc, char** argv)
+{
+  EvaluationOption option;
+  option.jobs = std::thread::hardware_concurrency();
+  if (option.jobs == 0)
+  {
+    option.jobs = 1;
+  }
+  option.csv_file = "evaluation.csv";
+  option.reference_table = COLUMN_LOG_REFERENCE_TABLE;
+  option.output_namespace = "/eagleye";
+  setDefaultTrajectoryErrorParameter(&option.parameter);
+
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--reference_topic" && i + 1 < argc)
+    {
+      option.reference_table = argv[++i];
+    }
+    else if (arg == "--namespace" && i + 1 < argc)
+    {
+      option.output_namespace = argv[++i];
+    }
+    else if (arg == "--skip" && i + 1 < argc)
+    {
+      option.parameter.skip_time = atof(argv[++i]);
+    }
+    else if (arg == "--time_offset" && i + 1 < argc)
+    {
+      option.parameter.reference_time_offset = atof(argv[++i]);
+    }
+    else if (arg == "--max_reference_gap" && i + 1 < argc)
+    {
+      option.parameter.max_reference_gap = atof(argv[++i]);
+    }
+    else if (arg == "--max_estimate_gap" && i + 1 < argc)
+    {
+      option.parameter.max_estimate_gap = atof(argv[++i]);
+    }
+    else if (arg == "--min_speed" && i + 1 < argc)
+    {
+      option.parameter.min_speed = atof(argv[++i]);
+    }
+    else if (arg == "--jobs" && i + 1 < argc)
+    {
+      option.jobs = std::max(1, atoi(argv[++i]));
+    }
+    else if (arg == "--output" && i + 1 < argc)
+    {
+      option.csv_file = argv[++i];
+    }
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      printUsage();
+      return 1;
+    }
+    else
+    {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.size() != 1)
+  {
+    printUsage();
+    return 1;
+  }
+  option.list_file = files[0];
+
+  std::vector<EvaluationJob> jobs;
+  if (!readList(option.list_file, &jobs))
+  {
+    return 1;
+  }
+  if (jobs.empty())
+  {
+    std::cerr << "no logs in " << option.list_file << std::endl;
+    return 1;
+  }
+  option.jobs = std::min<unsigned int>(option.jobs, jobs.size());
+
+  // One total per worker, merged at the end.
+  std::vector<std::vector<TrajectoryEvaluation> > totals(option.jobs, std::vector<TrajectoryEvaluation>(SOURCE_COUNT));
+  ros::WallTime start = ros::WallTime::now();
+  std::atomic<std::size_t> next_job(0);
+  std::vector<std::thread> threads;
+  for (unsigned int worker = 0; worker < option.jobs; worker++)
+  {
+    threads.push_back(std::thread([&, worker]()
+    {
+      std::size_t index;
+      while ((index = next_job++) < jobs.size())
+      {
+        EvaluationJob& job = jobs[index];
+        try
+        {
+          evaluateLog(option, &job, &totals[worker][0]);
+          job.succeeded = true;
+        }
+        catch (std::exception& e)
+        {
+          job.succeeded = false;
+          job.error = e.what();
+        }
+        std::lock_guard<std::mutex> lock(print_mutex);
+        std::cout << "[" << index + 1 << "/" << jobs.size() << "] " << job.output_file
+                  << (job.succeeded ? "" : " failed: " + job.error) << std::endl;
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i].join();
+  }
+
+  std::vector<TrajectoryEvaluation> total(SOURCE_COUNT);
+  for (std::size_t worker = 0; worker < totals.size(); worker++)
+  {
+    for (int i = 0; i < SOURCE_COUNT; i++)
+    {
+      total[i].merge(totals[worker][i]);
+    }
+  }
+
+  std::ofstream ofs(option.csv_file.c_str());
+  writeCsvHeader(ofs);
+  std::size_t failed_count = 0;
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    if (!jobs[i].succeeded)
+    {
+      failed_count++;
+      continue;
+    }
+    for (int j = 0; j < SOURCE_COUNT; j++)
+    {
+      ofs << jobs[i].rows[j] << std::endl;
+    }
+  }
+  for (int i = 0; i < SOURCE_COUNT; i++)
+  {
+    ofs << csvRow("all", SOURCE_TOPICS[i], total[i]) << std::endl;
+  }
+
+  std::cout << std::fixed;
+  for (int i = 0; i < SOURCE_COUNT; i++)
+  {
+    printEvaluation(SOURCE_TOPICS[i], total[i], i == HEADING_SOURCE);
+  }
+  std::cout << "logs " << jobs.size() - failed_count << " of " << jobs.size() << ", processing time " << std::setprecision(3)
+            << (ros::WallTime::now() - start).toSec() << " [s]" << std::endl;
+  std::cout << "results " << option.csv_file << std::endl;
+  return failed_count == 0 ? 0 : 1;
+}
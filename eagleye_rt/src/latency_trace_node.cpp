@@ -0,0 +1,337 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * latency_trace_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Aggregates the eagleye_msgs/LatencyTrace events of latency_trace/enable
+// into latency distributions, either live or from a recorded bag:
+//
+//   rosrun eagleye_rt latency_trace                 (live, /eagleye/latency_trace)
+//   rosrun eagleye_rt latency_trace trace.bag       (rosbag record /eagleye/latency_trace ...)
+//
+// Events are joined by the stamp of the originating sensor message. The time
+// origin of a stamp is the earliest receive time among its events, so the
+// report does not depend on the sensor driver clock. "from stamp" compares
+// with the stamp itself and is only meaningful when the sensor stamps and the
+// wall clock agree.
+
+#include "ros/ros.h"
+#include "eagleye_msgs/LatencyTrace.h"
+#include "eagleye_rt/estimate_latency.hpp"
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct LatencyTraceNodeStats
+{
+  LatencyHistogram processing;
+  LatencyHistogram from_origin;
+  LatencyHistogram from_stamp;
+};
+
+class LatencyTraceAggregator
+{
+public:
+  LatencyTraceAggregator(const std::vector<std::string>& chain, double join_window)
+    : chain_(chain), hops_(chain.size() > 1 ? chain.size() - 1 : 0), join_window_(join_window * 1e9), newest_(0)
+  {
+  }
+
+  void add(const eagleye_msgs::LatencyTrace& event)
+  {
+    uint64_t stamp = event.header.stamp.toNSec();
+    pending_[stamp].push_back(event);
+    newest_ = std::max(newest_, stamp);
+
+    while (!pending_.empty() && pending_.begin()->first + join_window_ < newest_)
+    {
+      join(pending_.begin()->first, pending_.begin()->second);
+      pending_.erase(pending_.begin());
+    }
+  }
+
+  void flush()
+  {
+    for (std::map<uint64_t, std::vector<eagleye_msgs::LatencyTrace> >::iterator it = pending_.begin();
+         it != pending_.end(); ++it)
+    {
+      join(it->first, it->second);
+    }
+    pending_.clear();
+  }
+
+  void print(std::ostream& os) const
+  {
+    os << "per node [ms]" << std::endl;
+    printHeader(os, "node", "processing", "from first receive", "from stamp");
+    for (std::map<std::string, LatencyTraceNodeStats>::const_iterator it = nodes_.begin(); it != nodes_.end(); ++it)
+    {
+      printRow(os, it->first, it->second.processing, it->second.from_origin, it->second.from_stamp);
+    }
+
+    if (!hops_.empty())
+    {
+      os << "per hop, publish to publish [ms]" << std::endl;
+      for (std::size_t i = 0; i < hops_.size(); i++)
+      {
+        printRow(os, chain_[i] + " -> " + chain_[i + 1], hops_[i]);
+      }
+    }
+
+    if (!chain_.empty())
+    {
+      os << "end to end, to " << chain_.back() << " [ms]" << std::endl;
+      printRow(os, "from first receive", end_to_end_origin_);
+      printRow(os, "from stamp", end_to_end_stamp_);
+    }
+  }
+
+private:
+  static std::string baseName(const std::string& name)
+  {
+    std::string::size_type pos = name.rfind('/');
+    return pos == std::string::npos ? name : name.substr(pos + 1);
+  }
+
+  static std::string format(const LatencyHistogram& h)
+  {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%8.3f %8.3f %8.3f", h.percentile(0.5) * 1e-6, h.percentile(0.99) * 1e-6,
+                  h.max() * 1e-6);
+    return text;
+  }
+
+  static void printHeader(std::ostream& os, const std::string& name, const std::string& a, const std::string& b,
+                          const std::string& c)
+  {
+    char text[256];
+    std::snprintf(text, sizeof(text), "  %-36s %8s  %-26s  %-26s  %-26s", name.c_str(), "count", a.c_str(), b.c_str(),
+                  c.c_str());
+    os << text << std::endl;
+    std::snprintf(text, sizeof(text), "  %-36s %8s  %-26s  %-26s  %-26s", "", "", "     p50      p99      max",
+                  "     p50      p99      max", "     p50      p99      max");
+    os << text << std::endl;
+  }
+
+  static void printRow(std::ostream& os, const std::string& name, const LatencyHistogram& a)
+  {
+    char text[256];
+    std::snprintf(text, sizeof(text), "  %-48s %8lu  %s", name.c_str(), static_cast<unsigned long>(a.count()),
+                  format(a).c_str());
+    os << text << std::endl;
+  }
+
+  static void printRow(std::ostream& os, const std::string& name, const LatencyHistogram& a, const LatencyHistogram& b,
+                       const LatencyHistogram& c)
+  {
+    char text[256];
+    std::snprintf(text, sizeof(text), "  %-36s %8lu  %s  %s  %s", name.c_str(), static_cast<unsigned long>(a.count()),
+                  format(a).c_str(), format(b).c_str(), format(c).c_str());
+    os << text << std::endl;
+  }
+
+  static void record(LatencyHistogram* h, const ros::Time& end, uint64_t start)
+  {
+    uint64_t t = end.toNSec();
+    if (t >= start)
+    {
+      h->record(t - start);
+    }
+  }
+
+  void join(uint64_t stamp, const std::vector<eagleye_msgs::LatencyTrace>& events)
+  {
+    uint64_t origin = events[0].receive_time.toNSec();
+    for (std::size_t i = 1; i < events.size(); i++)
+    {
+      origin = std::min(origin, events[i].receive_time.toNSec());
+    }
+
+    std::vector<const eagleye_msgs::LatencyTrace*> chain_events(chain_.size(), NULL);
+    for (std::size_t i = 0; i < events.size(); i++)
+    {
+      const eagleye_msgs::LatencyTrace& event = events[i];
+      std::string name = baseName(event.node);
+      LatencyTraceNodeStats& stats = nodes_[name];
+      record(&stats.processing, event.publish_time, event.receive_time.toNSec());
+      record(&stats.from_origin, event.publish_time, origin);
+      record(&stats.from_stamp, event.publish_time, stamp);
+
+      for (std::size_t j = 0; j < chain_.size(); j++)
+      {
+        if (chain_[j] == name)
+        {
+          chain_events[j] = &event;
+        }
+      }
+    }
+
+    for (std::size_t i = 0; i < hops_.size(); i++)
+    {
+      if (chain_events[i] && chain_events[i + 1])
+      {
+        record(&hops_[i], chain_events[i + 1]->publish_time, chain_events[i]->publish_time.toNSec());
+      }
+    }
+
+    if (!chain_events.empty() && chain_events.back())
+    {
+      record(&end_to_end_origin_, chain_events.back()->publish_time, origin);
+      record(&end_to_end_stamp_, chain_events.back()->publish_time, stamp);
+    }
+  }
+
+  std::vector<std::string> chain_;
+  std::vector<LatencyHistogram> hops_;
+  uint64_t join_window_;
+  uint64_t newest_;
+  std::map<uint64_t, std::vector<eagleye_msgs::LatencyTrace> > pending_;
+  std::map<std::string, LatencyTraceNodeStats> nodes_;
+  LatencyHistogram end_to_end_origin_;
+  LatencyHistogram end_to_end_stamp_;
+};
+
+static LatencyTraceAggregator* aggregator;
+
+void latency_trace_callback(const eagleye_msgs::LatencyTrace::ConstPtr& msg)
+{
+  aggregator->add(*msg);
+}
+
+void timer_callback(const ros::TimerEvent& e)
+{
+  aggregator->print(std::cout);
+}
+
+static void printUsage()
+{
+  std::cerr << "Usage: rosrun eagleye_rt latency_trace [options] [trace.bag]" << std::endl;
+  std::cerr << "  --chain A,B,...  nodes of the per hop report, in order" << std::endl;
+  std::cerr << "                   (default: velocity_scale_factor_node,heading_node_3rd,heading_interpolate_node_3rd," << std::endl;
+  std::cerr << "                   trajectory_node,position_interpolate_node)" << std::endl;
+  std::cerr << "  --topic NAME     live trace topic (default: /eagleye/latency_trace)" << std::endl;
+  std::cerr << "  --period SEC     live report period (default: 10)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::string chain_list =
+      "velocity_scale_factor_node,heading_node_3rd,heading_interpolate_node_3rd,trajectory_node,position_interpolate_node";
+  std::string topic = "/eagleye/latency_trace";
+  std::string bag_file;
+  double period = 10;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--chain" && i + 1 < argc)
+    {
+      chain_list = argv[++i];
+    }
+    else if (arg == "--topic" && i + 1 < argc)
+    {
+      topic = argv[++i];
+    }
+    else if (arg == "--period" && i + 1 < argc)
+    {
+      period = std::atof(argv[++i]);
+    }
+    else if (arg.find(":=") != std::string::npos)
+    {
+      continue;
+    }
+    else if (arg.compare(0, 2, "--") == 0 || !bag_file.empty() || period <= 0)
+    {
+      printUsage();
+      return 1;
+    }
+    else
+    {
+      bag_file = arg;
+    }
+  }
+
+  std::vector<std::string> chain;
+  std::istringstream chain_stream(chain_list);
+  std::string name;
+  while (std::getline(chain_stream, name, ','))
+  {
+    if (!name.empty())
+    {
+      chain.push_back(name);
+    }
+  }
+
+  LatencyTraceAggregator latency_trace_aggregator(chain, 2.0);
+  aggregator = &latency_trace_aggregator;
+
+  if (!bag_file.empty())
+  {
+    try
+    {
+      rosbag::Bag bag;
+      bag.open(bag_file, rosbag::bagmode::Read);
+      rosbag::View view(bag, rosbag::TypeQuery("eagleye_msgs/LatencyTrace"));
+      for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+      {
+        eagleye_msgs::LatencyTrace::ConstPtr msg = it->instantiate<eagleye_msgs::LatencyTrace>();
+        if (msg)
+        {
+          aggregator->add(*msg);
+        }
+      }
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << "latency_trace failed: " << e.what() << std::endl;
+      return 1;
+    }
+    aggregator->flush();
+    aggregator->print(std::cout);
+    return 0;
+  }
+
+  ros::init(argc, argv, "latency_trace");
+  ros::NodeHandle n;
+  ros::Subscriber sub = n.subscribe(topic, 10000, latency_trace_callback, ros::TransportHints().tcpNoDelay());
+  ros::Timer timer = n.createTimer(ros::Duration(period), timer_callback);
+
+  ros::spin();
+
+  aggregator->flush();
+  aggregator->print(std::cout);
+
+  return 0;
+}
@@ -31,9 +31,12 @@
 #include "ros/ros.h"
 #include "coordinate/coordinate.hpp"
 #include "navigation/navigation.hpp"
+#include "eagleye_msgs/EagleyeState.h"
+#include "eagleye_rt/shm_transport.hpp"
 
 #include <boost/bind.hpp>
 #include <diagnostic_updater/diagnostic_updater.h>
+#include <vector>
 
 static sensor_msgs::Imu imu;
 static rtklib_msgs::RtklibNav rtklib_nav;
@@ -63,6 +66,7 @@ static geometry_msgs::TwistStamped eagleye_twist;
 
 static bool navsat_fix_sub_status;
 static bool print_status;
+static bool use_eagleye_state = false;
 
 static double imu_time_last;
 static double rtklib_nav_time_last;
@@ -276,6 +280,31 @@ void eagleye_twist_callback(const geometry_msgs::TwistStamped::ConstPtr& msg)
   eagleye_twist.twist = msg->twist;
 }
 
+void eagleye_state_callback(const eagleye_msgs::EagleyeState::ConstPtr& msg)
+{
+  typedef eagleye_msgs::EagleyeState S;
+  if (msg->updated & S::VELOCITY_SCALE_FACTOR) velocity_scale_factor = msg->velocity_scale_factor;
+  if (msg->updated & S::DISTANCE) distance = msg->distance;
+  if (msg->updated & S::HEADING_1ST) heading_1st = msg->heading_1st;
+  if (msg->updated & S::HEADING_INTERPOLATE_1ST) heading_interpolate_1st = msg->heading_interpolate_1st;
+  if (msg->updated & S::HEADING_2ND) heading_2nd = msg->heading_2nd;
+  if (msg->updated & S::HEADING_INTERPOLATE_2ND) heading_interpolate_2nd = msg->heading_interpolate_2nd;
+  if (msg->updated & S::HEADING_3RD) heading_3rd = msg->heading_3rd;
+  if (msg->updated & S::HEADING_INTERPOLATE_3RD) heading_interpolate_3rd = msg->heading_interpolate_3rd;
+  if (msg->updated & S::YAWRATE_OFFSET_STOP) yawrate_offset_stop = msg->yawrate_offset_stop;
+  if (msg->updated & S::YAWRATE_OFFSET_1ST) yawrate_offset_1st = msg->yawrate_offset_1st;
+  if (msg->updated & S::YAWRATE_OFFSET_2ND) yawrate_offset_2nd = msg->yawrate_offset_2nd;
+  if (msg->updated & S::SLIP_ANGLE) slip_angle = msg->slip_angle;
+  if (msg->updated & S::ENU_RELATIVE_POS) enu_relative_pos = msg->enu_relative_pos;
+  if (msg->updated & S::ENU_VEL) enu_vel = msg->enu_vel;
+  if (msg->updated & S::ENU_ABSOLUTE_POS) enu_absolute_pos = msg->enu_absolute_pos;
+  if (msg->updated & S::HEIGHT) height = msg->height;
+  if (msg->updated & S::PITCHING) pitching = msg->pitching;
+  if (msg->updated & S::ENU_ABSOLUTE_POS_INTERPOLATE) enu_absolute_pos_interpolate = msg->enu_absolute_pos_interpolate;
+  if (msg->updated & S::FIX) eagleye_fix = msg->fix;
+  if (msg->updated & S::TWIST) eagleye_twist = msg->twist;
+}
+
 void imu_topic_checker(diagnostic_updater::DiagnosticStatusWrapper & stat)
 {
   int8_t level = diagnostic_msgs::DiagnosticStatus::OK;
@@ -835,12 +864,14 @@ int main(int argc, char** argv)
   n.getParam("rtklib_nav_topic",subscribe_rtklib_nav_topic_name);
   n.getParam("navsatfix_topic",subscribe_navsatfix_topic_name);
   n.getParam("monitor/print_status",print_status);
+  n.getParam("monitor/use_eagleye_state",use_eagleye_state);
 
   std::cout<< "subscribe_twist_topic_name "<<subscribe_twist_topic_name<<std::endl;
   std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
   std::cout<< "subscribe_rtklib_nav_topic_name "<<subscribe_rtklib_nav_topic_name<<std::endl;
   std::cout<< "subscribe_navsatfix_topic_name "<<subscribe_navsatfix_topic_name<<std::endl;
   std::cout<< "print_status "<<print_status<<std::endl;
+  std::cout<< "use_eagleye_state "<<use_eagleye_state<<std::endl;
 
   // // Diagnostic Updater
   diagnostic_updater::Updater updater_;
@@ -868,31 +899,42 @@ int main(int argc, char** argv)
   updater_.add("eagleye_enu_absolute_pos_interpolate", enu_absolute_pos_interpolate_topic_checker);
   updater_.add("eagleye_twist", twist_topic_checker);
 
-  ros::Subscriber sub1 = n.subscribe(subscribe_imu_topic_name, 1000, imu_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub2 = n.subscribe(subscribe_rtklib_nav_topic_name, 1000, rtklib_nav_callback, ros::TransportHints().tcpNoDelay());
+  ShmSubscriber sub1 = subscribeShm(n, subscribe_imu_topic_name, 1000, imu_callback, ros::TransportHints().tcpNoDelay());
+  ShmSubscriber sub2 = subscribeShm(n, subscribe_rtklib_nav_topic_name, 1000, rtklib_nav_callback, ros::TransportHints().tcpNoDelay());
   ros::Subscriber sub3 = n.subscribe("rtklib/fix", 1000, fix_callback, ros::TransportHints().tcpNoDelay());
   ros::Subscriber sub4 = n.subscribe(subscribe_navsatfix_topic_name, 1000, navsatfix_fix_callback, ros::TransportHints().tcpNoDelay());
   ros::Subscriber sub5 = n.subscribe(subscribe_twist_topic_name, 1000, velocity_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub6 = n.subscribe("velocity_scale_factor", 1000, velocity_scale_factor_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub7 = n.subscribe("distance", 1000, distance_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub8 = n.subscribe("heading_1st", 1000, heading_1st_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub9 = n.subscribe("heading_interpolate_1st", 1000, heading_interpolate_1st_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub10 = n.subscribe("heading_2nd", 1000, heading_2nd_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub11 = n.subscribe("heading_interpolate_2nd", 1000, heading_interpolate_2nd_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub12 = n.subscribe("heading_3rd", 1000, heading_3rd_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub13 = n.subscribe("heading_interpolate_3rd", 1000, heading_interpolate_3rd_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub14 = n.subscribe("yawrate_offset_stop", 1000, yawrate_offset_stop_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub15 = n.subscribe("yawrate_offset_1st", 1000, yawrate_offset_1st_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub16 = n.subscribe("yawrate_offset_2nd", 1000, yawrate_offset_2nd_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub17 = n.subscribe("slip_angle", 1000, slip_angle_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub18 = n.subscribe("enu_relative_pos", 1000, enu_relative_pos_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub19 = n.subscribe("enu_vel", 1000, enu_vel_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub20 = n.subscribe("height", 1000, height_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub21 = n.subscribe("pitching", 1000, pitching_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub22 = n.subscribe("enu_absolute_pos", 1000, enu_absolute_pos_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub23 = n.subscribe("enu_absolute_pos_interpolate", 1000, enu_absolute_pos_interpolate_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub24 = n.subscribe("fix", 1000, eagleye_fix_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub25 = n.subscribe("twist", 1000, eagleye_twist_callback, ros::TransportHints().tcpNoDelay());
+
+  // The estimates come either from the single eagleye_state of eagleye_engine
+  // or from their own topics.
+  std::vector<ros::Subscriber> estimate_subs;
+  if (use_eagleye_state)
+  {
+    estimate_subs.push_back(n.subscribe("eagleye_state", 1000, eagleye_state_callback, ros::TransportHints().tcpNoDelay()));
+  }
+  else
+  {
+    estimate_subs.push_back(n.subscribe("velocity_scale_factor", 1000, velocity_scale_factor_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("distance", 1000, distance_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("heading_1st", 1000, heading_1st_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("heading_interpolate_1st", 1000, heading_interpolate_1st_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("heading_2nd", 1000, heading_2nd_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("heading_interpolate_2nd", 1000, heading_interpolate_2nd_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("heading_3rd", 1000, heading_3rd_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("heading_interpolate_3rd", 1000, heading_interpolate_3rd_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("yawrate_offset_stop", 1000, yawrate_offset_stop_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("yawrate_offset_1st", 1000, yawrate_offset_1st_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("yawrate_offset_2nd", 1000, yawrate_offset_2nd_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("slip_angle", 1000, slip_angle_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("enu_relative_pos", 1000, enu_relative_pos_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("enu_vel", 1000, enu_vel_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("height", 1000, height_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("pitching", 1000, pitching_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("enu_absolute_pos", 1000, enu_absolute_pos_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("enu_absolute_pos_interpolate", 1000, enu_absolute_pos_interpolate_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("fix", 1000, eagleye_fix_callback, ros::TransportHints().tcpNoDelay()));
+    estimate_subs.push_back(n.subscribe("twist", 1000, eagleye_twist_callback, ros::TransportHints().tcpNoDelay()));
+  }
 
   ros::Timer timer = n.createTimer(ros::Duration(1/update_rate), boost::bind(timer_callback,_1, &updater_));
 
@@ -0,0 +1,135 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * angular_velocity_offset_stop_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class AngularVelocityOffsetStopNodelet : public nodelet::Nodelet
+{
+public:
+  AngularVelocityOffsetStopNodelet() : angular_velocity_offset_stop_parameter_() {}
+  ~AngularVelocityOffsetStopNodelet();
+  virtual void onInit();
+
+private:
+  void velocityCallback(const geometry_msgs::TwistStamped::ConstPtr& msg);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_;
+  ros::Publisher pub_;
+  AngularVelocityOffsetStopEstimator angular_velocity_offset_stop_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  NodeCheckpoint<AngularVelocityOffsetStopEstimator> checkpoint_;
+  AngularVelocityOffsetStopParameter angular_velocity_offset_stop_parameter_;
+};
+
+void AngularVelocityOffsetStopNodelet::velocityCallback(const geometry_msgs::TwistStamped::ConstPtr& msg)
+{
+  angular_velocity_offset_stop_estimator_.setTwist(*msg);
+}
+
+void AngularVelocityOffsetStopNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = angular_velocity_offset_stop_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub_.publish(boost::make_shared<eagleye_msgs::AngularVelocityOffset>(angular_velocity_offset_stop_estimator_.getAngularVelocityOffset()));
+    latency_trace_.publish(msg->header.stamp);
+  }
+}
+
+AngularVelocityOffsetStopNodelet::~AngularVelocityOffsetStopNodelet()
+{
+  checkpoint_.save();
+}
+
+void AngularVelocityOffsetStopNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+
+  std::string subscribe_twist_topic_name = "/can_twist";
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+
+  n.getParam("twist_topic",subscribe_twist_topic_name);
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("reverse_imu", angular_velocity_offset_stop_parameter_.reverse_imu);
+  n.getParam("angular_velocity_offset_stop/stop_judgment_velocity_threshold",angular_velocity_offset_stop_parameter_.stop_judgment_velocity_threshold);
+  n.getParam("angular_velocity_offset_stop/estimated_number",angular_velocity_offset_stop_parameter_.estimated_number);
+  n.getParam("angular_velocity_offset_stop/outlier_threshold",angular_velocity_offset_stop_parameter_.outlier_threshold);
+
+  std::cout<< "subscribe_twist_topic_name "<<subscribe_twist_topic_name<<std::endl;
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "reverse_imu "<<angular_velocity_offset_stop_parameter_.reverse_imu<<std::endl;
+  std::cout<< "stop_judgment_velocity_threshold "<<angular_velocity_offset_stop_parameter_.stop_judgment_velocity_threshold<<std::endl;
+  std::cout<< "estimated_number "<<angular_velocity_offset_stop_parameter_.estimated_number<<std::endl;
+  std::cout<< "outlier_threshold "<<angular_velocity_offset_stop_parameter_.outlier_threshold<<std::endl;
+
+  angular_velocity_offset_stop_estimator_.setParameter(angular_velocity_offset_stop_parameter_);
+  if (real_time_.enabled())
+  {
+    angular_velocity_offset_stop_estimator_.reserve();
+  }
+
+  checkpoint_.init(n, getName(), &angular_velocity_offset_stop_estimator_);
+
+  sub1_ = input_merger_.subscribe(n, subscribe_twist_topic_name, 1000, &AngularVelocityOffsetStopNodelet::velocityCallback, this);
+  sub2_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &AngularVelocityOffsetStopNodelet::imuCallback, this, InputMerger::TRIGGER);
+  pub_ = n.advertise<eagleye_msgs::AngularVelocityOffset>("angular_velocity_offset_stop", 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::AngularVelocityOffsetStopNodelet, nodelet::Nodelet)
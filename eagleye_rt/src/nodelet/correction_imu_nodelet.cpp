@@ -0,0 +1,135 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * correction_imu_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class CorrectionImuNodelet : public nodelet::Nodelet
+{
+public:
+  CorrectionImuNodelet() : reverse_imu_(false) {}
+  ~CorrectionImuNodelet();
+  virtual void onInit();
+
+private:
+  void angularVelocityOffsetStopCallback(const eagleye_msgs::AngularVelocityOffset::ConstPtr& msg);
+  void accXOffsetCallback(const eagleye_msgs::AccXOffset::ConstPtr& msg);
+  void accXScaleFactorCallback(const eagleye_msgs::AccXScaleFactor::ConstPtr& msg);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_;
+  ros::Publisher pub_;
+  CorrectionImuEstimator correction_imu_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  NodeCheckpoint<CorrectionImuEstimator> checkpoint_;
+  bool reverse_imu_;
+};
+
+void CorrectionImuNodelet::angularVelocityOffsetStopCallback(const eagleye_msgs::AngularVelocityOffset::ConstPtr& msg)
+{
+  correction_imu_estimator_.setAngularVelocityOffsetStop(*msg);
+}
+
+void CorrectionImuNodelet::accXOffsetCallback(const eagleye_msgs::AccXOffset::ConstPtr& msg)
+{
+  correction_imu_estimator_.setAccXOffset(*msg);
+}
+
+void CorrectionImuNodelet::accXScaleFactorCallback(const eagleye_msgs::AccXScaleFactor::ConstPtr& msg)
+{
+  correction_imu_estimator_.setAccXScaleFactor(*msg);
+}
+
+void CorrectionImuNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = correction_imu_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub_.publish(boost::make_shared<sensor_msgs::Imu>(correction_imu_estimator_.getCorrectionImu()));
+    latency_trace_.publish(msg->header.stamp);
+  }
+}
+
+CorrectionImuNodelet::~CorrectionImuNodelet()
+{
+  checkpoint_.save();
+}
+
+void CorrectionImuNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("reverse_imu", reverse_imu_);
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "reverse_imu "<<reverse_imu_<<std::endl;
+
+  correction_imu_estimator_.setReverseImu(reverse_imu_);
+
+  checkpoint_.init(n, getName(), &correction_imu_estimator_);
+
+  sub1_ = input_merger_.subscribe(n, "angular_velocity_offset_stop", 1000, &CorrectionImuNodelet::angularVelocityOffsetStopCallback, this, InputMerger::DERIVED);
+  sub2_ = input_merger_.subscribe(n, "acc_x_offset", 1000, &CorrectionImuNodelet::accXOffsetCallback, this, InputMerger::DERIVED);
+  sub3_ = input_merger_.subscribe(n, "acc_x_scale_factor", 1000, &CorrectionImuNodelet::accXScaleFactorCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &CorrectionImuNodelet::imuCallback, this, InputMerger::TRIGGER);
+  pub_ = n.advertise<sensor_msgs::Imu>("imu/data_corrected", 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::CorrectionImuNodelet, nodelet::Nodelet)
@@ -0,0 +1,99 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * distance_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class DistanceNodelet : public nodelet::Nodelet
+{
+public:
+  ~DistanceNodelet();
+  virtual void onInit();
+
+private:
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+
+  ros::Subscriber sub1_;
+  ros::Publisher pub_;
+  DistanceEstimator distance_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  NodeCheckpoint<DistanceEstimator> checkpoint_;
+};
+
+void DistanceNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = distance_estimator_.velocityScaleFactorStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub_.publish(boost::make_shared<eagleye_msgs::Distance>(distance_estimator_.getDistance()));
+    latency_trace_.publish(msg->header.stamp);
+  }
+}
+
+DistanceNodelet::~DistanceNodelet()
+{
+  checkpoint_.save();
+}
+
+void DistanceNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  checkpoint_.init(n, getName(), &distance_estimator_);
+
+  sub1_ = n.subscribe("velocity_scale_factor", 1000, &DistanceNodelet::velocityScaleFactorCallback, this);
+  pub_ = n.advertise<eagleye_msgs::Distance>("distance", 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::DistanceNodelet, nodelet::Nodelet)
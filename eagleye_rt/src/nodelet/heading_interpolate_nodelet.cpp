@@ -0,0 +1,194 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * heading_interpolate_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class HeadingInterpolateNodelet : public nodelet::Nodelet
+{
+public:
+  HeadingInterpolateNodelet() : heading_interpolate_parameter_() {}
+  ~HeadingInterpolateNodelet();
+  virtual void onInit();
+
+private:
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+  void yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void yawrateOffsetCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void headingCallback(const eagleye_msgs::Heading::ConstPtr& msg);
+  void slipAngleCallback(const eagleye_msgs::SlipAngle::ConstPtr& msg);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_, sub5_, sub6_;
+  ros::Publisher pub_;
+  HeadingInterpolateEstimator heading_interpolate_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  NodeCheckpoint<HeadingInterpolateEstimator> checkpoint_;
+  HeadingInterpolateParameter heading_interpolate_parameter_;
+};
+
+void HeadingInterpolateNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  heading_interpolate_estimator_.setVelocityScaleFactor(*msg);
+}
+
+void HeadingInterpolateNodelet::yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  heading_interpolate_estimator_.setYawrateOffsetStop(*msg);
+}
+
+void HeadingInterpolateNodelet::yawrateOffsetCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  heading_interpolate_estimator_.setYawrateOffset(*msg);
+}
+
+void HeadingInterpolateNodelet::headingCallback(const eagleye_msgs::Heading::ConstPtr& msg)
+{
+  heading_interpolate_estimator_.setHeading(*msg);
+}
+
+void HeadingInterpolateNodelet::slipAngleCallback(const eagleye_msgs::SlipAngle::ConstPtr& msg)
+{
+  heading_interpolate_estimator_.setSlipAngle(*msg);
+}
+
+void HeadingInterpolateNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = heading_interpolate_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub_.publish(boost::make_shared<eagleye_msgs::Heading>(heading_interpolate_estimator_.getHeadingInterpolate()));
+    latency_trace_.publish(msg->header.stamp);
+  }
+}
+
+HeadingInterpolateNodelet::~HeadingInterpolateNodelet()
+{
+  checkpoint_.save();
+}
+
+void HeadingInterpolateNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+  const std::vector<std::string>& argv = getMyArgv();
+
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("reverse_imu", heading_interpolate_parameter_.reverse_imu);
+  n.getParam("heading_interpolate/stop_judgment_velocity_threshold", heading_interpolate_parameter_.stop_judgment_velocity_threshold);
+  n.getParam("heading_interpolate/number_buffer_max", heading_interpolate_parameter_.number_buffer_max);
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "reverse_imu "<<heading_interpolate_parameter_.reverse_imu<<std::endl;
+  std::cout<< "stop_judgment_velocity_threshold "<<heading_interpolate_parameter_.stop_judgment_velocity_threshold<<std::endl;
+  std::cout<< "number_buffer_max "<<heading_interpolate_parameter_.number_buffer_max<<std::endl;
+
+  std::string publish_topic_name = "/publish_topic_name/invalid";
+  std::string subscribe_topic_name_1 = "/subscribe_topic_name/invalid_1";
+  std::string subscribe_topic_name_2 = "/subscribe_topic_name/invalid_2";
+
+  if (argv.size() == 1)
+  {
+    if (argv[0] == "1st")
+    {
+      publish_topic_name = "heading_interpolate_1st";
+      subscribe_topic_name_1 = "yawrate_offset_stop";
+      subscribe_topic_name_2 = "heading_1st";
+    }
+    else if (argv[0] == "2nd")
+    {
+      publish_topic_name = "heading_interpolate_2nd";
+      subscribe_topic_name_1 = "yawrate_offset_1st";
+      subscribe_topic_name_2 = "heading_2nd";
+    }
+    else if (argv[0] == "3rd")
+    {
+      publish_topic_name = "heading_interpolate_3rd";
+      subscribe_topic_name_1 = "yawrate_offset_2nd";
+      subscribe_topic_name_2 = "heading_3rd";
+    }
+    else
+    {
+      NODELET_ERROR("Invalid argument");
+      return;
+    }
+  }
+  else
+  {
+    NODELET_ERROR("No arguments");
+    return;
+  }
+
+  heading_interpolate_estimator_.setParameter(heading_interpolate_parameter_);
+  if (real_time_.enabled())
+  {
+    heading_interpolate_estimator_.reserve();
+  }
+
+  checkpoint_.init(n, getName(), &heading_interpolate_estimator_);
+
+  sub1_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &HeadingInterpolateNodelet::imuCallback, this, InputMerger::TRIGGER);
+  sub2_ = input_merger_.subscribe(n, "velocity_scale_factor", 1000, &HeadingInterpolateNodelet::velocityScaleFactorCallback, this, InputMerger::DERIVED);
+  sub3_ = input_merger_.subscribe(n, "yawrate_offset_stop", 1000, &HeadingInterpolateNodelet::yawrateOffsetStopCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribe(n, subscribe_topic_name_1, 1000, &HeadingInterpolateNodelet::yawrateOffsetCallback, this, InputMerger::DERIVED);
+  sub5_ = input_merger_.subscribe(n, subscribe_topic_name_2, 1000, &HeadingInterpolateNodelet::headingCallback, this, InputMerger::DERIVED);
+  sub6_ = input_merger_.subscribe(n, "slip_angle", 1000, &HeadingInterpolateNodelet::slipAngleCallback, this, InputMerger::FEEDBACK);
+  pub_ = n.advertise<eagleye_msgs::Heading>(publish_topic_name, 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::HeadingInterpolateNodelet, nodelet::Nodelet)
@@ -0,0 +1,202 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * height_nodelet.cpp
+ * Author MapIV  Takanose
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/fit_worker.hpp"
+#include "eagleye_rt/warm_start.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class HeightNodelet : public nodelet::Nodelet
+{
+public:
+  HeightNodelet() : height_parameter_() {}
+  ~HeightNodelet();
+  virtual void onInit();
+
+private:
+  void fixCallback(const sensor_msgs::NavSatFix::ConstPtr& msg);
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+  void distanceCallback(const eagleye_msgs::Distance::ConstPtr& msg);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_;
+  ros::Publisher pub1_;
+  ros::Publisher pub2_;
+  ros::Publisher pub3_;
+  ros::Publisher pub4_;
+  ros::Publisher pub5_;
+  HeightEstimator height_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  FitWorker fit_worker_;
+  WarmStart warm_start_;
+  NodeCheckpoint<HeightEstimator> checkpoint_;
+  HeightParameter height_parameter_;
+};
+
+void HeightNodelet::fixCallback(const sensor_msgs::NavSatFix::ConstPtr& msg)
+{
+  height_estimator_.setNavSatFix(*msg);
+}
+
+void HeightNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  height_estimator_.setVelocityScaleFactor(*msg);
+}
+
+void HeightNodelet::distanceCallback(const eagleye_msgs::Distance::ConstPtr& msg)
+{
+  height_estimator_.setDistance(*msg);
+}
+
+void HeightNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = height_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub1_.publish(boost::make_shared<eagleye_msgs::Height>(height_estimator_.getHeight()));
+    pub2_.publish(boost::make_shared<eagleye_msgs::Pitching>(height_estimator_.getPitching()));
+    pub3_.publish(boost::make_shared<eagleye_msgs::AccXOffset>(height_estimator_.getAccXOffset()));
+    pub4_.publish(boost::make_shared<eagleye_msgs::AccXScaleFactor>(height_estimator_.getAccXScaleFactor()));
+    latency_trace_.publish(msg->header.stamp);
+    if (height_estimator_.getAccXOffset().status.estimate_status)
+    {
+      warm_start_.update("acc_x_offset", height_estimator_.getAccXOffset().acc_x_offset, msg->header.stamp);
+    }
+    if (height_estimator_.getAccXScaleFactor().status.estimate_status)
+    {
+      warm_start_.update("acc_x_scale_factor", height_estimator_.getAccXScaleFactor().acc_x_scale_factor, msg->header.stamp);
+    }
+  }
+
+  if(height_estimator_.isReliabilityFixUpdated())
+  {
+    pub5_.publish(boost::make_shared<sensor_msgs::NavSatFix>(height_estimator_.getReliabilityFix()));
+  }
+
+  if (height_estimator_.isFitDue())
+  {
+    fit_worker_.post(boost::bind(&HeightEstimator::fitSnapshot, &height_estimator_),
+                     boost::bind(&HeightEstimator::applyFit, &height_estimator_));
+  }
+}
+
+HeightNodelet::~HeightNodelet()
+{
+  fit_worker_.stop();
+  checkpoint_.save();
+  warm_start_.save();
+}
+
+void HeightNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+  warm_start_.init(n);
+
+  std::string subscribe_navsatfix_topic_name = "/navsat/fix";
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+
+  n.getParam("navsatfix_topic",subscribe_navsatfix_topic_name);
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("height/estimated_distance",height_parameter_.estimated_distance);
+  n.getParam("height/estimated_distance_max",height_parameter_.estimated_distance_max);
+  n.getParam("height/separation_distance",height_parameter_.separation_distance);
+  n.getParam("height/estimated_velocity_threshold",height_parameter_.estimated_velocity_threshold);
+  n.getParam("height/estimated_velocity_coefficient",height_parameter_.estimated_velocity_coefficient);
+  n.getParam("height/estimated_height_coefficient",height_parameter_.estimated_height_coefficient);
+  n.getParam("height/outlier_threshold",height_parameter_.outlier_threshold);
+  n.getParam("height/average_num",height_parameter_.average_num);
+
+  std::cout<< "subscribe_navsatfix_topic_name "<<subscribe_navsatfix_topic_name<<std::endl;
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "estimated_distance "<<height_parameter_.estimated_distance<<std::endl;
+  std::cout<< "estimated_distance_max "<<height_parameter_.estimated_distance_max<<std::endl;
+  std::cout<< "separation_distance "<<height_parameter_.separation_distance<<std::endl;
+  std::cout<< "estimated_velocity_threshold "<<height_parameter_.estimated_velocity_threshold<<std::endl;
+  std::cout<< "estimated_velocity_coefficient "<<height_parameter_.estimated_velocity_coefficient<<std::endl;
+  std::cout<< "estimated_height_coefficient "<<height_parameter_.estimated_height_coefficient<<std::endl;
+  std::cout<< "outlier_threshold "<<height_parameter_.outlier_threshold<<std::endl;
+  std::cout<< "average_num "<<height_parameter_.average_num<<std::endl;
+
+  height_estimator_.setParameter(height_parameter_);
+  height_estimator_.setDeferredFit(fit_worker_.init(n));
+  if (real_time_.enabled())
+  {
+    height_estimator_.reserve();
+  }
+  double warm_acc_x_offset, warm_acc_x_scale_factor;
+  if (warm_start_.load("acc_x_offset", warm_start_.maxAge(), &warm_acc_x_offset) &&
+      warm_start_.load("acc_x_scale_factor", warm_start_.maxAge(), &warm_acc_x_scale_factor))
+  {
+    height_estimator_.warmStart(warm_acc_x_offset, warm_acc_x_scale_factor);
+  }
+
+  checkpoint_.init(n, getName(), &height_estimator_);
+
+  sub1_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &HeightNodelet::imuCallback, this, InputMerger::TRIGGER);
+  sub2_ = input_merger_.subscribe(n, subscribe_navsatfix_topic_name, 1000, &HeightNodelet::fixCallback, this);
+  sub3_ = input_merger_.subscribe(n, "velocity_scale_factor", 1000, &HeightNodelet::velocityScaleFactorCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribe(n, "distance", 1000, &HeightNodelet::distanceCallback, this, InputMerger::DERIVED);
+
+  pub1_ = n.advertise<eagleye_msgs::Height>("height", 1000);
+  pub2_ = n.advertise<eagleye_msgs::Pitching>("pitching", 1000);
+  pub3_ = n.advertise<eagleye_msgs::AccXOffset>("acc_x_offset", 1000);
+  pub4_ = n.advertise<eagleye_msgs::AccXScaleFactor>("acc_x_scale_factor", 1000);
+  pub5_ = n.advertise<sensor_msgs::NavSatFix>("navsat/reliability_fix", 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::HeightNodelet, nodelet::Nodelet)
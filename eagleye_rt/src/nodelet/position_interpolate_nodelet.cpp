@@ -0,0 +1,154 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * position_interpolate_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class PositionInterpolateNodelet : public nodelet::Nodelet
+{
+public:
+  PositionInterpolateNodelet() : position_interpolate_parameter_() {}
+  ~PositionInterpolateNodelet();
+  virtual void onInit();
+
+private:
+  void fixCallback(const sensor_msgs::NavSatFix::ConstPtr& msg);
+  void enuAbsolutePosCallback(const eagleye_msgs::Position::ConstPtr& msg);
+  void gnssSmoothPosEnuCallback(const eagleye_msgs::Position::ConstPtr& msg);
+  void heightCallback(const eagleye_msgs::Height::ConstPtr& msg);
+  void enuVelCallback(const geometry_msgs::Vector3Stamped::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_, sub5_;
+  ros::Publisher pub1_;
+  ros::Publisher pub2_;
+  PositionInterpolateEstimator position_interpolate_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  NodeCheckpoint<PositionInterpolateEstimator> checkpoint_;
+  PositionInterpolateParameter position_interpolate_parameter_;
+};
+
+void PositionInterpolateNodelet::fixCallback(const sensor_msgs::NavSatFix::ConstPtr& msg)
+{
+  position_interpolate_estimator_.setNavSatFix(*msg);
+}
+
+void PositionInterpolateNodelet::enuAbsolutePosCallback(const eagleye_msgs::Position::ConstPtr& msg)
+{
+  position_interpolate_estimator_.setEnuAbsolutePos(*msg);
+}
+
+void PositionInterpolateNodelet::gnssSmoothPosEnuCallback(const eagleye_msgs::Position::ConstPtr& msg)
+{
+  position_interpolate_estimator_.setGnssSmoothPos(*msg);
+}
+
+void PositionInterpolateNodelet::heightCallback(const eagleye_msgs::Height::ConstPtr& msg)
+{
+  position_interpolate_estimator_.setHeight(*msg);
+}
+
+void PositionInterpolateNodelet::enuVelCallback(const geometry_msgs::Vector3Stamped::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = position_interpolate_estimator_.enuVelStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub1_.publish(boost::make_shared<eagleye_msgs::Position>(position_interpolate_estimator_.getEnuAbsolutePosInterpolate()));
+    latency_trace_.publish(msg->header.stamp);
+  }
+  if(position_interpolate_estimator_.isFixUpdated())
+  {
+    pub2_.publish(boost::make_shared<sensor_msgs::NavSatFix>(position_interpolate_estimator_.getFix()));
+  }
+}
+
+PositionInterpolateNodelet::~PositionInterpolateNodelet()
+{
+  checkpoint_.save();
+}
+
+void PositionInterpolateNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+
+  std::string subscribe_navsatfix_topic_name = "/navsat/fix";
+
+  n.getParam("navsatfix_topic",subscribe_navsatfix_topic_name);
+  n.getParam("position_interpolate/number_buffer_max", position_interpolate_parameter_.number_buffer_max);
+  n.getParam("position_interpolate/stop_judgment_velocity_threshold", position_interpolate_parameter_.stop_judgment_velocity_threshold);
+  std::cout<< "subscribe_navsatfix_topic_name "<<subscribe_navsatfix_topic_name<<std::endl;
+  std::cout<< "number_buffer_max "<<position_interpolate_parameter_.number_buffer_max<<std::endl;
+  std::cout<< "stop_judgment_velocity_threshold "<<position_interpolate_parameter_.stop_judgment_velocity_threshold<<std::endl;
+
+  position_interpolate_estimator_.setParameter(position_interpolate_parameter_);
+  if (real_time_.enabled())
+  {
+    position_interpolate_estimator_.reserve();
+  }
+
+  checkpoint_.init(n, getName(), &position_interpolate_estimator_);
+
+  sub1_ = input_merger_.subscribe(n, "enu_vel", 1000, &PositionInterpolateNodelet::enuVelCallback, this, InputMerger::DERIVED | InputMerger::TRIGGER);
+  sub2_ = input_merger_.subscribe(n, "enu_absolute_pos", 1000, &PositionInterpolateNodelet::enuAbsolutePosCallback, this, InputMerger::DERIVED);
+  sub3_ = input_merger_.subscribe(n, "gnss_smooth_pos_enu", 1000, &PositionInterpolateNodelet::gnssSmoothPosEnuCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribe(n, "height", 1000, &PositionInterpolateNodelet::heightCallback, this, InputMerger::DERIVED);
+  sub5_ = input_merger_.subscribe(n, subscribe_navsatfix_topic_name, 1000, &PositionInterpolateNodelet::fixCallback, this);
+  pub1_ = n.advertise<eagleye_msgs::Position>("enu_absolute_pos_interpolate", 1000);
+  pub2_ = n.advertise<sensor_msgs::NavSatFix>("fix", 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::PositionInterpolateNodelet, nodelet::Nodelet)
@@ -0,0 +1,219 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * position_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/fit_worker.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+#include <tf2_ros/transform_listener.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+
+namespace eagleye_rt
+{
+
+class PositionNodelet : public nodelet::Nodelet
+{
+public:
+  PositionNodelet() : position_parameter_() {}
+  ~PositionNodelet();
+  virtual void onInit();
+
+private:
+  void rtklibNavCallback(const rtklib_msgs::RtklibNav::ConstPtr& msg);
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+  void distanceCallback(const eagleye_msgs::Distance::ConstPtr& msg);
+  void headingInterpolate3rdCallback(const eagleye_msgs::Heading::ConstPtr& msg);
+  void timerCallback(const ros::TimerEvent& e);
+  void fitDoneCallback();
+  void enuVelCallback(const geometry_msgs::Vector3Stamped::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_, sub5_;
+  ros::Publisher pub_;
+  PositionEstimator position_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  FitWorker fit_worker_;
+  NodeCheckpoint<PositionEstimator> checkpoint_;
+  PositionParameter position_parameter_;
+  tf2_ros::Buffer tf_buffer_;
+  boost::shared_ptr<tf2_ros::TransformListener> tf_listener_;
+  ros::Timer timer_;
+};
+
+void PositionNodelet::rtklibNavCallback(const rtklib_msgs::RtklibNav::ConstPtr& msg)
+{
+  position_estimator_.setRtklibNav(*msg);
+}
+
+void PositionNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  position_estimator_.setVelocityScaleFactor(*msg);
+}
+
+void PositionNodelet::distanceCallback(const eagleye_msgs::Distance::ConstPtr& msg)
+{
+  position_estimator_.setDistance(*msg);
+}
+
+void PositionNodelet::headingInterpolate3rdCallback(const eagleye_msgs::Heading::ConstPtr& msg)
+{
+  position_estimator_.setHeadingInterpolate(*msg);
+}
+
+void PositionNodelet::timerCallback(const ros::TimerEvent& e)
+{
+  geometry_msgs::TransformStamped transformStamped;
+  try
+  {
+    transformStamped = tf_buffer_.lookupTransform(position_parameter_.tf_gnss_parent_flame, position_parameter_.tf_gnss_child_flame, ros::Time(0));
+
+    position_parameter_.tf_gnss_translation_x = transformStamped.transform.translation.x;
+    position_parameter_.tf_gnss_translation_y = transformStamped.transform.translation.y;
+    position_parameter_.tf_gnss_translation_z = transformStamped.transform.translation.z;
+    position_parameter_.tf_gnss_rotation_x = transformStamped.transform.rotation.x;
+    position_parameter_.tf_gnss_rotation_y = transformStamped.transform.rotation.y;
+    position_parameter_.tf_gnss_rotation_z = transformStamped.transform.rotation.z;
+    position_parameter_.tf_gnss_rotation_w = transformStamped.transform.rotation.w;
+    position_estimator_.setParameter(position_parameter_);
+  }
+  catch (tf2::TransformException& ex)
+  {
+    NODELET_WARN("%s", ex.what());
+    return;
+  }
+}
+
+void PositionNodelet::fitDoneCallback()
+{
+  if (position_estimator_.applyFit())
+  {
+    pub_.publish(boost::make_shared<eagleye_msgs::Position>(position_estimator_.getEnuAbsolutePos()));
+    input_merger_.published(position_estimator_.getEnuAbsolutePos().header.stamp);
+  }
+}
+
+void PositionNodelet::enuVelCallback(const geometry_msgs::Vector3Stamped::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = position_estimator_.enuVelStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub_.publish(boost::make_shared<eagleye_msgs::Position>(position_estimator_.getEnuAbsolutePos()));
+    input_merger_.published(msg->header.stamp);
+    latency_trace_.publish(msg->header.stamp);
+  }
+
+  if (position_estimator_.isFitDue())
+  {
+    fit_worker_.post(boost::bind(&PositionEstimator::fitSnapshot, &position_estimator_),
+                     boost::bind(&PositionNodelet::fitDoneCallback, this));
+  }
+}
+
+PositionNodelet::~PositionNodelet()
+{
+  fit_worker_.stop();
+  checkpoint_.save();
+}
+
+void PositionNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+
+  std::string subscribe_rtklib_nav_topic_name = "/rtklib_nav";
+
+  n.getParam("rtklib_nav_topic",subscribe_rtklib_nav_topic_name);
+  n.getParam("position/estimated_distance",position_parameter_.estimated_distance);
+  n.getParam("position/separation_distance",position_parameter_.separation_distance);
+  n.getParam("position/estimated_velocity_threshold",position_parameter_.estimated_velocity_threshold);
+  n.getParam("position/outlier_threshold",position_parameter_.outlier_threshold);
+  n.getParam("position/estimated_enu_vel_coefficient",position_parameter_.estimated_enu_vel_coefficient);
+  n.getParam("position/estimated_position_coefficient",position_parameter_.estimated_position_coefficient);
+  n.getParam("ecef_base_pos/x",position_parameter_.ecef_base_pos_x);
+  n.getParam("ecef_base_pos/y",position_parameter_.ecef_base_pos_y);
+  n.getParam("ecef_base_pos/z",position_parameter_.ecef_base_pos_z);
+  n.getParam("tf_gnss_flame/parent", position_parameter_.tf_gnss_parent_flame);
+  n.getParam("tf_gnss_flame/child", position_parameter_.tf_gnss_child_flame);
+
+  std::cout<< "subscribe_rtklib_nav_topic_name "<<subscribe_rtklib_nav_topic_name<<std::endl;
+  std::cout<< "estimated_distance "<<position_parameter_.estimated_distance<<std::endl;
+  std::cout<< "separation_distance "<<position_parameter_.separation_distance<<std::endl;
+  std::cout<< "estimated_velocity_threshold "<<position_parameter_.estimated_velocity_threshold<<std::endl;
+  std::cout<< "outlier_threshold "<<position_parameter_.outlier_threshold<<std::endl;
+  std::cout<< "estimated_enu_vel_coefficient "<<position_parameter_.estimated_enu_vel_coefficient<<std::endl;
+  std::cout<< "estimated_position_coefficient "<<position_parameter_.estimated_position_coefficient<<std::endl;
+  std::cout<< "tf_gnss_flame/parent "<<position_parameter_.tf_gnss_parent_flame<<std::endl;
+  std::cout<< "tf_gnss_flame/child "<<position_parameter_.tf_gnss_child_flame<<std::endl;
+
+  position_estimator_.setParameter(position_parameter_);
+  position_estimator_.setDeferredFit(fit_worker_.init(n));
+  if (real_time_.enabled())
+  {
+    position_estimator_.reserve();
+  }
+
+  checkpoint_.init(n, getName(), &position_estimator_);
+
+  sub1_ = input_merger_.subscribe(n, "enu_vel", 1000, &PositionNodelet::enuVelCallback, this, InputMerger::DERIVED | InputMerger::TRIGGER);
+  sub2_ = input_merger_.subscribeShm(n, subscribe_rtklib_nav_topic_name, 1000, &PositionNodelet::rtklibNavCallback, this);
+  sub3_ = input_merger_.subscribe(n, "velocity_scale_factor", 1000, &PositionNodelet::velocityScaleFactorCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribe(n, "distance", 1000, &PositionNodelet::distanceCallback, this, InputMerger::DERIVED);
+  sub5_ = input_merger_.subscribe(n, "heading_interpolate_3rd", 1000, &PositionNodelet::headingInterpolate3rdCallback, this, InputMerger::DERIVED);
+
+  pub_ = n.advertise<eagleye_msgs::Position>("enu_absolute_pos", 1000);
+  input_merger_.advertiseProgress(n, "enu_absolute_pos");
+
+  tf_listener_.reset(new tf2_ros::TransformListener(tf_buffer_));
+  timer_ = n.createTimer(ros::Duration(0.5), &PositionNodelet::timerCallback, this);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::PositionNodelet, nodelet::Nodelet)
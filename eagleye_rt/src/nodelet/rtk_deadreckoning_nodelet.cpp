@@ -0,0 +1,190 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * rtk_deadreckoning_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+#include <tf2_ros/transform_listener.h>
+#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+
+namespace eagleye_rt
+{
+
+class RtkDeadreckoningNodelet : public nodelet::Nodelet
+{
+public:
+  RtkDeadreckoningNodelet() : rtk_deadreckoning_parameter_() {}
+  ~RtkDeadreckoningNodelet();
+  virtual void onInit();
+
+private:
+  void rtklibNavCallback(const rtklib_msgs::RtklibNav::ConstPtr& msg);
+  void fixCallback(const sensor_msgs::NavSatFix::ConstPtr& msg);
+  void headingInterpolate3rdCallback(const eagleye_msgs::Heading::ConstPtr& msg);
+  void timerCallback(const ros::TimerEvent& e);
+  void enuVelCallback(const geometry_msgs::Vector3Stamped::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_;
+  ros::Publisher pub1_;
+  ros::Publisher pub2_;
+  RtkDeadreckoningEstimator rtk_deadreckoning_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  NodeCheckpoint<RtkDeadreckoningEstimator> checkpoint_;
+  RtkDeadreckoningParameter rtk_deadreckoning_parameter_;
+  tf2_ros::Buffer tf_buffer_;
+  boost::shared_ptr<tf2_ros::TransformListener> tf_listener_;
+  ros::Timer timer_;
+};
+
+void RtkDeadreckoningNodelet::rtklibNavCallback(const rtklib_msgs::RtklibNav::ConstPtr& msg)
+{
+  rtk_deadreckoning_estimator_.setRtklibNav(*msg);
+}
+
+void RtkDeadreckoningNodelet::fixCallback(const sensor_msgs::NavSatFix::ConstPtr& msg)
+{
+  rtk_deadreckoning_estimator_.setNavSatFix(*msg);
+}
+
+void RtkDeadreckoningNodelet::headingInterpolate3rdCallback(const eagleye_msgs::Heading::ConstPtr& msg)
+{
+  rtk_deadreckoning_estimator_.setHeadingInterpolate(*msg);
+}
+
+void RtkDeadreckoningNodelet::timerCallback(const ros::TimerEvent& e)
+{
+  geometry_msgs::TransformStamped transformStamped;
+  try
+  {
+    transformStamped = tf_buffer_.lookupTransform(rtk_deadreckoning_parameter_.tf_gnss_parent_flame, rtk_deadreckoning_parameter_.tf_gnss_child_flame, ros::Time(0));
+
+    rtk_deadreckoning_parameter_.tf_gnss_translation_x = transformStamped.transform.translation.x;
+    rtk_deadreckoning_parameter_.tf_gnss_translation_y = transformStamped.transform.translation.y;
+    rtk_deadreckoning_parameter_.tf_gnss_translation_z = transformStamped.transform.translation.z;
+    rtk_deadreckoning_parameter_.tf_gnss_rotation_x = transformStamped.transform.rotation.x;
+    rtk_deadreckoning_parameter_.tf_gnss_rotation_y = transformStamped.transform.rotation.y;
+    rtk_deadreckoning_parameter_.tf_gnss_rotation_z = transformStamped.transform.rotation.z;
+    rtk_deadreckoning_parameter_.tf_gnss_rotation_w = transformStamped.transform.rotation.w;
+    rtk_deadreckoning_estimator_.setParameter(rtk_deadreckoning_parameter_);
+  }
+  catch (tf2::TransformException& ex)
+  {
+    NODELET_WARN("%s", ex.what());
+    return;
+  }
+}
+
+void RtkDeadreckoningNodelet::enuVelCallback(const geometry_msgs::Vector3Stamped::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = rtk_deadreckoning_estimator_.enuVelStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub1_.publish(boost::make_shared<eagleye_msgs::Position>(rtk_deadreckoning_estimator_.getEnuAbsoluteRtkDeadreckoning()));
+    latency_trace_.publish(msg->header.stamp);
+  }
+  if(rtk_deadreckoning_estimator_.isFixUpdated())
+  {
+    pub2_.publish(boost::make_shared<sensor_msgs::NavSatFix>(rtk_deadreckoning_estimator_.getFix()));
+  }
+}
+
+RtkDeadreckoningNodelet::~RtkDeadreckoningNodelet()
+{
+  checkpoint_.save();
+}
+
+void RtkDeadreckoningNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+
+  std::string subscribe_rtklib_nav_topic_name = "/rtklib_nav";
+  std::string subscribe_navsatfix_topic_name = "/navsat/fix";
+
+  n.getParam("rtklib_nav_topic",subscribe_rtklib_nav_topic_name);
+  n.getParam("navsatfix_topic",subscribe_navsatfix_topic_name);
+  n.getParam("ecef_base_pos/x", rtk_deadreckoning_parameter_.ecef_base_pos_x);
+  n.getParam("ecef_base_pos/y", rtk_deadreckoning_parameter_.ecef_base_pos_y);
+  n.getParam("ecef_base_pos/z", rtk_deadreckoning_parameter_.ecef_base_pos_z);
+  n.getParam("ecef_base_pos/use_ecef_base_position", rtk_deadreckoning_parameter_.use_ecef_base_position);
+  n.getParam("rtk_deadreckoning/stop_judgment_velocity_threshold", rtk_deadreckoning_parameter_.stop_judgment_velocity_threshold);
+  n.getParam("tf_gnss_flame/parent", rtk_deadreckoning_parameter_.tf_gnss_parent_flame);
+  n.getParam("tf_gnss_flame/child", rtk_deadreckoning_parameter_.tf_gnss_child_flame);
+
+  std::cout<< "subscribe_rtklib_nav_topic_name "<<subscribe_rtklib_nav_topic_name<<std::endl;
+  std::cout<< "subscribe_navsatfix_topic_name "<<subscribe_navsatfix_topic_name<<std::endl;
+  std::cout<< "ecef_base_pos_x "<<rtk_deadreckoning_parameter_.ecef_base_pos_x<<std::endl;
+  std::cout<< "ecef_base_pos_y "<<rtk_deadreckoning_parameter_.ecef_base_pos_y<<std::endl;
+  std::cout<< "ecef_base_pos_z "<<rtk_deadreckoning_parameter_.ecef_base_pos_z<<std::endl;
+  std::cout<< "use_ecef_base_position "<<rtk_deadreckoning_parameter_.use_ecef_base_position<<std::endl;
+  std::cout<< "stop_judgment_velocity_threshold "<<rtk_deadreckoning_parameter_.stop_judgment_velocity_threshold<<std::endl;
+  std::cout<< "tf_gnss_flame/parent "<<rtk_deadreckoning_parameter_.tf_gnss_parent_flame<<std::endl;
+  std::cout<< "tf_gnss_flame/child "<<rtk_deadreckoning_parameter_.tf_gnss_child_flame<<std::endl;
+
+  rtk_deadreckoning_estimator_.setParameter(rtk_deadreckoning_parameter_);
+
+  checkpoint_.init(n, getName(), &rtk_deadreckoning_estimator_);
+
+  sub1_ = input_merger_.subscribeShm(n, subscribe_rtklib_nav_topic_name, 1000, &RtkDeadreckoningNodelet::rtklibNavCallback, this);
+  sub2_ = input_merger_.subscribe(n, "enu_vel", 1000, &RtkDeadreckoningNodelet::enuVelCallback, this, InputMerger::DERIVED | InputMerger::TRIGGER);
+  sub3_ = input_merger_.subscribe(n, subscribe_navsatfix_topic_name, 1000, &RtkDeadreckoningNodelet::fixCallback, this);
+  sub4_ = input_merger_.subscribe(n, "heading_interpolate_3rd", 1000, &RtkDeadreckoningNodelet::headingInterpolate3rdCallback, this, InputMerger::DERIVED);
+  
+  pub1_ = n.advertise<eagleye_msgs::Position>("enu_absolute_rtk_deadreckoning", 1000);
+  pub2_ = n.advertise<sensor_msgs::NavSatFix>("rtk_fix", 1000);
+
+  tf_listener_.reset(new tf2_ros::TransformListener(tf_buffer_));
+  timer_ = n.createTimer(ros::Duration(0.5), &RtkDeadreckoningNodelet::timerCallback, this);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::RtkDeadreckoningNodelet, nodelet::Nodelet)
@@ -0,0 +1,231 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * rtk_heading_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class RtkHeadingNodelet : public nodelet::Nodelet
+{
+public:
+  RtkHeadingNodelet() : heading_parameter_() {}
+  ~RtkHeadingNodelet();
+  virtual void onInit();
+
+private:
+  void fixCallback(const sensor_msgs::NavSatFix::ConstPtr& msg);
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+  void yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void yawrateOffsetCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void slipAngleCallback(const eagleye_msgs::SlipAngle::ConstPtr& msg);
+  void headingInterpolateCallback(const eagleye_msgs::Heading::ConstPtr& msg);
+  void distanceCallback(const eagleye_msgs::Distance::ConstPtr& msg);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_, sub5_, sub6_, sub7_, sub8_;
+  ros::Publisher pub_;
+  RtkHeadingEstimator heading_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  NodeCheckpoint<RtkHeadingEstimator> checkpoint_;
+  RtkHeadingParameter heading_parameter_;
+};
+
+void RtkHeadingNodelet::fixCallback(const sensor_msgs::NavSatFix::ConstPtr& msg)
+{
+  heading_estimator_.setNavSatFix(*msg);
+}
+
+void RtkHeadingNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  heading_estimator_.setVelocityScaleFactor(*msg);
+}
+
+void RtkHeadingNodelet::yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  heading_estimator_.setYawrateOffsetStop(*msg);
+}
+
+void RtkHeadingNodelet::yawrateOffsetCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  heading_estimator_.setYawrateOffset(*msg);
+}
+
+void RtkHeadingNodelet::slipAngleCallback(const eagleye_msgs::SlipAngle::ConstPtr& msg)
+{
+  heading_estimator_.setSlipAngle(*msg);
+}
+
+void RtkHeadingNodelet::headingInterpolateCallback(const eagleye_msgs::Heading::ConstPtr& msg)
+{
+  heading_estimator_.setHeadingInterpolate(*msg);
+}
+
+void RtkHeadingNodelet::distanceCallback(const eagleye_msgs::Distance::ConstPtr& msg)
+{
+  heading_estimator_.setDistance(*msg);
+}
+
+void RtkHeadingNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = heading_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub_.publish(boost::make_shared<eagleye_msgs::Heading>(heading_estimator_.getHeading()));
+    input_merger_.published(msg->header.stamp);
+    latency_trace_.publish(msg->header.stamp);
+  }
+}
+
+RtkHeadingNodelet::~RtkHeadingNodelet()
+{
+  checkpoint_.save();
+}
+
+void RtkHeadingNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+  const std::vector<std::string>& argv = getMyArgv();
+
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+  std::string subscribe_navsatfix_topic_name = "/navsat/fix";
+
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("navsatfix_topic",subscribe_navsatfix_topic_name);
+  n.getParam("reverse_imu", heading_parameter_.reverse_imu);
+  n.getParam("rtk_heading/estimated_distance",heading_parameter_.estimated_distance);
+  n.getParam("rtk_heading/estimated_heading_buffer_min",heading_parameter_.estimated_heading_buffer_min);
+  n.getParam("rtk_heading/estimated_number_min",heading_parameter_.estimated_number_min);
+  n.getParam("rtk_heading/estimated_number_max",heading_parameter_.estimated_number_max);
+  n.getParam("rtk_heading/estimated_gnss_coefficient",heading_parameter_.estimated_gnss_coefficient);
+  n.getParam("rtk_heading/estimated_heading_coefficient",heading_parameter_.estimated_heading_coefficient);
+  n.getParam("rtk_heading/outlier_threshold",heading_parameter_.outlier_threshold);
+  n.getParam("rtk_heading/estimated_velocity_threshold",heading_parameter_.estimated_velocity_threshold);
+  n.getParam("rtk_heading/stop_judgment_velocity_threshold",heading_parameter_.stop_judgment_velocity_threshold);
+  n.getParam("rtk_heading/estimated_yawrate_threshold",heading_parameter_.estimated_yawrate_threshold);
+
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "subscribe_navsatfix_topic_name "<<subscribe_navsatfix_topic_name<<std::endl;
+  std::cout<< "reverse_imu "<<heading_parameter_.reverse_imu<<std::endl;
+  std::cout<< "estimated_distance "<<heading_parameter_.estimated_distance<<std::endl;
+  std::cout<< "estimated_heading_buffer_min "<<heading_parameter_.estimated_heading_buffer_min<<std::endl;
+  std::cout<< "estimated_number_min "<<heading_parameter_.estimated_number_min<<std::endl;
+  std::cout<< "estimated_number_max "<<heading_parameter_.estimated_number_max<<std::endl;
+  std::cout<< "estimated_gnss_coefficient "<<heading_parameter_.estimated_gnss_coefficient<<std::endl;
+  std::cout<< "estimated_heading_coefficient "<<heading_parameter_.estimated_heading_coefficient<<std::endl;
+  std::cout<< "outlier_threshold "<<heading_parameter_.outlier_threshold<<std::endl;
+  std::cout<< "estimated_velocity_threshold "<<heading_parameter_.estimated_velocity_threshold<<std::endl;
+  std::cout<< "stop_judgment_velocity_threshold "<<heading_parameter_.stop_judgment_velocity_threshold<<std::endl;
+  std::cout<< "estimated_yawrate_threshold "<<heading_parameter_.estimated_yawrate_threshold<<std::endl;
+
+  std::string publish_topic_name = "/publish_topic_name/invalid";
+  std::string subscribe_topic_name = "/subscribe_topic_name/invalid";
+  std::string subscribe_topic_name2 = "/subscribe_topic_name2/invalid";
+
+  if (argv.size() == 1)
+  {
+    if (argv[0] == "1st")
+    {
+      publish_topic_name = "heading_1st";
+      subscribe_topic_name = "yawrate_offset_stop";
+      subscribe_topic_name2 = "heading_interpolate_1st";
+    }
+    else if (argv[0] == "2nd")
+    {
+      publish_topic_name = "heading_2nd";
+      subscribe_topic_name = "yawrate_offset_1st";
+      subscribe_topic_name2 = "heading_interpolate_2nd";
+    }
+    else if (argv[0] == "3rd")
+    {
+      publish_topic_name = "heading_3rd";
+      subscribe_topic_name = "yawrate_offset_2nd";
+      subscribe_topic_name2 = "heading_interpolate_3rd";
+    }
+    else
+    {
+      NODELET_ERROR("Invalid argument");
+      return;
+    }
+  }
+  else
+  {
+    NODELET_ERROR("No arguments");
+    return;
+  }
+
+  heading_estimator_.setParameter(heading_parameter_);
+  if (real_time_.enabled())
+  {
+    heading_estimator_.reserve();
+  }
+
+  checkpoint_.init(n, getName(), &heading_estimator_);
+
+  sub1_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &RtkHeadingNodelet::imuCallback, this, InputMerger::TRIGGER);
+  sub2_ = input_merger_.subscribe(n, subscribe_navsatfix_topic_name, 1000, &RtkHeadingNodelet::fixCallback, this);
+  sub3_ = input_merger_.subscribe(n, "velocity_scale_factor", 1000, &RtkHeadingNodelet::velocityScaleFactorCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribe(n, "yawrate_offset_stop", 1000, &RtkHeadingNodelet::yawrateOffsetStopCallback, this, InputMerger::DERIVED);
+  sub5_ = input_merger_.subscribe(n, subscribe_topic_name, 1000, &RtkHeadingNodelet::yawrateOffsetCallback, this, InputMerger::DERIVED);
+  sub6_ = input_merger_.subscribe(n, "slip_angle", 1000, &RtkHeadingNodelet::slipAngleCallback, this, InputMerger::FEEDBACK);
+  sub7_ = input_merger_.subscribe(n, subscribe_topic_name2, 1000, &RtkHeadingNodelet::headingInterpolateCallback, this, InputMerger::FEEDBACK);
+  sub8_ = input_merger_.subscribe(n, "distance", 1000, &RtkHeadingNodelet::distanceCallback, this, InputMerger::DERIVED);
+
+  pub_ = n.advertise<eagleye_msgs::Heading>(publish_topic_name, 1000);
+  input_merger_.advertiseProgress(n, publish_topic_name);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::RtkHeadingNodelet, nodelet::Nodelet)
@@ -0,0 +1,148 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * slip_angle_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/warm_start.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class SlipAngleNodelet : public nodelet::Nodelet
+{
+public:
+  SlipAngleNodelet() : slip_angle_parameter_() {}
+  ~SlipAngleNodelet();
+  virtual void onInit();
+
+private:
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+  void yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void yawrateOffset2ndCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_;
+  ros::Publisher pub_;
+  SlipAngleEstimator slip_angle_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  WarmStart warm_start_;
+  NodeCheckpoint<SlipAngleEstimator> checkpoint_;
+  SlipangleParameter slip_angle_parameter_;
+};
+
+void SlipAngleNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  slip_angle_estimator_.setVelocityScaleFactor(*msg);
+}
+
+void SlipAngleNodelet::yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  slip_angle_estimator_.setYawrateOffsetStop(*msg);
+}
+
+void SlipAngleNodelet::yawrateOffset2ndCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  slip_angle_estimator_.setYawrateOffset(*msg);
+}
+
+void SlipAngleNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = slip_angle_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub_.publish(boost::make_shared<eagleye_msgs::SlipAngle>(slip_angle_estimator_.getSlipAngle()));
+    latency_trace_.publish(msg->header.stamp);
+  }
+}
+
+SlipAngleNodelet::~SlipAngleNodelet()
+{
+  checkpoint_.save();
+}
+
+void SlipAngleNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+  warm_start_.init(n);
+
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("reverse_imu", slip_angle_parameter_.reverse_imu);
+  n.getParam("slip_angle/manual_coefficient", slip_angle_parameter_.manual_coefficient);
+  n.getParam("slip_angle/stop_judgment_velocity_threshold", slip_angle_parameter_.stop_judgment_velocity_threshold);
+  // The slip coefficient node saves its estimate, which is used when no
+  // coefficient is configured.
+  if (slip_angle_parameter_.manual_coefficient == 0)
+  {
+    warm_start_.load("slip_coefficient", warm_start_.maxAge(), &slip_angle_parameter_.manual_coefficient);
+  }
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "reverse_imu "<<slip_angle_parameter_.reverse_imu<<std::endl;
+  std::cout<< "manual_coefficient "<<slip_angle_parameter_.manual_coefficient<<std::endl;
+  std::cout<< "stop_judgment_velocity_threshold "<<slip_angle_parameter_.stop_judgment_velocity_threshold<<std::endl;
+
+  slip_angle_estimator_.setParameter(slip_angle_parameter_);
+
+  checkpoint_.init(n, getName(), &slip_angle_estimator_);
+
+  sub1_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &SlipAngleNodelet::imuCallback, this, InputMerger::TRIGGER);
+  sub2_ = input_merger_.subscribe(n, "velocity_scale_factor", 1000, &SlipAngleNodelet::velocityScaleFactorCallback, this, InputMerger::DERIVED);
+  sub3_ = input_merger_.subscribe(n, "yawrate_offset_stop", 1000, &SlipAngleNodelet::yawrateOffsetStopCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribe(n, "yawrate_offset_2nd", 1000, &SlipAngleNodelet::yawrateOffset2ndCallback, this, InputMerger::DERIVED);
+  pub_ = n.advertise<eagleye_msgs::SlipAngle>("slip_angle", 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::SlipAngleNodelet, nodelet::Nodelet)
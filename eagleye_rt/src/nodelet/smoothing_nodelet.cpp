@@ -0,0 +1,139 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * smoothing_nodelet.cpp
+ * Author MapIV Takanose
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class SmoothingNodelet : public nodelet::Nodelet
+{
+public:
+  SmoothingNodelet() : smoothing_parameter_() {}
+  ~SmoothingNodelet();
+  virtual void onInit();
+
+private:
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+  void rtklibNavCallback(const rtklib_msgs::RtklibNav::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_;
+  ros::Publisher pub_;
+  SmoothingEstimator smoothing_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  NodeCheckpoint<SmoothingEstimator> checkpoint_;
+  SmoothingParameter smoothing_parameter_;
+};
+
+void SmoothingNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  smoothing_estimator_.setVelocityScaleFactor(*msg);
+}
+
+void SmoothingNodelet::rtklibNavCallback(const rtklib_msgs::RtklibNav::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = smoothing_estimator_.rtklibNavStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    pub_.publish(boost::make_shared<eagleye_msgs::Position>(smoothing_estimator_.getGnssSmoothPos()));
+    input_merger_.published(msg->header.stamp);
+    latency_trace_.publish(msg->header.stamp);
+  }
+}
+
+SmoothingNodelet::~SmoothingNodelet()
+{
+  checkpoint_.save();
+}
+
+void SmoothingNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+
+  std::string subscribe_rtklib_nav_topic_name = "/rtklib_nav";
+
+  n.getParam("rtklib_nav_topic",subscribe_rtklib_nav_topic_name);
+  n.getParam("ecef_base_pos/x",smoothing_parameter_.ecef_base_pos_x);
+  n.getParam("ecef_base_pos/y",smoothing_parameter_.ecef_base_pos_y);
+  n.getParam("ecef_base_pos/z",smoothing_parameter_.ecef_base_pos_z);
+  n.getParam("smoothing/estimated_number_max",smoothing_parameter_.estimated_number_max);
+  n.getParam("smoothing/estimated_velocity_threshold",smoothing_parameter_.estimated_velocity_threshold);
+  n.getParam("smoothing/estimated_threshold",smoothing_parameter_.estimated_threshold);
+
+  std::cout<< "subscribe_rtklib_nav_topic_name "<<subscribe_rtklib_nav_topic_name<<std::endl;
+  std::cout<< "ecef_base_pos_x "<<smoothing_parameter_.ecef_base_pos_x<<std::endl;
+  std::cout<< "ecef_base_pos_y "<<smoothing_parameter_.ecef_base_pos_y<<std::endl;
+  std::cout<< "ecef_base_pos_z "<<smoothing_parameter_.ecef_base_pos_z<<std::endl;
+  std::cout<< "estimated_number_max "<<smoothing_parameter_.estimated_number_max<<std::endl;
+  std::cout<< "estimated_velocity_threshold "<<smoothing_parameter_.estimated_velocity_threshold<<std::endl;
+  std::cout<< "estimated_threshold "<<smoothing_parameter_.estimated_threshold<<std::endl;
+
+  smoothing_estimator_.setParameter(smoothing_parameter_);
+  if (real_time_.enabled())
+  {
+    smoothing_estimator_.reserve();
+  }
+
+  checkpoint_.init(n, getName(), &smoothing_estimator_);
+
+  sub1_ = input_merger_.subscribe(n, "velocity_scale_factor", 1000, &SmoothingNodelet::velocityScaleFactorCallback, this, InputMerger::DERIVED);
+  sub2_ = input_merger_.subscribeShm(n, subscribe_rtklib_nav_topic_name, 1000, &SmoothingNodelet::rtklibNavCallback, this, InputMerger::TRIGGER);
+
+  pub_ = n.advertise<eagleye_msgs::Position>("gnss_smooth_pos_enu", 1000);
+  input_merger_.advertiseProgress(n, "gnss_smooth_pos_enu");
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::SmoothingNodelet, nodelet::Nodelet)
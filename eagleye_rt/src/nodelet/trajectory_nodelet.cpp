@@ -0,0 +1,193 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * trajectory_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class TrajectoryNodelet : public nodelet::Nodelet
+{
+public:
+  TrajectoryNodelet() : trajectory_parameter_(), update_rate_(10), th_deadlock_time_(1) {}
+  ~TrajectoryNodelet();
+  virtual void onInit();
+
+private:
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+  void headingInterpolate3rdCallback(const eagleye_msgs::Heading::ConstPtr& msg);
+  void yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void yawrateOffset2ndCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void pitchingCallback(const eagleye_msgs::Pitching::ConstPtr& msg);
+  void velocityCallback(const geometry_msgs::TwistStamped::ConstPtr& msg);
+  void timerCallback(const ros::TimerEvent& e);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_, sub5_, sub6_, sub7_;
+  ros::Publisher pub1_;
+  ros::Publisher pub2_;
+  ros::Publisher pub3_;
+  TrajectoryEstimator trajectory_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  NodeCheckpoint<TrajectoryEstimator> checkpoint_;
+  TrajectoryParameter trajectory_parameter_;
+  ros::Timer timer_;
+  double update_rate_;
+  double th_deadlock_time_;
+};
+
+void TrajectoryNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  trajectory_estimator_.setVelocityScaleFactor(*msg);
+}
+
+void TrajectoryNodelet::headingInterpolate3rdCallback(const eagleye_msgs::Heading::ConstPtr& msg)
+{
+  trajectory_estimator_.setHeadingInterpolate(*msg);
+}
+
+void TrajectoryNodelet::yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  trajectory_estimator_.setYawrateOffsetStop(*msg);
+}
+
+void TrajectoryNodelet::yawrateOffset2ndCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  trajectory_estimator_.setYawrateOffset(*msg);
+}
+
+void TrajectoryNodelet::pitchingCallback(const eagleye_msgs::Pitching::ConstPtr& msg)
+{
+  trajectory_estimator_.setPitching(*msg);
+}
+
+void TrajectoryNodelet::velocityCallback(const geometry_msgs::TwistStamped::ConstPtr& msg)
+{
+  trajectory_estimator_.setTwist(*msg);
+}
+
+void TrajectoryNodelet::timerCallback(const ros::TimerEvent& e)
+{
+  if (!trajectory_estimator_.checkInputStatus(th_deadlock_time_))
+  {
+    NODELET_WARN("Twist is missing the required input topics.");
+  }
+}
+
+void TrajectoryNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = trajectory_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    if(trajectory_estimator_.isEnuVelUpdated())
+    {
+      pub1_.publish(boost::make_shared<geometry_msgs::Vector3Stamped>(trajectory_estimator_.getEnuVel()));
+      pub2_.publish(boost::make_shared<eagleye_msgs::Position>(trajectory_estimator_.getEnuRelativePos()));
+      input_merger_.published(msg->header.stamp);
+    }
+    pub3_.publish(boost::make_shared<geometry_msgs::TwistStamped>(trajectory_estimator_.getTwist()));
+    latency_trace_.publish(msg->header.stamp);
+  }
+}
+
+TrajectoryNodelet::~TrajectoryNodelet()
+{
+  checkpoint_.save();
+}
+
+void TrajectoryNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+  std::string subscribe_twist_topic_name = "/can_twist";
+
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("twist_topic",subscribe_twist_topic_name);
+  n.getParam("reverse_imu", trajectory_parameter_.reverse_imu);
+  n.getParam("trajectory/stop_judgment_velocity_threshold",trajectory_parameter_.stop_judgment_velocity_threshold);
+  n.getParam("trajectory/stop_judgment_yawrate_threshold",trajectory_parameter_.stop_judgment_yawrate_threshold);
+  n.getParam("trajectory/timer_updata_rate",update_rate_);
+  n.getParam("trajectory/th_deadlock_time",th_deadlock_time_);
+
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "subscribe_twist_topic_name "<<subscribe_twist_topic_name<<std::endl;
+  std::cout<< "reverse_imu "<<trajectory_parameter_.reverse_imu<<std::endl;
+  std::cout<< "stop_judgment_velocity_threshold "<<trajectory_parameter_.stop_judgment_velocity_threshold<<std::endl;
+  std::cout<< "stop_judgment_yawrate_threshold "<<trajectory_parameter_.stop_judgment_yawrate_threshold<<std::endl;
+  std::cout<< "timer_updata_rate "<<update_rate_<<std::endl;
+  std::cout<< "th_deadlock_time "<<th_deadlock_time_<<std::endl;
+
+  trajectory_estimator_.setParameter(trajectory_parameter_);
+
+  checkpoint_.init(n, getName(), &trajectory_estimator_);
+
+  sub1_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &TrajectoryNodelet::imuCallback, this, InputMerger::TRIGGER);
+  sub2_ = input_merger_.subscribe(n, subscribe_twist_topic_name, 1000, &TrajectoryNodelet::velocityCallback, this);
+  sub3_ = input_merger_.subscribe(n, "velocity_scale_factor", 1000, &TrajectoryNodelet::velocityScaleFactorCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribe(n, "heading_interpolate_3rd", 1000, &TrajectoryNodelet::headingInterpolate3rdCallback, this, InputMerger::DERIVED);
+  sub5_ = input_merger_.subscribe(n, "yawrate_offset_stop", 1000, &TrajectoryNodelet::yawrateOffsetStopCallback, this, InputMerger::DERIVED);
+  sub6_ = input_merger_.subscribe(n, "yawrate_offset_2nd", 1000, &TrajectoryNodelet::yawrateOffset2ndCallback, this, InputMerger::DERIVED);
+  sub7_ = input_merger_.subscribe(n, "pitching", 1000, &TrajectoryNodelet::pitchingCallback, this, InputMerger::DERIVED);
+  pub1_ = n.advertise<geometry_msgs::Vector3Stamped>("enu_vel", 1000);
+  input_merger_.advertiseProgress(n, "enu_vel");
+  pub2_ = n.advertise<eagleye_msgs::Position>("enu_relative_pos", 1000);
+  pub3_ = n.advertise<geometry_msgs::TwistStamped>("twist", 1000);
+
+  timer_ = n.createTimer(ros::Duration(1/update_rate_), &TrajectoryNodelet::timerCallback, this);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::TrajectoryNodelet, nodelet::Nodelet)
@@ -0,0 +1,159 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * velocity_scale_factor_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/warm_start.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class VelocityScaleFactorNodelet : public nodelet::Nodelet
+{
+public:
+  VelocityScaleFactorNodelet() : velocity_scale_factor_parameter_() {}
+  ~VelocityScaleFactorNodelet();
+  virtual void onInit();
+
+private:
+  void rtklibNavCallback(const rtklib_msgs::RtklibNav::ConstPtr& msg);
+  void velocityCallback(const geometry_msgs::TwistStamped::ConstPtr& msg);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_;
+  ros::Publisher pub_;
+  VelocityScaleFactorEstimator velocity_scale_factor_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  WarmStart warm_start_;
+  NodeCheckpoint<VelocityScaleFactorEstimator> checkpoint_;
+  VelocityScaleFactorParameter velocity_scale_factor_parameter_;
+};
+
+void VelocityScaleFactorNodelet::rtklibNavCallback(const rtklib_msgs::RtklibNav::ConstPtr& msg)
+{
+  velocity_scale_factor_estimator_.setRtklibNav(*msg);
+}
+
+void VelocityScaleFactorNodelet::velocityCallback(const geometry_msgs::TwistStamped::ConstPtr& msg)
+{
+  velocity_scale_factor_estimator_.setTwist(*msg);
+}
+
+void VelocityScaleFactorNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = velocity_scale_factor_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    const eagleye_msgs::VelocityScaleFactor& velocity_scale_factor = velocity_scale_factor_estimator_.getVelocityScaleFactor();
+    pub_.publish(boost::make_shared<eagleye_msgs::VelocityScaleFactor>(velocity_scale_factor));
+    latency_trace_.publish(msg->header.stamp);
+    if (velocity_scale_factor.status.estimate_status)
+    {
+      warm_start_.update("velocity_scale_factor", velocity_scale_factor.scale_factor, msg->header.stamp);
+    }
+  }
+}
+
+VelocityScaleFactorNodelet::~VelocityScaleFactorNodelet()
+{
+  checkpoint_.save();
+  warm_start_.save();
+}
+
+void VelocityScaleFactorNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+  warm_start_.init(n);
+
+  std::string subscribe_twist_topic_name = "/can_twist";
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+  std::string subscribe_rtklib_nav_topic_name = "/rtklib_nav";
+
+  n.getParam("twist_topic",subscribe_twist_topic_name);
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("rtklib_nav_topic",subscribe_rtklib_nav_topic_name);
+  n.getParam("velocity_scale_factor/estimated_number_min",velocity_scale_factor_parameter_.estimated_number_min);
+  n.getParam("velocity_scale_factor/estimated_number_max",velocity_scale_factor_parameter_.estimated_number_max);
+  n.getParam("velocity_scale_factor/estimated_velocity_threshold",velocity_scale_factor_parameter_.estimated_velocity_threshold);
+  n.getParam("velocity_scale_factor/estimated_coefficient",velocity_scale_factor_parameter_.estimated_coefficient);
+
+  std::cout<< "subscribe_twist_topic_name "<<subscribe_twist_topic_name<<std::endl;
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "subscribe_rtklib_nav_topic_name "<<subscribe_rtklib_nav_topic_name<<std::endl;
+  std::cout<< "estimated_number_min "<<velocity_scale_factor_parameter_.estimated_number_min<<std::endl;
+  std::cout<< "estimated_number_max "<<velocity_scale_factor_parameter_.estimated_number_max<<std::endl;
+  std::cout<< "estimated_velocity_threshold "<<velocity_scale_factor_parameter_.estimated_velocity_threshold<<std::endl;
+  std::cout<< "estimated_coefficient "<<velocity_scale_factor_parameter_.estimated_coefficient<<std::endl;
+
+  velocity_scale_factor_estimator_.setParameter(velocity_scale_factor_parameter_);
+  if (real_time_.enabled())
+  {
+    velocity_scale_factor_estimator_.reserve();
+  }
+  double warm_scale_factor;
+  if (warm_start_.load("velocity_scale_factor", warm_start_.maxAge(), &warm_scale_factor))
+  {
+    velocity_scale_factor_estimator_.warmStart(warm_scale_factor);
+  }
+
+  checkpoint_.init(n, getName(), &velocity_scale_factor_estimator_);
+
+  sub1_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &VelocityScaleFactorNodelet::imuCallback, this, InputMerger::TRIGGER);
+  sub2_ = input_merger_.subscribe(n, subscribe_twist_topic_name, 1000, &VelocityScaleFactorNodelet::velocityCallback, this);
+  sub3_ = input_merger_.subscribeShm(n, subscribe_rtklib_nav_topic_name, 1000, &VelocityScaleFactorNodelet::rtklibNavCallback, this);
+  pub_ = n.advertise<eagleye_msgs::VelocityScaleFactor>("velocity_scale_factor", 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::VelocityScaleFactorNodelet, nodelet::Nodelet)
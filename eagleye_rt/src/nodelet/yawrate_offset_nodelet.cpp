@@ -0,0 +1,196 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * yawrate_offset_nodelet.cpp
+ * Author MapIV Sekino
+ */
+
+#include "ros/ros.h"
+#include "coordinate/coordinate.hpp"
+#include "navigation/estimator.hpp"
+#include "eagleye_rt/estimate_latency.hpp"
+#include "eagleye_rt/latency_trace.hpp"
+#include "eagleye_rt/real_time.hpp"
+#include "eagleye_rt/input_merger.hpp"
+#include "eagleye_rt/warm_start.hpp"
+#include "eagleye_rt/node_checkpoint.hpp"
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <boost/make_shared.hpp>
+
+namespace eagleye_rt
+{
+
+class YawrateOffsetNodelet : public nodelet::Nodelet
+{
+public:
+  YawrateOffsetNodelet() : yawrate_offset_parameter_() {}
+  ~YawrateOffsetNodelet();
+  virtual void onInit();
+
+private:
+  void velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg);
+  void yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg);
+  void headingInterpolateCallback(const eagleye_msgs::Heading::ConstPtr& msg);
+  void imuCallback(const sensor_msgs::Imu::ConstPtr& msg);
+
+  ShmSubscriber sub1_, sub2_, sub3_, sub4_;
+  ros::Publisher pub_;
+  YawrateOffsetEstimator yawrate_offset_estimator_;
+  EstimateLatency estimate_latency_;
+  LatencyTrace latency_trace_;
+  RealTime real_time_;
+  InputMerger input_merger_;
+  WarmStart warm_start_;
+  std::string warm_start_name_;
+  NodeCheckpoint<YawrateOffsetEstimator> checkpoint_;
+  YawrateOffsetParameter yawrate_offset_parameter_;
+};
+
+void YawrateOffsetNodelet::velocityScaleFactorCallback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
+{
+  yawrate_offset_estimator_.setVelocityScaleFactor(*msg);
+}
+
+void YawrateOffsetNodelet::yawrateOffsetStopCallback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
+{
+  yawrate_offset_estimator_.setYawrateOffsetStop(*msg);
+}
+
+void YawrateOffsetNodelet::headingInterpolateCallback(const eagleye_msgs::Heading::ConstPtr& msg)
+{
+  yawrate_offset_estimator_.setHeadingInterpolate(*msg);
+}
+
+void YawrateOffsetNodelet::imuCallback(const sensor_msgs::Imu::ConstPtr& msg)
+{
+  latency_trace_.receive();
+  estimate_latency_.start();
+  real_time_.start();
+  bool updated = yawrate_offset_estimator_.imuStep(*msg);
+  real_time_.stop();
+  estimate_latency_.stop();
+
+  if (updated)
+  {
+    const eagleye_msgs::YawrateOffset& yawrate_offset = yawrate_offset_estimator_.getYawrateOffset();
+    pub_.publish(boost::make_shared<eagleye_msgs::YawrateOffset>(yawrate_offset));
+    latency_trace_.publish(msg->header.stamp);
+    if (yawrate_offset.status.estimate_status)
+    {
+      warm_start_.update(warm_start_name_, yawrate_offset.yawrate_offset, msg->header.stamp);
+    }
+  }
+}
+
+YawrateOffsetNodelet::~YawrateOffsetNodelet()
+{
+  checkpoint_.save();
+  warm_start_.save();
+}
+
+void YawrateOffsetNodelet::onInit()
+{
+  ros::NodeHandle& n = getNodeHandle();
+  estimate_latency_.init(n, getPrivateNodeHandle(), getName());
+  latency_trace_.init(n, getName());
+  real_time_.init(n, getName());
+  input_merger_.init(n);
+  warm_start_.init(n);
+  const std::vector<std::string>& argv = getMyArgv();
+
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("reverse_imu", yawrate_offset_parameter_.reverse_imu);
+  n.getParam("yawrate_offset/estimated_number_min",yawrate_offset_parameter_.estimated_number_min);
+  n.getParam("yawrate_offset/estimated_coefficient",yawrate_offset_parameter_.estimated_coefficient);
+  n.getParam("yawrate_offset/estimated_velocity_threshold",yawrate_offset_parameter_.estimated_velocity_threshold);
+  n.getParam("yawrate_offset/outlier_threshold",yawrate_offset_parameter_.outlier_threshold);
+
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "reverse_imu "<<yawrate_offset_parameter_.reverse_imu<<std::endl;
+  std::cout<< "estimated_number_min "<<yawrate_offset_parameter_.estimated_number_min<<std::endl;
+  std::cout<< "estimated_coefficient "<<yawrate_offset_parameter_.estimated_coefficient<<std::endl;
+  std::cout<< "estimated_velocity_threshold "<<yawrate_offset_parameter_.estimated_velocity_threshold<<std::endl;
+  std::cout<< "outlier_threshold "<<yawrate_offset_parameter_.outlier_threshold<<std::endl;
+
+  std::string publish_topic_name = "/publish_topic_name/invalid";
+  std::string subscribe_topic_name = "/subscribe_topic_name/invalid";
+
+  if (argv.size() == 1)
+  {
+    if (argv[0] == "1st")
+    {
+      publish_topic_name = "yawrate_offset_1st";
+      subscribe_topic_name = "heading_interpolate_1st";
+      n.getParam("yawrate_offset/1st/estimated_number_max",yawrate_offset_parameter_.estimated_number_max);
+      std::cout<< "estimated_number_max "<<yawrate_offset_parameter_.estimated_number_max<<std::endl;
+    }
+    else if (argv[0] == "2nd")
+    {
+      publish_topic_name = "yawrate_offset_2nd";
+      subscribe_topic_name = "heading_interpolate_2nd";
+      n.getParam("yawrate_offset/2nd/estimated_number_max",yawrate_offset_parameter_.estimated_number_max);
+      std::cout<< "estimated_number_max "<<yawrate_offset_parameter_.estimated_number_max<<std::endl;
+    }
+    else
+    {
+      NODELET_ERROR("Invalid argument");
+      return;
+    }
+  }
+  else
+  {
+    NODELET_ERROR("No arguments");
+    return;
+  }
+
+  yawrate_offset_estimator_.setParameter(yawrate_offset_parameter_);
+  if (real_time_.enabled())
+  {
+    yawrate_offset_estimator_.reserve();
+  }
+  warm_start_name_ = publish_topic_name;
+  double warm_yawrate_offset;
+  if (warm_start_.load(warm_start_name_, warm_start_.yawrateOffsetMaxAge(), &warm_yawrate_offset))
+  {
+    yawrate_offset_estimator_.warmStart(warm_yawrate_offset);
+  }
+
+  checkpoint_.init(n, getName(), &yawrate_offset_estimator_);
+
+  sub1_ = input_merger_.subscribe(n, "velocity_scale_factor", 1000, &YawrateOffsetNodelet::velocityScaleFactorCallback, this, InputMerger::DERIVED);
+  sub2_ = input_merger_.subscribe(n, "yawrate_offset_stop", 1000, &YawrateOffsetNodelet::yawrateOffsetStopCallback, this, InputMerger::DERIVED);
+  sub3_ = input_merger_.subscribe(n, subscribe_topic_name, 1000, &YawrateOffsetNodelet::headingInterpolateCallback, this, InputMerger::DERIVED);
+  sub4_ = input_merger_.subscribeShm(n, subscribe_imu_topic_name, 1000, &YawrateOffsetNodelet::imuCallback, this, InputMerger::TRIGGER);
+  pub_ = n.advertise<eagleye_msgs::YawrateOffset>(publish_topic_name, 1000);
+}
+
+}  // namespace eagleye_rt
+
+PLUGINLIB_EXPORT_CLASS(eagleye_rt::YawrateOffsetNodelet, nodelet::Nodelet)
@@ -0,0 +1,337 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * column_log.cpp
+ * Author MapIV Sekino
+ */
+
+#include "eagleye_rt/column_log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char column_log_magic[8] = {'E', 'A', 'G', 'L', 'E', 'L', 'O', 'G'};
+
+static void columnLogError(const std::string& message)
+{
+  throw std::runtime_error("column log: " + message);
+}
+
+// A name field has to be terminated within its size.
+static std::string nameField(const char* field, std::size_t size)
+{
+  if (std::memchr(field, '\0', size) == NULL)
+  {
+    columnLogError("unterminated name");
+  }
+  return std::string(field);
+}
+
+static void copyNameField(const std::string& name, char* field, std::size_t size)
+{
+  if (name.size() >= size)
+  {
+    columnLogError("name too long: " + name);
+  }
+  std::memset(field, 0, size);
+  std::memcpy(field, name.c_str(), name.size());
+}
+
+const double* ColumnTable::column(const std::string& name) const
+{
+  std::map<std::string, const double*>::const_iterator it = columns_.find(name);
+  if (it == columns_.end())
+  {
+    columnLogError("table " + name_ + " has no column " + name);
+  }
+  return it->second;
+}
+
+std::vector<std::string> ColumnTable::columnNames() const
+{
+  std::vector<std::string> names;
+  for (std::map<std::string, const double*>::const_iterator it = columns_.begin(); it != columns_.end(); ++it)
+  {
+    names.push_back(it->first);
+  }
+  return names;
+}
+
+std::size_t ColumnTable::lowerBound(int64_t stamp) const
+{
+  return std::lower_bound(stamp_, stamp_ + size_, stamp) - stamp_;
+}
+
+ColumnLog::ColumnLog(const std::string& file) : data_(NULL), length_(0)
+{
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    columnLogError("cannot open " + file);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(ColumnLogHeader)))
+  {
+    ::close(fd);
+    columnLogError(file + " is not a column log");
+  }
+  length_ = st.st_size;
+  data_ = mmap(NULL, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data_ == MAP_FAILED)
+  {
+    data_ = NULL;
+    columnLogError("cannot map " + file);
+  }
+
+  try
+  {
+    const char* base = static_cast<const char*>(data_);
+    const ColumnLogHeader* header = reinterpret_cast<const ColumnLogHeader*>(base);
+    if (std::memcmp(header->magic, column_log_magic, sizeof(column_log_magic)) != 0)
+    {
+      columnLogError(file + " is not a column log");
+    }
+    if (header->version != COLUMN_LOG_VERSION)
+    {
+      columnLogError(file + " has an unsupported version");
+    }
+
+    std::size_t position = sizeof(ColumnLogHeader);
+    for (uint32_t i = 0; i < header->table_count; i++)
+    {
+      if (position + sizeof(ColumnLogTableEntry) > length_)
+      {
+        columnLogError(file + " is truncated");
+      }
+      const ColumnLogTableEntry* entry = reinterpret_cast<const ColumnLogTableEntry*>(base + position);
+      position += sizeof(ColumnLogTableEntry);
+
+      // Every array holds row_count 8 byte values inside the file.
+      uint64_t array_size = entry->row_count * 8;
+      if (entry->row_count > length_ / 8 || entry->column_count > length_ / sizeof(ColumnLogColumnEntry))
+      {
+        columnLogError(file + " is truncated");
+      }
+      ColumnTable table;
+      table.name_ = nameField(entry->name, sizeof(entry->name));
+      table.frame_id_ = nameField(entry->frame_id, sizeof(entry->frame_id));
+      table.size_ = entry->row_count;
+      if (entry->stamp_offset % 8 != 0 || entry->stamp_offset > length_ || array_size > length_ - entry->stamp_offset)
+      {
+        columnLogError(file + " is truncated");
+      }
+      table.stamp_ = reinterpret_cast<const int64_t*>(base + entry->stamp_offset);
+
+      for (uint64_t j = 0; j < entry->column_count; j++)
+      {
+        if (position + sizeof(ColumnLogColumnEntry) > length_)
+        {
+          columnLogError(file + " is truncated");
+        }
+        const ColumnLogColumnEntry* column = reinterpret_cast<const ColumnLogColumnEntry*>(base + position);
+        position += sizeof(ColumnLogColumnEntry);
+        if (column->offset % 8 != 0 || column->offset > length_ || array_size > length_ - column->offset)
+        {
+          columnLogError(file + " is truncated");
+        }
+        table.columns_[nameField(column->name, sizeof(column->name))] = reinterpret_cast<const double*>(base + column->offset);
+      }
+      tables_[table.name_] = table;
+    }
+  }
+  catch (...)
+  {
+    munmap(data_, length_);
+    throw;
+  }
+}
+
+ColumnLog::~ColumnLog()
+{
+  munmap(data_, length_);
+}
+
+const ColumnTable* ColumnLog::table(const std::string& name) const
+{
+  std::map<std::string, ColumnTable>::const_iterator it = tables_.find(name);
+  return it == tables_.end() ? NULL : &it->second;
+}
+
+std::vector<std::string> ColumnLog::tableNames() const
+{
+  std::vector<std::string> names;
+  for (std::map<std::string, ColumnTable>::const_iterator it = tables_.begin(); it != tables_.end(); ++it)
+  {
+    names.push_back(it->first);
+  }
+  return names;
+}
+
+void ColumnLogWriter::beginRow(const std::string& table, int64_t stamp, const std::string& frame_id)
+{
+  endRow();
+  std::map<std::string, std::size_t>::iterator it = table_index_.find(table);
+  if (it == table_index_.end())
+  {
+    it = table_index_.insert(std::make_pair(table, tables_.size())).first;
+    tables_.push_back(Table());
+    tables_.back().name = table;
+    tables_.back().frame_id = frame_id;
+  }
+  row_table_ = &tables_[it->second];
+  row_table_->stamp.push_back(stamp);
+  row_column_ = 0;
+}
+
+void ColumnLogWriter::add(const char* column, double value)
+{
+  if (row_table_ == NULL)
+  {
+    columnLogError("add() before beginRow()");
+  }
+  Table& table = *row_table_;
+  // The first row defines the columns of the table.
+  if (table.stamp.size() == 1 && row_column_ == table.columns.size())
+  {
+    table.column_names.push_back(column);
+    table.columns.push_back(std::vector<double>());
+  }
+  if (row_column_ >= table.columns.size() || table.column_names[row_column_] != column)
+  {
+    columnLogError("row of table " + table.name + " does not match its columns at " + column);
+  }
+  table.columns[row_column_++].push_back(value);
+}
+
+void ColumnLogWriter::endRow()
+{
+  if (row_table_ != NULL && row_column_ != row_table_->columns.size())
+  {
+    columnLogError("row of table " + row_table_->name + " is incomplete");
+  }
+  row_table_ = NULL;
+  row_column_ = 0;
+}
+
+void ColumnLogWriter::save(const std::string& file)
+{
+  endRow();
+
+  std::size_t position = sizeof(ColumnLogHeader);
+  for (std::size_t i = 0; i < tables_.size(); i++)
+  {
+    position += sizeof(ColumnLogTableEntry) + tables_[i].columns.size() * sizeof(ColumnLogColumnEntry);
+  }
+
+  std::vector<char> directory(position, 0);
+  ColumnLogHeader* header = reinterpret_cast<ColumnLogHeader*>(&directory[0]);
+  std::memcpy(header->magic, column_log_magic, sizeof(column_log_magic));
+  header->version = COLUMN_LOG_VERSION;
+  header->table_count = tables_.size();
+
+  std::size_t entry_position = sizeof(ColumnLogHeader);
+  uint64_t data_position = position;
+  for (std::size_t i = 0; i < tables_.size(); i++)
+  {
+    Table& table = tables_[i];
+
+    // Inputs of a log can be recorded slightly out of stamp order.
+    if (!std::is_sorted(table.stamp.begin(), table.stamp.end()))
+    {
+      std::vector<std::size_t> order(table.stamp.size());
+      for (std::size_t j = 0; j < order.size(); j++)
+      {
+        order[j] = j;
+      }
+      const std::vector<int64_t>& stamp = table.stamp;
+      std::stable_sort(order.begin(), order.end(), [&stamp](std::size_t a, std::size_t b) { return stamp[a] < stamp[b]; });
+      std::vector<int64_t> sorted_stamp(order.size());
+      for (std::size_t j = 0; j < order.size(); j++)
+      {
+        sorted_stamp[j] = stamp[order[j]];
+      }
+      table.stamp.swap(sorted_stamp);
+      for (std::size_t k = 0; k < table.columns.size(); k++)
+      {
+        std::vector<double> sorted_column(order.size());
+        for (std::size_t j = 0; j < order.size(); j++)
+        {
+          sorted_column[j] = table.columns[k][order[j]];
+        }
+        table.columns[k].swap(sorted_column);
+      }
+    }
+
+    ColumnLogTableEntry* entry = reinterpret_cast<ColumnLogTableEntry*>(&directory[entry_position]);
+    entry_position += sizeof(ColumnLogTableEntry);
+    copyNameField(table.name, entry->name, sizeof(entry->name));
+    copyNameField(table.frame_id, entry->frame_id, sizeof(entry->frame_id));
+    entry->row_count = table.stamp.size();
+    entry->column_count = table.columns.size();
+    entry->stamp_offset = data_position;
+    data_position += table.stamp.size() * 8;
+    for (std::size_t j = 0; j < table.columns.size(); j++)
+    {
+      ColumnLogColumnEntry* column = reinterpret_cast<ColumnLogColumnEntry*>(&directory[entry_position]);
+      entry_position += sizeof(ColumnLogColumnEntry);
+      copyNameField(table.column_names[j], column->name, sizeof(column->name));
+      column->offset = data_position;
+      data_position += table.stamp.size() * 8;
+    }
+  }
+
+  std::FILE* fp = std::fopen(file.c_str(), "wb");
+  if (fp == NULL)
+  {
+    columnLogError("cannot create " + file);
+  }
+  bool written = std::fwrite(&directory[0], 1, directory.size(), fp) == directory.size();
+  for (std::size_t i = 0; i < tables_.size() && written; i++)
+  {
+    const Table& table = tables_[i];
+    written = std::fwrite(table.stamp.data(), 8, table.stamp.size(), fp) == table.stamp.size();
+    for (std::size_t j = 0; j < table.columns.size() && written; j++)
+    {
+      written = std::fwrite(table.columns[j].data(), 8, table.columns[j].size(), fp) == table.columns[j].size();
+    }
+  }
+  if (std::fclose(fp) != 0 || !written)
+  {
+    columnLogError("cannot write " + file);
+  }
+}
+
+bool isColumnLogFile(const std::string& file)
+{
+  const std::string extension = ".elog";
+  return file.size() > extension.size() && file.compare(file.size() - extension.size(), extension.size(), extension) == 0;
+}
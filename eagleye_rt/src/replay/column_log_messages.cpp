@@ -0,0 +1,372 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * column_log_messages.cpp
+ * Author MapIV Sekino
+ */
+
+#include "eagleye_rt/column_log_messages.hpp"
+#include <cmath>
+#include <limits>
+
+// Shared by the writer and the reader of each input type, in row order.
+static const char* const imu_columns[] = {
+  "orientation_x", "orientation_y", "orientation_z", "orientation_w",
+  "angular_velocity_x", "angular_velocity_y", "angular_velocity_z",
+  "linear_acceleration_x", "linear_acceleration_y", "linear_acceleration_z"
+};
+static const char* const twist_columns[] = {
+  "linear_x", "linear_y", "linear_z", "angular_x", "angular_y", "angular_z"
+};
+// status_stamp_delta is the status header stamp minus the row stamp [ns],
+// NaN for an unset status stamp.
+static const char* const rtklib_nav_columns[] = {
+  "tow", "ecef_pos_x", "ecef_pos_y", "ecef_pos_z", "ecef_vel_x", "ecef_vel_y", "ecef_vel_z",
+  "status_stamp_delta", "status_status", "status_service", "status_latitude", "status_longitude", "status_altitude"
+};
+static const char* const navsatfix_columns[] = {
+  "status", "service", "latitude", "longitude", "altitude",
+  "position_covariance_0", "position_covariance_1", "position_covariance_2",
+  "position_covariance_3", "position_covariance_4", "position_covariance_5",
+  "position_covariance_6", "position_covariance_7", "position_covariance_8", "position_covariance_type"
+};
+static const char* const transform_columns[] = {
+  "translation_x", "translation_y", "translation_z", "rotation_x", "rotation_y", "rotation_z", "rotation_w"
+};
+
+template <std::size_t N>
+static void bindColumns(const ColumnTable& table, const char* const (&names)[N], std::vector<const double*>* columns)
+{
+  columns->resize(N);
+  for (std::size_t i = 0; i < N; i++)
+  {
+    (*columns)[i] = table.column(names[i]);
+  }
+}
+
+template <std::size_t N>
+static void addColumns(ColumnLogWriter* writer, const char* const (&names)[N], const double (&values)[N])
+{
+  for (std::size_t i = 0; i < N; i++)
+  {
+    writer->add(names[i], values[i]);
+  }
+}
+
+static void beginRow(ColumnLogWriter* writer, const std::string& table, const std_msgs::Header& header)
+{
+  writer->beginRow(table, header.stamp.toNSec(), header.frame_id);
+}
+
+static void readHeader(const ColumnTable& table, std::size_t row, std_msgs::Header* header)
+{
+  header->stamp.fromNSec(table.stamp()[row]);
+  header->frame_id = table.frameId();
+}
+
+static void addStatus(ColumnLogWriter* writer, const eagleye_msgs::Status& status)
+{
+  writer->add("enabled_status", status.enabled_status);
+  writer->add("estimate_status", status.estimate_status);
+}
+
+static std::string stripSlash(const std::string& frame)
+{
+  return (!frame.empty() && frame[0] == '/') ? frame.substr(1) : frame;
+}
+
+std::string columnLogTfTable(const std::string& parent, const std::string& child)
+{
+  return "tf_static/" + stripSlash(parent) + "/" + stripSlash(child);
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const sensor_msgs::Imu& msg)
+{
+  const double values[] = {
+    msg.orientation.x, msg.orientation.y, msg.orientation.z, msg.orientation.w,
+    msg.angular_velocity.x, msg.angular_velocity.y, msg.angular_velocity.z,
+    msg.linear_acceleration.x, msg.linear_acceleration.y, msg.linear_acceleration.z
+  };
+  beginRow(writer, table, msg.header);
+  addColumns(writer, imu_columns, values);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const geometry_msgs::TwistStamped& msg)
+{
+  const double values[] = {
+    msg.twist.linear.x, msg.twist.linear.y, msg.twist.linear.z,
+    msg.twist.angular.x, msg.twist.angular.y, msg.twist.angular.z
+  };
+  beginRow(writer, table, msg.header);
+  addColumns(writer, twist_columns, values);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const rtklib_msgs::RtklibNav& msg)
+{
+  const double values[] = {
+    static_cast<double>(msg.tow), msg.ecef_pos.x, msg.ecef_pos.y, msg.ecef_pos.z,
+    msg.ecef_vel.x, msg.ecef_vel.y, msg.ecef_vel.z,
+    msg.status.header.stamp.isZero() ? std::numeric_limits<double>::quiet_NaN() :
+      static_cast<double>(static_cast<int64_t>(msg.status.header.stamp.toNSec() - msg.header.stamp.toNSec())),
+    static_cast<double>(msg.status.status.status), static_cast<double>(msg.status.status.service),
+    msg.status.latitude, msg.status.longitude, msg.status.altitude
+  };
+  beginRow(writer, table, msg.header);
+  addColumns(writer, rtklib_nav_columns, values);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const sensor_msgs::NavSatFix& msg)
+{
+  const double values[] = {
+    static_cast<double>(msg.status.status), static_cast<double>(msg.status.service),
+    msg.latitude, msg.longitude, msg.altitude,
+    msg.position_covariance[0], msg.position_covariance[1], msg.position_covariance[2],
+    msg.position_covariance[3], msg.position_covariance[4], msg.position_covariance[5],
+    msg.position_covariance[6], msg.position_covariance[7], msg.position_covariance[8],
+    static_cast<double>(msg.position_covariance_type)
+  };
+  beginRow(writer, table, msg.header);
+  addColumns(writer, navsatfix_columns, values);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const geometry_msgs::TransformStamped& msg)
+{
+  const double values[] = {
+    msg.transform.translation.x, msg.transform.translation.y, msg.transform.translation.z,
+    msg.transform.rotation.x, msg.transform.rotation.y, msg.transform.rotation.z, msg.transform.rotation.w
+  };
+  beginRow(writer, table, msg.header);
+  addColumns(writer, transform_columns, values);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const geometry_msgs::Vector3Stamped& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("x", msg.vector.x);
+  writer->add("y", msg.vector.y);
+  writer->add("z", msg.vector.z);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::VelocityScaleFactor& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("scale_factor", msg.scale_factor);
+  writer->add("correction_velocity_linear_x", msg.correction_velocity.linear.x);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::Distance& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("distance", msg.distance);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::YawrateOffset& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("yawrate_offset", msg.yawrate_offset);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::Heading& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("heading_angle", msg.heading_angle);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::SlipAngle& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("coefficient", msg.coefficient);
+  writer->add("slip_angle", msg.slip_angle);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::Height& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("height", msg.height);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::Pitching& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("pitching_angle", msg.pitching_angle);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::AccXOffset& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("acc_x_offset", msg.acc_x_offset);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::AccXScaleFactor& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("acc_x_scale_factor", msg.acc_x_scale_factor);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+bool addColumnRow(ColumnLogWriter* writer, const std::string& table, const eagleye_msgs::Position& msg)
+{
+  beginRow(writer, table, msg.header);
+  writer->add("enu_pos_x", msg.enu_pos.x);
+  writer->add("enu_pos_y", msg.enu_pos.y);
+  writer->add("enu_pos_z", msg.enu_pos.z);
+  writer->add("ecef_base_pos_x", msg.ecef_base_pos.x);
+  writer->add("ecef_base_pos_y", msg.ecef_base_pos.y);
+  writer->add("ecef_base_pos_z", msg.ecef_base_pos.z);
+  addStatus(writer, msg.status);
+  return true;
+}
+
+template <>
+ColumnReader<sensor_msgs::Imu>::ColumnReader(const ColumnTable& table) : table_(table)
+{
+  bindColumns(table, imu_columns, &columns_);
+}
+
+template <>
+void ColumnReader<sensor_msgs::Imu>::read(std::size_t row, sensor_msgs::Imu* msg) const
+{
+  readHeader(table_, row, &msg->header);
+  msg->orientation.x = columns_[0][row];
+  msg->orientation.y = columns_[1][row];
+  msg->orientation.z = columns_[2][row];
+  msg->orientation.w = columns_[3][row];
+  msg->angular_velocity.x = columns_[4][row];
+  msg->angular_velocity.y = columns_[5][row];
+  msg->angular_velocity.z = columns_[6][row];
+  msg->linear_acceleration.x = columns_[7][row];
+  msg->linear_acceleration.y = columns_[8][row];
+  msg->linear_acceleration.z = columns_[9][row];
+}
+
+template <>
+ColumnReader<geometry_msgs::TwistStamped>::ColumnReader(const ColumnTable& table) : table_(table)
+{
+  bindColumns(table, twist_columns, &columns_);
+}
+
+template <>
+void ColumnReader<geometry_msgs::TwistStamped>::read(std::size_t row, geometry_msgs::TwistStamped* msg) const
+{
+  readHeader(table_, row, &msg->header);
+  msg->twist.linear.x = columns_[0][row];
+  msg->twist.linear.y = columns_[1][row];
+  msg->twist.linear.z = columns_[2][row];
+  msg->twist.angular.x = columns_[3][row];
+  msg->twist.angular.y = columns_[4][row];
+  msg->twist.angular.z = columns_[5][row];
+}
+
+template <>
+ColumnReader<rtklib_msgs::RtklibNav>::ColumnReader(const ColumnTable& table) : table_(table)
+{
+  bindColumns(table, rtklib_nav_columns, &columns_);
+}
+
+template <>
+void ColumnReader<rtklib_msgs::RtklibNav>::read(std::size_t row, rtklib_msgs::RtklibNav* msg) const
+{
+  readHeader(table_, row, &msg->header);
+  msg->tow = static_cast<uint32_t>(columns_[0][row]);
+  msg->ecef_pos.x = columns_[1][row];
+  msg->ecef_pos.y = columns_[2][row];
+  msg->ecef_pos.z = columns_[3][row];
+  msg->ecef_vel.x = columns_[4][row];
+  msg->ecef_vel.y = columns_[5][row];
+  msg->ecef_vel.z = columns_[6][row];
+  msg->status.header.stamp = std::isnan(columns_[7][row]) ? ros::Time() :
+    ros::Time().fromNSec(table_.stamp()[row] + static_cast<int64_t>(columns_[7][row]));
+  msg->status.header.frame_id = table_.frameId();
+  msg->status.status.status = static_cast<int8_t>(columns_[8][row]);
+  msg->status.status.service = static_cast<uint16_t>(columns_[9][row]);
+  msg->status.latitude = columns_[10][row];
+  msg->status.longitude = columns_[11][row];
+  msg->status.altitude = columns_[12][row];
+}
+
+template <>
+ColumnReader<sensor_msgs::NavSatFix>::ColumnReader(const ColumnTable& table) : table_(table)
+{
+  bindColumns(table, navsatfix_columns, &columns_);
+}
+
+template <>
+void ColumnReader<sensor_msgs::NavSatFix>::read(std::size_t row, sensor_msgs::NavSatFix* msg) const
+{
+  readHeader(table_, row, &msg->header);
+  msg->status.status = static_cast<int8_t>(columns_[0][row]);
+  msg->status.service = static_cast<uint16_t>(columns_[1][row]);
+  msg->latitude = columns_[2][row];
+  msg->longitude = columns_[3][row];
+  msg->altitude = columns_[4][row];
+  for (std::size_t i = 0; i < 9; i++)
+  {
+    msg->position_covariance[i] = columns_[5 + i][row];
+  }
+  msg->position_covariance_type = static_cast<uint8_t>(columns_[14][row]);
+}
+
+template <>
+ColumnReader<geometry_msgs::TransformStamped>::ColumnReader(const ColumnTable& table) : table_(table)
+{
+  bindColumns(table, transform_columns, &columns_);
+}
+
+template <>
+void ColumnReader<geometry_msgs::TransformStamped>::read(std::size_t row, geometry_msgs::TransformStamped* msg) const
+{
+  readHeader(table_, row, &msg->header);
+  msg->transform.translation.x = columns_[0][row];
+  msg->transform.translation.y = columns_[1][row];
+  msg->transform.translation.z = columns_[2][row];
+  msg->transform.rotation.x = columns_[3][row];
+  msg->transform.rotation.y = columns_[4][row];
+  msg->transform.rotation.z = columns_[5][row];
+  msg->transform.rotation.w = columns_[6][row];
+}
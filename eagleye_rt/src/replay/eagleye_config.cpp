@@ -0,0 +1,227 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * eagleye_config.cpp
+ * Author MapIV Sekino
+ */
+
+#include "eagleye_rt/replay.hpp"
+
+// Same lookup as ros::NodeHandle::getParam() on the namespace eagleye_config.yaml
+// is loaded into: "a/b" addresses nested maps, and a missing key leaves the
+// value untouched.
+template <class T>
+static bool getParam(const YAML::Node& config, const std::string& key, T& value)
+{
+  if (!config.IsMap())
+  {
+    return false;
+  }
+
+  std::string::size_type pos = key.find('/');
+  const YAML::Node node = config[key.substr(0, pos)];
+  if (!node)
+  {
+    return false;
+  }
+
+  if (pos == std::string::npos)
+  {
+    value = node.as<T>();
+    return true;
+  }
+  return getParam(node, key.substr(pos + 1), value);
+}
+
+void setDefaultReplayParameter(EagleyeEngineParameter* engine_parameter, ReplayParameter* replay_parameter)
+{
+  *engine_parameter = EagleyeEngineParameter();
+  engine_parameter->trajectory_timer_update_rate = 10;
+  engine_parameter->trajectory_th_deadlock_time = 1;
+  engine_parameter->position.tf_gnss_rotation_w = 1;
+  engine_parameter->rtk_deadreckoning.tf_gnss_rotation_w = 1;
+
+  replay_parameter->imu_topic = "/imu/data_raw";
+  replay_parameter->twist_topic = "/can_twist";
+  replay_parameter->rtklib_nav_topic = "/rtklib_nav";
+  replay_parameter->navsatfix_topic = "/navsat/fix";
+  replay_parameter->output_namespace = "/eagleye";
+  replay_parameter->use_tf_static = true;
+  replay_parameter->publish_state = true;
+  replay_parameter->publish_topics = true;
+  replay_parameter->save_checkpoint_file = "";
+  replay_parameter->save_checkpoint_time = 0;
+  replay_parameter->load_checkpoint_file = "";
+  replay_parameter->smooth = false;
+  replay_parameter->start_time = 0;
+  replay_parameter->end_time = 0;
+  replay_parameter->output_start_time = 0;
+}
+
+void loadEagleyeConfig(const YAML::Node& config, EagleyeEngineParameter* p, ReplayParameter* replay_parameter)
+{
+  getParam(config, "imu_topic", replay_parameter->imu_topic);
+  getParam(config, "twist_topic", replay_parameter->twist_topic);
+  getParam(config, "rtklib_nav_topic", replay_parameter->rtklib_nav_topic);
+  getParam(config, "navsatfix_topic", replay_parameter->navsatfix_topic);
+  getParam(config, "eagleye_state/enable", replay_parameter->publish_state);
+  getParam(config, "eagleye_state/publish_topics", replay_parameter->publish_topics);
+
+  // launch arguments of eagleye_rt.launch
+  getParam(config, "use_rtk_heading", p->use_rtk_heading);
+  getParam(config, "use_rtk_deadreckoning", p->use_rtk_deadreckoning);
+
+  if (getParam(config, "reverse_imu", p->reverse_imu))
+  {
+    p->yawrate_offset_stop.reverse_imu = p->reverse_imu;
+    p->angular_velocity_offset_stop.reverse_imu = p->reverse_imu;
+    p->yawrate_offset_1st.reverse_imu = p->reverse_imu;
+    p->yawrate_offset_2nd.reverse_imu = p->reverse_imu;
+    p->heading.reverse_imu = p->reverse_imu;
+    p->rtk_heading.reverse_imu = p->reverse_imu;
+    p->heading_interpolate.reverse_imu = p->reverse_imu;
+    p->slip_angle.reverse_imu = p->reverse_imu;
+    p->trajectory.reverse_imu = p->reverse_imu;
+  }
+
+  getParam(config, "tf_gnss_flame/parent", p->position.tf_gnss_parent_flame);
+  getParam(config, "tf_gnss_flame/child", p->position.tf_gnss_child_flame);
+  getParam(config, "tf_gnss_flame/parent", p->rtk_deadreckoning.tf_gnss_parent_flame);
+  getParam(config, "tf_gnss_flame/child", p->rtk_deadreckoning.tf_gnss_child_flame);
+
+  getParam(config, "ecef_base_pos/x", p->position.ecef_base_pos_x);
+  getParam(config, "ecef_base_pos/y", p->position.ecef_base_pos_y);
+  getParam(config, "ecef_base_pos/z", p->position.ecef_base_pos_z);
+  getParam(config, "ecef_base_pos/x", p->smoothing.ecef_base_pos_x);
+  getParam(config, "ecef_base_pos/y", p->smoothing.ecef_base_pos_y);
+  getParam(config, "ecef_base_pos/z", p->smoothing.ecef_base_pos_z);
+  getParam(config, "ecef_base_pos/x", p->rtk_deadreckoning.ecef_base_pos_x);
+  getParam(config, "ecef_base_pos/y", p->rtk_deadreckoning.ecef_base_pos_y);
+  getParam(config, "ecef_base_pos/z", p->rtk_deadreckoning.ecef_base_pos_z);
+  getParam(config, "ecef_base_pos/use_ecef_base_position", p->rtk_deadreckoning.use_ecef_base_position);
+
+  getParam(config, "velocity_scale_factor/estimated_number_min", p->velocity_scale_factor.estimated_number_min);
+  getParam(config, "velocity_scale_factor/estimated_number_max", p->velocity_scale_factor.estimated_number_max);
+  getParam(config, "velocity_scale_factor/estimated_velocity_threshold", p->velocity_scale_factor.estimated_velocity_threshold);
+  getParam(config, "velocity_scale_factor/estimated_coefficient", p->velocity_scale_factor.estimated_coefficient);
+
+  getParam(config, "yawrate_offset_stop/stop_judgment_velocity_threshold", p->yawrate_offset_stop.stop_judgment_velocity_threshold);
+  getParam(config, "yawrate_offset_stop/estimated_number", p->yawrate_offset_stop.estimated_number);
+  getParam(config, "yawrate_offset_stop/outlier_threshold", p->yawrate_offset_stop.outlier_threshold);
+
+  getParam(config, "angular_velocity_offset_stop/stop_judgment_velocity_threshold", p->angular_velocity_offset_stop.stop_judgment_velocity_threshold);
+  getParam(config, "angular_velocity_offset_stop/estimated_number", p->angular_velocity_offset_stop.estimated_number);
+  getParam(config, "angular_velocity_offset_stop/outlier_threshold", p->angular_velocity_offset_stop.outlier_threshold);
+
+  YawrateOffsetParameter* yawrate_offset[2] = {&p->yawrate_offset_1st, &p->yawrate_offset_2nd};
+  for (int i = 0; i < 2; i++)
+  {
+    getParam(config, "yawrate_offset/estimated_number_min", yawrate_offset[i]->estimated_number_min);
+    getParam(config, "yawrate_offset/estimated_coefficient", yawrate_offset[i]->estimated_coefficient);
+    getParam(config, "yawrate_offset/estimated_velocity_threshold", yawrate_offset[i]->estimated_velocity_threshold);
+    getParam(config, "yawrate_offset/outlier_threshold", yawrate_offset[i]->outlier_threshold);
+  }
+  getParam(config, "yawrate_offset/1st/estimated_number_max", p->yawrate_offset_1st.estimated_number_max);
+  getParam(config, "yawrate_offset/2nd/estimated_number_max", p->yawrate_offset_2nd.estimated_number_max);
+
+  getParam(config, "heading/estimated_number_min", p->heading.estimated_number_min);
+  getParam(config, "heading/estimated_number_max", p->heading.estimated_number_max);
+  getParam(config, "heading/estimated_gnss_coefficient", p->heading.estimated_gnss_coefficient);
+  getParam(config, "heading/estimated_heading_coefficient", p->heading.estimated_heading_coefficient);
+  getParam(config, "heading/outlier_threshold", p->heading.outlier_threshold);
+  getParam(config, "heading/estimated_velocity_threshold", p->heading.estimated_velocity_threshold);
+  getParam(config, "heading/stop_judgment_velocity_threshold", p->heading.stop_judgment_velocity_threshold);
+  getParam(config, "heading/estimated_yawrate_threshold", p->heading.estimated_yawrate_threshold);
+
+  getParam(config, "rtk_heading/estimated_distance", p->rtk_heading.estimated_distance);
+  getParam(config, "rtk_heading/estimated_heading_buffer_min", p->rtk_heading.estimated_heading_buffer_min);
+  getParam(config, "rtk_heading/estimated_number_min", p->rtk_heading.estimated_number_min);
+  getParam(config, "rtk_heading/estimated_number_max", p->rtk_heading.estimated_number_max);
+  getParam(config, "rtk_heading/estimated_gnss_coefficient", p->rtk_heading.estimated_gnss_coefficient);
+  getParam(config, "rtk_heading/estimated_heading_coefficient", p->rtk_heading.estimated_heading_coefficient);
+  getParam(config, "rtk_heading/outlier_threshold", p->rtk_heading.outlier_threshold);
+  getParam(config, "rtk_heading/estimated_velocity_threshold", p->rtk_heading.estimated_velocity_threshold);
+  getParam(config, "rtk_heading/stop_judgment_velocity_threshold", p->rtk_heading.stop_judgment_velocity_threshold);
+  getParam(config, "rtk_heading/estimated_yawrate_threshold", p->rtk_heading.estimated_yawrate_threshold);
+
+  getParam(config, "heading_interpolate/stop_judgment_velocity_threshold", p->heading_interpolate.stop_judgment_velocity_threshold);
+  getParam(config, "heading_interpolate/number_buffer_max", p->heading_interpolate.number_buffer_max);
+
+  getParam(config, "slip_angle/manual_coefficient", p->slip_angle.manual_coefficient);
+  getParam(config, "slip_angle/stop_judgment_velocity_threshold", p->slip_angle.stop_judgment_velocity_threshold);
+
+  getParam(config, "trajectory/stop_judgment_velocity_threshold", p->trajectory.stop_judgment_velocity_threshold);
+  getParam(config, "trajectory/stop_judgment_yawrate_threshold", p->trajectory.stop_judgment_yawrate_threshold);
+  getParam(config, "trajectory/timer_updata_rate", p->trajectory_timer_update_rate);
+  getParam(config, "trajectory/th_deadlock_time", p->trajectory_th_deadlock_time);
+
+  getParam(config, "position/estimated_distance", p->position.estimated_distance);
+  getParam(config, "position/separation_distance", p->position.separation_distance);
+  getParam(config, "position/estimated_velocity_threshold", p->position.estimated_velocity_threshold);
+  getParam(config, "position/outlier_threshold", p->position.outlier_threshold);
+  getParam(config, "position/estimated_enu_vel_coefficient", p->position.estimated_enu_vel_coefficient);
+  getParam(config, "position/estimated_position_coefficient", p->position.estimated_position_coefficient);
+
+  getParam(config, "position_interpolate/number_buffer_max", p->position_interpolate.number_buffer_max);
+  getParam(config, "position_interpolate/stop_judgment_velocity_threshold", p->position_interpolate.stop_judgment_velocity_threshold);
+
+  getParam(config, "rtk_deadreckoning/stop_judgment_velocity_threshold", p->rtk_deadreckoning.stop_judgment_velocity_threshold);
+
+  getParam(config, "smoothing/estimated_number_max", p->smoothing.estimated_number_max);
+  getParam(config, "smoothing/estimated_velocity_threshold", p->smoothing.estimated_velocity_threshold);
+  getParam(config, "smoothing/estimated_threshold", p->smoothing.estimated_threshold);
+
+  getParam(config, "height/estimated_distance", p->height.estimated_distance);
+  getParam(config, "height/estimated_distance_max", p->height.estimated_distance_max);
+  getParam(config, "height/separation_distance", p->height.separation_distance);
+  getParam(config, "height/estimated_velocity_threshold", p->height.estimated_velocity_threshold);
+  getParam(config, "height/estimated_velocity_coefficient", p->height.estimated_velocity_coefficient);
+  getParam(config, "height/estimated_height_coefficient", p->height.estimated_height_coefficient);
+  getParam(config, "height/outlier_threshold", p->height.outlier_threshold);
+  getParam(config, "height/average_num", p->height.average_num);
+
+  getParam(config, "ekf/enable", p->use_ekf);
+  getParam(config, "ekf/stop_judgment_velocity_threshold", p->ekf.stop_judgment_velocity_threshold);
+  getParam(config, "ekf/estimated_velocity_threshold", p->ekf.estimated_velocity_threshold);
+  getParam(config, "ekf/yawrate_noise", p->ekf.yawrate_noise);
+  getParam(config, "ekf/yawrate_offset_noise", p->ekf.yawrate_offset_noise);
+  getParam(config, "ekf/velocity_scale_factor_noise", p->ekf.velocity_scale_factor_noise);
+  getParam(config, "ekf/pitch_noise", p->ekf.pitch_noise);
+  getParam(config, "ekf/acc_x_offset_noise", p->ekf.acc_x_offset_noise);
+  getParam(config, "ekf/position_noise", p->ekf.position_noise);
+  getParam(config, "ekf/acc_noise", p->ekf.acc_noise);
+  getParam(config, "ekf/gnss_position_noise", p->ekf.gnss_position_noise);
+  getParam(config, "ekf/gnss_height_noise", p->ekf.gnss_height_noise);
+  getParam(config, "ekf/gnss_velocity_noise", p->ekf.gnss_velocity_noise);
+  getParam(config, "ekf/outlier_threshold", p->ekf.outlier_threshold);
+  getParam(config, "ekf/yawrate_offset_std_threshold", p->ekf.yawrate_offset_std_threshold);
+  getParam(config, "ekf/velocity_scale_factor_std_threshold", p->ekf.velocity_scale_factor_std_threshold);
+}
+
+void loadEagleyeConfig(const std::string& file, EagleyeEngineParameter* engine_parameter, ReplayParameter* replay_parameter)
+{
+  loadEagleyeConfig(YAML::LoadFile(file), engine_parameter, replay_parameter);
+}
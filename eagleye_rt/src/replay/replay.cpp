@@ -0,0 +1,630 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * replay.cpp
+ * Author MapIV Sekino
+ */
+
+#include "eagleye_rt/replay.hpp"
+#include "navigation/checkpoint.hpp"
+#include "navigation/ekf_smoother.hpp"
+#include "eagleye_rt/column_log_messages.hpp"
+#include "coordinate/coordinate.hpp"
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <tf2_msgs/TFMessage.h>
+#include <iomanip>
+#include <algorithm>
+#include <memory>
+
+// The input log of a replay, a rosbag or a column log. begin and end limit
+// the bag views by record time, which only roughly follows header stamps.
+struct ReplaySource
+{
+  rosbag::Bag bag;
+  std::unique_ptr<ColumnLog> log;
+  ros::Time begin;
+  ros::Time end;
+};
+
+// Messages of one topic in recorded order, instantiated one at a time. From a
+// column log the rows of the table are read in place, starting at the first
+// one stamped at or after begin.
+template <class T>
+class ReplayInput
+{
+public:
+  ReplayInput(const ReplaySource& source, const std::string& topic, const std::string& table)
+    : table_(NULL), row_(0), count_(0)
+  {
+    if (source.log)
+    {
+      table_ = source.log->table(table);
+    }
+    if (table_ != NULL)
+    {
+      reader_.reset(new ColumnReader<T>(*table_));
+      row_ = table_->lowerBound(source.begin.toNSec());
+      log_msg_.reset(new T());
+    }
+    else if (!source.log)
+    {
+      view_.addQuery(source.bag, rosbag::TopicQuery(topic), source.begin, source.end);
+    }
+    it_ = view_.begin();
+    next();
+  }
+
+  bool empty() const { return !msg_; }
+  const ros::Time& stamp() const { return msg_->header.stamp; }
+  const T& get() const { return *msg_; }
+  unsigned long count() const { return count_; }
+
+  void next()
+  {
+    msg_.reset();
+    if (table_ != NULL)
+    {
+      if (row_ < table_->size())
+      {
+        reader_->read(row_++, log_msg_.get());
+        msg_ = log_msg_;
+        count_++;
+      }
+      return;
+    }
+    while (it_ != view_.end() && !msg_)
+    {
+      msg_ = it_->instantiate<T>();
+      ++it_;
+    }
+    if (msg_)
+    {
+      count_++;
+    }
+  }
+
+private:
+  rosbag::View view_;
+  rosbag::View::iterator it_;
+  const ColumnTable* table_;
+  std::unique_ptr<ColumnReader<T> > reader_;
+  std::size_t row_;
+  boost::shared_ptr<T> log_msg_;
+  boost::shared_ptr<T> msg_;
+  unsigned long count_;
+};
+
+class ReplayOutput
+{
+public:
+  ReplayOutput(const std::string& file, const ReplayParameter& parameter)
+    : namespace_(parameter.output_namespace), publish_state_(parameter.publish_state),
+      publish_topics_(parameter.publish_topics), fix_trajectory_(NULL), count_(0)
+  {
+    if (parameter.output_start_time > 0)
+    {
+      write_start_.fromSec(parameter.output_start_time);
+    }
+    if (isColumnLogFile(file))
+    {
+      column_file_ = file;
+    }
+    else if (!file.empty())
+    {
+      bag_.open(file, rosbag::bagmode::Write);
+    }
+  }
+
+  // A column log only takes the message types of addColumnRow(), its tables
+  // are named by topic without output_namespace.
+  template <class T>
+  void write(const std::string& topic, bool updated, const T& msg, const ros::Time& time)
+  {
+    if (!updated || time < write_start_)
+    {
+      return;
+    }
+    if (!column_file_.empty())
+    {
+      count_ += addColumnRow(&column_log_, topic, msg) ? 1 : 0;
+      return;
+    }
+    count_++;
+    if (bag_.isOpen())
+    {
+      bag_.write(namespace_ + "/" + topic, time, msg);
+    }
+  }
+
+  void close()
+  {
+    if (!column_file_.empty())
+    {
+      column_log_.save(column_file_);
+    }
+    bag_.close();
+  }
+
+  void setFixTrajectory(Trajectory* trajectory) { fix_trajectory_ = trajectory; }
+
+  void write(const EagleyeEngineOutput& o, const ros::Time& stamp)
+  {
+    ros::Time time = stamp.isZero() ? ros::TIME_MIN : stamp;
+
+    if (fix_trajectory_ != NULL && o.fix_updated && !(time < write_start_))
+    {
+      fix_trajectory_->stamp.push_back(o.fix.header.stamp.toNSec());
+      fix_trajectory_->latitude.push_back(o.fix.latitude);
+      fix_trajectory_->longitude.push_back(o.fix.longitude);
+      fix_trajectory_->altitude.push_back(o.fix.altitude);
+    }
+
+    if (publish_state_)
+    {
+      state_.add(o);
+    }
+    write("imu/data_corrected", o.imu_corrected_updated, o.imu_corrected, time);
+    if (!publish_topics_)
+    {
+      return;
+    }
+    write("velocity_scale_factor", o.velocity_scale_factor_updated, o.velocity_scale_factor, time);
+    write("distance", o.distance_updated, o.distance, time);
+    write("yawrate_offset_stop", o.yawrate_offset_stop_updated, o.yawrate_offset_stop, time);
+    write("yawrate_offset_1st", o.yawrate_offset_1st_updated, o.yawrate_offset_1st, time);
+    write("yawrate_offset_2nd", o.yawrate_offset_2nd_updated, o.yawrate_offset_2nd, time);
+    write("heading_1st", o.heading_1st_updated, o.heading_1st, time);
+    write("heading_2nd", o.heading_2nd_updated, o.heading_2nd, time);
+    write("heading_3rd", o.heading_3rd_updated, o.heading_3rd, time);
+    write("heading_interpolate_1st", o.heading_interpolate_1st_updated, o.heading_interpolate_1st, time);
+    write("heading_interpolate_2nd", o.heading_interpolate_2nd_updated, o.heading_interpolate_2nd, time);
+    write("heading_interpolate_3rd", o.heading_interpolate_3rd_updated, o.heading_interpolate_3rd, time);
+    write("slip_angle", o.slip_angle_updated, o.slip_angle, time);
+    write("height", o.height_updated, o.height, time);
+    write("pitching", o.pitching_updated, o.pitching, time);
+    write("acc_x_offset", o.acc_x_offset_updated, o.acc_x_offset, time);
+    write("acc_x_scale_factor", o.acc_x_scale_factor_updated, o.acc_x_scale_factor, time);
+    write("navsat/reliability_fix", o.reliability_fix_updated, o.reliability_fix, time);
+    write("enu_vel", o.enu_vel_updated, o.enu_vel, time);
+    write("enu_relative_pos", o.enu_relative_pos_updated, o.enu_relative_pos, time);
+    write("twist", o.twist_updated, o.twist, time);
+    write("enu_absolute_pos", o.enu_absolute_pos_updated, o.enu_absolute_pos, time);
+    write("enu_absolute_pos_interpolate", o.enu_absolute_pos_interpolate_updated, o.enu_absolute_pos_interpolate, time);
+    write("fix", o.fix_updated, o.fix, time);
+    write("gnss_smooth_pos_enu", o.gnss_smooth_pos_enu_updated, o.gnss_smooth_pos_enu, time);
+    write("angular_velocity_offset_stop", o.angular_velocity_offset_stop_updated, o.angular_velocity_offset_stop, time);
+    write("enu_absolute_rtk_deadreckoning", o.enu_absolute_rtk_deadreckoning_updated, o.enu_absolute_rtk_deadreckoning, time);
+    write("rtk_fix", o.rtk_fix_updated, o.rtk_fix, time);
+  }
+
+  // Once per IMU message, after its output was written.
+  void writeState(const ros::Time& stamp)
+  {
+    if (publish_state_)
+    {
+      write("eagleye_state", true, state_.get(stamp), stamp.isZero() ? ros::TIME_MIN : stamp);
+    }
+  }
+
+  // After the forward run, once per IMU message in the same order.
+  void writeSmoothed(const EkfSmoothedState& s)
+  {
+    ros::Time stamp;
+    stamp.fromNSec(s.stamp);
+    ros::Time time = stamp.isZero() ? ros::TIME_MIN : stamp;
+    std_msgs::Header header;
+    header.stamp = stamp;
+    header.frame_id = "base_link";
+    bool fix_status = s.position_status && s.heading_status;
+
+    double enu_pos[3], ecef_base_pos[3], llh_pos[3];
+    std::copy(s.state + EKF_E, s.state + EKF_U + 1, enu_pos);
+    std::copy(s.ecef_base_pos, s.ecef_base_pos + 3, ecef_base_pos);
+    llh_pos[0] = llh_pos[1] = llh_pos[2] = 0;
+    if (s.height_status || s.position_status)
+    {
+      enu2llh(enu_pos, ecef_base_pos, llh_pos);
+    }
+
+    eagleye_msgs::Heading heading;
+    heading.header = header;
+    heading.heading_angle = s.heading_status ? s.state[EKF_HEADING] + s.slip_angle : 0;
+    heading.status.enabled_status = s.heading_status;
+    write("smoothed/heading_interpolate", true, heading, time);
+
+    eagleye_msgs::Pitching pitching;
+    pitching.header = header;
+    pitching.pitching_angle = s.state[EKF_PITCH];
+    pitching.status.enabled_status = s.heading_status;
+    write("smoothed/pitching", true, pitching, time);
+
+    eagleye_msgs::Height height;
+    height.header = header;
+    height.height = s.height_status ? llh_pos[2] : 0;
+    height.status.enabled_status = s.height_status;
+    write("smoothed/height", true, height, time);
+
+    eagleye_msgs::Position position;
+    position.header = header;
+    position.ecef_base_pos.x = s.ecef_base_pos[0];
+    position.ecef_base_pos.y = s.ecef_base_pos[1];
+    position.ecef_base_pos.z = s.ecef_base_pos[2];
+    position.enu_pos.x = fix_status ? enu_pos[0] : 0;
+    position.enu_pos.y = fix_status ? enu_pos[1] : 0;
+    position.enu_pos.z = fix_status ? enu_pos[2] : 0;
+    position.status.enabled_status = fix_status;
+    write("smoothed/enu_absolute_pos_interpolate", true, position, time);
+
+    // The smoothed variances in east, north and up.
+    sensor_msgs::NavSatFix fix;
+    fix.header = header;
+    fix.header.frame_id = "gnss";
+    fix.latitude = llh_pos[0] * 180 / M_PI;
+    fix.longitude = llh_pos[1] * 180 / M_PI;
+    fix.altitude = llh_pos[2];
+    fix.position_covariance[0] = s.variance[EKF_E];
+    fix.position_covariance[4] = s.variance[EKF_N];
+    fix.position_covariance[8] = s.variance[EKF_U];
+    fix.position_covariance_type = sensor_msgs::NavSatFix::COVARIANCE_TYPE_DIAGONAL_KNOWN;
+    write("smoothed/fix", fix_status, fix, time);
+  }
+
+  unsigned long count() const { return count_; }
+
+private:
+  rosbag::Bag bag_;
+  std::string column_file_;
+  ColumnLogWriter column_log_;
+  std::string namespace_;
+  bool publish_state_;
+  bool publish_topics_;
+  ros::Time write_start_;
+  Trajectory* fix_trajectory_;
+  EagleyeStateBuilder state_;
+  unsigned long count_;
+};
+
+static std::string stripSlash(const std::string& frame)
+{
+  return (!frame.empty() && frame[0] == '/') ? frame.substr(1) : frame;
+}
+
+static void setGnssTf(const geometry_msgs::TransformStamped& t, EagleyeEngineParameter* p)
+{
+  p->position.tf_gnss_translation_x = t.transform.translation.x;
+  p->position.tf_gnss_translation_y = t.transform.translation.y;
+  p->position.tf_gnss_translation_z = t.transform.translation.z;
+  p->position.tf_gnss_rotation_x = t.transform.rotation.x;
+  p->position.tf_gnss_rotation_y = t.transform.rotation.y;
+  p->position.tf_gnss_rotation_z = t.transform.rotation.z;
+  p->position.tf_gnss_rotation_w = t.transform.rotation.w;
+  p->rtk_deadreckoning.tf_gnss_translation_x = t.transform.translation.x;
+  p->rtk_deadreckoning.tf_gnss_translation_y = t.transform.translation.y;
+  p->rtk_deadreckoning.tf_gnss_translation_z = t.transform.translation.z;
+  p->rtk_deadreckoning.tf_gnss_rotation_x = t.transform.rotation.x;
+  p->rtk_deadreckoning.tf_gnss_rotation_y = t.transform.rotation.y;
+  p->rtk_deadreckoning.tf_gnss_rotation_z = t.transform.rotation.z;
+  p->rtk_deadreckoning.tf_gnss_rotation_w = t.transform.rotation.w;
+}
+
+// The online nodes look up the GNSS antenna offset from tf. Offline only a
+// direct parent->child entry of /tf_static is used.
+static void setTfStatic(const ReplaySource& source, EagleyeEngineParameter* p)
+{
+  if (source.log)
+  {
+    const ColumnTable* table =
+      source.log->table(columnLogTfTable(p->position.tf_gnss_parent_flame, p->position.tf_gnss_child_flame));
+    if (table != NULL && table->size() > 0)
+    {
+      geometry_msgs::TransformStamped t;
+      ColumnReader<geometry_msgs::TransformStamped>(*table).read(0, &t);
+      setGnssTf(t, p);
+    }
+    return;
+  }
+
+  const rosbag::Bag& bag = source.bag;
+  rosbag::View view(bag, rosbag::TopicQuery("/tf_static"));
+  for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+  {
+    tf2_msgs::TFMessage::ConstPtr tf = it->instantiate<tf2_msgs::TFMessage>();
+    if (!tf)
+    {
+      continue;
+    }
+    for (std::size_t i = 0; i < tf->transforms.size(); i++)
+    {
+      const geometry_msgs::TransformStamped& t = tf->transforms[i];
+      if (stripSlash(t.header.frame_id) != stripSlash(p->position.tf_gnss_parent_flame) ||
+          stripSlash(t.child_frame_id) != stripSlash(p->position.tf_gnss_child_flame))
+      {
+        continue;
+      }
+      setGnssTf(t, p);
+      return;
+    }
+  }
+}
+
+static ReplayBoundaryState boundaryState(const EagleyeEngineOutput& o, const ros::Time& stamp)
+{
+  ReplayBoundaryState state;
+  state.stamp = stamp.toSec();
+  state.fix_status = o.enu_absolute_pos_interpolate.status.enabled_status;
+  state.latitude = o.fix.latitude;
+  state.longitude = o.fix.longitude;
+  state.altitude = o.fix.altitude;
+  state.heading_status = o.heading_interpolate_3rd.status.enabled_status;
+  state.heading = o.heading_interpolate_3rd.heading_angle;
+  state.velocity_scale_factor_status = o.velocity_scale_factor.status.enabled_status;
+  state.velocity_scale_factor = o.velocity_scale_factor.scale_factor;
+  state.yawrate_offset = o.yawrate_offset_2nd.yawrate_offset;
+  return state;
+}
+
+void replayBag(const std::string& input_file, const std::string& output_file, const EagleyeEngineParameter& engine_parameter,
+  const ReplayParameter& replay_parameter, ReplaySummary* summary, Trajectory* fix_trajectory)
+{
+  ros::WallTime processing_start = ros::WallTime::now();
+
+  ReplaySource source;
+  if (isColumnLogFile(input_file))
+  {
+    source.log.reset(new ColumnLog(input_file));
+  }
+  else
+  {
+    source.bag.open(input_file, rosbag::bagmode::Read);
+  }
+
+  EagleyeEngineParameter parameter = engine_parameter;
+  parameter.use_ekf = parameter.use_ekf || replay_parameter.smooth;
+  if (replay_parameter.use_tf_static)
+  {
+    setTfStatic(source, &parameter);
+  }
+
+  EagleyeEngine engine(parameter);
+  ReplayOutput output(output_file, replay_parameter);
+  output.setFixTrajectory(fix_trajectory);
+
+  // Header stamps may trail the record time by the sensor latency. A column
+  // log is indexed by header stamp and needs no margin.
+  const double view_margin = source.log ? 0 : 60;
+  ros::Time start_limit, end_limit;
+  source.begin = ros::TIME_MIN;
+  source.end = ros::TIME_MAX;
+  if (replay_parameter.start_time > 0)
+  {
+    start_limit.fromSec(replay_parameter.start_time);
+    source.begin.fromSec(std::max(replay_parameter.start_time - view_margin, ros::TIME_MIN.toSec()));
+  }
+  if (replay_parameter.end_time > 0)
+  {
+    end_limit.fromSec(replay_parameter.end_time);
+    source.end.fromSec(replay_parameter.end_time + view_margin);
+  }
+  ros::Time output_start;
+  if (replay_parameter.output_start_time > 0)
+  {
+    output_start.fromSec(replay_parameter.output_start_time);
+  }
+
+  ReplayInput<rtklib_msgs::RtklibNav> rtklib_nav(source, replay_parameter.rtklib_nav_topic, COLUMN_LOG_RTKLIB_NAV_TABLE);
+  ReplayInput<sensor_msgs::NavSatFix> navsatfix(source, replay_parameter.navsatfix_topic, COLUMN_LOG_NAVSATFIX_TABLE);
+  ReplayInput<geometry_msgs::TwistStamped> twist(source, replay_parameter.twist_topic, COLUMN_LOG_TWIST_TABLE);
+  ReplayInput<sensor_msgs::Imu> imu(source, replay_parameter.imu_topic, COLUMN_LOG_IMU_TABLE);
+
+  *summary = ReplaySummary();
+  ros::Time start_time, end_time;
+
+  ros::Time checkpoint_stamp;
+  if (!replay_parameter.load_checkpoint_file.empty())
+  {
+    CheckpointReader reader(replay_parameter.load_checkpoint_file);
+    int64_t nsec;
+    reader.section("replay");
+    reader.field(nsec);
+    engine.loadCheckpoint(&reader);
+    checkpoint_stamp.fromNSec(nsec);
+  }
+  bool save_checkpoint = !replay_parameter.save_checkpoint_file.empty();
+  EkfSmoother smoother;
+
+  // Always take the input with the oldest header stamp. On equal stamps GNSS
+  // comes before twist and twist before IMU, so the IMU step that triggers the
+  // estimation sees every input of the same instant.
+  while (true)
+  {
+    ros::Time stamp;
+    int next = -1;
+    if (!rtklib_nav.empty())
+    {
+      next = 0;
+      stamp = rtklib_nav.stamp();
+    }
+    if (!navsatfix.empty() && (next < 0 || navsatfix.stamp() < stamp))
+    {
+      next = 1;
+      stamp = navsatfix.stamp();
+    }
+    if (!twist.empty() && (next < 0 || twist.stamp() < stamp))
+    {
+      next = 2;
+      stamp = twist.stamp();
+    }
+    if (!imu.empty() && (next < 0 || imu.stamp() < stamp))
+    {
+      next = 3;
+      stamp = imu.stamp();
+    }
+    if (next < 0 || (!end_limit.isZero() && stamp >= end_limit))
+    {
+      break;
+    }
+
+    // Already processed before the loaded checkpoint was written, or before
+    // the requested range.
+    if (stamp <= checkpoint_stamp || stamp < start_limit)
+    {
+      if (next == 0)
+      {
+        rtklib_nav.next();
+      }
+      else if (next == 1)
+      {
+        navsatfix.next();
+      }
+      else if (next == 2)
+      {
+        twist.next();
+      }
+      else
+      {
+        imu.next();
+      }
+      continue;
+    }
+
+    if (start_time.isZero())
+    {
+      start_time = stamp;
+    }
+    end_time = stamp;
+
+    if (next == 0)
+    {
+      output.write(engine.addRtklibNav(rtklib_nav.get()), stamp);
+      rtklib_nav.next();
+    }
+    else if (next == 1)
+    {
+      output.write(engine.addNavSatFix(navsatfix.get()), stamp);
+      navsatfix.next();
+    }
+    else if (next == 2)
+    {
+      output.write(engine.addTwist(twist.get()), stamp);
+      twist.next();
+    }
+    else
+    {
+      const EagleyeEngineOutput& o = engine.addImu(imu.get());
+      output.write(o, stamp);
+      output.writeState(stamp);
+      imu.next();
+
+      summary->end = boundaryState(o, stamp);
+      if (stamp < output_start)
+      {
+        summary->warm_up_end = summary->end;
+      }
+
+      if (replay_parameter.smooth)
+      {
+        const EkfEstimator& ekf = engine.getEkfEstimator();
+        smoother.add(stamp.toNSec(), ekf.getStatus(), ekf.getTransition(), ekf.getSlipAngle().slip_angle);
+      }
+
+      if (save_checkpoint && stamp.toSec() >= replay_parameter.save_checkpoint_time)
+      {
+        CheckpointWriter writer;
+        writer.section("replay");
+        writer.field(static_cast<int64_t>(stamp.toNSec()));
+        engine.saveCheckpoint(&writer);
+        writer.save(replay_parameter.save_checkpoint_file);
+        save_checkpoint = false;
+      }
+    }
+  }
+
+  source.bag.close();
+
+  if (replay_parameter.smooth)
+  {
+    smoother.smooth();
+    EkfSmoothedState smoothed;
+    while (smoother.next(&smoothed))
+    {
+      output.writeSmoothed(smoothed);
+    }
+  }
+  output.close();
+
+  summary->imu_count = imu.count();
+  summary->twist_count = twist.count();
+  summary->rtklib_nav_count = rtklib_nav.count();
+  summary->navsatfix_count = navsatfix.count();
+  summary->output_count = output.count();
+  summary->start_time = start_time.toSec();
+  summary->end_time = end_time.toSec();
+  summary->processing_time = (ros::WallTime::now() - processing_start).toSec();
+}
+
+void replayTimeRange(const std::string& file, const ReplayParameter& replay_parameter, double* begin, double* end)
+{
+  *begin = *end = 0;
+  if (isColumnLogFile(file))
+  {
+    ColumnLog log(file);
+    const ColumnTable* table = log.table(COLUMN_LOG_IMU_TABLE);
+    if (table != NULL && table->size() > 0)
+    {
+      *begin = table->stamp()[0] * 1e-9;
+      *end = table->stamp()[table->size() - 1] * 1e-9;
+    }
+    return;
+  }
+
+  rosbag::Bag bag;
+  bag.open(file, rosbag::bagmode::Read);
+  rosbag::View view(bag, rosbag::TopicQuery(replay_parameter.imu_topic));
+  if (view.size() > 0)
+  {
+    *begin = view.getBeginTime().toSec();
+    *end = view.getEndTime().toSec();
+  }
+  bag.close();
+}
+
+void printReplaySummary(std::ostream& os, const std::string& name, const ReplaySummary& summary)
+{
+  double log_duration = summary.end_time - summary.start_time;
+
+  os << std::fixed << std::setprecision(3);
+  os << "input " << name << std::endl;
+  os << "  imu " << summary.imu_count << " twist " << summary.twist_count
+     << " rtklib_nav " << summary.rtklib_nav_count << " navsat/fix " << summary.navsatfix_count << std::endl;
+  os << "  output messages " << summary.output_count << std::endl;
+  os << "  log duration " << log_duration << " [s]" << std::endl;
+  os << "  processing time " << summary.processing_time << " [s]" << std::endl;
+  if (summary.processing_time > 0)
+  {
+    os << "  real-time factor " << log_duration / summary.processing_time << std::endl;
+  }
+}
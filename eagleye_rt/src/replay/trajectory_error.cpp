@@ -0,0 +1,513 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * trajectory_error.cpp
+ * Author MapIV Sekino
+ */
+
+#include "eagleye_rt/trajectory_error.hpp"
+#include "eagleye_rt/column_log.hpp"
+#include "coordinate/coordinate.hpp"
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <sensor_msgs/NavSatFix.h>
+#include <eagleye_msgs/Heading.h>
+#include <eagleye_msgs/Position.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// |error| below the first bin are counted in bin 0, above the last in the
+// last bin.
+static const double ERROR_HISTOGRAM_MIN = 1e-4;
+static const double ERROR_HISTOGRAM_MAX = 1e4;
+static const double ERROR_HISTOGRAM_RATIO = 1.01;
+
+static std::size_t histogramSize()
+{
+  return static_cast<std::size_t>(std::ceil(std::log(ERROR_HISTOGRAM_MAX / ERROR_HISTOGRAM_MIN) /
+                                            std::log(ERROR_HISTOGRAM_RATIO))) + 2;
+}
+
+ErrorStatistics::ErrorStatistics() : count_(0), sum_(0), square_sum_(0), max_(0), histogram_(histogramSize(), 0)
+{
+}
+
+void ErrorStatistics::add(double error)
+{
+  double abs_error = std::abs(error);
+  std::size_t bin = 0;
+  if (abs_error >= ERROR_HISTOGRAM_MIN)
+  {
+    bin = 1 + static_cast<std::size_t>(std::min(std::log(abs_error / ERROR_HISTOGRAM_MIN) / std::log(ERROR_HISTOGRAM_RATIO),
+                                                static_cast<double>(histogram_.size())));
+    bin = std::min(bin, histogram_.size() - 1);
+  }
+  histogram_[bin]++;
+  count_++;
+  sum_ += error;
+  square_sum_ += error * error;
+  max_ = std::max(max_, abs_error);
+}
+
+void ErrorStatistics::merge(const ErrorStatistics& other)
+{
+  for (std::size_t i = 0; i < histogram_.size(); i++)
+  {
+    histogram_[i] += other.histogram_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  square_sum_ += other.square_sum_;
+  max_ = std::max(max_, other.max_);
+}
+
+double ErrorStatistics::mean() const
+{
+  return count_ == 0 ? 0 : sum_ / count_;
+}
+
+double ErrorStatistics::rms() const
+{
+  return count_ == 0 ? 0 : std::sqrt(square_sum_ / count_);
+}
+
+double ErrorStatistics::percentile(double ratio) const
+{
+  if (count_ == 0)
+  {
+    return 0;
+  }
+  uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(ratio * count_)));
+  uint64_t sum = 0;
+  std::size_t bin = 0;
+  for (; bin + 1 < histogram_.size(); bin++)
+  {
+    sum += histogram_[bin];
+    if (sum >= rank)
+    {
+      break;
+    }
+  }
+  return std::min(max_, ERROR_HISTOGRAM_MIN * std::pow(ERROR_HISTOGRAM_RATIO, static_cast<double>(bin)));
+}
+
+void TrajectoryEvaluation::merge(const TrajectoryEvaluation& other)
+{
+  reference_count += other.reference_count;
+  available_count += other.available_count;
+  horizontal.merge(other.horizontal);
+  along_track.merge(other.along_track);
+  cross_track.merge(other.cross_track);
+  height.merge(other.height);
+  heading.merge(other.heading);
+}
+
+static void addPosition(const eagleye_msgs::Position& msg, Trajectory* trajectory)
+{
+  double enu_pos[3] = {msg.enu_pos.x, msg.enu_pos.y, msg.enu_pos.z};
+  double ecef_base_pos[3] = {msg.ecef_base_pos.x, msg.ecef_base_pos.y, msg.ecef_base_pos.z};
+  double llh_pos[3];
+  enu2llh(enu_pos, ecef_base_pos, llh_pos);
+  trajectory->stamp.push_back(msg.header.stamp.toNSec());
+  trajectory->latitude.push_back(llh_pos[0] * 180 / M_PI);
+  trajectory->longitude.push_back(llh_pos[1] * 180 / M_PI);
+  trajectory->altitude.push_back(llh_pos[2]);
+}
+
+// Bag messages are in record order, which may differ from header stamp order.
+template <class T>
+static void sortByStamp(std::vector<int64_t>* stamp, std::vector<T>* values)
+{
+  if (std::is_sorted(stamp->begin(), stamp->end()))
+  {
+    return;
+  }
+  std::vector<std::size_t> order(stamp->size());
+  for (std::size_t i = 0; i < order.size(); i++)
+  {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [stamp](std::size_t a, std::size_t b) { return (*stamp)[a] < (*stamp)[b]; });
+  std::vector<int64_t> sorted_stamp(order.size());
+  for (std::size_t i = 0; i < order.size(); i++)
+  {
+    sorted_stamp[i] = (*stamp)[order[i]];
+  }
+  stamp->swap(sorted_stamp);
+  for (std::size_t k = 0; k < values->size(); k++)
+  {
+    T sorted_values((*values)[k].size());
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+      sorted_values[i] = (*values)[k][order[i]];
+    }
+    (*values)[k].swap(sorted_values);
+  }
+}
+
+static const ColumnTable& findTable(const ColumnLog& log, const std::string& file, const std::string& table_name)
+{
+  const ColumnTable* table = log.table(table_name);
+  if (table == NULL)
+  {
+    throw std::runtime_error(file + " has no table " + table_name);
+  }
+  return *table;
+}
+
+void loadTrajectory(const std::string& file, const std::string& table_name, Trajectory* trajectory)
+{
+  *trajectory = Trajectory();
+  if (isColumnLogFile(file))
+  {
+    ColumnLog log(file);
+    const ColumnTable& table = findTable(log, file, table_name);
+    if (table.hasColumn("enu_pos_x"))
+    {
+      const char* names[] = {"enu_pos_x", "enu_pos_y", "enu_pos_z", "ecef_base_pos_x", "ecef_base_pos_y", "ecef_base_pos_z"};
+      const double* columns[6];
+      for (int k = 0; k < 6; k++)
+      {
+        columns[k] = table.column(names[k]);
+      }
+      const double* enabled_status = table.column("enabled_status");
+      for (std::size_t i = 0; i < table.size(); i++)
+      {
+        if (enabled_status[i] == 0)
+        {
+          continue;
+        }
+        eagleye_msgs::Position msg;
+        msg.header.stamp.fromNSec(table.stamp()[i]);
+        msg.enu_pos.x = columns[0][i];
+        msg.enu_pos.y = columns[1][i];
+        msg.enu_pos.z = columns[2][i];
+        msg.ecef_base_pos.x = columns[3][i];
+        msg.ecef_base_pos.y = columns[4][i];
+        msg.ecef_base_pos.z = columns[5][i];
+        addPosition(msg, trajectory);
+      }
+      return;
+    }
+    const double* latitude = table.column("latitude");
+    const double* longitude = table.column("longitude");
+    const double* altitude = table.column("altitude");
+    trajectory->stamp.assign(table.stamp(), table.stamp() + table.size());
+    trajectory->latitude.assign(latitude, latitude + table.size());
+    trajectory->longitude.assign(longitude, longitude + table.size());
+    trajectory->altitude.assign(altitude, altitude + table.size());
+    return;
+  }
+
+  rosbag::Bag bag;
+  bag.open(file, rosbag::bagmode::Read);
+  rosbag::View view(bag, rosbag::TopicQuery(table_name));
+  for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+  {
+    sensor_msgs::NavSatFix::ConstPtr fix = it->instantiate<sensor_msgs::NavSatFix>();
+    if (fix)
+    {
+      trajectory->stamp.push_back(fix->header.stamp.toNSec());
+      trajectory->latitude.push_back(fix->latitude);
+      trajectory->longitude.push_back(fix->longitude);
+      trajectory->altitude.push_back(fix->altitude);
+      continue;
+    }
+    eagleye_msgs::Position::ConstPtr position = it->instantiate<eagleye_msgs::Position>();
+    if (position && position->status.enabled_status)
+    {
+      addPosition(*position, trajectory);
+    }
+  }
+  bag.close();
+
+  std::vector<std::vector<double> > values(3);
+  values[0].swap(trajectory->latitude);
+  values[1].swap(trajectory->longitude);
+  values[2].swap(trajectory->altitude);
+  sortByStamp(&trajectory->stamp, &values);
+  trajectory->latitude.swap(values[0]);
+  trajectory->longitude.swap(values[1]);
+  trajectory->altitude.swap(values[2]);
+}
+
+void loadHeadingTrajectory(const std::string& file, const std::string& table_name, HeadingTrajectory* trajectory)
+{
+  *trajectory = HeadingTrajectory();
+  if (isColumnLogFile(file))
+  {
+    ColumnLog log(file);
+    const ColumnTable& table = findTable(log, file, table_name);
+    const double* heading = table.column("heading_angle");
+    const double* enabled_status = table.column("enabled_status");
+    for (std::size_t i = 0; i < table.size(); i++)
+    {
+      if (enabled_status[i] != 0)
+      {
+        trajectory->stamp.push_back(table.stamp()[i]);
+        trajectory->heading.push_back(heading[i]);
+      }
+    }
+    return;
+  }
+
+  rosbag::Bag bag;
+  bag.open(file, rosbag::bagmode::Read);
+  rosbag::View view(bag, rosbag::TopicQuery(table_name));
+  for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+  {
+    eagleye_msgs::Heading::ConstPtr heading = it->instantiate<eagleye_msgs::Heading>();
+    if (heading && heading->status.enabled_status)
+    {
+      trajectory->stamp.push_back(heading->header.stamp.toNSec());
+      trajectory->heading.push_back(heading->heading_angle);
+    }
+  }
+  bag.close();
+
+  std::vector<std::vector<double> > values(1);
+  values[0].swap(trajectory->heading);
+  sortByStamp(&trajectory->stamp, &values);
+  trajectory->heading.swap(values[0]);
+}
+
+void setDefaultTrajectoryErrorParameter(TrajectoryErrorParameter* parameter)
+{
+  parameter->max_reference_gap = 1.0;
+  parameter->skip_time = 0;
+  parameter->max_estimate_gap = 0.5;
+  parameter->min_speed = 1.0;
+  parameter->reference_time_offset = 0;
+}
+
+struct ReferencePoint
+{
+  double latitude;
+  double longitude;
+  double altitude;
+  // Direction of travel [rad] clockwise from north, and speed [m/s], over the
+  // reference interval of the point.
+  double course;
+  double speed;
+  double meridian_radius;
+  double prime_vertical_radius;
+};
+
+static void referenceDisplacement(const Trajectory& reference, std::size_t from, std::size_t to, const ReferencePoint& point,
+                                  double* east, double* north)
+{
+  *north = (reference.latitude[to] - reference.latitude[from]) * M_PI / 180 * point.meridian_radius;
+  *east = (reference.longitude[to] - reference.longitude[from]) * M_PI / 180 * point.prime_vertical_radius *
+          std::cos(point.latitude * M_PI / 180);
+}
+
+static double referenceCourse(const Trajectory& reference, std::size_t i, const ReferencePoint& point)
+{
+  std::size_t from = i == 0 ? 0 : i - 1;
+  std::size_t to = std::min(i + 1, reference.stamp.size() - 1);
+  double east, north;
+  referenceDisplacement(reference, from, to, point, &east, &north);
+  return std::atan2(east, north);
+}
+
+// stamp in reference time. False outside the reference or in a gap.
+static bool interpolateReference(const Trajectory& reference, int64_t stamp, int64_t max_gap, ReferencePoint* point)
+{
+  if (reference.stamp.size() < 2 || stamp < reference.stamp.front() || stamp > reference.stamp.back())
+  {
+    return false;
+  }
+  std::size_t j = std::lower_bound(reference.stamp.begin(), reference.stamp.end(), stamp) - reference.stamp.begin();
+  j = std::max<std::size_t>(j, 1);
+  std::size_t k = j - 1;
+  int64_t interval = reference.stamp[j] - reference.stamp[k];
+  if (interval > max_gap)
+  {
+    return false;
+  }
+  double ratio = interval == 0 ? 0 : static_cast<double>(stamp - reference.stamp[k]) / interval;
+  point->latitude = reference.latitude[k] + ratio * (reference.latitude[j] - reference.latitude[k]);
+  point->longitude = reference.longitude[k] + ratio * (reference.longitude[j] - reference.longitude[k]);
+  point->altitude = reference.altitude[k] + ratio * (reference.altitude[j] - reference.altitude[k]);
+
+  // WGS84 radii of curvature, errors are small enough for a local tangent plane.
+  const double a = 6378137.0;
+  const double e2 = 6.69437999019758e-3;
+  double sin_latitude = std::sin(point->latitude * M_PI / 180);
+  double w = std::sqrt(1 - e2 * sin_latitude * sin_latitude);
+  point->meridian_radius = a * (1 - e2) / (w * w * w);
+  point->prime_vertical_radius = a / w;
+
+  double east, north;
+  referenceDisplacement(reference, k, j, *point, &east, &north);
+  point->speed = interval == 0 ? 0 : std::sqrt(east * east + north * north) / (interval * 1e-9);
+
+  // The chord from k to j points along the course at the middle of the
+  // interval. The courses at k and j, from their neighbours, are interpolated
+  // instead so that a turn does not make the course lag.
+  double course_k = referenceCourse(reference, k, *point);
+  double course_j = referenceCourse(reference, j, *point);
+  double difference = course_j - course_k;
+  point->course = course_k + ratio * std::atan2(std::sin(difference), std::cos(difference));
+  return true;
+}
+
+static void localError(double latitude, double longitude, double altitude, const ReferencePoint& point, double* east,
+                       double* north, double* up)
+{
+  *north = (latitude - point.latitude) * M_PI / 180 * point.meridian_radius;
+  *east = (longitude - point.longitude) * M_PI / 180 * point.prime_vertical_radius * std::cos(point.latitude * M_PI / 180);
+  *up = altitude - point.altitude;
+}
+
+void evaluateTrajectory(const Trajectory& estimate, const Trajectory& reference, const TrajectoryErrorParameter& parameter,
+                        TrajectoryError* error)
+{
+  *error = TrajectoryError();
+  if (reference.stamp.size() < 2)
+  {
+    return;
+  }
+
+  int64_t max_gap = static_cast<int64_t>(parameter.max_reference_gap * 1e9);
+  int64_t offset = static_cast<int64_t>(parameter.reference_time_offset * 1e9);
+  int64_t start = reference.stamp.front() + offset + static_cast<int64_t>(parameter.skip_time * 1e9);
+
+  std::vector<double> horizontal;
+  horizontal.reserve(estimate.stamp.size());
+  for (std::size_t i = 0; i < estimate.stamp.size(); i++)
+  {
+    ReferencePoint point;
+    if (estimate.stamp[i] < start || !interpolateReference(reference, estimate.stamp[i] - offset, max_gap, &point))
+    {
+      continue;
+    }
+    double east, north, up;
+    localError(estimate.latitude[i], estimate.longitude[i], estimate.altitude[i], point, &east, &north, &up);
+
+    double horizontal_error = std::sqrt(east * east + north * north);
+    horizontal.push_back(horizontal_error);
+    error->horizontal_square_sum += horizontal_error * horizontal_error;
+    error->horizontal_max = std::max(error->horizontal_max, horizontal_error);
+    error->vertical_square_sum += up * up;
+    error->vertical_max = std::max(error->vertical_max, std::abs(up));
+  }
+
+  error->count = horizontal.size();
+  if (error->count == 0)
+  {
+    return;
+  }
+  error->horizontal_rms = std::sqrt(error->horizontal_square_sum / error->count);
+  error->vertical_rms = std::sqrt(error->vertical_square_sum / error->count);
+  std::size_t p95 = std::min(error->count - 1, static_cast<std::size_t>(0.95 * error->count));
+  std::nth_element(horizontal.begin(), horizontal.begin() + p95, horizontal.end());
+  error->horizontal_p95 = horizontal[p95];
+}
+
+// A reference epoch is available if an estimate lies within max_estimate_gap of it.
+static void addAvailability(const std::vector<int64_t>& estimate_stamp, const Trajectory& reference,
+                            const TrajectoryErrorParameter& parameter, TrajectoryEvaluation* evaluation)
+{
+  if (reference.stamp.empty())
+  {
+    return;
+  }
+  int64_t max_gap = static_cast<int64_t>(parameter.max_estimate_gap * 1e9);
+  int64_t offset = static_cast<int64_t>(parameter.reference_time_offset * 1e9);
+  int64_t start = reference.stamp.front() + offset + static_cast<int64_t>(parameter.skip_time * 1e9);
+  std::vector<int64_t>::const_iterator it = estimate_stamp.begin();
+  for (std::size_t i = 0; i < reference.stamp.size(); i++)
+  {
+    int64_t stamp = reference.stamp[i] + offset;
+    if (stamp < start)
+    {
+      continue;
+    }
+    evaluation->reference_count++;
+    it = std::lower_bound(it, estimate_stamp.end(), stamp);
+    bool available = (it != estimate_stamp.end() && *it - stamp <= max_gap) ||
+                     (it != estimate_stamp.begin() && stamp - *(it - 1) <= max_gap);
+    evaluation->available_count += available ? 1 : 0;
+  }
+}
+
+void evaluateTrajectory(const Trajectory& estimate, const Trajectory& reference, const TrajectoryErrorParameter& parameter,
+                        TrajectoryEvaluation* evaluation)
+{
+  addAvailability(estimate.stamp, reference, parameter, evaluation);
+  if (reference.stamp.size() < 2)
+  {
+    return;
+  }
+
+  int64_t max_gap = static_cast<int64_t>(parameter.max_reference_gap * 1e9);
+  int64_t offset = static_cast<int64_t>(parameter.reference_time_offset * 1e9);
+  int64_t start = reference.stamp.front() + offset + static_cast<int64_t>(parameter.skip_time * 1e9);
+  for (std::size_t i = 0; i < estimate.stamp.size(); i++)
+  {
+    ReferencePoint point;
+    if (estimate.stamp[i] < start || !interpolateReference(reference, estimate.stamp[i] - offset, max_gap, &point))
+    {
+      continue;
+    }
+    double east, north, up;
+    localError(estimate.latitude[i], estimate.longitude[i], estimate.altitude[i], point, &east, &north, &up);
+    evaluation->horizontal.add(std::sqrt(east * east + north * north));
+    evaluation->height.add(up);
+    if (point.speed >= parameter.min_speed)
+    {
+      evaluation->along_track.add(east * std::sin(point.course) + north * std::cos(point.course));
+      evaluation->cross_track.add(east * std::cos(point.course) - north * std::sin(point.course));
+    }
+  }
+}
+
+void evaluateTrajectory(const HeadingTrajectory& estimate, const Trajectory& reference,
+                        const TrajectoryErrorParameter& parameter, TrajectoryEvaluation* evaluation)
+{
+  addAvailability(estimate.stamp, reference, parameter, evaluation);
+  if (reference.stamp.size() < 2)
+  {
+    return;
+  }
+
+  int64_t max_gap = static_cast<int64_t>(parameter.max_reference_gap * 1e9);
+  int64_t offset = static_cast<int64_t>(parameter.reference_time_offset * 1e9);
+  int64_t start = reference.stamp.front() + offset + static_cast<int64_t>(parameter.skip_time * 1e9);
+  for (std::size_t i = 0; i < estimate.stamp.size(); i++)
+  {
+    ReferencePoint point;
+    if (estimate.stamp[i] < start || !interpolateReference(reference, estimate.stamp[i] - offset, max_gap, &point) ||
+        point.speed < parameter.min_speed)
+    {
+      continue;
+    }
+    double difference = estimate.heading[i] - point.course;
+    evaluation->heading.add(std::atan2(std::sin(difference), std::cos(difference)));
+  }
+}
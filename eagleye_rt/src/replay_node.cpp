@@ -0,0 +1,156 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * replay_node.cpp
+ * Author MapIV Sekino
+ */
+
+#include "eagleye_rt/replay.hpp"
+#include <ros/package.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+static void printUsage()
+{
+  std::cerr << "Usage: rosrun eagleye_rt replay [options] input.bag [output.bag]" << std::endl;
+  std::cerr << "  --config FILE            eagleye_config.yaml to use, later files override earlier ones" << std::endl;
+  std::cerr << "                           (default: eagleye_rt/config/eagleye_config.yaml)" << std::endl;
+  std::cerr << "  --use_rtk_heading        same as use_rtk_heading:=true of eagleye_rt.launch" << std::endl;
+  std::cerr << "  --use_rtk_deadreckoning  same as use_rtk_deadreckoning:=true of eagleye_rt.launch" << std::endl;
+  std::cerr << "  --use_ekf                same as ekf/enable: true of eagleye_config.yaml" << std::endl;
+  std::cerr << "  --smooth                 run in ekf mode and also write the forward-backward smoothed states" << std::endl;
+  std::cerr << "                           under <output_namespace>/smoothed/" << std::endl;
+  std::cerr << "  --save_checkpoint TIME FILE" << std::endl;
+  std::cerr << "                           write the engine state after the first imu message at or after TIME [s]" << std::endl;
+  std::cerr << "  --load_checkpoint FILE   start from a saved engine state, earlier inputs are skipped" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<std::string> config_files;
+  std::vector<std::string> files;
+  bool use_rtk_heading = false;
+  bool use_rtk_deadreckoning = false;
+  bool use_ekf = false;
+  bool smooth = false;
+  std::string save_checkpoint_file;
+  double save_checkpoint_time = 0;
+  std::string load_checkpoint_file;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--config" && i + 1 < argc)
+    {
+      config_files.push_back(argv[++i]);
+    }
+    else if (arg == "--use_rtk_heading")
+    {
+      use_rtk_heading = true;
+    }
+    else if (arg == "--use_rtk_deadreckoning")
+    {
+      use_rtk_deadreckoning = true;
+    }
+    else if (arg == "--use_ekf")
+    {
+      use_ekf = true;
+    }
+    else if (arg == "--smooth")
+    {
+      smooth = true;
+    }
+    else if (arg == "--save_checkpoint" && i + 2 < argc)
+    {
+      save_checkpoint_time = atof(argv[++i]);
+      save_checkpoint_file = argv[++i];
+    }
+    else if (arg == "--load_checkpoint" && i + 1 < argc)
+    {
+      load_checkpoint_file = argv[++i];
+    }
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      printUsage();
+      return 1;
+    }
+    else
+    {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.empty() || files.size() > 2)
+  {
+    printUsage();
+    return 1;
+  }
+
+  if (config_files.empty())
+  {
+    config_files.push_back(ros::package::getPath("eagleye_rt") + "/config/eagleye_config.yaml");
+  }
+
+  std::string input_file = files[0];
+  std::string output_file = files.size() == 2 ? files[1] : "";
+
+  EagleyeEngineParameter engine_parameter;
+  ReplayParameter replay_parameter;
+  ReplaySummary summary;
+
+  try
+  {
+    setDefaultReplayParameter(&engine_parameter, &replay_parameter);
+    for (std::size_t i = 0; i < config_files.size(); i++)
+    {
+      std::cout << "config " << config_files[i] << std::endl;
+      loadEagleyeConfig(config_files[i], &engine_parameter, &replay_parameter);
+    }
+    engine_parameter.use_rtk_heading = engine_parameter.use_rtk_heading || use_rtk_heading;
+    engine_parameter.use_rtk_deadreckoning = engine_parameter.use_rtk_deadreckoning || use_rtk_deadreckoning;
+    engine_parameter.use_ekf = engine_parameter.use_ekf || use_ekf;
+    replay_parameter.save_checkpoint_file = save_checkpoint_file;
+    replay_parameter.save_checkpoint_time = save_checkpoint_time;
+    replay_parameter.load_checkpoint_file = load_checkpoint_file;
+    replay_parameter.smooth = smooth;
+
+    replayBag(input_file, output_file, engine_parameter, replay_parameter, &summary);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "replay failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  printReplaySummary(std::cout, input_file, summary);
+  if (!output_file.empty())
+  {
+    std::cout << "output " << output_file << std::endl;
+  }
+
+  return 0;
+}
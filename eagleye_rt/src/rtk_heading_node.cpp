@@ -28,186 +28,9 @@
  * Author MapIV Sekino
  */
 
-#include "ros/ros.h"
-#include "coordinate/coordinate.hpp"
-#include "navigation/navigation.hpp"
-
-static sensor_msgs::NavSatFix fix;
-static sensor_msgs::Imu imu;
-static eagleye_msgs::VelocityScaleFactor velocity_scale_factor;
-static eagleye_msgs::Distance distance;
-static eagleye_msgs::YawrateOffset yawrate_offset_stop;
-static eagleye_msgs::YawrateOffset yawrate_offset;
-static eagleye_msgs::SlipAngle slip_angle;
-static eagleye_msgs::Heading heading_interpolate;
-
-
-static ros::Publisher pub;
-static eagleye_msgs::Heading heading;
-
-struct RtkHeadingParameter heading_parameter;
-struct RtkHeadingStatus heading_status;
-
-void fix_callback(const sensor_msgs::NavSatFix::ConstPtr& msg)
-{
-  fix.header = msg->header;
-  fix.status = msg->status;
-  fix.latitude = msg->latitude;
-  fix.longitude = msg->longitude;
-  fix.altitude = msg->altitude;
-  fix.position_covariance = msg->position_covariance;
-  fix.position_covariance_type = msg->position_covariance_type;
-}
-
-void velocity_scale_factor_callback(const eagleye_msgs::VelocityScaleFactor::ConstPtr& msg)
-{
-  velocity_scale_factor.header = msg->header;
-  velocity_scale_factor.scale_factor = msg->scale_factor;
-  velocity_scale_factor.correction_velocity = msg->correction_velocity;
-  velocity_scale_factor.status = msg->status;
-}
-
-void yawrate_offset_stop_callback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
-{
-  yawrate_offset_stop.header = msg->header;
-  yawrate_offset_stop.yawrate_offset = msg->yawrate_offset;
-  yawrate_offset_stop.status = msg->status;
-}
-
-void yawrate_offset_callback(const eagleye_msgs::YawrateOffset::ConstPtr& msg)
-{
-  yawrate_offset.header = msg->header;
-  yawrate_offset.yawrate_offset = msg->yawrate_offset;
-  yawrate_offset.status = msg->status;
-}
-
-void slip_angle_callback(const eagleye_msgs::SlipAngle::ConstPtr& msg)
-{
-  slip_angle.header = msg->header;
-  slip_angle.coefficient = msg->coefficient;
-  slip_angle.slip_angle = msg->slip_angle;
-  slip_angle.status = msg->status;
-}
-
-void heading_interpolate_callback(const eagleye_msgs::Heading::ConstPtr& msg)
-{
-  heading_interpolate.header = msg->header;
-  heading_interpolate.heading_angle = msg->heading_angle;
-  heading_interpolate.status = msg->status;
-}
-
-void distance_callback(const eagleye_msgs::Distance::ConstPtr& msg)
-{
-  distance.header = msg->header;
-  distance.distance = msg->distance;
-  distance.status = msg->status;
-}
-
-void imu_callback(const sensor_msgs::Imu::ConstPtr& msg)
-{
-  imu.header = msg->header;
-  imu.orientation = msg->orientation;
-  imu.orientation_covariance = msg->orientation_covariance;
-  imu.angular_velocity = msg->angular_velocity;
-  imu.angular_velocity_covariance = msg->angular_velocity_covariance;
-  imu.linear_acceleration = msg->linear_acceleration;
-  imu.linear_acceleration_covariance = msg->linear_acceleration_covariance;
-  heading.header = msg->header;
-  heading.header.frame_id = "base_link";
-  rtk_heading_estimate(fix,imu,velocity_scale_factor,distance,yawrate_offset_stop,yawrate_offset,slip_angle,heading_interpolate,heading_parameter,&heading_status,&heading);
-
-  if (heading.status.estimate_status == true)
-  {
-    pub.publish(heading);
-  }
-  heading.status.estimate_status = false;
-}
+#include "eagleye_rt/nodelet_main.hpp"
 
 int main(int argc, char** argv)
 {
-  ros::init(argc, argv, "rtk_heading");
-  ros::NodeHandle n;
-
-  std::string subscribe_imu_topic_name = "/imu/data_raw";
-  std::string subscribe_navsatfix_topic_name = "/navsat/fix";
-
-  n.getParam("imu_topic",subscribe_imu_topic_name);
-  n.getParam("navsatfix_topic",subscribe_navsatfix_topic_name);
-  n.getParam("reverse_imu", heading_parameter.reverse_imu);
-  n.getParam("rtk_heading/estimated_distance",heading_parameter.estimated_distance);
-  n.getParam("rtk_heading/estimated_heading_buffer_min",heading_parameter.estimated_heading_buffer_min);
-  n.getParam("rtk_heading/estimated_number_min",heading_parameter.estimated_number_min);
-  n.getParam("rtk_heading/estimated_number_max",heading_parameter.estimated_number_max);
-  n.getParam("rtk_heading/estimated_gnss_coefficient",heading_parameter.estimated_gnss_coefficient);
-  n.getParam("rtk_heading/estimated_heading_coefficient",heading_parameter.estimated_heading_coefficient);
-  n.getParam("rtk_heading/outlier_threshold",heading_parameter.outlier_threshold);
-  n.getParam("rtk_heading/estimated_velocity_threshold",heading_parameter.estimated_velocity_threshold);
-  n.getParam("rtk_heading/stop_judgment_velocity_threshold",heading_parameter.stop_judgment_velocity_threshold);
-  n.getParam("rtk_heading/estimated_yawrate_threshold",heading_parameter.estimated_yawrate_threshold);
-
-  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
-  std::cout<< "subscribe_navsatfix_topic_name "<<subscribe_navsatfix_topic_name<<std::endl;
-  std::cout<< "reverse_imu "<<heading_parameter.reverse_imu<<std::endl;
-  std::cout<< "estimated_distance "<<heading_parameter.estimated_distance<<std::endl;
-  std::cout<< "estimated_heading_buffer_min "<<heading_parameter.estimated_heading_buffer_min<<std::endl;
-  std::cout<< "estimated_number_min "<<heading_parameter.estimated_number_min<<std::endl;
-  std::cout<< "estimated_number_max "<<heading_parameter.estimated_number_max<<std::endl;
-  std::cout<< "estimated_gnss_coefficient "<<heading_parameter.estimated_gnss_coefficient<<std::endl;
-  std::cout<< "estimated_heading_coefficient "<<heading_parameter.estimated_heading_coefficient<<std::endl;
-  std::cout<< "outlier_threshold "<<heading_parameter.outlier_threshold<<std::endl;
-  std::cout<< "estimated_velocity_threshold "<<heading_parameter.estimated_velocity_threshold<<std::endl;
-  std::cout<< "stop_judgment_velocity_threshold "<<heading_parameter.stop_judgment_velocity_threshold<<std::endl;
-  std::cout<< "estimated_yawrate_threshold "<<heading_parameter.estimated_yawrate_threshold<<std::endl;
-
-  std::string publish_topic_name = "/publish_topic_name/invalid";
-  std::string subscribe_topic_name = "/subscribe_topic_name/invalid";
-  std::string subscribe_topic_name2 = "/subscribe_topic_name2/invalid";
-
-  if (argc == 2)
-  {
-    if (strcmp(argv[1], "1st") == 0)
-    {
-      publish_topic_name = "heading_1st";
-      subscribe_topic_name = "yawrate_offset_stop";
-      subscribe_topic_name2 = "heading_interpolate_1st";
-    }
-    else if (strcmp(argv[1], "2nd") == 0)
-    {
-      publish_topic_name = "heading_2nd";
-      subscribe_topic_name = "yawrate_offset_1st";
-      subscribe_topic_name2 = "heading_interpolate_2nd";
-    }
-    else if (strcmp(argv[1], "3rd") == 0)
-    {
-      publish_topic_name = "heading_3rd";
-      subscribe_topic_name = "yawrate_offset_2nd";
-      subscribe_topic_name2 = "heading_interpolate_3rd";
-    }
-    else
-    {
-      ROS_ERROR("Invalid argument");
-      ros::shutdown();
-    }
-  }
-  else
-  {
-    ROS_ERROR("No arguments");
-    ros::shutdown();
-  }
-
-  ros::Subscriber sub1 = n.subscribe(subscribe_imu_topic_name, 1000, imu_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub2 = n.subscribe(subscribe_navsatfix_topic_name, 1000, fix_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub3 = n.subscribe("velocity_scale_factor", 1000, velocity_scale_factor_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub4 = n.subscribe("yawrate_offset_stop", 1000, yawrate_offset_stop_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub5 = n.subscribe(subscribe_topic_name, 1000, yawrate_offset_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub6 = n.subscribe("slip_angle", 1000, slip_angle_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub7 = n.subscribe(subscribe_topic_name2, 1000, heading_interpolate_callback, ros::TransportHints().tcpNoDelay());
-  ros::Subscriber sub8 = n.subscribe("distance", 1000, distance_callback, ros::TransportHints().tcpNoDelay());
-
-
-  pub = n.advertise<eagleye_msgs::Heading>(publish_topic_name, 1000);
-
-  ros::spin();
-
-  return 0;
+  return runNodelet(argc, argv, "rtk_heading", "eagleye_rt/RtkHeadingNodelet");
 }
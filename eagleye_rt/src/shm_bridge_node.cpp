@@ -0,0 +1,130 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * shm_bridge_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Producer of the shared-memory transport (shm_transport/enable). Subscribes
+// imu_topic and rtklib_nav_topic once and serializes every message straight
+// into the shared-memory ring of the topic, from which all eagleye nodes read.
+// The rings are removed when the bridge exits; the nodes reconnect when it is
+// restarted. Only the user of the bridge can open the rings, unless
+// shm_transport/group names a group that may open them as well.
+
+#include "ros/ros.h"
+#include "sensor_msgs/Imu.h"
+#include "rtklib_msgs/RtklibNav.h"
+#include "eagleye_rt/shm_ring.hpp"
+#include <string>
+#include <grp.h>
+
+template<class M>
+class ShmBridge
+{
+public:
+  bool init(ros::NodeHandle& nh, const std::string& topic, uint32_t slot_count, uint32_t slot_size, gid_t group)
+  {
+    topic_ = nh.resolveName(topic);
+    std::string name = ShmRing::nameForTopic(topic_);
+    if (!ring_.create(name, slot_count, slot_size, ros::message_traits::datatype<M>(),
+                      ros::message_traits::md5sum<M>(), group))
+    {
+      ROS_ERROR("Failed to create shared memory %s for %s", name.c_str(), topic_.c_str());
+      return false;
+    }
+    sub_ = nh.subscribe(topic_, 1000, &ShmBridge::callback, this, ros::TransportHints().tcpNoDelay());
+    std::cout << "shm_bridge " << topic_ << " -> /dev/shm" << name << std::endl;
+    return true;
+  }
+
+private:
+  void callback(const boost::shared_ptr<M const>& msg)
+  {
+    uint32_t size = ros::serialization::serializationLength(*msg);
+    uint8_t* data = ring_.beginWrite(size);
+    if (!data)
+    {
+      ROS_WARN_THROTTLE(1.0, "%s: message of %u bytes exceeds shm_transport/slot_size", topic_.c_str(), size);
+      return;
+    }
+    ros::serialization::OStream stream(data, size);
+    ros::serialization::serialize(stream, *msg);
+    ring_.endWrite();
+  }
+
+  std::string topic_;
+  ShmRing ring_;
+  ros::Subscriber sub_;
+};
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "shm_bridge");
+  ros::NodeHandle n;
+
+  std::string subscribe_imu_topic_name = "/imu/data_raw";
+  std::string subscribe_rtklib_nav_topic_name = "/rtklib_nav";
+  int slot_count = 1024;
+  int slot_size = 4096;
+  std::string group_name = "";
+
+  n.getParam("imu_topic",subscribe_imu_topic_name);
+  n.getParam("rtklib_nav_topic",subscribe_rtklib_nav_topic_name);
+  n.getParam("shm_transport/slot_count",slot_count);
+  n.getParam("shm_transport/slot_size",slot_size);
+  n.getParam("shm_transport/group",group_name);
+
+  std::cout<< "subscribe_imu_topic_name "<<subscribe_imu_topic_name<<std::endl;
+  std::cout<< "subscribe_rtklib_nav_topic_name "<<subscribe_rtklib_nav_topic_name<<std::endl;
+  std::cout<< "slot_count "<<slot_count<<std::endl;
+  std::cout<< "slot_size "<<slot_size<<std::endl;
+  std::cout<< "group "<<group_name<<std::endl;
+
+  gid_t group = (gid_t)-1;
+  if (!group_name.empty())
+  {
+    struct group* entry = getgrnam(group_name.c_str());
+    if (!entry)
+    {
+      ROS_ERROR("Unknown group %s in shm_transport/group", group_name.c_str());
+      return 1;
+    }
+    group = entry->gr_gid;
+  }
+
+  ShmBridge<sensor_msgs::Imu> imu_bridge;
+  ShmBridge<rtklib_msgs::RtklibNav> rtklib_nav_bridge;
+  if (!imu_bridge.init(n, subscribe_imu_topic_name, slot_count, slot_size, group) ||
+      !rtklib_nav_bridge.init(n, subscribe_rtklib_nav_topic_name, slot_count, slot_size, group))
+  {
+    return 1;
+  }
+
+  ros::spin();
+
+  return 0;
+}
@@ -31,6 +31,8 @@
 #include "ros/ros.h"
 #include "coordinate/coordinate.hpp"
 #include "navigation/navigation.hpp"
+#include "eagleye_rt/shm_transport.hpp"
+#include "eagleye_rt/warm_start.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -47,6 +49,7 @@ struct SlipCoefficientParameter slip_coefficient_parameter;
 struct SlipCoefficientStatus slip_coefficient_status;
 
 static double estimate_coefficient;
+static WarmStart warm_start;
 
 void rtklib_nav_callback(const rtklib_msgs::RtklibNav::ConstPtr& msg)
 {
@@ -95,7 +98,12 @@ void imu_callback(const sensor_msgs::Imu::ConstPtr& msg)
   imu.angular_velocity_covariance = msg->angular_velocity_covariance;
   imu.linear_acceleration = msg->linear_acceleration;
   imu.linear_acceleration_covariance = msg->linear_acceleration_covariance;
+  double estimate_coefficient_last = estimate_coefficient;
   slip_coefficient_estimate(imu,rtklib_nav,velocity_scale_factor,yawrate_offset_stop,yawrate_offset_2nd,heading_interpolate_3rd,slip_coefficient_parameter,&slip_coefficient_status,&estimate_coefficient);
+  if (estimate_coefficient != estimate_coefficient_last)
+  {
+    warm_start.update("slip_coefficient", estimate_coefficient, imu.header.stamp);
+  }
 
   std::cout << "--- \033[1;34m slip_coefficient \033[m ------------------------------"<< std::endl;
   std::cout<<"\033[1m estimate_coefficient \033[m "<<estimate_coefficient<<std::endl;
@@ -107,6 +115,7 @@ int main(int argc, char** argv)
   ros::init(argc, argv, "slip_coefficient");
 
   ros::NodeHandle n;
+  warm_start.init(n);
 
   std::string subscribe_imu_topic_name = "/imu/data_raw";
   std::string subscribe_rtklib_nav_topic_name = "/rtklib_nav";
@@ -131,14 +140,15 @@ int main(int argc, char** argv)
   std::cout<< "lever_arm "<<slip_coefficient_parameter.lever_arm<<std::endl;
   std::cout<< "stop_judgment_velocity_threshold "<<slip_coefficient_parameter.stop_judgment_velocity_threshold<<std::endl;
 
-  ros::Subscriber sub1 = n.subscribe(subscribe_imu_topic_name, 1000, imu_callback);
-  ros::Subscriber sub2 = n.subscribe(subscribe_rtklib_nav_topic_name, 1000, rtklib_nav_callback);
+  ShmSubscriber sub1 = subscribeShm(n, subscribe_imu_topic_name, 1000, imu_callback);
+  ShmSubscriber sub2 = subscribeShm(n, subscribe_rtklib_nav_topic_name, 1000, rtklib_nav_callback);
   ros::Subscriber sub3 = n.subscribe("velocity_scale_factor", 1000, velocity_scale_factor_callback);
   ros::Subscriber sub4 = n.subscribe("yawrate_offset_stop", 1000, yawrate_offset_stop_callback);
   ros::Subscriber sub5 = n.subscribe("yawrate_offset_2nd", 1000, yawrate_offset_2nd_callback);
   ros::Subscriber sub6 = n.subscribe("heading_interpolate_3rd", 1000, heading_interpolate_3rd_callback);
 
   ros::spin();
+  warm_start.save();
 
   std::string str;
   n.getParam("output_dir", str);
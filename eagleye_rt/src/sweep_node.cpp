@@ -0,0 +1,596 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * sweep_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Replays a list of logs once per configuration of a parameter sweep and
+// scores every configuration by the error of its fix against a reference
+// trajectory and by its CPU time. The configurations are a grid, random
+// samples, or a grid with random samples at every grid point, on top of the
+// base eagleye_config.yaml:
+//
+//   grid:
+//     heading/outlier_threshold: [0.0087, 0.0175, 0.035]
+//   random:
+//     samples: 20
+//     seed: 1
+//     parameters:
+//       position/outlier_threshold: [1.0, 5.0]   # uniform, integers if both bounds are
+//
+// Every (configuration, log) pair is one job for the worker threads. Column
+// logs are memory-mapped, so all workers share one read-only copy of each
+// input in the page cache; the references are loaded once and shared.
+
+#include "eagleye_rt/replay.hpp"
+#include "eagleye_rt/column_log_messages.hpp"
+#include <ros/package.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, std::string> > SweepConfiguration;
+
+struct SweepLog
+{
+  std::string input_file;
+  std::string reference_file;
+  Trajectory reference;
+};
+
+struct SweepJob
+{
+  std::size_t configuration;
+  std::size_t log;
+  ReplaySummary summary;
+  TrajectoryError error;
+  double cpu_time;
+  bool succeeded;
+  std::string message;
+};
+
+struct SweepResult
+{
+  std::size_t configuration;
+  std::size_t log_count;
+  std::size_t failed_count;
+  std::size_t count;
+  double horizontal_rms;
+  double horizontal_p95;
+  double horizontal_max;
+  double vertical_rms;
+  double vertical_max;
+  double cpu_time;
+  double log_duration;
+};
+
+struct SweepOption
+{
+  std::string spec_file;
+  std::string list_file;
+  std::string output_file;
+  std::string reference_table;
+  std::vector<std::string> config_files;
+  unsigned int jobs;
+  unsigned int top;
+  TrajectoryErrorParameter error_parameter;
+};
+
+static void printUsage()
+{
+  std::cerr << "Usage: rosrun eagleye_rt sweep [options] sweep.yaml list.txt" << std::endl;
+  std::cerr << "  list.txt has one log per line: input.elog [reference.elog]" << std::endl;
+  std::cerr << "  the reference is a column log table with latitude, longitude and altitude," << std::endl;
+  std::cerr << "  taken from the input log if no reference file is given" << std::endl;
+  std::cerr << "  --config FILE            base eagleye_config.yaml (default: eagleye_rt/config/eagleye_config.yaml)" << std::endl;
+  std::cerr << "  --reference_table NAME   table of the reference trajectory (default: reference)" << std::endl;
+  std::cerr << "  --skip SEC               leave the first SEC of every log out of the errors (default: 0)" << std::endl;
+  std::cerr << "  --max_reference_gap SEC  longest reference gap to interpolate over (default: 1)" << std::endl;
+  std::cerr << "  --jobs N                 number of worker threads (default: number of cores)" << std::endl;
+  std::cerr << "  --output FILE            write one csv row per configuration (default: sweep.csv)" << std::endl;
+  std::cerr << "  --top N                  number of configurations printed (default: 10)" << std::endl;
+}
+
+static bool readList(const std::string& list_file, std::vector<SweepLog>* logs)
+{
+  std::ifstream ifs(list_file.c_str());
+  if (!ifs)
+  {
+    std::cerr << "cannot open " << list_file << std::endl;
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(ifs, line))
+  {
+    std::string::size_type comment = line.find('#');
+    if (comment != std::string::npos)
+    {
+      line = line.substr(0, comment);
+    }
+    std::istringstream iss(line);
+    SweepLog log;
+    if (!(iss >> log.input_file))
+    {
+      continue;
+    }
+    if (!(iss >> log.reference_file))
+    {
+      log.reference_file = log.input_file;
+    }
+    logs->push_back(log);
+  }
+  return true;
+}
+
+// "a/b" addresses nested maps, as in eagleye_config.yaml.
+static bool hasParam(const YAML::Node& config, const std::string& key)
+{
+  if (!config.IsMap())
+  {
+    return false;
+  }
+  std::string::size_type pos = key.find('/');
+  const YAML::Node node = config[key.substr(0, pos)];
+  if (!node)
+  {
+    return false;
+  }
+  return pos == std::string::npos ? true : hasParam(node, key.substr(pos + 1));
+}
+
+// A child map is only attached to its parent when it is assigned, so the
+// nested maps are filled first and assigned on the way back.
+static void setParam(YAML::Node& config, const std::string& key, const std::string& value)
+{
+  std::string::size_type pos = key.find('/');
+  if (pos == std::string::npos)
+  {
+    config[key] = value;
+    return;
+  }
+  const std::string parent = key.substr(0, pos);
+  YAML::Node child = config[parent].IsMap() ? YAML::Node(config[parent]) : YAML::Node(YAML::NodeType::Map);
+  setParam(child, key.substr(pos + 1), value);
+  config[parent] = child;
+}
+
+static std::string formatValue(double value)
+{
+  std::ostringstream oss;
+  oss << std::setprecision(6) << value;
+  return oss.str();
+}
+
+// Every grid point, times the random samples if there are any.
+static void makeConfigurations(const YAML::Node& spec, const std::vector<YAML::Node>& base,
+                               std::vector<SweepConfiguration>* configurations)
+{
+  std::vector<std::string> grid_keys;
+  std::vector<std::vector<std::string> > grid_values;
+  if (spec["grid"])
+  {
+    for (YAML::const_iterator it = spec["grid"].begin(); it != spec["grid"].end(); ++it)
+    {
+      grid_keys.push_back(it->first.as<std::string>());
+      grid_values.push_back(it->second.as<std::vector<std::string> >());
+      if (grid_values.back().empty())
+      {
+        throw std::runtime_error("no values for " + grid_keys.back());
+      }
+    }
+  }
+
+  std::vector<std::string> random_keys;
+  std::vector<std::vector<std::string> > random_ranges;
+  int samples = 1;
+  unsigned int seed = 1;
+  if (spec["random"])
+  {
+    const YAML::Node random = spec["random"];
+    samples = random["samples"] ? random["samples"].as<int>() : 10;
+    seed = random["seed"] ? random["seed"].as<unsigned int>() : 1;
+    for (YAML::const_iterator it = random["parameters"].begin(); it != random["parameters"].end(); ++it)
+    {
+      random_keys.push_back(it->first.as<std::string>());
+      random_ranges.push_back(it->second.as<std::vector<std::string> >());
+      if (random_ranges.back().size() != 2)
+      {
+        throw std::runtime_error("random range of " + random_keys.back() + " is not [min, max]");
+      }
+    }
+  }
+
+  // A key the base configuration does not have would be silently ignored.
+  std::vector<std::string> keys = grid_keys;
+  keys.insert(keys.end(), random_keys.begin(), random_keys.end());
+  for (std::size_t i = 0; i < keys.size(); i++)
+  {
+    bool found = false;
+    for (std::size_t j = 0; j < base.size() && !found; j++)
+    {
+      found = hasParam(base[j], keys[i]);
+    }
+    if (!found)
+    {
+      throw std::runtime_error("unknown parameter " + keys[i]);
+    }
+  }
+
+  std::mt19937 random_engine(seed);
+  std::vector<std::size_t> index(grid_keys.size(), 0);
+  while (true)
+  {
+    for (int sample = 0; sample < samples; sample++)
+    {
+      SweepConfiguration configuration;
+      for (std::size_t i = 0; i < grid_keys.size(); i++)
+      {
+        configuration.push_back(std::make_pair(grid_keys[i], grid_values[i][index[i]]));
+      }
+      for (std::size_t i = 0; i < random_keys.size(); i++)
+      {
+        const std::vector<std::string>& range = random_ranges[i];
+        bool integer = range[0].find_first_of(".eE") == std::string::npos && range[1].find_first_of(".eE") == std::string::npos;
+        if (integer)
+        {
+          std::uniform_int_distribution<long> distribution(atol(range[0].c_str()), atol(range[1].c_str()));
+          configuration.push_back(std::make_pair(random_keys[i], std::to_string(distribution(random_engine))));
+        }
+        else
+        {
+          std::uniform_real_distribution<double> distribution(atof(range[0].c_str()), atof(range[1].c_str()));
+          configuration.push_back(std::make_pair(random_keys[i], formatValue(distribution(random_engine))));
+        }
+      }
+      configurations->push_back(configuration);
+    }
+
+    // Next grid point, the last key changes fastest.
+    std::size_t i = grid_keys.size();
+    while (i > 0 && ++index[i - 1] == grid_values[i - 1].size())
+    {
+      index[--i] = 0;
+    }
+    if (i == 0)
+    {
+      break;
+    }
+  }
+}
+
+static double threadCpuTime()
+{
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void runJob(const EagleyeEngineParameter& engine_parameter, const ReplayParameter& replay_parameter,
+                   const SweepLog& log, const TrajectoryErrorParameter& error_parameter, SweepJob* job)
+{
+  double cpu_start = threadCpuTime();
+  try
+  {
+    Trajectory fix;
+    replayBag(log.input_file, "", engine_parameter, replay_parameter, &job->summary, &fix);
+    evaluateTrajectory(fix, log.reference, error_parameter, &job->error);
+    job->succeeded = true;
+  }
+  catch (std::exception& e)
+  {
+    job->succeeded = false;
+    job->message = e.what();
+  }
+  job->cpu_time = threadCpuTime() - cpu_start;
+}
+
+static SweepResult poolResult(std::size_t configuration, const std::vector<SweepJob>& jobs)
+{
+  SweepResult result = SweepResult();
+  result.configuration = configuration;
+  double horizontal_square_sum = 0;
+  double vertical_square_sum = 0;
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    const SweepJob& job = jobs[i];
+    if (job.configuration != configuration)
+    {
+      continue;
+    }
+    result.log_count++;
+    result.cpu_time += job.cpu_time;
+    if (!job.succeeded)
+    {
+      result.failed_count++;
+      continue;
+    }
+    result.count += job.error.count;
+    horizontal_square_sum += job.error.horizontal_square_sum;
+    vertical_square_sum += job.error.vertical_square_sum;
+    result.horizontal_p95 = std::max(result.horizontal_p95, job.error.horizontal_p95);
+    result.horizontal_max = std::max(result.horizontal_max, job.error.horizontal_max);
+    result.vertical_max = std::max(result.vertical_max, job.error.vertical_max);
+    result.log_duration += job.summary.end_time - job.summary.start_time;
+  }
+  if (result.count > 0)
+  {
+    result.horizontal_rms = std::sqrt(horizontal_square_sum / result.count);
+    result.vertical_rms = std::sqrt(vertical_square_sum / result.count);
+  }
+  return result;
+}
+
+// Configurations with failed logs or no compared fix go last.
+static bool betterResult(const SweepResult& a, const SweepResult& b)
+{
+  bool a_valid = a.failed_count == 0 && a.count > 0;
+  bool b_valid = b.failed_count == 0 && b.count > 0;
+  if (a_valid != b_valid)
+  {
+    return a_valid;
+  }
+  return a.horizontal_rms < b.horizontal_rms;
+}
+
+static std::string describe(const SweepConfiguration& configuration)
+{
+  std::ostringstream oss;
+  for (std::size_t i = 0; i < configuration.size(); i++)
+  {
+    oss << (i == 0 ? "" : " ") << configuration[i].first << "=" << configuration[i].second;
+  }
+  return configuration.empty() ? "(base)" : oss.str();
+}
+
+static void writeCsv(const std::string& file, const std::vector<SweepConfiguration>& configurations,
+                     const std::vector<SweepResult>& results)
+{
+  std::ofstream ofs(file.c_str());
+  ofs << "configuration";
+  for (std::size_t i = 0; i < configurations[0].size(); i++)
+  {
+    ofs << "," << configurations[0][i].first;
+  }
+  ofs << ",logs,failed,fix_count,horizontal_rms,horizontal_p95,horizontal_max,vertical_rms,vertical_max,"
+      << "cpu_time,cpu_time_per_log_time" << std::endl;
+  ofs << std::setprecision(6);
+  for (std::size_t i = 0; i < results.size(); i++)
+  {
+    const SweepResult& r = results[i];
+    ofs << r.configuration;
+    for (std::size_t j = 0; j < configurations[r.configuration].size(); j++)
+    {
+      ofs << "," << configurations[r.configuration][j].second;
+    }
+    ofs << "," << r.log_count << "," << r.failed_count << "," << r.count << "," << r.horizontal_rms << ","
+        << r.horizontal_p95 << "," << r.horizontal_max << "," << r.vertical_rms << "," << r.vertical_max << ","
+        << r.cpu_time << "," << (r.log_duration > 0 ? r.cpu_time / r.log_duration : 0) << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  SweepOption option = SweepOption();
+  option.jobs = std::thread::hardware_concurrency();
+  if (option.jobs == 0)
+  {
+    option.jobs = 1;
+  }
+  option.top = 10;
+  option.output_file = "sweep.csv";
+  option.reference_table = COLUMN_LOG_REFERENCE_TABLE;
+  setDefaultTrajectoryErrorParameter(&option.error_parameter);
+
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--config" && i + 1 < argc)
+    {
+      option.config_files.push_back(argv[++i]);
+    }
+    else if (arg == "--reference_table" && i + 1 < argc)
+    {
+      option.reference_table = argv[++i];
+    }
+    else if (arg == "--skip" && i + 1 < argc)
+    {
+      option.error_parameter.skip_time = atof(argv[++i]);
+    }
+    else if (arg == "--max_reference_gap" && i + 1 < argc)
+    {
+      option.error_parameter.max_reference_gap = atof(argv[++i]);
+    }
+    else if (arg == "--jobs" && i + 1 < argc)
+    {
+      option.jobs = std::max(1, atoi(argv[++i]));
+    }
+    else if (arg == "--output" && i + 1 < argc)
+    {
+      option.output_file = argv[++i];
+    }
+    else if (arg == "--top" && i + 1 < argc)
+    {
+      option.top = std::max(1, atoi(argv[++i]));
+    }
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      printUsage();
+      return 1;
+    }
+    else
+    {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.size() != 2)
+  {
+    printUsage();
+    return 1;
+  }
+  option.spec_file = files[0];
+  option.list_file = files[1];
+  if (option.config_files.empty())
+  {
+    option.config_files.push_back(ros::package::getPath("eagleye_rt") + "/config/eagleye_config.yaml");
+  }
+
+  std::vector<SweepLog> logs;
+  if (!readList(option.list_file, &logs))
+  {
+    return 1;
+  }
+  if (logs.empty())
+  {
+    std::cerr << "no logs in " << option.list_file << std::endl;
+    return 1;
+  }
+
+  // Parameters are resolved here, the workers only read them.
+  std::vector<SweepConfiguration> configurations;
+  std::vector<EagleyeEngineParameter> engine_parameters;
+  std::vector<ReplayParameter> replay_parameters;
+  try
+  {
+    std::vector<YAML::Node> base;
+    for (std::size_t i = 0; i < option.config_files.size(); i++)
+    {
+      std::cout << "config " << option.config_files[i] << std::endl;
+      base.push_back(YAML::LoadFile(option.config_files[i]));
+    }
+    makeConfigurations(YAML::LoadFile(option.spec_file), base, &configurations);
+
+    for (std::size_t i = 0; i < configurations.size(); i++)
+    {
+      EagleyeEngineParameter engine_parameter;
+      ReplayParameter replay_parameter;
+      setDefaultReplayParameter(&engine_parameter, &replay_parameter);
+      for (std::size_t j = 0; j < base.size(); j++)
+      {
+        loadEagleyeConfig(base[j], &engine_parameter, &replay_parameter);
+      }
+      YAML::Node override_config;
+      for (std::size_t j = 0; j < configurations[i].size(); j++)
+      {
+        setParam(override_config, configurations[i][j].first, configurations[i][j].second);
+      }
+      loadEagleyeConfig(override_config, &engine_parameter, &replay_parameter);
+      replay_parameter.publish_state = false;
+      engine_parameters.push_back(engine_parameter);
+      replay_parameters.push_back(replay_parameter);
+    }
+
+    for (std::size_t i = 0; i < logs.size(); i++)
+    {
+      loadTrajectory(logs[i].reference_file, option.reference_table, &logs[i].reference);
+    }
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "sweep failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::vector<SweepJob> jobs;
+  for (std::size_t i = 0; i < configurations.size(); i++)
+  {
+    for (std::size_t j = 0; j < logs.size(); j++)
+    {
+      SweepJob job = SweepJob();
+      job.configuration = i;
+      job.log = j;
+      jobs.push_back(job);
+    }
+  }
+  std::cout << "configurations " << configurations.size() << " logs " << logs.size() << " jobs " << jobs.size()
+            << " workers " << option.jobs << std::endl;
+
+  ros::WallTime start = ros::WallTime::now();
+  std::atomic<std::size_t> next_job(0);
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < option.jobs; i++)
+  {
+    threads.push_back(std::thread([&]()
+    {
+      std::size_t index;
+      while ((index = next_job++) < jobs.size())
+      {
+        SweepJob& job = jobs[index];
+        runJob(engine_parameters[job.configuration], replay_parameters[job.configuration], logs[job.log],
+               option.error_parameter, &job);
+      }
+    }));
+  }
+  for (std::size_t i = 0; i < threads.size(); i++)
+  {
+    threads[i].join();
+  }
+  double wall_time = (ros::WallTime::now() - start).toSec();
+
+  for (std::size_t i = 0; i < jobs.size(); i++)
+  {
+    if (!jobs[i].succeeded)
+    {
+      std::cout << "configuration " << jobs[i].configuration << " log " << logs[jobs[i].log].input_file
+                << " failed: " << jobs[i].message << std::endl;
+    }
+  }
+
+  std::vector<SweepResult> results;
+  for (std::size_t i = 0; i < configurations.size(); i++)
+  {
+    results.push_back(poolResult(i, jobs));
+  }
+  writeCsv(option.output_file, configurations, results);
+
+  std::vector<SweepResult> ranking = results;
+  std::stable_sort(ranking.begin(), ranking.end(), betterResult);
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "rank, horizontal rms [m], p95 [m], max [m], vertical rms [m], cpu time / log time, configuration" << std::endl;
+  for (std::size_t i = 0; i < ranking.size() && i < option.top; i++)
+  {
+    const SweepResult& r = ranking[i];
+    std::cout << i + 1 << ", " << r.horizontal_rms << ", " << r.horizontal_p95 << ", " << r.horizontal_max << ", "
+              << r.vertical_rms << ", " << std::setprecision(5) << (r.log_duration > 0 ? r.cpu_time / r.log_duration : 0)
+              << std::setprecision(3) << ", " << (r.failed_count > 0 ? "failed " : r.count == 0 ? "no fix " : "") << describe(configurations[r.configuration])
+              << std::endl;
+  }
+  std::cout << "wall time " << wall_time << " [s]" << std::endl;
+  std::cout << "results " << option.output_file << std::endl;
+  return 0;
+}
@@ -0,0 +1,230 @@
+// Copyright (c) 2019, Map IV, Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name of the Map IV, Inc. nor the names of its contributors
+//   may be used to endorse or promote products derived from this software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL COPYRIGHT HOLDER BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * synthetic_bag_node.cpp
+ * Author MapIV Sekino
+ */
+
+// Writes a synthetic drive (navigation/synthetic_drive.hpp) to a rosbag that
+// replay and batch_replay read as is. The sensor topics are the defaults of
+// eagleye_config.yaml, the ground truth is written under /truth.
+
+#include "navigation/synthetic_drive.hpp"
+#include <rosbag/bag.h>
+#include <yaml-cpp/yaml.h>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+template <class T>
+static void getParam(const YAML::Node& config, const std::string& key, T& value)
+{
+  if (config[key])
+  {
+    value = config[key].as<T>();
+  }
+}
+
+static void loadSyntheticDriveParameter(const std::string& file, SyntheticDriveParameter* p)
+{
+  YAML::Node config = YAML::LoadFile(file);
+
+  getParam(config, "start_time", p->start_time);
+  getParam(config, "imu_rate", p->imu_rate);
+  getParam(config, "gnss_rate", p->gnss_rate);
+  getParam(config, "route_period", p->route_period);
+  getParam(config, "cruise_velocity", p->cruise_velocity);
+  getParam(config, "slope_amplitude", p->slope_amplitude);
+  getParam(config, "slope_period", p->slope_period);
+  getParam(config, "latitude", p->latitude);
+  getParam(config, "longitude", p->longitude);
+  getParam(config, "altitude", p->altitude);
+  getParam(config, "initial_heading", p->initial_heading);
+
+  getParam(config, "gyro_bias", p->gyro_bias);
+  getParam(config, "gyro_bias_drift", p->gyro_bias_drift);
+  getParam(config, "gyro_noise", p->gyro_noise);
+  getParam(config, "acc_offset", p->acc_offset);
+  getParam(config, "acc_scale", p->acc_scale);
+  getParam(config, "acc_noise", p->acc_noise);
+  getParam(config, "wheel_scale_factor", p->wheel_scale_factor);
+  getParam(config, "wheel_speed_noise", p->wheel_speed_noise);
+
+  getParam(config, "gnss_fix_position_noise", p->gnss_fix_position_noise);
+  getParam(config, "gnss_float_position_noise", p->gnss_float_position_noise);
+  getParam(config, "gnss_velocity_noise", p->gnss_velocity_noise);
+  getParam(config, "multipath_probability", p->multipath_probability);
+  getParam(config, "multipath_magnitude", p->multipath_magnitude);
+  getParam(config, "float_probability", p->float_probability);
+  getParam(config, "float_duration", p->float_duration);
+  getParam(config, "seed", p->seed);
+
+  const YAML::Node events = config["gnss_events"];
+  if (!events)
+  {
+    return;
+  }
+  p->gnss_events.clear();
+  for (std::size_t i = 0; i < events.size(); i++)
+  {
+    SyntheticGnssEvent event = SyntheticGnssEvent();
+    std::string type = events[i]["type"].as<std::string>();
+    if (type == "outage")
+    {
+      event.type = GNSS_OUTAGE;
+    }
+    else if (type == "multipath")
+    {
+      event.type = GNSS_MULTIPATH;
+      event.magnitude = p->multipath_magnitude;
+    }
+    else if (type == "float")
+    {
+      event.type = GNSS_FLOAT;
+    }
+    else
+    {
+      throw std::runtime_error("unknown gnss_events type " + type);
+    }
+    getParam(events[i], "start", event.start);
+    getParam(events[i], "duration", event.duration);
+    getParam(events[i], "magnitude", event.magnitude);
+    p->gnss_events.push_back(event);
+  }
+}
+
+static void printUsage()
+{
+  std::cerr << "Usage: rosrun eagleye_rt synthetic_bag [options] output.bag" << std::endl;
+  std::cerr << "  --config FILE     synthetic drive parameters (see eagleye_rt/config/synthetic_drive.yaml)" << std::endl;
+  std::cerr << "  --duration SEC    length of the drive (default: 1800)" << std::endl;
+  std::cerr << "  --seed N          random seed, overrides the config" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::string config_file;
+  std::string output_file;
+  double duration = 1800;
+  long seed = -1;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "--config" && i + 1 < argc)
+    {
+      config_file = argv[++i];
+    }
+    else if (arg == "--duration" && i + 1 < argc)
+    {
+      duration = std::atof(argv[++i]);
+    }
+    else if (arg == "--seed" && i + 1 < argc)
+    {
+      seed = std::atol(argv[++i]);
+    }
+    else if (arg.compare(0, 2, "--") == 0 || !output_file.empty())
+    {
+      printUsage();
+      return 1;
+    }
+    else
+    {
+      output_file = arg;
+    }
+  }
+
+  if (output_file.empty() || duration <= 0)
+  {
+    printUsage();
+    return 1;
+  }
+
+  SyntheticDriveParameter parameter;
+  setDefaultSyntheticDriveParameter(&parameter);
+
+  unsigned long imu_count = 0;
+  unsigned long gnss_count = 0;
+  unsigned long float_count = 0;
+  unsigned long multipath_count = 0;
+
+  try
+  {
+    if (!config_file.empty())
+    {
+      loadSyntheticDriveParameter(config_file, &parameter);
+    }
+    if (seed >= 0)
+    {
+      parameter.seed = static_cast<unsigned int>(seed);
+    }
+
+    SyntheticDrive drive(parameter);
+    rosbag::Bag bag;
+    bag.open(output_file, rosbag::bagmode::Write);
+
+    while (drive.time() < parameter.start_time + duration)
+    {
+      const SyntheticDriveSample& s = drive.next();
+      const ros::Time& stamp = s.imu.header.stamp;
+
+      bag.write("/imu/data_raw", stamp, s.imu);
+      bag.write("/can_twist", stamp, s.twist);
+      if (s.gnss_updated)
+      {
+        bag.write("/rtklib_nav", stamp, s.rtklib_nav);
+        bag.write("/navsat/fix", stamp, s.fix);
+        gnss_count++;
+        float_count += s.gnss_state == GNSS_STATE_FLOAT ? 1 : 0;
+        multipath_count += s.multipath ? 1 : 0;
+      }
+
+      bag.write("/truth/fix", stamp, s.truth_fix);
+      bag.write("/truth/velocity_scale_factor", stamp, s.velocity_scale_factor);
+      bag.write("/truth/distance", stamp, s.distance);
+      bag.write("/truth/yawrate_offset", stamp, s.yawrate_offset);
+      bag.write("/truth/heading", stamp, s.heading_interpolate);
+      bag.write("/truth/pitching", stamp, s.pitching);
+      bag.write("/truth/height", stamp, s.height);
+      bag.write("/truth/enu_vel", stamp, s.enu_vel);
+      bag.write("/truth/enu_absolute_pos", stamp, s.enu_absolute_pos);
+      imu_count++;
+    }
+
+    bag.close();
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << "synthetic_bag failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << "output " << output_file << std::endl;
+  std::cout << "imu " << imu_count << " gnss " << gnss_count << " float " << float_count << " multipath "
+            << multipath_count << std::endl;
+
+  return 0;
+}
@@ -34,6 +34,7 @@
 #include "sensor_msgs/NavSatFix.h"
 #include "eagleye_msgs/Heading.h"
 #include "eagleye_msgs/Position.h"
+#include "eagleye_msgs/EagleyeState.h"
 #include "tf/transform_broadcaster.h"
 #include "coordinate/coordinate.hpp"
 
@@ -51,6 +52,7 @@ static int convert_height_num = 0;
 static int plane = 7;
 static int tf_num = 1;
 static std::string parent_frame_id, child_frame_id;
+static bool use_eagleye_state = false;
 
 static ConvertHeight convert_height;
 
@@ -69,7 +71,7 @@ void position_callback(const eagleye_msgs::Position::ConstPtr& msg)
   eagleye_position.status = msg->status;
 }
 
-void fix_callback(const sensor_msgs::NavSatFix::ConstPtr& msg)
+static void publish_pose(const sensor_msgs::NavSatFix& msg)
 {
 
   double llh[3] = {0};
@@ -79,18 +81,18 @@ void fix_callback(const sensor_msgs::NavSatFix::ConstPtr& msg)
 
   if (eagleye_position.status.enabled_status == true)
   {
-    llh[0] = msg->latitude * M_PI / 180;
-    llh[1] = msg->longitude* M_PI / 180;
-    llh[2] = msg->altitude;
+    llh[0] = msg.latitude * M_PI / 180;
+    llh[1] = msg.longitude* M_PI / 180;
+    llh[2] = msg.altitude;
 
     if (convert_height_num == 1)
     {
-      convert_height.setLLH(msg->latitude,msg->longitude,msg->altitude);
+      convert_height.setLLH(msg.latitude,msg.longitude,msg.altitude);
       llh[2] = convert_height.convert2altitude();
     }
     else if(convert_height_num == 2)
     {
-      convert_height.setLLH(msg->latitude,msg->longitude,msg->altitude);
+      convert_height.setLLH(msg.latitude,msg.longitude,msg.altitude);
       llh[2] = convert_height.convert2ellipsoid();
     }
 
@@ -114,7 +116,7 @@ void fix_callback(const sensor_msgs::NavSatFix::ConstPtr& msg)
     _quat = tf::createQuaternionMsgFromYaw(0);
   }
 
-  pose.header = msg->header;
+  pose.header = msg.header;
   pose.header.frame_id = "map";
   pose.pose.position.x = xyz[1];
   pose.pose.position.y = xyz[0];
@@ -128,7 +130,27 @@ void fix_callback(const sensor_msgs::NavSatFix::ConstPtr& msg)
   transform.setOrigin(tf::Vector3(pose.pose.position.x, pose.pose.position.y, pose.pose.position.z));
   q.setRPY(0, 0, (90* M_PI / 180)-eagleye_heading.heading_angle);
   transform.setRotation(q);
-  br.sendTransform(tf::StampedTransform(transform, msg->header.stamp, parent_frame_id, child_frame_id));
+  br.sendTransform(tf::StampedTransform(transform, msg.header.stamp, parent_frame_id, child_frame_id));
+}
+void fix_callback(const sensor_msgs::NavSatFix::ConstPtr& msg)
+{
+  publish_pose(*msg);
+}
+
+void eagleye_state_callback(const eagleye_msgs::EagleyeState::ConstPtr& msg)
+{
+  if (msg->updated & eagleye_msgs::EagleyeState::HEADING_INTERPOLATE_3RD)
+  {
+    eagleye_heading = msg->heading_interpolate_3rd;
+  }
+  if (msg->updated & eagleye_msgs::EagleyeState::ENU_ABSOLUTE_POS_INTERPOLATE)
+  {
+    eagleye_position = msg->enu_absolute_pos_interpolate;
+  }
+  if (msg->updated & eagleye_msgs::EagleyeState::FIX)
+  {
+    publish_pose(msg->fix);
+  }
 }
 
 int main(int argc, char** argv)
@@ -141,16 +163,26 @@ int main(int argc, char** argv)
   n.getParam("fix2pose_node/convert_height_num",convert_height_num);
   n.getParam("fix2pose_node/parent_frame_id",parent_frame_id);
   n.getParam("fix2pose_node/child_frame_id",child_frame_id);
+  n.getParam("fix2pose_node/use_eagleye_state",use_eagleye_state);
 
   std::cout<< "plane "<<plane<<std::endl;
   std::cout<< "tf_num "<<tf_num<<std::endl;
   std::cout<< "convert_height_num "<<convert_height_num<<std::endl;
   std::cout<< "parent_frame_id "<<parent_frame_id<<std::endl;
   std::cout<< "child_frame_id "<<child_frame_id<<std::endl;
+  std::cout<< "use_eagleye_state "<<use_eagleye_state<<std::endl;
 
-  ros::Subscriber sub1 = n.subscribe("eagleye/heading_interpolate_3rd", 1000, heading_callback);
-  ros::Subscriber sub2 = n.subscribe("eagleye/enu_absolute_pos_interpolate", 1000, position_callback);
-  ros::Subscriber sub3 = n.subscribe("eagleye/fix", 1000, fix_callback);
+  ros::Subscriber sub1, sub2, sub3;
+  if (use_eagleye_state)
+  {
+    sub1 = n.subscribe("eagleye/eagleye_state", 1000, eagleye_state_callback);
+  }
+  else
+  {
+    sub1 = n.subscribe("eagleye/heading_interpolate_3rd", 1000, heading_callback);
+    sub2 = n.subscribe("eagleye/enu_absolute_pos_interpolate", 1000, position_callback);
+    sub3 = n.subscribe("eagleye/fix", 1000, fix_callback);
+  }
   pub = n.advertise<geometry_msgs::PoseStamped>("/eagleye/pose", 1000);
   ros::spin();
 